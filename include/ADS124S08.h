@@ -38,7 +38,9 @@
 
 #include <SPI.h>
 #include "clsPCA9555.h"
+#include "SpiBusManager.h"
 #include "config.h"
+#include "util/ring_buffer.h"
 
 #ifdef DEVICE_TYPE_ANALOGIC
 
@@ -408,11 +410,40 @@
 */
 #define SPI_WORD_SIZE 8
 
+/* Bit nRDY del byte STATUS: 1 indica que el dispositivo no estaba listo */
+#define ADS_STATUS_NRDY			0x40
+
+/* Reintentos con RDATA de una trama que no supera la validación */
+#define ADS_FRAME_MAX_RETRIES	2
+
+/* Capacidad del buffer circular de muestras en modo streaming */
+#define ADS_STREAM_BUFFER_SIZE 32
+
+/*
+ * Muestra capturada en modo streaming (conversión continua)
+ */
+struct ADS124S08Sample {
+	int32_t raw;       // Código de 24 bits con signo extendido
+	uint8_t status;    // Byte STATUS (0 si SENDSTAT está desactivado)
+	uint8_t crc;       // Byte CRC (0 si CRC está desactivado)
+	uint8_t mux;       // Valor de INPMUX con el que se tomó la muestra
+};
+
+/*
+ * Contadores de error de lectura por canal (indexados por MUXP de INPMUX)
+ */
+struct ADS124S08ChannelErrors {
+	uint32_t crcErrors;     // Tramas con CRC incorrecto
+	uint32_t statusErrors;  // Tramas con nRDY activo
+	uint32_t recovered;     // Conversiones recuperadas con RDATA
+	uint32_t dropped;       // Conversiones descartadas tras agotar los reintentos
+};
+
 class ADS124S08
 {
 	// Device command prototypes
 	public:
-		ADS124S08(PCA9555& ioExpander, SPIClass& spi, SPISettings& spiSettings);
+		ADS124S08(PCA9555& ioExpander, SpiDeviceHandle spiDevice);
 		void init();
 		void ADS124S08_Reset();
 		void begin();
@@ -424,19 +455,37 @@ class ADS124S08
 		void sendCommand(uint8_t op_code);
 		int  rData(uint8_t *dStatus, uint8_t *dData, uint8_t *dCRC);
 		int  dataRead(uint8_t *dStatus, uint8_t *dData, uint8_t *dCRC);
-		void selectDeviceCSLow(void);
+		bool selectDeviceCSLow(void);
 		void releaseChipSelect(void);
 		void assertStart(void);
 		void deassertStart(void);
+		void setDataReadyTimeout(uint32_t timeoutMs);
+		// Modo streaming: conversión continua con el pin START y CS sostenido
+		void startStreaming(uint8_t muxConfig);
+		uint8_t pollStream(uint8_t maxFrames);
+		void stopStreaming(void);
+		bool readSample(ADS124S08Sample &sample);
+		size_t samplesAvailable(void) const;
+		bool isStreaming(void) const;
+		const ADS124S08ChannelErrors &channelErrors(uint8_t muxConfig) const;
+		void clearChannelErrors(void);
 		bool converting;
 		uint8_t registers[NUM_REGISTERS];
   private:
 		bool fStart;
 		void DRDY_int(void);
 		PCA9555* _ioExpander;  // Puntero al expansor IO
-		SPIClass* _spi;        // Puntero a la interfaz SPI
-		SPISettings _spiSettings; // Configuración SPI
+		SpiDeviceHandle _spiDevice; // Dispositivo registrado en SpiBusManager
+		bool _busHeld;         // Bus SPI tomado por selectDeviceCSLow
 		bool _initialized;     // Flag para indicar si se ha inicializado
+		uint32_t _drdyTimeoutMs; // Tiempo máximo de espera de DRDY (ms)
+		bool waitDataReady(void);
+		uint8_t frameLength(void) const;
+		bool readValidatedFrame(ADS124S08Sample &sample, uint8_t mux, bool useRdata);
+		bool _streaming;       // CS sostenido y START en alto
+		uint8_t _streamMux;    // INPMUX de la ráfaga en curso
+		RingBuffer<ADS124S08Sample, ADS_STREAM_BUFFER_SIZE> _stream;
+		ADS124S08ChannelErrors _channelErrors[16];
 };
 
 #endif // DEVICE_TYPE_ANALOGIC
@@ -3,6 +3,36 @@
 
 #include <Arduino.h>
 
+// Número máximo de conversiones por ráfaga (tamaño del buffer de muestras)
+#define ADC_MAX_SAMPLES_PER_BURST 32
+
+/**
+ * @brief Tipo de filtro digital del ADS124S08 (bit FILTER del registro DATARATE)
+ */
+enum AdcFilterType : uint8_t {
+    ADC_FILTER_SINC3 = 0,        // Filtro sinc3 (mejor rechazo, mayor latencia)
+    ADC_FILTER_LOW_LATENCY = 1   // Filtro de baja latencia (settling en un solo periodo)
+};
+
+/**
+ * @brief Método de reducción aplicado a las conversiones de una ráfaga
+ */
+enum AdcReduction : uint8_t {
+    ADC_REDUCE_MEAN = 0,         // Media aritmética
+    ADC_REDUCE_TRIMMED_MEAN = 1, // Media descartando el 25% inferior y superior
+    ADC_REDUCE_MEDIAN = 2        // Mediana
+};
+
+/**
+ * @brief Perfil de adquisición de un canal del ADC
+ */
+struct AdcAcquisitionProfile {
+    uint8_t dataRate;            // Código ADS_DR_* del registro DATARATE
+    AdcFilterType filter;        // Filtro digital
+    uint8_t numSamples;          // Conversiones por ráfaga (1..ADC_MAX_SAMPLES_PER_BURST)
+    AdcReduction reduction;      // Reducción de las conversiones a un único valor
+};
+
 /**
  * @brief Clase para gestionar funciones de utilidad relacionadas con el ADC
  */
@@ -14,6 +44,61 @@ public:
      * @return Voltaje diferencial medido (en V), o NAN en caso de error.
      */
     static float measureAdcDifferential(uint8_t muxConfig);
+
+    /**
+     * @brief Mide el voltaje diferencial con un perfil de adquisición propio del canal.
+     *        Todas las conversiones se toman dentro de una única ráfaga en modo continuo
+     *        y se reducen según el perfil (media, media recortada o mediana). La
+     *        desviación de la ráfaga entra en el seguimiento de ruido del ciclo (reportNoise).
+     * @param muxConfig Valor del registro INPMUX
+     * @param profile Perfil de adquisición del canal
+     * @return Voltaje diferencial reducido (en V), o NAN si no hubo conversiones válidas.
+     */
+    static float measureAdcDifferential(uint8_t muxConfig,
+                                        const AdcAcquisitionProfile& profile);
+
+    /**
+     * @brief Devuelve el periodo de conversión (en µs) para un código ADS_DR_*
+     * @param dataRate Código de data rate
+     * @return Periodo de conversión en microsegundos
+     */
+    static uint32_t conversionPeriodUs(uint8_t dataRate);
+
+    /**
+     * @brief Acumula los contadores de error por canal del ADS124S08 en memoria RTC y, si
+     *        el ciclo tuvo errores nuevos, los registra en Diagnostics (AdcErrorsDiag).
+     *        Llamar una vez por ciclo tras leer los sensores del ADC.
+     */
+    static void reportChannelErrors();
+
+    /**
+     * @brief Registra en Diagnostics (AdcNoiseDiag) la ráfaga más ruidosa del ciclo si su
+     *        desviación supera ADC_NOISE_REPORT_UV, y reinicia el seguimiento. Llamar una
+     *        vez por ciclo tras leer los sensores del ADC.
+     */
+    static void reportNoise();
+
+private:
+    /**
+     * @brief Convierte un código crudo de 24 bits a voltaje (referencia interna de 2.5V)
+     */
+    static float rawToVoltage(int32_t rawData);
+
+    /**
+     * @brief Reduce un conjunto de muestras a un único valor
+     * @param samples Muestras (se ordenan in situ para media recortada y mediana)
+     * @param count Número de muestras
+     * @param reduction Método de reducción
+     */
+    static float reduceSamples(float* samples, uint8_t count, AdcReduction reduction);
+
+    /**
+     * @brief Actualiza la ráfaga más ruidosa del ciclo con una nueva ráfaga
+     * @param muxConfig INPMUX de la ráfaga
+     * @param samples Muestras en V (antes de reducir)
+     * @param count Número de muestras
+     */
+    static void trackNoise(uint8_t muxConfig, const float* samples, uint8_t count);
 };
 
-#endif // ADC_UTILITIES_H 
\ No newline at end of file
+#endif // ADC_UTILITIES_H
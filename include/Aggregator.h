@@ -0,0 +1,84 @@
+/*******************************************************************************************
+ * Archivo: include/Aggregator.h
+ * Descripción: Agregación por ventana entre uplinks. Los sensores con aggWindow > 1 se
+ *              acumulan en cada muestra (Welford, estado en memoria RTC) y, al completar la
+ *              ventana, queda un resumen pendiente que se envía en el siguiente ciclo de
+ *              reporte por LORA_AGG_FPORT en lugar de las muestras individuales.
+ *
+ *              Formato del uplink (little-endian):
+ *                version u8 | timestamp u32 | n u8 | n resúmenes
+ *              Cada resumen:
+ *                idLen u8 | sensorId | type u8 | subIndex u8 | stats u8 | age u16 (s antes
+ *                de timestamp) | [count u16] [min f32] [max f32] [mean f32] [stddev f32]
+ *              Los campos entre corchetes aparecen según los bits de stats, en ese orden.
+ *******************************************************************************************/
+
+#ifndef AGGREGATOR_H
+#define AGGREGATOR_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "sensor_types.h"
+#include "BootManager.h"
+#include "util/span.h"
+
+// Estadísticas del resumen (máscara de bits de aggStats)
+#define AGG_STAT_COUNT      0x01
+#define AGG_STAT_MIN        0x02
+#define AGG_STAT_MAX        0x04
+#define AGG_STAT_MEAN       0x08
+#define AGG_STAT_STDDEV     0x10
+#define AGG_STAT_ALL        0x1F
+
+#define AGG_RECORD_VERSION  1
+
+class Aggregator {
+public:
+    /**
+     * @brief Descarta ventanas y resúmenes tras un arranque en frío o de configuración
+     */
+    static void begin(BootMode bootMode);
+
+    /**
+     * @brief Acumula las lecturas de los sensores agregados. La vista de lecturas se
+     *        sustituye por las que se envían tal cual (tabla estática hasta la siguiente
+     *        llamada). readings[i] debe corresponder a configs[i].
+     * @param timestamp Hora de la muestra, para la antigüedad de los resúmenes
+     */
+    static void feed(Span<const SensorConfig> configs, Span<const SensorReading>& readings,
+                     uint32_t timestamp);
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    static void feed(Span<const ModbusSensorConfig> configs, Span<const ModbusSensorReading>& readings,
+                     uint32_t timestamp);
+#endif
+
+    /**
+     * @brief true si hay resúmenes de ventana pendientes de envío
+     */
+    static bool pending();
+
+    /**
+     * @brief Serializa los resúmenes pendientes que quepan en el buffer
+     * @return Bytes escritos (0 si no hay nada que enviar)
+     */
+    static size_t encode(uint32_t timestamp, uint8_t* buffer, size_t bufferSize);
+
+    /**
+     * @brief Libera los resúmenes incluidos en el último encode() (tras un envío correcto)
+     */
+    static void markSent();
+
+private:
+    static int8_t channelFor(const char* sensorId, SensorType type, uint8_t subIndex,
+                             uint8_t window, uint8_t stats);
+    static bool accumulate(const char* sensorId, SensorType type, uint8_t window, uint8_t stats,
+                           const float* values, uint8_t count, uint32_t timestamp);
+
+    static SensorReading _passNormal[MAX_NORMAL_SENSORS];
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    static ModbusSensorReading _passModbus[MAX_MODBUS_SENSORS];
+#endif
+};
+
+#endif // AGGREGATOR_H
@@ -0,0 +1,69 @@
+/*******************************************************************************************
+ * Archivo: include/AirtimeBudget.h
+ * Descripción: Contabilidad del tiempo en el aire de los uplinks. Cada uplink suma su ToA
+ *              (calculado con el SF, ancho de banda y tasa de código del DR usado y la
+ *              longitud de la trama) a cubetas horarias en memoria RTC, de las que salen los
+ *              totales móviles de la última hora y de las últimas 24 h. Un uplink que
+ *              superaría AIRTIME_BUDGET_HOUR_MS o AIRTIME_BUDGET_DAY_MS se aplaza: los datos
+ *              pasan al lote (BatchBuffer) y los resúmenes y diagnósticos quedan pendientes.
+ *              Al cerrar cada hora se registra una entrada de diagnóstico con los contadores.
+ *******************************************************************************************/
+
+#ifndef AIRTIME_BUDGET_H
+#define AIRTIME_BUDGET_H
+
+#include <Arduino.h>
+#include <RTClib.h>
+#include "config.h"
+
+// Resultado de un uplink no transmitido por falta de presupuesto (fuera del rango de RadioLib)
+#define AIRTIME_ERR_OVER_BUDGET     (-2001)
+
+class AirtimeBudget {
+public:
+    /**
+     * @brief Inicializa los contadores solo si la memoria RTC no los conserva (magic
+     *        inválido tras perder la alimentación)
+     */
+    static void begin(RTC_DS3231& rtc);
+
+    /**
+     * @brief ToA estimado (ms) de un uplink con el DR que se usaría para él
+     */
+    static uint32_t estimateMs(size_t payloadLength);
+
+    /**
+     * @brief true si un uplink de este tamaño cabe en el presupuesto; si no, lo cuenta
+     *        como aplazado
+     */
+    static bool allows(size_t payloadLength);
+
+    /**
+     * @brief Suma el ToA de un uplink transmitido
+     * @param datarate DR del evento de uplink de RadioLib
+     */
+    static void record(uint8_t datarate, size_t payloadLength);
+
+    /**
+     * @brief Tamaño del último uplink de datos (estimación para el siguiente)
+     */
+    static size_t lastDataLength();
+
+    /**
+     * @brief Anota el tamaño de un uplink de datos
+     */
+    static void noteDataLength(size_t payloadLength);
+
+    /**
+     * @brief Tiempo en el aire de la última hora (móvil) y de las últimas 24 h (ms)
+     */
+    static uint32_t hourMs();
+    static uint32_t dayMs();
+
+private:
+    static void advance();
+
+    static RTC_DS3231* _rtc;
+};
+
+#endif // AIRTIME_BUDGET_H
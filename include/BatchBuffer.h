@@ -0,0 +1,76 @@
+/*******************************************************************************************
+ * Archivo: include/BatchBuffer.h
+ * Descripción: Lote de muestras entre uplinks. Con BATCH_UPLINK_ENABLED cada ciclo añade
+ *              una fila (timestamp + valores cuantizados por canal) en memoria RTC y en los
+ *              ciclos de reporte el lote se envía codificado por columnas (util/batch_codec.h)
+ *              por LORA_BATCH_FPORT, en tramas de hasta BATCH_FRAME_MAX_BYTES.
+ *
+ *              Tag de cada columna (7 bits): posición << 2 | subvalor, con la posición del
+ *              sensor en la lista de habilitados (normales 0..15, Modbus 16 + índice) y
+ *              BATCH_TAG_BATTERY para la tensión de batería. Cada columna se cuantiza con
+ *              los decimales de su magnitud (BATCH_DECIMALS, _FINE o _COARSE).
+ *
+ *              Un downlink de comandos no descarta el lote: la nueva configuración se aplica
+ *              desde el siguiente despertar, así que las filas con timestamp anterior al
+ *              uplink que recibió el downlink usan las posiciones de la lista anterior.
+ *******************************************************************************************/
+
+#ifndef BATCH_BUFFER_H
+#define BATCH_BUFFER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "sensor_types.h"
+#include "BootManager.h"
+#include "util/span.h"
+
+#define BATCH_POSITION_MODBUS   16
+#define BATCH_TAG_BATTERY       (31 << 2)
+
+class BatchBuffer {
+public:
+    /**
+     * @brief Descarta el lote tras un arranque en frío o de configuración
+     */
+    static void begin(BootMode bootMode);
+
+    /**
+     * @brief Añade una fila con las lecturas del ciclo y la batería. Si el lote está
+     *        lleno se descarta la fila más antigua.
+     * @param enabled Sensores habilitados, para la posición de cada lectura
+     */
+    static void append(Span<const SensorConfig> enabled, Span<const SensorReading> readings,
+                       uint32_t timestamp);
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    static void append(Span<const SensorConfig> enabled, Span<const SensorReading> readings,
+                       Span<const ModbusSensorConfig> enabledModbus,
+                       Span<const ModbusSensorReading> modbusReadings, uint32_t timestamp);
+#endif
+
+    /**
+     * @brief true si hay filas pendientes de envío
+     */
+    static bool pending();
+
+    /**
+     * @brief Codifica las filas más antiguas que quepan en el buffer
+     * @return Bytes escritos (0 si no hay nada que enviar)
+     */
+    static size_t encode(uint8_t* buffer, size_t bufferSize);
+
+    /**
+     * @brief Libera las filas incluidas en el último encode() (tras un envío correcto)
+     */
+    static void markSent();
+
+private:
+    static uint8_t beginRow(uint32_t timestamp);
+    static void put(uint8_t row, uint8_t tag, float value, uint8_t decimals);
+    static void putReading(uint8_t row, uint8_t position, const SensorReading& reading);
+    static void dropRows(uint8_t count);
+
+    static uint8_t _encodedRows;
+};
+
+#endif // BATCH_BUFFER_H
@@ -0,0 +1,127 @@
+/*******************************************************************************************
+ * Archivo: include/BootManager.h
+ * Descripción: Clasificación del arranque (frío, despertar por temporizador, modo
+ *              configuración) y registro de "estado caliente" en memoria RTC. En un
+ *              despertar por temporizador con estado válido se restaura la configuración y
+ *              los registros del PCA9555 desde RTC en lugar de volver a leer NVS y sondear
+ *              el hardware que conservó su estado durante el deep sleep.
+ *******************************************************************************************/
+
+#ifndef BOOT_MANAGER_H
+#define BOOT_MANAGER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "sensor_types.h"
+#include "clsPCA9555.h"
+#include "util/span.h"
+
+#define WARM_STATE_MAGIC    0x57A3C0DEUL
+
+/**
+ * @brief Tipo de arranque
+ */
+enum BootMode : uint8_t {
+    BOOT_MODE_COLD = 0,     // Encendido, reset o estado RTC inválido: secuencia completa
+    BOOT_MODE_WARM,         // Despertar por temporizador con estado RTC válido
+    BOOT_MODE_CONFIG        // Despertar por el pin de configuración: secuencia completa
+};
+
+/**
+ * @brief Estado que sobrevive al deep sleep en memoria RTC
+ */
+struct WarmState {
+    uint32_t magic;
+    uint8_t schemaVersion;                  // CONFIG_SCHEMA_VERSION al guardarlo
+    uint32_t timeToSleep;
+    char deviceId[MAX_ID_LENGTH];
+    char stationId[MAX_ID_LENGTH];
+    uint8_t normalCount;
+    SensorConfig normalSensors[MAX_NORMAL_SENSORS];
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    uint8_t modbusCount;
+    ModbusSensorConfig modbusSensors[MAX_MODBUS_SENSORS];
+#endif
+    uint16_t ioConfiguration;               // Registros del PCA9555 antes de ioExpander.sleep()
+    uint16_t ioOutput;
+    uint8_t hardwareValid;                  // Se guardaron los registros del PCA9555
+    uint8_t reloadConfig;                   // La configuración cambió en NVS: releerla
+    uint16_t crc;                           // CRC-16 de todos los campos anteriores
+};
+
+class BootManager {
+public:
+    /**
+     * @brief Clasifica el arranque a partir de esp_sleep_get_wakeup_cause() y la validez
+     *        del estado RTC. Llamar una vez al inicio de setup().
+     */
+    static BootMode begin();
+
+    /**
+     * @brief Tipo de arranque clasificado por begin()
+     */
+    static BootMode mode();
+
+    /**
+     * @brief Guarda la configuración cargada de NVS para los siguientes despertares
+     */
+    static void storeConfig(uint32_t timeToSleep, const char* deviceId, const char* stationId,
+                            Span<const SensorConfig> normalSensors
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+                            , Span<const ModbusSensorConfig> modbusSensors
+#endif
+                            );
+
+    /**
+     * @brief Restaura la configuración guardada (solo en BOOT_MODE_WARM)
+     * @return false si no hay estado válido o se pidió releer NVS con requestConfigReload()
+     */
+    static bool restoreConfig(uint32_t& timeToSleep,
+                              char* deviceId, size_t deviceIdSize,
+                              char* stationId, size_t stationIdSize,
+                              SensorConfig* normalSensors, size_t& normalCount
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+                              , ModbusSensorConfig* modbusSensors, size_t& modbusCount
+#endif
+                              );
+
+    /**
+     * @brief Restaura los registros del PCA9555 guardados antes de dormir
+     * @return false si no hay registros válidos o el PCA9555 no respondió
+     */
+    static bool restoreExpander(PCA9555& ioExpander);
+
+    /**
+     * @brief Guarda el estado del hardware y sella el registro. Llamar justo antes de
+     *        poner el PCA9555 en modo sleep.
+     */
+    static void commitBeforeSleep(PCA9555& ioExpander);
+
+    /**
+     * @brief Invalida el estado RTC (p.ej. tras cambiar la configuración por BLE)
+     */
+    static void invalidate();
+
+    /**
+     * @brief Pide releer la configuración de NVS en el siguiente despertar (p.ej. tras un
+     *        downlink de comandos). A diferencia de invalidate(), el arranque sigue siendo
+     *        BOOT_MODE_WARM y los módulos conservan su estado RTC.
+     */
+    static void requestConfigReload();
+
+    /**
+     * @brief true si este arranque releyó la configuración por requestConfigReload(); los
+     *        módulos que copian límites de NVS a su estado RTC deben refrescarlos
+     */
+    static bool configReloaded();
+
+private:
+    static bool isValid();
+    static void seal();
+
+    static BootMode _mode;
+    static bool _sealAllowed;
+    static bool _configReloaded;
+};
+
+#endif // BOOT_MANAGER_H
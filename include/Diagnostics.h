@@ -0,0 +1,132 @@
+/*******************************************************************************************
+ * Archivo: include/Diagnostics.h
+ * Descripción: Uplink de diagnóstico. Los módulos registran entradas binarias TLV
+ *              (etiqueta, longitud, datos) que se acumulan en memoria RTC y se envían por
+ *              LORA_DIAG_FPORT en el siguiente ciclo de reporte. Una entrada nueva con la
+ *              misma etiqueta reemplaza a la pendiente.
+ *******************************************************************************************/
+
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <Arduino.h>
+#include "util/span.h"
+
+// Tamaño máximo del payload de diagnóstico (cabe en DR0 de US915 junto con FOpts)
+#define DIAG_MAX_PAYLOAD    48
+
+/**
+ * @brief Etiquetas de las entradas de diagnóstico
+ */
+enum DiagnosticTag : uint8_t {
+    DIAG_TAG_INTERVAL_POLICY = 0x01,    // IntervalPolicyDiag
+    DIAG_TAG_LINK_POLICY = 0x02,        // LinkPolicyDiag
+    DIAG_TAG_COMMAND_ACK = 0x03,        // CommandAckDiag
+    DIAG_TAG_AIRTIME = 0x04,            // AirtimeDiag
+    DIAG_TAG_ADC_ERRORS = 0x05,         // AdcErrorsDiag
+    DIAG_TAG_ADC_NOISE = 0x06,          // AdcNoiseDiag
+    DIAG_TAG_RAIL_TIME = 0x07           // RailTimeDiag
+};
+
+/**
+ * @brief Decisión del intervalo adaptativo (little-endian)
+ */
+struct __attribute__((packed)) IntervalPolicyDiag {
+    uint32_t interval;          // Intervalo aplicado (s)
+    uint16_t batteryMv;         // Batería al decidir (0 = no disponible)
+    uint8_t band;               // Banda de batería (0 = buena)
+    uint8_t reasons;            // INTERVAL_REASON_*
+    uint16_t changePermille;    // Mayor cambio relativo entre ciclos (‰)
+};
+
+/**
+ * @brief Cambio de DR/potencia de la política de enlace (little-endian)
+ */
+struct __attribute__((packed)) LinkPolicyDiag {
+    uint8_t datarate;
+    int8_t txPower;             // dBm
+    int8_t margin;              // Último margen (dB, -128 = desconocido)
+    uint8_t gatewayCount;
+    int16_t rssi;               // Último downlink (dBm)
+    int8_t snrQuarterDb;        // Último downlink (0,25 dB)
+    uint8_t lossStreak;
+    uint16_t uplinks;
+    uint16_t linkAnswers;
+};
+
+/**
+ * @brief Confirmación de un downlink de comandos
+ */
+struct __attribute__((packed)) CommandAckDiag {
+    uint8_t seq;                // seq del downlink
+    uint8_t status;             // CommandStatus
+    uint8_t applied;            // Comandos aplicados
+    uint8_t failedOpcode;       // Opcode rechazado (0 si status es OK)
+};
+
+/**
+ * @brief Contadores de tiempo en el aire al cerrar cada hora (little-endian)
+ */
+struct __attribute__((packed)) AirtimeDiag {
+    uint32_t hourMs;            // Tiempo en el aire de la hora cerrada (ms)
+    uint32_t dayMs;             // Últimas 24 h (ms)
+    uint16_t uplinks;           // Uplinks desde el arranque en frío
+    uint16_t deferred;          // Uplinks aplazados por presupuesto
+    uint8_t lastDatarate;       // DR del último uplink
+};
+
+/**
+ * @brief Errores de trama del ADS124S08 desde el arranque en frío (little-endian). Se
+ *        registra solo en los ciclos con errores nuevos.
+ */
+struct __attribute__((packed)) AdcErrorsDiag {
+    uint16_t channelMask;       // Bit n: AINn (MUXP) tuvo algún error
+    uint16_t crcErrors;         // Tramas con CRC incorrecto
+    uint16_t statusErrors;      // Tramas con nRDY activo
+    uint16_t dropped;           // Conversiones descartadas tras agotar los reintentos
+};
+
+/**
+ * @brief Ráfaga del ADC más ruidosa del ciclo (little-endian). Se registra solo si su
+ *        desviación supera ADC_NOISE_REPORT_UV.
+ */
+struct __attribute__((packed)) AdcNoiseDiag {
+    uint8_t channel;            // AINn (MUXP) de la ráfaga
+    uint8_t samples;            // Conversiones válidas
+    uint16_t sigmaUv;           // Desviación estándar muestral (µV, saturada)
+    uint16_t spanUv;            // Máximo - mínimo (µV, saturado)
+};
+
+/**
+ * @brief Tiempo de encendido de los rieles desde el arranque en frío (little-endian). Viaja
+ *        con cualquier otro diagnóstico pendiente.
+ */
+struct __attribute__((packed)) RailTimeDiag {
+    uint32_t onMs[3];           // Por riel: 3V3, 2V5, 12V (0 si no existe en el dispositivo)
+};
+
+class Diagnostics {
+public:
+    /**
+     * @brief Registra una entrada, reemplazando la pendiente con la misma etiqueta
+     * @return false si no cabe en el payload
+     */
+    static bool add(DiagnosticTag tag, const void* data, uint8_t length);
+
+    /**
+     * @brief Hay entradas pendientes de enviar
+     */
+    static bool pending();
+
+    /**
+     * @brief Payload TLV acumulado
+     */
+    static Span<const uint8_t> payload();
+
+    /**
+     * @brief Descarta las entradas (tras enviarlas)
+     */
+    static void clear();
+};
+
+#endif // DIAGNOSTICS_H
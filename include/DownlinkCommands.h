@@ -0,0 +1,59 @@
+/*******************************************************************************************
+ * Archivo: include/DownlinkCommands.h
+ * Descripción: Canal de comandos por downlink (LORA_CMD_FPORT) para ajustar el muestreo
+ *              y el reporte sin BLE. Formato binario, enteros little-endian:
+ *
+ *                [seq u8] { [opcode u8] [argumentos] }...
+ *
+ *              Opcodes:
+ *                0x01 CMD_SET_INTERVAL        u32 intervalo de sueño (s)
+ *                0x02 CMD_SET_INTERVAL_BOUNDS u32 mínimo, u32 máximo (s)
+ *                0x03 CMD_SET_DR_LIMITS       u8 DR mínimo, u8 DR máximo
+ *                0x10 CMD_SENSOR_ENABLE       u8 sensor, u8 habilitado (0/1)
+ *                0x11 CMD_SENSOR_PERIOD       u8 sensor, u8 periodTicks
+ *                0x12 CMD_SENSOR_AGGREGATE    u8 sensor, u8 aggWindow, u8 aggStats
+ *                0x13 CMD_SENSOR_TOLERANCE    u8 sensor, f32 predictTolerance
+ *
+ *              El byte de sensor es el índice en la lista configurada (incluidos los
+ *              deshabilitados); con el bit 7 se refiere a la lista de sensores Modbus.
+ *              Todos los comandos se validan antes de aplicar ninguno: un downlink se
+ *              aplica completo o no se aplica. El resultado se confirma con una entrada
+ *              de diagnóstico DIAG_TAG_COMMAND_ACK, que sale en el siguiente uplink de
+ *              diagnóstico; el servidor reintenta mientras no reciba el ack de su seq.
+ *******************************************************************************************/
+
+#ifndef DOWNLINK_COMMANDS_H
+#define DOWNLINK_COMMANDS_H
+
+#include <Arduino.h>
+
+#define CMD_SET_INTERVAL            0x01
+#define CMD_SET_INTERVAL_BOUNDS     0x02
+#define CMD_SET_DR_LIMITS           0x03
+#define CMD_SENSOR_ENABLE           0x10
+#define CMD_SENSOR_PERIOD           0x11
+#define CMD_SENSOR_AGGREGATE        0x12
+#define CMD_SENSOR_TOLERANCE        0x13
+
+#define CMD_SENSOR_MODBUS_FLAG      0x80
+
+/**
+ * @brief Resultado de un downlink de comandos (campo status del ack)
+ */
+enum CommandStatus : uint8_t {
+    CMD_STATUS_OK = 0,
+    CMD_STATUS_UNKNOWN_OPCODE = 1,      // Opcode no soportado por este firmware
+    CMD_STATUS_TRUNCATED = 2,           // Faltan bytes de argumentos
+    CMD_STATUS_INVALID_ARGUMENT = 3,    // Valor fuera de rango o sensor inexistente
+    CMD_STATUS_EMPTY = 4                // Sin seq
+};
+
+class DownlinkCommands {
+public:
+    /**
+     * @brief Valida y aplica un downlink recibido en LORA_CMD_FPORT y registra el ack
+     */
+    static void handle(const uint8_t* payload, size_t length);
+};
+
+#endif // DOWNLINK_COMMANDS_H
@@ -0,0 +1,83 @@
+/*******************************************************************************************
+ * Archivo: include/DualPredictor.h
+ * Descripción: Supresión por predicción dual. Cada canal (sensor o subvalor) con
+ *              predictTolerance > 0 tiene un modelo en memoria RTC idéntico al del servidor
+ *              (util/dual_predictor.h, modelo PREDICT_MODEL). En los ciclos de reporte una
+ *              lectura solo se incluye en el payload si algún valor se aparta de la
+ *              predicción más que la tolerancia, si falló (NaN) o si el canal lleva
+ *              PREDICT_MAX_SILENCE_S sin transmitirse; al incluirla ambos lados actualizan
+ *              el modelo con el valor enviado (3 decimales) y el timestamp del payload. El
+ *              dispositivo solo lo actualiza tras un envío correcto (commit()). Cuando se
+ *              descartan los modelos (arranque en frío) el siguiente payload lo indica
+ *              (resetPending()) para que el servidor descarte también los suyos.
+ *******************************************************************************************/
+
+#ifndef DUAL_PREDICTOR_H
+#define DUAL_PREDICTOR_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "sensor_types.h"
+#include "BootManager.h"
+#include "util/span.h"
+
+class DualPredictor {
+public:
+    /**
+     * @brief Descarta los modelos tras un arranque en frío o de configuración
+     */
+    static void begin(BootMode bootMode);
+
+    /**
+     * @brief Inicia un ciclo de reporte (antes de filter())
+     */
+    static void beginCycle();
+
+    /**
+     * @brief Quita de la vista las lecturas que el modelo predice dentro de la tolerancia
+     *        (tabla estática hasta la siguiente llamada). Las configuraciones se buscan
+     *        por sensorId.
+     * @param timestamp Timestamp del payload de este ciclo
+     */
+    static void filter(Span<const SensorConfig> configs, Span<const SensorReading>& readings,
+                       uint32_t timestamp);
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    static void filter(Span<const ModbusSensorConfig> configs, Span<const ModbusSensorReading>& readings,
+                       uint32_t timestamp);
+#endif
+
+    /**
+     * @brief Aplica a los modelos las lecturas incluidas por filter() en este ciclo, una vez
+     *        enviado el payload. Sin commit() los modelos siguen como antes del ciclo.
+     */
+    static void commit();
+
+    /**
+     * @brief true si los modelos se descartaron y ningún payload lo ha comunicado todavía
+     */
+    static bool resetPending();
+
+    /**
+     * @brief true si en este ciclo se suprimieron lecturas y no queda ninguna por enviar:
+     *        el uplink de datos puede omitirse
+     */
+    static bool silent();
+
+private:
+    static bool mustSend(const char* sensorId, float tolerance, const float* values, uint8_t count,
+                         uint32_t timestamp);
+
+    static uint8_t _sent;
+    static uint8_t _suppressed;
+    static uint8_t _pendingCount;               // Actualizaciones a la espera del envío
+    static uint32_t _pendingTime;
+    static int8_t _pendingSlots[PREDICT_MAX_CHANNELS];
+    static int32_t _pendingValues[PREDICT_MAX_CHANNELS];
+    static SensorReading _sendNormal[MAX_NORMAL_SENSORS];
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    static ModbusSensorReading _sendModbus[MAX_MODBUS_SENSORS];
+#endif
+};
+
+#endif // DUAL_PREDICTOR_H
@@ -15,7 +15,7 @@
 #include "clsPCA9555.h"
 #include "SHT31.h"
 #include "sensor_types.h"
-#include <vector>
+#include "util/span.h"
 
 class HardwareManager {
 public:
@@ -26,11 +26,14 @@ public:
      * @param sht30Sensor Referencia al sensor SHT30
      * @param spi Referencia a la interfaz SPI
      * @param enabledNormalSensors Vector con las configuraciones de sensores habilitados
+     * @param warmBoot true en un despertar por temporizador con estado RTC válido: se
+     *                 restauran los registros del PCA9555 y se omite el reset del SHT30
      * @return true si la inicialización fue exitosa, false en caso contrario
      */
     static bool initHardware(PCA9555& ioExpander, PowerManager& powerManager, 
                            SHT31& sht30Sensor, SPIClass& spi,
-                           const std::vector<SensorConfig>& enabledNormalSensors);
+                           Span<const SensorConfig> enabledNormalSensors,
+                           bool warmBoot = false);
 
     /**
      * @brief Inicializa los pines de selección SPI (SS)
@@ -0,0 +1,39 @@
+/*******************************************************************************************
+ * Archivo: include/HeapProbe.h
+ * Descripción: Contador de asignaciones de heap para verificar que el ciclo de medición y
+ *              envío no usa memoria dinámica. Solo el entorno
+ *              esp32-c3-devkitc-02-heapprobe define HEAP_PROBE_ENABLED y enlaza con
+ *              -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc; en el firmware de campo las
+ *              funciones no hacen nada.
+ *******************************************************************************************/
+
+#ifndef HEAP_PROBE_H
+#define HEAP_PROBE_H
+
+#include <stdint.h>
+
+class HeapProbe {
+public:
+#ifdef HEAP_PROBE_ENABLED
+    /**
+     * @brief Guarda el contador actual como punto de referencia
+     */
+    static void mark();
+
+    /**
+     * @brief Asignaciones realizadas desde la última llamada a mark()
+     */
+    static uint32_t sinceMark();
+
+    /**
+     * @brief Asignaciones totales desde el arranque
+     */
+    static uint32_t allocationCount();
+#else
+    static void mark() {}
+    static uint32_t sinceMark() { return 0; }
+    static uint32_t allocationCount() { return 0; }
+#endif
+};
+
+#endif // HEAP_PROBE_H
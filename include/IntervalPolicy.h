@@ -0,0 +1,54 @@
+/*******************************************************************************************
+ * Archivo: include/IntervalPolicy.h
+ * Descripción: Intervalo de muestreo adaptativo. Parte del intervalo configurado, lo alarga
+ *              según la banda de batería (BATTERY_BAND_*) y lo acorta cuando las lecturas
+ *              cambian rápido entre ciclos. El resultado queda dentro de los límites fijados
+ *              por el servidor y cada cambio de decisión se registra en el uplink de
+ *              diagnóstico.
+ *******************************************************************************************/
+
+#ifndef INTERVAL_POLICY_H
+#define INTERVAL_POLICY_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "sensor_types.h"
+#include "BootManager.h"
+#include "util/span.h"
+
+// Motivos de la decisión (máscara de bits)
+#define INTERVAL_REASON_BATTERY     0x01    // Alargado por banda de batería
+#define INTERVAL_REASON_FAST_CHANGE 0x02    // Acortado por cambio rápido de las lecturas
+#define INTERVAL_REASON_CLAMPED     0x04    // Recortado a los límites del servidor
+
+// Sensores cuyo primer valor se sigue entre mediciones
+#define INTERVAL_POLICY_TRACKED     (MAX_NORMAL_SENSORS + MAX_MODBUS_SENSORS)
+
+#define BATTERY_BAND_COUNT          4
+
+class IntervalPolicy {
+public:
+    /**
+     * @brief Reinicia el estado tras un arranque en frío y carga los límites de NVS.
+     *        En un despertar en caliente se conserva el estado RTC.
+     */
+    static void begin(BootMode bootMode);
+
+    /**
+     * @brief Calcula el intervalo del siguiente sueño a partir de las lecturas del ciclo
+     * @param baseInterval Intervalo configurado (s)
+     * @return Intervalo a aplicar (s)
+     */
+    static uint32_t update(uint32_t baseInterval,
+                           Span<const SensorReading> normalReadings
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+                           , Span<const ModbusSensorReading> modbusReadings
+#endif
+                           );
+
+private:
+    static uint8_t batteryBand(float voltage, uint8_t currentBand);
+    static float trackChange(const char* sensorId, float value);
+};
+
+#endif // INTERVAL_POLICY_H
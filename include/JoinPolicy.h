@@ -0,0 +1,61 @@
+/*******************************************************************************************
+ * Archivo: include/JoinPolicy.h
+ * Descripción: Reintentos de join con back-off exponencial y memoria de sub-banda. Tras
+ *              cada join fallido (contados en memoria RTC) el siguiente intento se
+ *              aplaza JOIN_BACKOFF_BASE_S · 2^(fallos-1), hasta JOIN_BACKOFF_MAX_S, con un
+ *              ±JOIN_BACKOFF_JITTER_PERCENT aleatorio para que los nodos que perdieron la red
+ *              a la vez no vuelvan a la vez. En bandas de canales fijos (US915) el join
+ *              empieza en la última sub-banda que funcionó (memoria RTC y NVS) y, con
+ *              JOIN_SUBBAND_SCAN, cada JOIN_ATTEMPTS_PER_SUBBAND fallos pasa a la siguiente.
+ *******************************************************************************************/
+
+#ifndef JOIN_POLICY_H
+#define JOIN_POLICY_H
+
+#include <Arduino.h>
+#include <RTClib.h>
+#include "config.h"
+#include "BootManager.h"
+
+class JoinPolicy {
+public:
+    /**
+     * @brief Carga de NVS la última sub-banda buena tras un arranque en frío. Los fallos
+     *        seguidos (RTC_NOINIT_ATTR) solo se descartan al perder la alimentación: un
+     *        reset por brown-out, WDT o pánico durante los reintentos no acorta el back-off.
+     */
+    static void begin(RTC_DS3231& rtc, BootMode bootMode);
+
+    /**
+     * @brief Sub-banda para la siguiente activación (0 = la elige RadioLib)
+     */
+    static uint8_t subBand();
+
+    /**
+     * @brief true si ya pasó el back-off del último join fallido
+     */
+    static bool mayJoin();
+
+    /**
+     * @brief Cuenta el join fallido y programa el siguiente intento
+     */
+    static void onJoinFailed();
+
+    /**
+     * @brief Recuerda la sub-banda con la que se unió el nodo
+     */
+    static void onJoinSucceeded();
+
+    /**
+     * @brief Sueño tras no poder activar la radio: hasta el siguiente intento de join, sin
+     *        bajar del intervalo configurado
+     */
+    static uint32_t retrySleep(uint32_t interval);
+
+private:
+    static uint32_t now();
+
+    static RTC_DS3231* _rtc;
+};
+
+#endif // JOIN_POLICY_H
@@ -0,0 +1,85 @@
+/*******************************************************************************************
+ * Archivo: include/LinkPolicy.h
+ * Descripción: Selección de datarate y potencia de transmisión según el margen del enlace.
+ *              Con LINK_NETWORK_ADR el servidor decide (ADR de LoRaWAN); en caso contrario
+ *              una política local usa las respuestas LinkCheck (margen medido en el gateway)
+ *              y el SNR de los downlinks para elegir el DR de menor airtime y la menor
+ *              potencia que mantienen LINK_TARGET_MARGIN_DB. Tras LINK_LOSSES_BEFORE_FALLBACK
+ *              LinkCheck sin respuesta retrocede un paso (primero potencia máxima, luego un
+ *              DR más robusto). El estado y las estadísticas del enlace viven en memoria RTC.
+ *******************************************************************************************/
+
+#ifndef LINK_POLICY_H
+#define LINK_POLICY_H
+
+#include <Arduino.h>
+#include <RadioLib.h>
+#include "config.h"
+#include "BootManager.h"
+
+#define LINK_MARGIN_UNKNOWN     INT8_MIN
+
+/**
+ * @brief Estadísticas del enlace (acumuladas desde el último arranque en frío)
+ */
+struct LinkStats {
+    uint8_t datarate;           // DR de uplink elegido por la política
+    int8_t txPower;             // Potencia de uplink (dBm)
+    int8_t lastMargin;          // Último margen conocido (dB, LINK_MARGIN_UNKNOWN = ninguno)
+    uint8_t lastGatewayCount;   // Gateways de la última respuesta LinkCheck
+    int16_t lastRssi;           // RSSI del último downlink (dBm)
+    int8_t lastSnrQuarterDb;    // SNR del último downlink (0,25 dB)
+    uint8_t lossStreak;         // LinkCheck consecutivos sin respuesta
+    uint16_t uplinks;
+    uint16_t downlinks;
+    uint16_t linkChecks;        // LinkCheck solicitados
+    uint16_t linkAnswers;       // LinkCheck respondidos
+};
+
+class LinkPolicy {
+public:
+    /**
+     * @brief Vuelve al DR inicial y a potencia máxima tras un arranque en frío o de configuración
+     *        y carga los límites de DR de ConfigManager
+     */
+    static void begin(BootMode bootMode);
+
+    /**
+     * @brief Aplica ADR o el DR/potencia de la política antes de un uplink. El DR se sube
+     *        si hace falta para que quepa el payload (con margen para FOpts).
+     */
+    static void apply(LoRaWANNode& node, size_t payloadLength);
+
+    /**
+     * @brief DR que apply() usaría para un payload con la política local
+     */
+    static uint8_t datarateFor(size_t payloadLength);
+
+    /**
+     * @brief Encola un LinkCheckReq si toca en este uplink
+     * @return true si se solicitó
+     */
+    static bool requestLinkCheck(LoRaWANNode& node);
+
+    /**
+     * @brief Procesa el resultado de un uplink con ventanas de recepción
+     * @param state Resultado de sendReceive()
+     * @param linkCheckRequested Lo devuelto por requestLinkCheck() para este uplink
+     * @param downEvent Evento del downlink (válido si state == RADIOLIB_ERR_NONE)
+     * @param snr SNR del downlink (dB)
+     */
+    static void onUplink(LoRaWANNode& node, int16_t state, bool linkCheckRequested,
+                         const LoRaWANEvent_t& downEvent, float snr);
+
+    /**
+     * @brief Estadísticas actuales del enlace
+     */
+    static const LinkStats& stats();
+
+private:
+    static void applyMargin(int8_t margin);
+    static void fallBack();
+    static void report();
+};
+
+#endif // LINK_POLICY_H
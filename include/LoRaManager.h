@@ -9,7 +9,7 @@
 
 #include <Arduino.h>
 #include <RadioLib.h>
-#include <vector>
+#include "util/span.h"
 #include <ArduinoJson.h>
 #include "config_manager.h"
 #include "utilities.h"
@@ -45,16 +45,18 @@ public:
      * @param stationId ID de la estación.
      * @param battery Valor de la batería.
      * @param timestamp Timestamp del sistema.
+     * @param predictorReset Marca el timestamp con '*' (modelos de predicción dual descartados).
      * @param buffer Buffer donde se almacenará el payload.
      * @param bufferSize Tamaño del buffer.
      * @return Tamaño del payload generado.
      */
     static size_t createDelimitedPayload(
-        const std::vector<SensorReading>& readings,
-        const String& deviceId,
-        const String& stationId,
+        Span<const SensorReading> readings,
+        const char* deviceId,
+        const char* stationId,
         float battery,
         uint32_t timestamp,
+        bool predictorReset,
         char* buffer,
         size_t bufferSize
     );
@@ -68,17 +70,19 @@ public:
      * @param stationId ID de la estación.
      * @param battery Valor de la batería.
      * @param timestamp Timestamp del sistema.
+     * @param predictorReset Marca el timestamp con '*' (modelos de predicción dual descartados).
      * @param buffer Buffer donde se almacenará el payload.
      * @param bufferSize Tamaño del buffer.
      * @return Tamaño del payload generado.
      */
     static size_t createDelimitedPayload(
-        const std::vector<SensorReading>& normalReadings,
-        const std::vector<ModbusSensorReading>& modbusReadings,
-        const String& deviceId,
-        const String& stationId,
+        Span<const SensorReading> normalReadings,
+        Span<const ModbusSensorReading> modbusReadings,
+        const char* deviceId,
+        const char* stationId,
         float battery,
         uint32_t timestamp,
+        bool predictorReset,
         char* buffer,
         size_t bufferSize
     );
@@ -90,13 +94,14 @@ public:
      * @param node Referencia al nodo LoRaWAN
      * @param deviceId ID del dispositivo
      * @param stationId ID de la estación
-     * @param rtc Referencia al RTC para obtener timestamp
+     * @param timestamp Timestamp de la medición (el mismo con el que se filtraron las lecturas)
+     * @return Estado del envío (ver sendData)
      */
-    static void sendDelimitedPayload(const std::vector<SensorReading>& readings, 
+    static int16_t sendDelimitedPayload(Span<const SensorReading> readings, 
                                    LoRaWANNode& node,
-                                   const String& deviceId, 
-                                   const String& stationId, 
-                                   RTC_DS3231& rtc);
+                                   const char* deviceId, 
+                                   const char* stationId, 
+                                   uint32_t timestamp);
 
 #if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
     /**
@@ -106,16 +111,37 @@ public:
      * @param node Referencia al nodo LoRaWAN
      * @param deviceId ID del dispositivo
      * @param stationId ID de la estación
-     * @param rtc Referencia al RTC para obtener timestamp
+     * @param timestamp Timestamp de la medición (el mismo con el que se filtraron las lecturas)
+     * @return Estado del envío (ver sendData)
      */
-    static void sendDelimitedPayload(const std::vector<SensorReading>& normalReadings, 
-                                   const std::vector<ModbusSensorReading>& modbusReadings,
+    static int16_t sendDelimitedPayload(Span<const SensorReading> normalReadings, 
+                                   Span<const ModbusSensorReading> modbusReadings,
                                    LoRaWANNode& node,
-                                   const String& deviceId, 
-                                   const String& stationId, 
-                                   RTC_DS3231& rtc);
+                                   const char* deviceId, 
+                                   const char* stationId, 
+                                   uint32_t timestamp);
 #endif
 
+    /**
+     * @brief Envía los resúmenes de ventana pendientes (Aggregator) por LORA_AGG_FPORT
+     * @param node Referencia al nodo LoRaWAN
+     * @param rtc Referencia al RTC para el timestamp de la cabecera
+     */
+    static void sendAggregates(LoRaWANNode& node, RTC_DS3231& rtc);
+
+    /**
+     * @brief Envía el lote de muestras pendiente (BatchBuffer) por LORA_BATCH_FPORT, en
+     *        hasta BATCH_MAX_FRAMES tramas de BATCH_FRAME_MAX_BYTES
+     * @param node Referencia al nodo LoRaWAN
+     */
+    static void sendBatch(LoRaWANNode& node);
+
+    /**
+     * @brief Envía las entradas de diagnóstico pendientes por LORA_DIAG_FPORT
+     * @param node Referencia al nodo LoRaWAN
+     */
+    static void sendDiagnostics(LoRaWANNode& node);
+
     /**
      * @brief Prepara el módulo LoRa para entrar en modo sleep
      * @param radio Puntero al módulo de radio SX1262
@@ -130,6 +156,14 @@ public:
     static void setDatarate(LoRaWANNode& node, uint8_t datarate);
 
 private:
+    /**
+     * @brief Envía un uplink de datos con ventanas de recepción, aplicando y alimentando
+     *        la política de enlace (LinkPolicy)
+     * @return Resultado de sendReceive() (RADIOLIB_LORAWAN_NO_DOWNLINK = enviado sin downlink)
+     *         o AIRTIME_ERR_OVER_BUDGET si no se transmitió por el presupuesto de airtime
+     */
+    static int16_t sendData(LoRaWANNode& node, uint8_t* payload, size_t length, uint8_t fPort);
+
     static LoRaWANNode* node;
     static SX1262* radioModule;
 
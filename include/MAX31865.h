@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <SPI.h>
 #include "clsPCA9555.h"
+#include "SpiBusManager.h"
 
 
 #define MAX31865_FAULT_HIGH_THRESHOLD  ( 1 << 7 )
@@ -12,6 +13,8 @@
 #define MAX31865_FAULT_REFIN_FORCE     ( 1 << 4 )
 #define MAX31865_FAULT_RTDIN_FORCE     ( 1 << 3 )
 #define MAX31865_FAULT_VOLTAGE         ( 1 << 2 )
+/* Estado devuelto por read_all() si no se pudo tomar el bus SPI */
+#define MAX31865_BUS_ERROR             0xFF
 
 #define MAX31865_FAULT_DETECTION_NONE      ( 0x00 << 2 )
 #define MAX31865_FAULT_DETECTION_AUTO      ( 0x01 << 2 )
@@ -61,29 +64,13 @@ public:
   enum ptd_type { RTD_PT100, RTD_PT1000 };
 
   /**
-   * @brief Constructor para usar PCA9555 como CS.
+   * @brief Constructor.
    * @param type         Tipo de RTD (PT100/PT1000)
-   * @param spi          Referencia al objeto SPI que usarás (por ej. spiCustom)
-   * @param spiSettings  Configuración de SPI (frecuencia, MSB/LSB, modo, etc.)
-   * @param pca          Referencia a tu PCA9555
-   * @param pcaPinCS     Pin del PCA que actúa como CS
+   * @param spiDevice    Dispositivo registrado en SpiBusManager (reloj, modo y CS)
    */
   MAX31865_RTD(
       ptd_type type,
-      SPIClass& spi,
-      SPISettings& spiSettings,
-      PCA9555& pca,
-      uint8_t pcaPinCS
-  );
-
-    /**
-   * @brief Constructor alternativo, usando pin nativo de microcontrolador como CS.
-   */
-  MAX31865_RTD(
-      ptd_type type,
-      SPIClass& spi,
-      SPISettings& spiSettings,
-      uint8_t csPin
+      SpiDeviceHandle spiDevice
   );
 
   void configure( bool v_bias, bool conversion_mode, bool one_shot, bool three_wire,
@@ -109,20 +96,12 @@ public:
   bool begin();
 
 private:
-  void reconfigure();
+  bool reconfigure();
   void setCSLow();
   void setCSHigh();
 
   /* SPI */
-  SPIClass* _spi;           ///< Puntero a la clase SPI
-  SPISettings* _spiSettings;   ///< Puntero a SPISettings
-
-  /* PCA9555 / Pin CS */
-  PCA9555* _pca = nullptr; 
-  uint8_t  _pcaPinCS = 0xFF;
-  bool     _usePCA   = false;
-
-  uint8_t  _csPinMCU = 0xFF;     ///< CS pin nativo (si no usamos PCA)
+  SpiDeviceHandle _spiDevice;   ///< Dispositivo en SpiBusManager
 
   /* Config RTD */
   ptd_type type;
@@ -0,0 +1,67 @@
+/*******************************************************************************************
+ * Archivo: include/MeasurementContext.h
+ * Descripción: Contexto de medición por ciclo. Las entradas compartidas (canales crudos del
+ *              ADC, temperaturas de compensación, batería) se evalúan una sola vez por
+ *              despertar, en orden de dependencias, y se memorizan para el resto del ciclo.
+ *******************************************************************************************/
+
+#ifndef MEASUREMENT_CONTEXT_H
+#define MEASUREMENT_CONTEXT_H
+
+#include <Arduino.h>
+#include "util/span.h"
+#include "config.h"
+#include "sensor_types.h"
+
+/**
+ * @brief Entradas compartidas entre sensores. Cada entrada declara sus dependencias
+ *        en la tabla de MeasurementContext.cpp.
+ */
+enum MeasurementInput : uint8_t {
+    MEAS_INPUT_NTC10K_VOLTAGE = 0,   // Canal crudo AIN11/AIN8 del NTC10K (V)
+    MEAS_INPUT_NTC10K_TEMPERATURE,   // Temperatura del agua para compensación (°C)
+    MEAS_INPUT_BATTERY_VOLTAGE,      // Voltaje de batería (V)
+    MEAS_INPUT_COUNT
+};
+
+#define MEAS_INPUT_BIT(input) (1UL << (input))
+
+class MeasurementContext {
+public:
+    /**
+     * @brief Invalida todas las entradas memorizadas. Llamar al inicio de cada ciclo.
+     */
+    static void beginCycle();
+
+    /**
+     * @brief Evalúa una vez todas las entradas que declaran los sensores habilitados,
+     *        junto con la batería que se envía en cada uplink.
+     * @param enabledSensors Sensores habilitados en este ciclo
+     * @param readBattery false para reutilizar la última batería leída sin tocar el ADC
+     */
+    static void prepare(Span<const SensorConfig> enabledSensors, bool readBattery = true);
+
+    /**
+     * @brief Devuelve el valor de una entrada, evaluándola (y sus dependencias) si aún
+     *        no se ha medido en este ciclo.
+     * @param input Entrada solicitada
+     * @return Valor de la entrada o NAN si la medición falló
+     */
+    static float get(MeasurementInput input);
+
+    /**
+     * @brief Entradas que necesita un tipo de sensor
+     * @param type Tipo de sensor
+     * @return Máscara de bits MEAS_INPUT_BIT(...)
+     */
+    static uint32_t inputsFor(SensorType type);
+
+private:
+    static float evaluate(MeasurementInput input);
+
+    static float _values[MEAS_INPUT_COUNT];
+    static uint32_t _validMask;
+    static uint32_t _pendingMask;
+};
+
+#endif // MEASUREMENT_CONTEXT_H
@@ -4,31 +4,65 @@
 #include "clsPCA9555.h"
 #include "config.h"
 
+/**
+ * @brief Rieles de alimentación (máscara de bits)
+ */
+#define SENSOR_RAIL_3V3     0x01
+#define SENSOR_RAIL_2V5     0x02
+#define SENSOR_RAIL_12V     0x04
+
+#define POWER_RAIL_COUNT    3
+
+/**
+ * @brief Control de los rieles conmutados por el PCA9555. Cada consumidor pide los rieles
+ *        que necesita con acquire() y los suelta con release(); un riel se apaga en cuanto
+ *        lo suelta su último consumidor. Los rieles que se encienden juntos conmutan en una
+ *        sola escritura y comparten un único tiempo de estabilización.
+ */
 class PowerManager {
 private:
     PCA9555& ioExpander;
+    uint8_t refCount[POWER_RAIL_COUNT];
+    unsigned long onSinceMs[POWER_RAIL_COUNT];
+
+    void writeRails(uint8_t rails, bool on);
 
 public:
     PowerManager(PCA9555& expander);
     void begin();
 
-    // Método común para todos los dispositivos
-    void power3V3On();
-    void power3V3Off();
-    
-    // Métodos disponibles solo para dispositivos ANALOGIC y MODBUS
-#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
-    void power12VOn();
-    void power12VOff();
-#endif
+    /**
+     * @brief Añade un consumidor a cada riel de la máscara y enciende los que estaban apagados
+     * @param rails Máscara SENSOR_RAIL_* (se ignoran los rieles que no existen en el dispositivo)
+     * @return Rieles recién encendidos (sus dispositivos necesitan inicializarse)
+     */
+    uint8_t acquire(uint8_t rails);
 
-    // Método disponible solo para dispositivo ANALOGIC
-#ifdef DEVICE_TYPE_ANALOGIC
-    void power2V5On();
-    void power2V5Off();
-#endif
+    /**
+     * @brief Quita un consumidor de cada riel de la máscara y apaga los que quedan sin uso
+     */
+    void release(uint8_t rails);
 
+    /**
+     * @brief Rieles encendidos actualmente
+     */
+    uint8_t activeRails() const;
+
+    /**
+     * @brief Tiempo acumulado de encendido de un riel (memoria RTC, se conserva en deep sleep)
+     * @param rail Un único bit SENSOR_RAIL_*
+     * @return Milisegundos, incluido el tramo en curso si el riel está encendido
+     */
+    uint32_t railOnTimeMs(uint8_t rail) const;
+
+    /**
+     * @brief Añade el tiempo acumulado de los rieles (RailTimeDiag) al diagnóstico si ya hay
+     *        uno pendiente de envío. Llamar en los ciclos de reporte antes de enviarlo.
+     */
+    void reportRailTime() const;
+
+    // Apaga todos los rieles sin importar los consumidores (antes de dormir o ante un error)
     void allPowerOff();
 };
 
-#endif 
\ No newline at end of file
+#endif
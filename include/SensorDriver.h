@@ -0,0 +1,110 @@
+/*******************************************************************************************
+ * Archivo: include/SensorDriver.h
+ * Descripción: Interfaz de drivers de sensores. Cada tipo de sensor se registra en una tabla
+ *              constante (src/SensorDriver.cpp) con sus hooks y metadatos (subvalores, bus,
+ *              rieles de alimentación, calentamiento y entradas compartidas). SensorManager
+ *              recorre la tabla en lugar de un switch por tipo.
+ *******************************************************************************************/
+
+#ifndef SENSOR_DRIVER_H
+#define SENSOR_DRIVER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "sensor_types.h"
+#include "PowerManager.h"
+#include "util/span.h"
+#include "util/signal_filter.h"
+
+/**
+ * @brief Bus que usa el sensor durante la adquisición
+ */
+enum SensorBus : uint8_t {
+    SENSOR_BUS_NONE = 0,
+    SENSOR_BUS_ADC,         // ADS124S08 (SPI compartido, un canal a la vez)
+    SENSOR_BUS_SPI,         // Dispositivo SPI propio (MAX31865)
+    SENSOR_BUS_I2C,         // I2C (SHT30)
+    SENSOR_BUS_ONEWIRE      // OneWire (DS18B20)
+};
+
+/**
+ * @brief Driver de un sensor normal (no Modbus). Los hooks pueden ser nullptr.
+ *
+ * Secuencia por ciclo: start() de todos los sensores y después, bus a bus en el orden de
+ * SensorDriverRegistry::collectOrder(), poll() hasta que esté listo (o venza warmupMs) y
+ * collect(). begin() se llama cada vez que se enciende alguno de sus rieles, si hay al menos
+ * un sensor habilitado del tipo.
+ */
+struct SensorDriver {
+    SensorType type;
+    uint8_t subValueCount;      // 0 = valor único en reading.value
+    SensorBus bus;              // Agrupa la recogida (collectOrder)
+    uint8_t rails;              // SENSOR_RAIL_*
+    uint16_t warmupMs;          // Tiempo máximo de espera entre start() y collect()
+    uint32_t inputs;            // Entradas de MeasurementContext (MEAS_INPUT_BIT)
+    uint8_t filter;             // SignalFilterKind aplicado a cada valor (SensorFilter)
+
+    void (*begin)();
+    void (*start)(const SensorConfig& cfg);
+    bool (*poll)(const SensorConfig& cfg);
+    void (*collect)(const SensorConfig& cfg, SensorReading& reading);
+};
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+/**
+ * @brief Driver de un sensor Modbus
+ */
+struct ModbusSensorDriver {
+    SensorType type;
+    uint8_t subValueCount;
+    uint8_t rails;              // SENSOR_RAIL_*
+    uint16_t warmupMs;          // Estabilización tras encender el riel
+    uint8_t filter;             // SignalFilterKind aplicado a cada subvalor
+    void (*collect)(const ModbusSensorConfig& cfg, ModbusSensorReading& reading);
+};
+#endif
+
+class SensorDriverRegistry {
+public:
+    /**
+     * @brief Driver registrado para un tipo de sensor
+     * @return nullptr si el tipo no está soportado en este dispositivo
+     */
+    static const SensorDriver* find(SensorType type);
+
+    /**
+     * @brief Bus del driver de un tipo (SENSOR_BUS_NONE si no está soportado)
+     */
+    static SensorBus busOf(SensorType type);
+
+    /**
+     * @brief Orden en que SensorManager recoge los sensores: primero los buses que leen al
+     *        momento (ADC, I2C) y al final los que convierten en segundo plano desde start()
+     *        o begin() (RTD por SPI, DS18B20 por OneWire), para que esperen lo menos posible
+     */
+    static Span<const SensorBus> collectOrder();
+
+    /**
+     * @brief Llama a begin() una vez por cada tipo con algún sensor habilitado cuyo driver
+     *        use alguno de los rieles indicados
+     * @param poweredRails Rieles recién encendidos (SENSOR_RAIL_*)
+     */
+    static void beginDrivers(Span<const SensorConfig> sensors, uint8_t poweredRails);
+
+    /**
+     * @brief Rieles que necesitan los sensores habilitados
+     */
+    static uint8_t requiredRails(Span<const SensorConfig> sensors);
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    static const ModbusSensorDriver* findModbus(SensorType type);
+    static uint8_t requiredRails(Span<const ModbusSensorConfig> sensors);
+
+    /**
+     * @brief Mayor tiempo de estabilización entre los sensores Modbus habilitados
+     */
+    static uint16_t maxWarmupMs(Span<const ModbusSensorConfig> sensors);
+#endif
+};
+
+#endif // SENSOR_DRIVER_H
@@ -0,0 +1,38 @@
+/*******************************************************************************************
+ * Archivo: include/SensorFilter.h
+ * Descripción: Etapa de filtrado por sensor entre la adquisición y la codificación. Cada
+ *              canal (sensor o subvalor) usa el filtro que declara su driver (EMA, mediana
+ *              deslizante o Kalman 1-D, ver util/signal_filter.h) y su estado se conserva en
+ *              memoria RTC entre despertares.
+ *******************************************************************************************/
+
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "sensor_types.h"
+#include "BootManager.h"
+#include "util/signal_filter.h"
+
+class SensorFilter {
+public:
+    /**
+     * @brief Descarta el estado de los filtros tras un arranque en frío o de configuración
+     */
+    static void begin(BootMode bootMode);
+
+    /**
+     * @brief Sustituye en la lectura cada valor por su valor filtrado
+     */
+    static void apply(SensorReading& reading);
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    static void apply(ModbusSensorReading& reading);
+#endif
+
+private:
+    static float filterValue(const char* sensorId, uint8_t subIndex, uint8_t kind, float value);
+};
+
+#endif // SENSOR_FILTER_H
@@ -2,7 +2,7 @@
 #define SENSOR_MANAGER_H
 
 #include <Arduino.h>
-#include <vector>
+#include "util/span.h"
 #include "sensor_types.h"
 #include <RTClib.h>
 #include "clsPCA9555.h"
@@ -25,10 +25,6 @@ extern RTC_DS3231 rtc;
 extern PCA9555 ioExpander;
 extern PowerManager powerManager;
 extern SPIClass spi;
-#ifdef DEVICE_TYPE_ANALOGIC
-extern SPISettings spiAdcSettings;
-#endif
-extern SPISettings spiRtdSettings;
 extern MAX31865_RTD rtd;
 #if defined(DEVICE_TYPE_BASIC) || defined(DEVICE_TYPE_ANALOGIC)
 extern OneWire oneWire;
@@ -42,9 +38,6 @@ extern SHT31 sht30Sensor;
  */
 class SensorManager {
   public:
-    // Inicializa pines, periféricos (ADC, RTD, etc.), OneWire, etc.
-    static void beginSensors(const std::vector<SensorConfig>& enabledNormalSensors);
-
     // Devuelve la lectura (o lecturas) de un sensor NO-Modbus según su configuración.
     static SensorReading getSensorReading(const SensorConfig& cfg);
     
@@ -53,14 +46,16 @@ class SensorManager {
     static ModbusSensorReading getModbusSensorReading(const ModbusSensorConfig& cfg);
 #endif
     
-    // Obtiene todas las lecturas de sensores (normales y Modbus) habilitados
-    static void getAllSensorReadings(std::vector<SensorReading>& normalReadings
+    // Obtiene todas las lecturas de sensores (normales y Modbus) habilitados. Cada riel se
+    // enciende solo durante la medición de sus consumidores.
+    // Las vistas devueltas apuntan a tablas estáticas válidas hasta la siguiente llamada.
+    static void getAllSensorReadings(Span<const SensorReading>& normalReadings
 #if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
-                                    , std::vector<ModbusSensorReading>& modbusReadings
+                                    , Span<const ModbusSensorReading>& modbusReadings
 #endif
-                                    , const std::vector<SensorConfig>& enabledNormalSensors
+                                    , Span<const SensorConfig> enabledNormalSensors
 #if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
-                                    , const std::vector<ModbusSensorConfig>& enabledModbusSensors
+                                    , Span<const ModbusSensorConfig> enabledModbusSensors
 #endif
                                    );
 
@@ -83,6 +78,24 @@ class SensorManager {
     // static void readSht30(float& outTemp, float& outHum);
 
     static float readSensorValue(const SensorConfig &cfg, SensorReading &reading);
+
+    // Enciende los rieles e inicializa los dispositivos de los que estaban apagados
+    static void powerUp(uint8_t rails, Span<const SensorConfig> enabledNormalSensors);
+
+#ifdef DEVICE_TYPE_ANALOGIC
+    // Reset y configuración del ADS124S08 (single shot, referencia interna, STATUS+CRC)
+    static void beginAdc();
+#endif
+
+    // Llama al hook start() de los drivers para que las conversiones lentas corran en paralelo
+    static void startConversions(Span<const SensorConfig> enabledNormalSensors);
+
+    static unsigned long _cycleStartMs;
+
+    static SensorReading _normalReadings[MAX_NORMAL_SENSORS];
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    static ModbusSensorReading _modbusReadings[MAX_MODBUS_SENSORS];
+#endif
 };
 
 #endif // SENSOR_MANAGER_H
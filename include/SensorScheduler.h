@@ -0,0 +1,62 @@
+/*******************************************************************************************
+ * Archivo: include/SensorScheduler.h
+ * Descripción: Planificación multi-tasa por sensor. Cada sensor se lee cada periodTicks
+ *              ticks de la planificación de despertares (WakeStub::tick()); en cada ciclo
+ *              solo se miden los sensores que tocan, de modo que los sensores lentos o
+ *              costosos (p.ej. el bus Modbus de 12 V) no encienden su riel en todos los ticks.
+ *              El último tick leído de cada sensor se guarda en memoria RTC.
+ *******************************************************************************************/
+
+#ifndef SENSOR_SCHEDULER_H
+#define SENSOR_SCHEDULER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "sensor_types.h"
+#include "BootManager.h"
+#include "util/span.h"
+
+class SensorScheduler {
+public:
+    /**
+     * @brief Reinicia los ticks de lectura tras un arranque en frío o de configuración:
+     *        todos los sensores tocan en el primer ciclo.
+     */
+    static void begin(BootMode bootMode);
+
+    /**
+     * @brief Toma el tick actual y decide si toca leer la batería. Llamar al inicio de
+     *        cada ciclo de medición, antes de dueNormal()/dueModbus().
+     */
+    static void beginTick();
+
+    /**
+     * @brief Sensores normales que tocan en este tick (se marcan como leídos)
+     * @return Vista a una tabla estática válida hasta la siguiente llamada
+     */
+    static Span<const SensorConfig> dueNormal(Span<const SensorConfig> sensors);
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    /**
+     * @brief Sensores Modbus que tocan en este tick (se marcan como leídos)
+     */
+    static Span<const ModbusSensorConfig> dueModbus(Span<const ModbusSensorConfig> sensors);
+#endif
+
+    /**
+     * @brief true si en este tick toca leer la batería (BATTERY_SAMPLE_EVERY_TICKS)
+     */
+    static bool batteryDue();
+
+private:
+    static bool due(uint32_t& lastTick, uint8_t periodTicks);
+
+    static uint32_t _tick;
+    static bool _batteryDue;
+    static SensorConfig _dueNormal[MAX_NORMAL_SENSORS];
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    static ModbusSensorConfig _dueModbus[MAX_MODBUS_SENSORS];
+#endif
+};
+
+#endif // SENSOR_SCHEDULER_H
@@ -0,0 +1,46 @@
+/*******************************************************************************************
+ * Archivo: include/SessionStore.h
+ * Descripción: Copia de la sesión LoRaWAN en NVS para sobrevivir a cortes de alimentación
+ *              sin repetir el join. La sesión vive en memoria RTC (LWsession); cada
+ *              SESSION_CHECKPOINT_EVERY uplinks se guarda también en flash, de modo que la
+ *              escritura no crece con la frecuencia de reporte. Al restaurar desde flash el
+ *              contador de tramas se adelanta SESSION_FCNT_GAP (cubre los uplinks enviados
+ *              después del último checkpoint, que el servidor ya vio) y el valor adelantado
+ *              se vuelve a guardar antes de transmitir.
+ *******************************************************************************************/
+
+#ifndef SESSION_STORE_H
+#define SESSION_STORE_H
+
+#include <Arduino.h>
+#include <RadioLib.h>
+#include "config.h"
+#include "BootManager.h"
+
+class SessionStore {
+public:
+    /**
+     * @brief Olvida el último checkpoint tras un arranque en frío (se desconoce si la
+     *        sesión de flash coincide con la activa)
+     */
+    static void begin(BootMode bootMode);
+
+    /**
+     * @brief Carga la sesión de flash en 'session', con el FCnt de subida adelantado
+     * @return false si no hay una sesión válida guardada
+     */
+    static bool restore(uint8_t* session);
+
+    /**
+     * @brief Guarda la sesión activa en flash (tras un join)
+     */
+    static void save(LoRaWANNode& node);
+
+    /**
+     * @brief Guarda la sesión si el FCnt avanzó SESSION_CHECKPOINT_EVERY desde el último
+     *        checkpoint
+     */
+    static void checkpoint(LoRaWANNode& node);
+};
+
+#endif // SESSION_STORE_H
@@ -37,6 +37,38 @@ public:
                              uint8_t* LWsession,
                              SPIClass& spi);
     
+    /**
+     * @brief Sueño ligero durante un intervalo conservando RAM, periféricos y rieles de
+     *        sensores. Despierta por temporizador o por el pin de configuración.
+     * @param timeToSleep Tiempo en segundos
+     * @param radio Radio que se deja en sleep (arranque en caliente)
+     * @return true si despertó por el temporizador
+     */
+    static bool lightSleep(uint32_t timeToSleep, SX1262* radio);
+
+    /**
+     * @brief Pausa corta en sueño ligero dentro de un ciclo (sin alinear a slot ni medir
+     *        latencia), p.ej. hasta el slot de transmisión
+     * @param durationMs Duración en milisegundos
+     * @param radio Radio que se deja en sleep
+     * @return true si despertó por el temporizador
+     */
+    static bool napMs(uint32_t durationMs, SX1262* radio);
+
+    /**
+     * @brief Decide entre sueño ligero y deep sleep comparando la energía extra de dormir en
+     *        ligero durante el intervalo con la de un arranque completo (modelo de config.h
+     *        con el coste de arranque medido).
+     * @param timeToSleep Tiempo en segundos
+     */
+    static bool useLightSleep(uint32_t timeToSleep);
+
+    /**
+     * @brief Registra la duración de un arranque en caliente (media móvil en RTC)
+     * @param setupMs millis() al terminar setup()
+     */
+    static void recordBootCost(uint32_t setupMs);
+
     /**
      * @brief Configura los pines no utilizados en alta impedancia para reducir el consumo durante deep sleep.
      */
@@ -0,0 +1,84 @@
+/*******************************************************************************************
+ * Archivo: include/SlotScheduler.h
+ * Descripción: Despertares alineados al reloj de pared. El siguiente despertar se calcula
+ *              como el próximo slot absoluto (múltiplo del intervalo desde la época Unix,
+ *              según el DS3231) menos la latencia despertar→medición aprendida en ciclos
+ *              anteriores, corrigiendo la deriva del reloj lento del ESP32 frente al DS3231.
+ *              Opcionalmente la alarma 1 del DS3231 (RTC_ALARM_WAKE_PIN) despierta al ESP32.
+ *******************************************************************************************/
+
+#ifndef SLOT_SCHEDULER_H
+#define SLOT_SCHEDULER_H
+
+#include <Arduino.h>
+#include <RTClib.h>
+#include "config.h"
+#include "BootManager.h"
+
+// Fechas anteriores indican un DS3231 sin hora válida (2024-01-01)
+#define SLOT_MIN_VALID_UNIX     1704067200UL
+
+class SlotScheduler {
+public:
+    /**
+     * @brief Valida la hora del DS3231 y, tras un despertar en caliente, mide la deriva del
+     *        reloj lento comparando el sueño pedido con el tiempo transcurrido en el DS3231.
+     *        Llamar después de rtc.begin().
+     */
+    static void begin(RTC_DS3231& rtc, BootMode bootMode);
+
+    /**
+     * @brief Registra un despertar de sueño ligero (la latencia se mide desde aquí)
+     * @param timerWake true si despertó por el temporizador
+     */
+    static void noteLightWake(bool timerWake);
+
+    /**
+     * @brief Marca el inicio de la medición y actualiza la latencia aprendida
+     */
+    static void markMeasurementStart();
+
+    /**
+     * @brief Tiempo de sueño hasta el próximo slot, ya descontada la latencia y corregida
+     *        la deriva. Sin hora válida devuelve el intervalo sin alinear.
+     * @param interval Periodo de los slots (s)
+     * @param deepSleep true para deep sleep, false para sueño ligero
+     * @return Microsegundos para el temporizador
+     */
+    static uint64_t nextSleepUs(uint32_t interval, bool deepSleep);
+
+    /**
+     * @brief Sueño hasta el despertar previsto por el último nextSleepUs(), sin el
+     *        temporizador de respaldo de la alarma (ancla de los ticks del wake stub)
+     */
+    static uint64_t plannedSleepUs();
+
+    /**
+     * @brief Duración de un periodo en tiempo del reloj lento (deriva corregida)
+     */
+    static uint64_t tickSleepUs(uint32_t interval);
+
+    /**
+     * @brief Timestamp de las lecturas: el slot objetivo si el ciclo cayó dentro de
+     *        SLOT_TIMESTAMP_TOLERANCE_S, o la hora actual del DS3231.
+     */
+    static uint32_t timestamp(RTC_DS3231& rtc);
+
+#ifdef RTC_ALARM_WAKE_PIN
+    /**
+     * @brief true si el despertar por GPIO lo produjo la alarma del DS3231
+     */
+    static bool alarmWake();
+#endif
+
+private:
+    static RTC_DS3231* _rtc;
+    static bool _rtcValid;
+    static uint32_t _wakeMs;            // millis() del despertar actual
+    static bool _deepWake;              // El despertar actual vino de deep sleep
+    static bool _scheduledWake;         // Despertar programado (mide latencia)
+    static uint32_t _currentSlot;       // Slot al que apunta el ciclo actual
+    static uint64_t _plannedSleepUs;    // Último sueño calculado, sin respaldo de alarma
+};
+
+#endif // SLOT_SCHEDULER_H
@@ -0,0 +1,148 @@
+/*******************************************************************************************
+ * Archivo: include/SpiBusManager.h
+ * Descripción: Gestión del bus SPI compartido (FSPI). Cada dispositivo se registra con su
+ *              reloj máximo, modo SPI y estrategia de CS; las transacciones se serializan
+ *              con un mutex para que radio y sensores compartan el bus.
+ *******************************************************************************************/
+
+#ifndef SPI_BUS_MANAGER_H
+#define SPI_BUS_MANAGER_H
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <RadioLib.h>
+#include "clsPCA9555.h"
+#include "config.h"
+
+// Número máximo de dispositivos registrados en el bus
+#define SPI_BUS_MAX_DEVICES         4
+// Transferencias de este tamaño o mayores se mueven en bloque por la FIFO del periférico
+#define SPI_BUS_BULK_THRESHOLD      4
+// Tiempo máximo de espera para obtener el bus (ms)
+#define SPI_BUS_LOCK_TIMEOUT_MS     1000
+// Profundidad máxima de transacciones anidadas
+#define SPI_BUS_MAX_DEPTH           8
+
+/**
+ * @brief Estrategia de control del chip select de un dispositivo
+ */
+enum SpiCsStrategy : uint8_t {
+    SPI_CS_NATIVE_GPIO = 0,     // Pin GPIO del ESP32
+    SPI_CS_PCA9555 = 1,         // Pin del expansor PCA9555 (cada cambio es una escritura I2C)
+    SPI_CS_EXTERNAL = 2         // El driver gestiona el CS (p.ej. RadioLib)
+};
+
+/**
+ * @brief Dispositivo registrado en el bus
+ */
+struct SpiDevice {
+    const char* name;           // Nombre para depuración
+    uint32_t clock;             // Reloj máximo del dispositivo (Hz)
+    uint8_t dataMode;           // SPI_MODE0..SPI_MODE3
+    SpiCsStrategy csStrategy;   // Estrategia de CS
+    uint8_t csPin;              // Pin de CS (GPIO o pin del PCA9555)
+    PCA9555* ioExpander;        // Expansor para SPI_CS_PCA9555
+};
+
+typedef int8_t SpiDeviceHandle;
+#define SPI_DEVICE_INVALID (-1)
+
+class SpiBusManager {
+public:
+    /**
+     * @brief Inicializa el periférico SPI con los pines de config.h y crea el mutex del bus.
+     * @param spi Periférico SPI compartido
+     */
+    static void begin(SPIClass& spi);
+
+    /**
+     * @brief Registra un dispositivo en el bus. Puede llamarse antes de begin().
+     * @param name Nombre para depuración
+     * @param clock Reloj SPI máximo del dispositivo (Hz)
+     * @param dataMode Modo SPI
+     * @param csStrategy Estrategia de CS
+     * @param csPin Pin de CS (ignorado con SPI_CS_EXTERNAL)
+     * @param ioExpander Expansor para SPI_CS_PCA9555 (nullptr en otro caso)
+     * @return Handle del dispositivo o SPI_DEVICE_INVALID si no hay espacio
+     */
+    static SpiDeviceHandle registerDevice(const char* name, uint32_t clock, uint8_t dataMode,
+                                          SpiCsStrategy csStrategy, uint8_t csPin,
+                                          PCA9555* ioExpander = nullptr);
+
+    /**
+     * @brief Toma el bus y aplica la configuración del dispositivo. Admite anidamiento
+     *        desde la misma tarea (p.ej. una ráfaga que mantiene el bus entre tramas).
+     * @return false si no se obtuvo el bus dentro del timeout; en ese caso no se debe
+     *         seleccionar el dispositivo ni llamar a endTransaction
+     */
+    static bool beginTransaction(SpiDeviceHandle device);
+
+    /**
+     * @brief Libera el bus tomado con beginTransaction. Al cerrar una transacción anidada
+     *        se restaura la configuración del dispositivo exterior. No hace nada si la
+     *        tarea no tiene el bus o el dispositivo no es el de la transacción abierta.
+     */
+    static void endTransaction(SpiDeviceHandle device);
+
+    /**
+     * @brief Configura el pin de CS como salida y lo deja inactivo (alto)
+     */
+    static void initChipSelect(SpiDeviceHandle device);
+
+    /**
+     * @brief Activa / desactiva el CS del dispositivo según su estrategia
+     */
+    static void select(SpiDeviceHandle device);
+    static void deselect(SpiDeviceHandle device);
+
+    /**
+     * @brief Transfiere un byte dentro de una transacción
+     */
+    static uint8_t transfer(uint8_t data);
+
+    /**
+     * @brief Transfiere un bloque dentro de una transacción
+     * @param tx Bytes a enviar (nullptr para enviar ceros)
+     * @param rx Bytes recibidos (nullptr para descartarlos)
+     * @param len Número de bytes
+     */
+    static void transfer(const uint8_t* tx, uint8_t* rx, size_t len);
+
+    /**
+     * @brief Dispositivo registrado (nullptr si el handle no es válido)
+     */
+    static const SpiDevice* getDevice(SpiDeviceHandle device);
+
+private:
+    static SPIClass* _spi;
+    static SemaphoreHandle_t _mutex;
+    static SpiDevice _devices[SPI_BUS_MAX_DEVICES];
+    static uint8_t _deviceCount;
+    static SpiDeviceHandle _stack[SPI_BUS_MAX_DEPTH];  // Dispositivo de cada nivel anidado
+    static uint8_t _depth;
+
+    static void applySettings(SpiDeviceHandle device);
+    static bool ownsBus();
+};
+
+/**
+ * @brief HAL de RadioLib que pasa las transacciones del SX1262 por SpiBusManager. Si no
+ *        obtiene el bus, la transacción no toca el SPI y RadioLib recibe ceros.
+ */
+class SpiBusHal : public ArduinoHal {
+public:
+    SpiBusHal(SPIClass& spi, SpiDeviceHandle device);
+
+    void spiBeginTransaction() override;
+    void spiTransfer(uint8_t* out, size_t len, uint8_t* in) override;
+    void spiEndTransaction() override;
+
+private:
+    SpiDeviceHandle _device;
+    bool _acquired;     // spiBeginTransaction() obtuvo el bus
+};
+
+#endif // SPI_BUS_MANAGER_H
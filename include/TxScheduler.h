@@ -0,0 +1,48 @@
+/*******************************************************************************************
+ * Archivo: include/TxScheduler.h
+ * Descripción: Slots de transmisión por nodo. La medición sigue alineada al slot del
+ *              periodo (SlotScheduler), pero el primer uplink de cada ciclo de reporte
+ *              espera en sueño ligero hasta un slot de TX_SLOT_LENGTH_S dentro de la
+ *              ventana de reparto (TX_SLOT_SPREAD_PERCENT del periodo, como mucho
+ *              TX_SLOT_WINDOW_MAX_S). El slot sale del hash del DevEUI, así que los nodos de
+ *              una estación que despiertan a la vez transmiten en momentos distintos; si el
+ *              enlace indica pérdidas (LinkCheck sin respuesta) se usa un slot aleatorio
+ *              para no repetir la misma colisión en cada ciclo.
+ *******************************************************************************************/
+
+#ifndef TX_SCHEDULER_H
+#define TX_SCHEDULER_H
+
+#include <Arduino.h>
+#include <RadioLib.h>
+#include <RTClib.h>
+#include "config.h"
+#include "BootManager.h"
+
+class TxScheduler {
+public:
+    /**
+     * @brief Calcula el hash del DevEUI tras un arranque en frío o de configuración
+     */
+    static void begin(RTC_DS3231& rtc, BootMode bootMode);
+
+    /**
+     * @brief Inicia un ciclo de reporte
+     * @param sampleTime Timestamp de la medición (inicio del slot del periodo)
+     * @param interval Periodo actual (s)
+     */
+    static void beginCycle(uint32_t sampleTime, uint32_t interval);
+
+    /**
+     * @brief Espera al slot de transmisión del nodo; solo la primera vez en cada ciclo
+     */
+    static void waitForSlot(SX1262* radio);
+
+private:
+    static RTC_DS3231* _rtc;
+    static uint32_t _cycleStart;
+    static uint32_t _interval;
+    static bool _waited;
+};
+
+#endif // TX_SCHEDULER_H
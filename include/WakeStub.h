@@ -0,0 +1,83 @@
+/*******************************************************************************************
+ * Archivo: include/WakeStub.h
+ * Descripción: Wake stub de deep sleep. Se ejecuta desde memoria RTC antes del bootloader
+ *              en cada despertar: incrementa contadores, avanza la planificación residente
+ *              en RTC (util/wake_schedule.h) y, si en este tick no toca ni muestreo ni envío,
+ *              vuelve a dormir sin pagar el arranque de ESP-IDF/Arduino. El siguiente
+ *              despertar se cuenta desde el previsto, así que los ticks del stub siguen en la
+ *              rejilla de slots de SlotScheduler. Atiende tanto el temporizador como la
+ *              alarma del DS3231 (RTC_ALARM_WAKE_PIN).
+ *******************************************************************************************/
+
+#ifndef WAKE_STUB_H
+#define WAKE_STUB_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "BootManager.h"
+#include "util/wake_schedule.h"
+
+#define WAKE_STUB_MAGIC     0x5754AB1EUL
+
+/**
+ * @brief Estado del wake stub en memoria RTC
+ */
+struct WakeStubState {
+    uint32_t magic;
+    WakeSchedule schedule;
+    uint64_t sleepRtcTicks;         // Intervalo de sueño en ciclos del reloj lento (0 = stub inactivo)
+    uint64_t nextWakeRtc;           // Despertar previsto (ciclos absolutos del reloj lento)
+    uint32_t idleSinceBoot;         // Ticks resueltos por el stub desde el último arranque
+    uint32_t stubWakes;             // Despertares atendidos por el stub
+    uint32_t idleWakes;             // Despertares resueltos sin arranque completo
+    uint32_t fullBoots;             // Arranques completos
+    uint8_t decision;               // WakeDecision del último despertar
+    uint8_t dueMask;
+};
+
+class WakeStub {
+public:
+    /**
+     * @brief Decide el trabajo del arranque actual. En un despertar por temporizador usa la
+     *        decisión del stub; en cualquier otro arranque reinicia la planificación con
+     *        WAKE_SAMPLE_EVERY_TICKS / WAKE_REPORT_EVERY_TICKS y hace un ciclo de reporte.
+     * @param bootMode Clasificación de BootManager::begin()
+     */
+    static WakeDecision begin(BootMode bootMode);
+
+    /**
+     * @brief Decisión del arranque actual
+     */
+    static WakeDecision decision();
+
+    /**
+     * @brief Avanza un tick fuera del stub (bucle de sueño ligero, sin reinicio)
+     * @return Decisión del nuevo tick (WAKE_DECISION_IDLE si no hay trabajo)
+     */
+    static WakeDecision advanceTick();
+
+    /**
+     * @brief Tareas de la planificación que tocan en este arranque (bit = índice)
+     */
+    static uint8_t dueMask();
+
+    /**
+     * @brief Tick actual de la planificación (ticks desde el arranque en frío)
+     */
+    static uint32_t tick();
+
+    /**
+     * @brief Ticks que resolvió el stub sin arranque completo antes del arranque actual
+     */
+    static uint32_t idleTicksSinceBoot();
+
+    /**
+     * @brief Prepara el reloj lento para que el stub pueda volver a armar el temporizador
+     *        sobre la rejilla de slots. Llamar justo antes de esp_deep_sleep_start().
+     * @param firstSleepUs Sueño hasta el despertar previsto (sin respaldo de alarma)
+     * @param tickUs Duración de un tick de la planificación, corregida la deriva
+     */
+    static void prepareSleep(uint64_t firstSleepUs, uint64_t tickUs);
+};
+
+#endif // WAKE_STUB_H
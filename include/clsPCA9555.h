@@ -45,10 +45,15 @@ public:
     void pinMode(uint8_t pin, uint8_t IOMode );          // pinMode
     uint8_t digitalRead(uint8_t pin);                    // digitalRead
     void digitalWrite(uint8_t pin, uint8_t value );      // digitalWrite
+    void writePins(uint16_t mask, uint16_t values);      // Varias salidas en una transacción
     uint8_t stateOfPin(uint8_t pin);                     // Actual ISR
     void setClock(uint32_t clockFrequency);              // Clock speed
     bool begin();                                        // Checks if PCA is responsive
     void sleep();
+    // Registros de configuración y salida en memoria (para conservarlos durante deep sleep)
+    uint16_t configurationRegister() const { return _configurationRegister; }
+    uint16_t outputRegister() const { return _valueRegister; }
+    bool restoreRegisters(uint16_t configuration, uint16_t output); // Sin sondeo ni reintentos
 
 private:
     static PCA9555* instancePointer;
@@ -22,7 +22,7 @@
 #define SPI_MISO_PIN        6
 #define SPI_MOSI_PIN        7
 #define SPI_RTD_CLOCK       1000000
-#define SPI_RADIO_CLOCK     100000
+#define SPI_RADIO_CLOCK     8000000   // SX1262 admite hasta 16 MHz
 
 // PT100
 #define PT100_CS_PIN        P03
@@ -48,6 +48,79 @@
 // Deep Sleep
 #define DEFAULT_TIME_TO_SLEEP   30
 
+// Planificación del wake stub (en ticks = intervalos de sueño). En los ticks sin tarea el
+// stub vuelve a dormir sin arrancar el firmware.
+#define WAKE_SAMPLE_EVERY_TICKS 1       // Muestreo sin envío (0 = deshabilitado)
+#define WAKE_REPORT_EVERY_TICKS 1       // Muestreo y envío
+
+// Periodo de la lectura de batería en ticks. Cada sensor tiene su propio periodo en la
+// configuración (periodTicks); en los ticks intermedios se usa el último valor leído.
+#define BATTERY_SAMPLE_EVERY_TICKS 1
+
+// Sueño ligero para intervalos cortos: se usa cuando la energía extra de dormir en ligero
+// durante el intervalo es menor que la de un arranque completo desde deep sleep
+#define LIGHT_SLEEP_ENABLED     1
+#define BOOT_COST_DEFAULT_MS    400     // Arranque en caliente hasta fin de setup() (sin medir)
+#define BOOT_ROM_OVERHEAD_MS    80      // ROM + bootloader, antes de que empiece millis()
+#define BOOT_ACTIVE_CURRENT_UA  30000   // Consumo medio durante el arranque
+#define LIGHT_SLEEP_CURRENT_UA  1500    // Sueño ligero (rieles de sensores apagados)
+#define DEEP_SLEEP_CURRENT_UA   20
+
+// Despertares alineados al reloj del DS3231: slots múltiplos del intervalo desde la época Unix
+#define SLOT_ALIGNMENT_ENABLED      1
+#define SLOT_OFFSET_S               0       // Desfase de los slots (s)
+#define SLOT_MIN_SLEEP_MS           1000    // Si falta menos, se apunta al slot siguiente
+#define SLOT_TIMESTAMP_TOLERANCE_S  5       // Margen para sellar las lecturas con el slot
+#define SLOT_DRIFT_MIN_SLEEP_MS     60000   // Sueños más cortos no miden deriva (resolución 1 s)
+#define SLOT_DRIFT_MAX_PPM          20000   // Muestras de deriva mayores se descartan
+// #define RTC_ALARM_WAKE_PIN       2       // INT/SQW del DS3231 como fuente de despertar (opcional)
+#define SLOT_ALARM_FALLBACK_MS      2000    // Temporizador de respaldo tras la alarma
+
+// Intervalo adaptativo: se alarga al bajar la batería y se acorta cuando las lecturas
+// cambian rápido. Siempre dentro de los límites [min, max] guardados en NVS.
+#define ADAPTIVE_INTERVAL_ENABLED       1
+#define INTERVAL_MIN_DEFAULT            10      // Segundos
+#define INTERVAL_MAX_DEFAULT            3600    // Segundos
+#define BATTERY_BAND_GOOD_V             3.9f    // >= : intervalo base
+#define BATTERY_BAND_LOW_V              3.6f    // >= : intervalo x2
+#define BATTERY_BAND_CRITICAL_V         3.4f    // >= : intervalo x4 (por debajo x8)
+#define BATTERY_BAND_HYSTERESIS_V       0.05f   // Margen para volver a una banda mejor
+#define BATTERY_BAND_STRETCH            { 1, 2, 4, 8 }
+#define ADAPTIVE_FAST_CHANGE_RATIO      0.05f   // Cambio relativo entre ciclos que acorta
+#define ADAPTIVE_CHANGE_FLOOR           1.0f    // Denominador mínimo del cambio relativo
+#define ADAPTIVE_FAST_CHANGE_DIVISOR    2
+
+// Filtros por sensor con estado en memoria RTC (el tipo de filtro lo declara cada driver
+// en src/SensorDriver.cpp). Se aplican antes de codificar y de la política de intervalo.
+#define SENSOR_FILTERS_ENABLED          1
+#define FILTER_MAX_CHANNELS             16      // Canales (sensor o subvalor) con estado
+#define FILTER_EMA_ALPHA                0.3f    // Peso de la muestra nueva
+#define FILTER_MEDIAN_WINDOW            5       // Muestras de la mediana (impar, máx. 7)
+#define FILTER_KALMAN_Q                 0.01f   // Varianza del proceso por muestra
+#define FILTER_KALMAN_R                 0.25f   // Varianza de la medición
+
+// Agregación por ventana: los sensores con aggWindow > 1 se muestrean en cada tick pero solo
+// se envía un resumen (mín/máx/media/σ/n) por ventana, en un uplink por LORA_AGG_FPORT
+#define AGG_MAX_CHANNELS                8       // Canales (sensor o subvalor) agregados
+
+// Lotes: cada ciclo añade una fila (timestamp + valores cuantizados) y los ciclos de reporte
+// envían el lote codificado por columnas (util/batch_codec.h) por LORA_BATCH_FPORT en lugar
+// del payload delimitado. Útil con WAKE_SAMPLE_EVERY_TICKS > 0 para juntar varias muestras.
+#define BATCH_UPLINK_ENABLED            0
+#define BATCH_MAX_ROWS                  10      // Filas por lote (máx. 16)
+#define BATCH_MAX_COLUMNS               12      // Canales (sensor o subvalor) por lote (máx. 24)
+#define BATCH_DECIMALS                  1       // Decimales de temperatura, presión y demás canales
+#define BATCH_DECIMALS_FINE             2       // Decimales de pH y tensión de batería
+#define BATCH_DECIMALS_COARSE           0       // Decimales de humedad, conductividad, CO2 y luz
+#define BATCH_FRAME_MAX_BYTES           61      // Tamaño de cada trama (payload de DR1 en US915)
+#define BATCH_MAX_FRAMES                3       // Tramas por ciclo de reporte; el resto espera
+
+// Predicción dual: los sensores con predictTolerance > 0 solo se transmiten cuando el modelo
+// compartido con el servidor (util/dual_predictor.h) falla por más de la tolerancia
+#define PREDICT_MODEL                   DUAL_PREDICT_LINEAR
+#define PREDICT_MAX_CHANNELS            16      // Canales (sensor o subvalor) con modelo
+#define PREDICT_MAX_SILENCE_S           43200   // Transmitir al menos cada 12 h (0 = sin límite)
+
 // Identificadores
 #define DEFAULT_DEVICE_ID   "DEV01"
 #define DEFAULT_STATION_ID  "ST001"
@@ -61,6 +134,46 @@
 // LoRa Region y SubBand
 #define LORA_REGION         US915
 #define LORA_SUBBAND        2       // For US915, use 2; for other regions, use 0
+#define LORA_DIAG_FPORT     2       // Uplink de diagnóstico (binario, TLV)
+#define LORA_AGG_FPORT      3       // Resúmenes de ventana de agregación (binario)
+#define LORA_BATCH_FPORT    4       // Lotes de muestras codificados por columnas (binario)
+#define LORA_CMD_FPORT      10      // Downlinks de comandos de configuración (binario)
+
+// Enlace: DR y potencia de uplink (ver LinkPolicy.h). Los DR son los de 125 kHz de la región.
+#define LINK_NETWORK_ADR            0       // 1 = el servidor decide con ADR; 0 = política local
+#define LINK_DR_MIN                 0       // DR más robusto permitido (por defecto; ajustable por downlink)
+#define LINK_DR_MAX                 3       // DR de menor airtime permitido (ídem)
+#define LINK_DR_START               3       // DR tras un arranque en frío
+#define LINK_DR0_SF                 10      // SF de DR0 (US915: 10; EU868: 12)
+#define LINK_TX_POWER_MAX           22      // dBm (límite del SX1262)
+#define LINK_TX_POWER_MIN           10      // dBm
+#define LINK_TARGET_MARGIN_DB       10      // Margen a mantener sobre el umbral de demodulación
+#define LINK_CHECK_EVERY            8       // LinkCheck cada N uplinks de datos
+#define LINK_LOSSES_BEFORE_FALLBACK 2       // LinkCheck sin respuesta seguidos antes de retroceder
+#define LINK_DOWNLINK_SNR_OFFSET_DB 0       // Corrección del SNR de downlink como margen de uplink
+#define LINK_FOPTS_RESERVE          16      // Bytes reservados a comandos MAC al elegir DR
+
+// Tiempo en el aire: presupuesto por nodo (ver AirtimeBudget.h). 0 = sin límite.
+#define AIRTIME_BUDGET_HOUR_MS      36000   // Última hora (1 % de ciclo de trabajo)
+#define AIRTIME_BUDGET_DAY_MS       0       // Últimas 24 h (30000 = política de uso justo de TTN)
+
+// Slots de transmisión: desfase por nodo dentro del periodo (ver TxScheduler.h)
+#define TX_SLOT_ENABLED             1
+#define TX_SLOT_LENGTH_S            4       // Uplink en DR0 más las ventanas RX1/RX2
+#define TX_SLOT_SPREAD_PERCENT      50      // Parte del periodo en la que se reparten los uplinks
+#define TX_SLOT_WINDOW_MAX_S        120     // Espera máxima tras la medición
+
+// Sesión LoRaWAN en flash (ver SessionStore.h)
+#define SESSION_CHECKPOINT_EVERY    32      // Uplinks entre copias de la sesión en NVS
+#define SESSION_FCNT_GAP            48      // Salto de FCnt al restaurar (> CHECKPOINT_EVERY + uplinks por ciclo)
+
+// Join: back-off exponencial y memoria de sub-banda (ver JoinPolicy.h)
+#define JOIN_BACKOFF_BASE_S         300     // Espera tras el primer join fallido
+#define JOIN_BACKOFF_MAX_S          21600   // Tope de la espera (6 h)
+#define JOIN_BACKOFF_JITTER_PERCENT 25      // ± aleatorio para no sincronizar nodos
+#define JOIN_SUBBAND_SCAN           1       // 1 = probar otras sub-bandas si la conocida falla
+#define JOIN_ATTEMPTS_PER_SUBBAND   2       // Joins fallidos antes de pasar a la siguiente
+#define JOIN_SUBBAND_COUNT          8       // Sub-bandas de 8 canales de la región (US915: 8)
 
 #define BLE_SERVICE_UUID             "180A"
 #define BLE_CHAR_SYSTEM_UUID         "2A37"
@@ -78,6 +191,8 @@ const double conversionFactor = (R1 + R2) / R1;
 #define NAMESPACE_SENSORS       "sensors"
 #define NAMESPACE_LORAWAN       "lorawan"
 #define NAMESPACE_LORA_SESSION  "lorasession"
+#define NAMESPACE_CONFIG_BIN    "cfgbin"      // Registros binarios de configuración
+#define CONFIG_SCHEMA_VERSION   4
 
 // Claves
 #define KEY_INITIALIZED         "initialized"
@@ -90,6 +205,10 @@ const double conversionFactor = (R1 + R2) / R1;
 #define KEY_SENSOR_ID_TEMPERATURE_SENSOR "ts"
 #define KEY_SENSOR_TYPE         "t"
 #define KEY_SENSOR_ENABLE       "e"
+#define KEY_SENSOR_PERIOD       "p"
+#define KEY_SENSOR_AGG_WINDOW   "w"
+#define KEY_SENSOR_AGG_STATS    "s"
+#define KEY_SENSOR_PREDICT_TOL  "d"
 #define KEY_LORA_JOIN_EUI       "joinEUI"
 #define KEY_LORA_DEV_EUI        "devEUI"
 #define KEY_LORA_NWK_KEY        "nwkKey"
@@ -101,6 +220,12 @@ const double conversionFactor = (R1 + R2) / R1;
 #define JSON_DOC_SIZE_MEDIUM  1024
 #define JSON_DOC_SIZE_LARGE   2048
 
+// Capacidad de las tablas estáticas de configuración y lecturas
+#define MAX_NORMAL_SENSORS    16
+#define MAX_MODBUS_SENSORS    8
+#define MAX_SUBVALUES         4     // ENV4 reporta 4 subvalores
+#define MAX_ID_LENGTH         32    // deviceId / stationId (incluye '\0')
+
 // Batería
 #define BATTERY_PIN             1
 
@@ -131,7 +256,7 @@ const double conversionFactor = (R1 + R2) / R1;
 #define SPI_MISO_PIN        6
 #define SPI_MOSI_PIN        7
 #define SPI_RTD_CLOCK       1000000
-#define SPI_RADIO_CLOCK     100000
+#define SPI_RADIO_CLOCK     8000000   // SX1262 admite hasta 16 MHz
 
 // PT100
 #define PT100_CS_PIN        P03
@@ -157,6 +282,79 @@ const double conversionFactor = (R1 + R2) / R1;
 // Deep Sleep
 #define DEFAULT_TIME_TO_SLEEP   30
 
+// Planificación del wake stub (en ticks = intervalos de sueño). En los ticks sin tarea el
+// stub vuelve a dormir sin arrancar el firmware.
+#define WAKE_SAMPLE_EVERY_TICKS 1       // Muestreo sin envío (0 = deshabilitado)
+#define WAKE_REPORT_EVERY_TICKS 1       // Muestreo y envío
+
+// Periodo de la lectura de batería en ticks. Cada sensor tiene su propio periodo en la
+// configuración (periodTicks); en los ticks intermedios se usa el último valor leído.
+#define BATTERY_SAMPLE_EVERY_TICKS 1
+
+// Sueño ligero para intervalos cortos: se usa cuando la energía extra de dormir en ligero
+// durante el intervalo es menor que la de un arranque completo desde deep sleep
+#define LIGHT_SLEEP_ENABLED     1
+#define BOOT_COST_DEFAULT_MS    400     // Arranque en caliente hasta fin de setup() (sin medir)
+#define BOOT_ROM_OVERHEAD_MS    80      // ROM + bootloader, antes de que empiece millis()
+#define BOOT_ACTIVE_CURRENT_UA  30000   // Consumo medio durante el arranque
+#define LIGHT_SLEEP_CURRENT_UA  1500    // Sueño ligero (rieles de sensores apagados)
+#define DEEP_SLEEP_CURRENT_UA   20
+
+// Despertares alineados al reloj del DS3231: slots múltiplos del intervalo desde la época Unix
+#define SLOT_ALIGNMENT_ENABLED      1
+#define SLOT_OFFSET_S               0       // Desfase de los slots (s)
+#define SLOT_MIN_SLEEP_MS           1000    // Si falta menos, se apunta al slot siguiente
+#define SLOT_TIMESTAMP_TOLERANCE_S  5       // Margen para sellar las lecturas con el slot
+#define SLOT_DRIFT_MIN_SLEEP_MS     60000   // Sueños más cortos no miden deriva (resolución 1 s)
+#define SLOT_DRIFT_MAX_PPM          20000   // Muestras de deriva mayores se descartan
+// #define RTC_ALARM_WAKE_PIN       2       // INT/SQW del DS3231 como fuente de despertar (opcional)
+#define SLOT_ALARM_FALLBACK_MS      2000    // Temporizador de respaldo tras la alarma
+
+// Intervalo adaptativo: se alarga al bajar la batería y se acorta cuando las lecturas
+// cambian rápido. Siempre dentro de los límites [min, max] guardados en NVS.
+#define ADAPTIVE_INTERVAL_ENABLED       1
+#define INTERVAL_MIN_DEFAULT            10      // Segundos
+#define INTERVAL_MAX_DEFAULT            3600    // Segundos
+#define BATTERY_BAND_GOOD_V             3.9f    // >= : intervalo base
+#define BATTERY_BAND_LOW_V              3.6f    // >= : intervalo x2
+#define BATTERY_BAND_CRITICAL_V         3.4f    // >= : intervalo x4 (por debajo x8)
+#define BATTERY_BAND_HYSTERESIS_V       0.05f   // Margen para volver a una banda mejor
+#define BATTERY_BAND_STRETCH            { 1, 2, 4, 8 }
+#define ADAPTIVE_FAST_CHANGE_RATIO      0.05f   // Cambio relativo entre ciclos que acorta
+#define ADAPTIVE_CHANGE_FLOOR           1.0f    // Denominador mínimo del cambio relativo
+#define ADAPTIVE_FAST_CHANGE_DIVISOR    2
+
+// Filtros por sensor con estado en memoria RTC (el tipo de filtro lo declara cada driver
+// en src/SensorDriver.cpp). Se aplican antes de codificar y de la política de intervalo.
+#define SENSOR_FILTERS_ENABLED          1
+#define FILTER_MAX_CHANNELS             16      // Canales (sensor o subvalor) con estado
+#define FILTER_EMA_ALPHA                0.3f    // Peso de la muestra nueva
+#define FILTER_MEDIAN_WINDOW            5       // Muestras de la mediana (impar, máx. 7)
+#define FILTER_KALMAN_Q                 0.01f   // Varianza del proceso por muestra
+#define FILTER_KALMAN_R                 0.25f   // Varianza de la medición
+
+// Agregación por ventana: los sensores con aggWindow > 1 se muestrean en cada tick pero solo
+// se envía un resumen (mín/máx/media/σ/n) por ventana, en un uplink por LORA_AGG_FPORT
+#define AGG_MAX_CHANNELS                8       // Canales (sensor o subvalor) agregados
+
+// Lotes: cada ciclo añade una fila (timestamp + valores cuantizados) y los ciclos de reporte
+// envían el lote codificado por columnas (util/batch_codec.h) por LORA_BATCH_FPORT en lugar
+// del payload delimitado. Útil con WAKE_SAMPLE_EVERY_TICKS > 0 para juntar varias muestras.
+#define BATCH_UPLINK_ENABLED            0
+#define BATCH_MAX_ROWS                  10      // Filas por lote (máx. 16)
+#define BATCH_MAX_COLUMNS               12      // Canales (sensor o subvalor) por lote (máx. 24)
+#define BATCH_DECIMALS                  1       // Decimales de temperatura, presión y demás canales
+#define BATCH_DECIMALS_FINE             2       // Decimales de pH y tensión de batería
+#define BATCH_DECIMALS_COARSE           0       // Decimales de humedad, conductividad, CO2 y luz
+#define BATCH_FRAME_MAX_BYTES           61      // Tamaño de cada trama (payload de DR1 en US915)
+#define BATCH_MAX_FRAMES                3       // Tramas por ciclo de reporte; el resto espera
+
+// Predicción dual: los sensores con predictTolerance > 0 solo se transmiten cuando el modelo
+// compartido con el servidor (util/dual_predictor.h) falla por más de la tolerancia
+#define PREDICT_MODEL                   DUAL_PREDICT_LINEAR
+#define PREDICT_MAX_CHANNELS            16      // Canales (sensor o subvalor) con modelo
+#define PREDICT_MAX_SILENCE_S           43200   // Transmitir al menos cada 12 h (0 = sin límite)
+
 // Identificadores
 #define DEFAULT_DEVICE_ID   "DEV01"
 #define DEFAULT_STATION_ID  "ST001"
@@ -170,6 +368,46 @@ const double conversionFactor = (R1 + R2) / R1;
 // LoRa Region y SubBand
 #define LORA_REGION         US915
 #define LORA_SUBBAND        2       // For US915, use 2; for other regions, use 0
+#define LORA_DIAG_FPORT     2       // Uplink de diagnóstico (binario, TLV)
+#define LORA_AGG_FPORT      3       // Resúmenes de ventana de agregación (binario)
+#define LORA_BATCH_FPORT    4       // Lotes de muestras codificados por columnas (binario)
+#define LORA_CMD_FPORT      10      // Downlinks de comandos de configuración (binario)
+
+// Enlace: DR y potencia de uplink (ver LinkPolicy.h). Los DR son los de 125 kHz de la región.
+#define LINK_NETWORK_ADR            0       // 1 = el servidor decide con ADR; 0 = política local
+#define LINK_DR_MIN                 0       // DR más robusto permitido (por defecto; ajustable por downlink)
+#define LINK_DR_MAX                 3       // DR de menor airtime permitido (ídem)
+#define LINK_DR_START               3       // DR tras un arranque en frío
+#define LINK_DR0_SF                 10      // SF de DR0 (US915: 10; EU868: 12)
+#define LINK_TX_POWER_MAX           22      // dBm (límite del SX1262)
+#define LINK_TX_POWER_MIN           10      // dBm
+#define LINK_TARGET_MARGIN_DB       10      // Margen a mantener sobre el umbral de demodulación
+#define LINK_CHECK_EVERY            8       // LinkCheck cada N uplinks de datos
+#define LINK_LOSSES_BEFORE_FALLBACK 2       // LinkCheck sin respuesta seguidos antes de retroceder
+#define LINK_DOWNLINK_SNR_OFFSET_DB 0       // Corrección del SNR de downlink como margen de uplink
+#define LINK_FOPTS_RESERVE          16      // Bytes reservados a comandos MAC al elegir DR
+
+// Tiempo en el aire: presupuesto por nodo (ver AirtimeBudget.h). 0 = sin límite.
+#define AIRTIME_BUDGET_HOUR_MS      36000   // Última hora (1 % de ciclo de trabajo)
+#define AIRTIME_BUDGET_DAY_MS       0       // Últimas 24 h (30000 = política de uso justo de TTN)
+
+// Slots de transmisión: desfase por nodo dentro del periodo (ver TxScheduler.h)
+#define TX_SLOT_ENABLED             1
+#define TX_SLOT_LENGTH_S            4       // Uplink en DR0 más las ventanas RX1/RX2
+#define TX_SLOT_SPREAD_PERCENT      50      // Parte del periodo en la que se reparten los uplinks
+#define TX_SLOT_WINDOW_MAX_S        120     // Espera máxima tras la medición
+
+// Sesión LoRaWAN en flash (ver SessionStore.h)
+#define SESSION_CHECKPOINT_EVERY    32      // Uplinks entre copias de la sesión en NVS
+#define SESSION_FCNT_GAP            48      // Salto de FCnt al restaurar (> CHECKPOINT_EVERY + uplinks por ciclo)
+
+// Join: back-off exponencial y memoria de sub-banda (ver JoinPolicy.h)
+#define JOIN_BACKOFF_BASE_S         300     // Espera tras el primer join fallido
+#define JOIN_BACKOFF_MAX_S          21600   // Tope de la espera (6 h)
+#define JOIN_BACKOFF_JITTER_PERCENT 25      // ± aleatorio para no sincronizar nodos
+#define JOIN_SUBBAND_SCAN           1       // 1 = probar otras sub-bandas si la conocida falla
+#define JOIN_ATTEMPTS_PER_SUBBAND   2       // Joins fallidos antes de pasar a la siguiente
+#define JOIN_SUBBAND_COUNT          8       // Sub-bandas de 8 canales de la región (US915: 8)
 
 #define BLE_SERVICE_UUID             "180A"
 #define BLE_CHAR_SYSTEM_UUID         "2A37"
@@ -191,6 +429,8 @@ const double conversionFactor = (R1 + R2) / R1;
 #define NAMESPACE_SENSORS       "sensors"
 #define NAMESPACE_LORAWAN       "lorawan"
 #define NAMESPACE_LORA_SESSION  "lorasession"
+#define NAMESPACE_CONFIG_BIN    "cfgbin"      // Registros binarios de configuración
+#define CONFIG_SCHEMA_VERSION   4
 #define NAMESPACE_SENSORS_MODBUS "sensors_modbus"
 
 // Claves
@@ -204,6 +444,10 @@ const double conversionFactor = (R1 + R2) / R1;
 #define KEY_SENSOR_ID_TEMPERATURE_SENSOR "ts"
 #define KEY_SENSOR_TYPE         "t"
 #define KEY_SENSOR_ENABLE       "e"
+#define KEY_SENSOR_PERIOD       "p"
+#define KEY_SENSOR_AGG_WINDOW   "w"
+#define KEY_SENSOR_AGG_STATS    "s"
+#define KEY_SENSOR_PREDICT_TOL  "d"
 #define KEY_LORA_JOIN_EUI       "joinEUI"
 #define KEY_LORA_DEV_EUI        "devEUI"
 #define KEY_LORA_NWK_KEY        "nwkKey"
@@ -215,6 +459,10 @@ const double conversionFactor = (R1 + R2) / R1;
 #define KEY_MODBUS_SENSOR_TYPE  "t"
 #define KEY_MODBUS_SENSOR_ADDR  "a"
 #define KEY_MODBUS_SENSOR_ENABLE "e"
+#define KEY_MODBUS_SENSOR_PERIOD "p"
+#define KEY_MODBUS_SENSOR_AGG_WINDOW "w"
+#define KEY_MODBUS_SENSOR_AGG_STATS "s"
+#define KEY_MODBUS_SENSOR_PREDICT_TOL "d"
 
 // Configuración Modbus
 #define MODBUS_BAUDRATE         9600
@@ -228,6 +476,12 @@ const double conversionFactor = (R1 + R2) / R1;
 #define JSON_DOC_SIZE_MEDIUM  1024
 #define JSON_DOC_SIZE_LARGE   2048
 
+// Capacidad de las tablas estáticas de configuración y lecturas
+#define MAX_NORMAL_SENSORS    16
+#define MAX_MODBUS_SENSORS    8
+#define MAX_SUBVALUES         4     // ENV4 reporta 4 subvalores
+#define MAX_ID_LENGTH         32    // deviceId / stationId (incluye '\0')
+
 // Batería
 #define POWER_3V3_PIN           P00
 #define POWER_12V_PIN           P01
@@ -241,6 +495,16 @@ const double conversionFactor = (R1 + R2) / R1;
 #define ADS124S08_START_PIN     P14
 #define SPI_ADC_CLOCK           1000000
 
+// Perfiles de adquisición ADC por canal: { data rate, filtro, conversiones, reducción }
+// Los códigos ADS_DR_* están en ADS124S08.h y los tipos en AdcUtilities.h
+#define ADC_PROFILE_NTC100K     { ADS_DR_400,  ADC_FILTER_SINC3,       8, ADC_REDUCE_TRIMMED_MEAN }
+#define ADC_PROFILE_NTC10K      { ADS_DR_400,  ADC_FILTER_SINC3,       8, ADC_REDUCE_TRIMMED_MEAN }
+#define ADC_PROFILE_HDS10       { ADS_DR_400,  ADC_FILTER_SINC3,       4, ADC_REDUCE_MEAN }
+#define ADC_PROFILE_COND        { ADS_DR_400,  ADC_FILTER_SINC3,       8, ADC_REDUCE_TRIMMED_MEAN }
+#define ADC_PROFILE_PH          { ADS_DR_100,  ADC_FILTER_SINC3,       8, ADC_REDUCE_MEDIAN }
+#define ADC_PROFILE_BATTERY     { ADS_DR_1000, ADC_FILTER_LOW_LATENCY, 4, ADC_REDUCE_MEAN }
+#define ADC_NOISE_REPORT_UV     200     // Desviación de ráfaga que se informa en diagnóstico
+
 // FlowSensor
 #define FLOW_SENSOR_PIN         0
 
@@ -359,7 +623,7 @@ const double conversionFactor = (R1 + R2) / R1;
 #define SPI_MISO_PIN        6
 #define SPI_MOSI_PIN        7
 #define SPI_RTD_CLOCK       1000000
-#define SPI_RADIO_CLOCK     100000
+#define SPI_RADIO_CLOCK     8000000   // SX1262 admite hasta 16 MHz
 
 // PT100
 #define PT100_CS_PIN        P03
@@ -391,6 +655,79 @@ const double conversionFactor = (R1 + R2) / R1;
 // Deep Sleep
 #define DEFAULT_TIME_TO_SLEEP   30
 
+// Planificación del wake stub (en ticks = intervalos de sueño). En los ticks sin tarea el
+// stub vuelve a dormir sin arrancar el firmware.
+#define WAKE_SAMPLE_EVERY_TICKS 1       // Muestreo sin envío (0 = deshabilitado)
+#define WAKE_REPORT_EVERY_TICKS 1       // Muestreo y envío
+
+// Periodo de la lectura de batería en ticks. Cada sensor tiene su propio periodo en la
+// configuración (periodTicks); en los ticks intermedios se usa el último valor leído.
+#define BATTERY_SAMPLE_EVERY_TICKS 1
+
+// Sueño ligero para intervalos cortos: se usa cuando la energía extra de dormir en ligero
+// durante el intervalo es menor que la de un arranque completo desde deep sleep
+#define LIGHT_SLEEP_ENABLED     1
+#define BOOT_COST_DEFAULT_MS    400     // Arranque en caliente hasta fin de setup() (sin medir)
+#define BOOT_ROM_OVERHEAD_MS    80      // ROM + bootloader, antes de que empiece millis()
+#define BOOT_ACTIVE_CURRENT_UA  30000   // Consumo medio durante el arranque
+#define LIGHT_SLEEP_CURRENT_UA  1500    // Sueño ligero (rieles de sensores apagados)
+#define DEEP_SLEEP_CURRENT_UA   20
+
+// Despertares alineados al reloj del DS3231: slots múltiplos del intervalo desde la época Unix
+#define SLOT_ALIGNMENT_ENABLED      1
+#define SLOT_OFFSET_S               0       // Desfase de los slots (s)
+#define SLOT_MIN_SLEEP_MS           1000    // Si falta menos, se apunta al slot siguiente
+#define SLOT_TIMESTAMP_TOLERANCE_S  5       // Margen para sellar las lecturas con el slot
+#define SLOT_DRIFT_MIN_SLEEP_MS     60000   // Sueños más cortos no miden deriva (resolución 1 s)
+#define SLOT_DRIFT_MAX_PPM          20000   // Muestras de deriva mayores se descartan
+// #define RTC_ALARM_WAKE_PIN       2       // INT/SQW del DS3231 como fuente de despertar (opcional)
+#define SLOT_ALARM_FALLBACK_MS      2000    // Temporizador de respaldo tras la alarma
+
+// Intervalo adaptativo: se alarga al bajar la batería y se acorta cuando las lecturas
+// cambian rápido. Siempre dentro de los límites [min, max] guardados en NVS.
+#define ADAPTIVE_INTERVAL_ENABLED       1
+#define INTERVAL_MIN_DEFAULT            10      // Segundos
+#define INTERVAL_MAX_DEFAULT            3600    // Segundos
+#define BATTERY_BAND_GOOD_V             3.9f    // >= : intervalo base
+#define BATTERY_BAND_LOW_V              3.6f    // >= : intervalo x2
+#define BATTERY_BAND_CRITICAL_V         3.4f    // >= : intervalo x4 (por debajo x8)
+#define BATTERY_BAND_HYSTERESIS_V       0.05f   // Margen para volver a una banda mejor
+#define BATTERY_BAND_STRETCH            { 1, 2, 4, 8 }
+#define ADAPTIVE_FAST_CHANGE_RATIO      0.05f   // Cambio relativo entre ciclos que acorta
+#define ADAPTIVE_CHANGE_FLOOR           1.0f    // Denominador mínimo del cambio relativo
+#define ADAPTIVE_FAST_CHANGE_DIVISOR    2
+
+// Filtros por sensor con estado en memoria RTC (el tipo de filtro lo declara cada driver
+// en src/SensorDriver.cpp). Se aplican antes de codificar y de la política de intervalo.
+#define SENSOR_FILTERS_ENABLED          1
+#define FILTER_MAX_CHANNELS             16      // Canales (sensor o subvalor) con estado
+#define FILTER_EMA_ALPHA                0.3f    // Peso de la muestra nueva
+#define FILTER_MEDIAN_WINDOW            5       // Muestras de la mediana (impar, máx. 7)
+#define FILTER_KALMAN_Q                 0.01f   // Varianza del proceso por muestra
+#define FILTER_KALMAN_R                 0.25f   // Varianza de la medición
+
+// Agregación por ventana: los sensores con aggWindow > 1 se muestrean en cada tick pero solo
+// se envía un resumen (mín/máx/media/σ/n) por ventana, en un uplink por LORA_AGG_FPORT
+#define AGG_MAX_CHANNELS                8       // Canales (sensor o subvalor) agregados
+
+// Lotes: cada ciclo añade una fila (timestamp + valores cuantizados) y los ciclos de reporte
+// envían el lote codificado por columnas (util/batch_codec.h) por LORA_BATCH_FPORT en lugar
+// del payload delimitado. Útil con WAKE_SAMPLE_EVERY_TICKS > 0 para juntar varias muestras.
+#define BATCH_UPLINK_ENABLED            0
+#define BATCH_MAX_ROWS                  10      // Filas por lote (máx. 16)
+#define BATCH_MAX_COLUMNS               12      // Canales (sensor o subvalor) por lote (máx. 24)
+#define BATCH_DECIMALS                  1       // Decimales de temperatura, presión y demás canales
+#define BATCH_DECIMALS_FINE             2       // Decimales de pH y tensión de batería
+#define BATCH_DECIMALS_COARSE           0       // Decimales de humedad, conductividad, CO2 y luz
+#define BATCH_FRAME_MAX_BYTES           61      // Tamaño de cada trama (payload de DR1 en US915)
+#define BATCH_MAX_FRAMES                3       // Tramas por ciclo de reporte; el resto espera
+
+// Predicción dual: los sensores con predictTolerance > 0 solo se transmiten cuando el modelo
+// compartido con el servidor (util/dual_predictor.h) falla por más de la tolerancia
+#define PREDICT_MODEL                   DUAL_PREDICT_LINEAR
+#define PREDICT_MAX_CHANNELS            16      // Canales (sensor o subvalor) con modelo
+#define PREDICT_MAX_SILENCE_S           43200   // Transmitir al menos cada 12 h (0 = sin límite)
+
 // Identificadores
 #define DEFAULT_DEVICE_ID   "DEV01"
 #define DEFAULT_STATION_ID  "ST001"
@@ -404,6 +741,46 @@ const double conversionFactor = (R1 + R2) / R1;
 // LoRa Region y SubBand
 #define LORA_REGION         US915
 #define LORA_SUBBAND        2
+#define LORA_DIAG_FPORT     2       // Uplink de diagnóstico (binario, TLV)
+#define LORA_AGG_FPORT      3       // Resúmenes de ventana de agregación (binario)
+#define LORA_BATCH_FPORT    4       // Lotes de muestras codificados por columnas (binario)
+#define LORA_CMD_FPORT      10      // Downlinks de comandos de configuración (binario)
+
+// Enlace: DR y potencia de uplink (ver LinkPolicy.h). Los DR son los de 125 kHz de la región.
+#define LINK_NETWORK_ADR            0       // 1 = el servidor decide con ADR; 0 = política local
+#define LINK_DR_MIN                 0       // DR más robusto permitido (por defecto; ajustable por downlink)
+#define LINK_DR_MAX                 3       // DR de menor airtime permitido (ídem)
+#define LINK_DR_START               3       // DR tras un arranque en frío
+#define LINK_DR0_SF                 10      // SF de DR0 (US915: 10; EU868: 12)
+#define LINK_TX_POWER_MAX           22      // dBm (límite del SX1262)
+#define LINK_TX_POWER_MIN           10      // dBm
+#define LINK_TARGET_MARGIN_DB       10      // Margen a mantener sobre el umbral de demodulación
+#define LINK_CHECK_EVERY            8       // LinkCheck cada N uplinks de datos
+#define LINK_LOSSES_BEFORE_FALLBACK 2       // LinkCheck sin respuesta seguidos antes de retroceder
+#define LINK_DOWNLINK_SNR_OFFSET_DB 0       // Corrección del SNR de downlink como margen de uplink
+#define LINK_FOPTS_RESERVE          16      // Bytes reservados a comandos MAC al elegir DR
+
+// Tiempo en el aire: presupuesto por nodo (ver AirtimeBudget.h). 0 = sin límite.
+#define AIRTIME_BUDGET_HOUR_MS      36000   // Última hora (1 % de ciclo de trabajo)
+#define AIRTIME_BUDGET_DAY_MS       0       // Últimas 24 h (30000 = política de uso justo de TTN)
+
+// Slots de transmisión: desfase por nodo dentro del periodo (ver TxScheduler.h)
+#define TX_SLOT_ENABLED             1
+#define TX_SLOT_LENGTH_S            4       // Uplink en DR0 más las ventanas RX1/RX2
+#define TX_SLOT_SPREAD_PERCENT      50      // Parte del periodo en la que se reparten los uplinks
+#define TX_SLOT_WINDOW_MAX_S        120     // Espera máxima tras la medición
+
+// Sesión LoRaWAN en flash (ver SessionStore.h)
+#define SESSION_CHECKPOINT_EVERY    32      // Uplinks entre copias de la sesión en NVS
+#define SESSION_FCNT_GAP            48      // Salto de FCnt al restaurar (> CHECKPOINT_EVERY + uplinks por ciclo)
+
+// Join: back-off exponencial y memoria de sub-banda (ver JoinPolicy.h)
+#define JOIN_BACKOFF_BASE_S         300     // Espera tras el primer join fallido
+#define JOIN_BACKOFF_MAX_S          21600   // Tope de la espera (6 h)
+#define JOIN_BACKOFF_JITTER_PERCENT 25      // ± aleatorio para no sincronizar nodos
+#define JOIN_SUBBAND_SCAN           1       // 1 = probar otras sub-bandas si la conocida falla
+#define JOIN_ATTEMPTS_PER_SUBBAND   2       // Joins fallidos antes de pasar a la siguiente
+#define JOIN_SUBBAND_COUNT          8       // Sub-bandas de 8 canales de la región (US915: 8)
 
 #define BLE_SERVICE_UUID             "180A"
 #define BLE_CHAR_SYSTEM_UUID         "2A37"
@@ -421,6 +798,8 @@ const double conversionFactor = (R1 + R2) / R1;
 #define NAMESPACE_SENSORS               "sensors"
 #define NAMESPACE_LORAWAN               "lorawan"
 #define NAMESPACE_LORA_SESSION          "lorasession"
+#define NAMESPACE_CONFIG_BIN            "cfgbin"    // Registros binarios de configuración
+#define CONFIG_SCHEMA_VERSION           4
 #define NAMESPACE_SENSORS_MODBUS        "sensors_modbus"
 
 // Claves
@@ -434,6 +813,10 @@ const double conversionFactor = (R1 + R2) / R1;
 #define KEY_SENSOR_ID_TEMPERATURE_SENSOR "ts"
 #define KEY_SENSOR_TYPE                  "t"
 #define KEY_SENSOR_ENABLE                "e"
+#define KEY_SENSOR_PERIOD                "p"
+#define KEY_SENSOR_AGG_WINDOW            "w"
+#define KEY_SENSOR_AGG_STATS             "s"
+#define KEY_SENSOR_PREDICT_TOL           "d"
 #define KEY_LORA_JOIN_EUI                "joinEUI"
 #define KEY_LORA_DEV_EUI                 "devEUI"
 #define KEY_LORA_NWK_KEY                 "nwkKey"
@@ -445,6 +828,10 @@ const double conversionFactor = (R1 + R2) / R1;
 #define KEY_MODBUS_SENSOR_TYPE  "t"
 #define KEY_MODBUS_SENSOR_ADDR  "a"
 #define KEY_MODBUS_SENSOR_ENABLE "e"
+#define KEY_MODBUS_SENSOR_PERIOD "p"
+#define KEY_MODBUS_SENSOR_AGG_WINDOW "w"
+#define KEY_MODBUS_SENSOR_AGG_STATS "s"
+#define KEY_MODBUS_SENSOR_PREDICT_TOL "d"
 
 // Configuración Modbus
 #define MODBUS_BAUDRATE         9600
@@ -457,6 +844,12 @@ const double conversionFactor = (R1 + R2) / R1;
 #define JSON_DOC_SIZE_MEDIUM  1024
 #define JSON_DOC_SIZE_LARGE   2048
 
+// Capacidad de las tablas estáticas de configuración y lecturas
+#define MAX_NORMAL_SENSORS    16
+#define MAX_MODBUS_SENSORS    8
+#define MAX_SUBVALUES         4     // ENV4 reporta 4 subvalores
+#define MAX_ID_LENGTH         32    // deviceId / stationId (incluye '\0')
+
 // Power management
 #define POWER_3V3_PIN           P00
 #define POWER_12V_PIN           P01
@@ -26,29 +26,50 @@ public:
     
     // Configuración del sistema
     static void getSystemConfig(bool &initialized, uint32_t &sleepTime, String &deviceId, String &stationId);
+    static void getSystemConfig(bool &initialized, uint32_t &sleepTime,
+                                char *deviceId, size_t deviceIdSize,
+                                char *stationId, size_t stationIdSize);
     static void setSystemConfig(bool initialized, uint32_t sleepTime, const String &deviceId, const String &stationId);
+    static void setSystemConfig(bool initialized, uint32_t sleepTime,
+                                const char *deviceId, const char *stationId);
+    // Límites del intervalo adaptativo (segundos)
+    static void getIntervalBounds(uint32_t &minInterval, uint32_t &maxInterval);
+    static void setIntervalBounds(uint32_t minInterval, uint32_t maxInterval);
+    // Límites de DR de uplink de la política de enlace
+    static void getDatarateLimits(uint8_t &drMin, uint8_t &drMax);
+    static void setDatarateLimits(uint8_t drMin, uint8_t drMax);
 
     /* =========================================================================
        CONFIGURACIÓN DE SENSORES NO-MODBUS
        ========================================================================= */
     // Gestión de sensores generales
     static void setSensorsConfigs(const std::vector<SensorConfig>& configs);
+    static void setSensorsConfigs(const SensorConfig* configs, size_t count);
     static std::vector<SensorConfig> getAllSensorConfigs();
-    static std::vector<SensorConfig> getEnabledSensorConfigs();
+    // Copia todos los sensores configurados en 'out' (hasta maxCount) y devuelve cuántos hay
+    static size_t getAllSensorConfigs(SensorConfig* out, size_t maxCount);
+    // Copia los sensores habilitados en 'out' (hasta maxCount) y devuelve cuántos hay
+    static size_t getEnabledSensorConfigs(SensorConfig* out, size_t maxCount);
 
 #if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
     /* =========================================================================
        CONFIGURACIÓN DE SENSORES MODBUS
        ========================================================================= */
     static void setModbusSensorsConfigs(const std::vector<ModbusSensorConfig>& configs);
+    static void setModbusSensorsConfigs(const ModbusSensorConfig* configs, size_t count);
     static std::vector<ModbusSensorConfig> getAllModbusSensorConfigs();
-    static std::vector<ModbusSensorConfig> getEnabledModbusSensorConfigs();
+    static size_t getAllModbusSensorConfigs(ModbusSensorConfig* out, size_t maxCount);
+    static size_t getEnabledModbusSensorConfigs(ModbusSensorConfig* out, size_t maxCount);
 #endif
     
     /* =========================================================================
        CONFIGURACIÓN DE LORA
        ========================================================================= */
+    // Vista en texto de EUIs y claves (interfaz BLE)
     static LoRaConfig getLoRaConfig();
+    // EUIs y claves en binario, listos para LoRaWANNode::beginOTAA (false si el DevEUI
+    // guardado no es válido)
+    static bool getLoRaKeys(uint64_t &joinEUI, uint64_t &devEUI, uint8_t *nwkKey, uint8_t *appKey);
     static void setLoRaConfig(
         const String &joinEUI, 
         const String &devEUI, 
@@ -0,0 +1,139 @@
+/*******************************************************************************************
+ * Archivo: include/config_records.h
+ * Descripción: Registros binarios de configuración guardados en NVS. Cada registro es un
+ *              blob con cabecera (magia, versión de esquema, longitud y CRC-16) seguido de
+ *              la estructura empaquetada. Un blob se escribe de forma atómica, de modo que
+ *              todos los campos de un registro se actualizan juntos.
+ *******************************************************************************************/
+
+#ifndef CONFIG_RECORDS_H
+#define CONFIG_RECORDS_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Marca de registro válido
+#define CONFIG_RECORD_MAGIC     0xC5
+
+// Claves de cada registro dentro de NAMESPACE_CONFIG_BIN (máx. 15 caracteres en NVS)
+#define CFG_RECORD_SYSTEM       "sys"
+#define CFG_RECORD_LORAWAN      "lora"
+#define CFG_RECORD_SENSORS      "sensors"
+#define CFG_RECORD_MODBUS       "modbus"
+#define CFG_RECORD_NTC100K      "ntc100k"
+#define CFG_RECORD_NTC10K       "ntc10k"
+#define CFG_RECORD_COND         "cond"
+#define CFG_RECORD_PH           "ph"
+#define CFG_RECORD_INTERVAL     "interval"
+#define CFG_RECORD_LINK         "link"
+
+/**
+ * @brief Cabecera común de todos los registros
+ */
+struct __attribute__((packed)) ConfigRecordHeader {
+    uint8_t magic;              // CONFIG_RECORD_MAGIC
+    uint8_t version;            // CONFIG_SCHEMA_VERSION con el que se escribió
+    uint16_t length;            // Tamaño de la estructura que sigue
+    uint16_t crc;               // CRC-16 (0xA001, semilla 0xFFFF) de la estructura
+};
+
+struct __attribute__((packed)) SystemConfigRecord {
+    uint8_t initialized;
+    uint32_t sleepTime;
+    char deviceId[MAX_ID_LENGTH];
+    char stationId[MAX_ID_LENGTH];
+};
+
+// EUIs en orden big-endian, claves tal como las usa RadioLib
+struct __attribute__((packed)) LoRaConfigRecord {
+    uint8_t joinEUI[8];
+    uint8_t devEUI[8];
+    uint8_t nwkKey[16];
+    uint8_t appKey[16];
+};
+
+// Límites del intervalo adaptativo (segundos), fijados por el servidor
+struct __attribute__((packed)) IntervalBoundsRecord {
+    uint32_t minInterval;
+    uint32_t maxInterval;
+};
+
+// Límites de DR de uplink de la política de enlace, fijados por el servidor
+struct __attribute__((packed)) LinkLimitsRecord {
+    uint8_t drMin;
+    uint8_t drMax;
+};
+
+struct __attribute__((packed)) SensorConfigEntry {
+    char configKey[20];
+    char sensorId[20];
+    uint8_t type;               // SensorType
+    uint8_t enable;
+    uint8_t periodTicks;        // Esquema 2
+    uint8_t aggWindow;          // Esquema 3
+    uint8_t aggStats;
+    float predictTolerance;     // Esquema 4 (los campos nuevos van siempre al final)
+};
+
+struct __attribute__((packed)) SensorsConfigRecord {
+    uint8_t count;
+    SensorConfigEntry sensors[MAX_NORMAL_SENSORS];
+};
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+struct __attribute__((packed)) ModbusSensorConfigEntry {
+    char sensorId[20];
+    uint8_t type;               // SensorType
+    uint8_t address;
+    uint8_t enable;
+    uint8_t periodTicks;        // Esquema 2
+    uint8_t aggWindow;          // Esquema 3
+    uint8_t aggStats;
+    float predictTolerance;     // Esquema 4 (los campos nuevos van siempre al final)
+};
+
+struct __attribute__((packed)) ModbusSensorsConfigRecord {
+    uint8_t count;
+    ModbusSensorConfigEntry sensors[MAX_MODBUS_SENSORS];
+};
+#endif
+
+#ifdef DEVICE_TYPE_ANALOGIC
+// Tres puntos (T, R) de Steinhart-Hart
+struct __attribute__((packed)) NtcConfigRecord {
+    double t1, r1, t2, r2, t3, r3;
+};
+
+struct __attribute__((packed)) ConductivityConfigRecord {
+    float calTemp, coefComp;
+    float v1, t1, v2, t2, v3, t3;
+};
+
+struct __attribute__((packed)) PhConfigRecord {
+    float v1, t1, v2, t2, v3, t3;
+    float calTemp;
+};
+#endif
+
+/**
+ * @brief Unión usada solo para dimensionar el buffer de lectura/escritura
+ */
+union ConfigRecordPayload {
+    SystemConfigRecord system;
+    LoRaConfigRecord lorawan;
+    IntervalBoundsRecord interval;
+    LinkLimitsRecord link;
+    SensorsConfigRecord sensors;
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    ModbusSensorsConfigRecord modbus;
+#endif
+#ifdef DEVICE_TYPE_ANALOGIC
+    NtcConfigRecord ntc;
+    ConductivityConfigRecord cond;
+    PhConfigRecord ph;
+#endif
+};
+
+#define CONFIG_RECORD_MAX_SIZE (sizeof(ConfigRecordHeader) + sizeof(ConfigRecordPayload))
+
+#endif // CONFIG_RECORDS_H
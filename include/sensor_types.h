@@ -11,6 +11,7 @@
  ************************************************************************/
  
 #define MODBUS_ENV4_STABILIZATION_TIME 5000   // Tiempo de estabilización para sensor ENV4 Modbus
+#define MODBUS_DEFAULT_STABILIZATION_TIME 500 // Tiempo para tipos Modbus sin driver registrado
 // Añadir aquí otros tiempos de estabilización para sensores Modbus
 
 /**
@@ -63,9 +64,23 @@ struct SensorReading {
     char sensorId[20];         // Identificador del sensor (ej. "SHT30_1")
     SensorType type;           // Tipo de sensor
     float value;               // Valor único (si aplica)
-    std::vector<SubValue> subValues; // Subvalores, si el sensor genera varias mediciones
+    SubValue subValues[MAX_SUBVALUES]; // Subvalores, si el sensor genera varias mediciones
+    uint8_t subValueCount;     // Número de subvalores válidos
 };
 
+/**
+ * @brief Agrega un subvalor a una lectura sin usar memoria dinámica.
+ * @return false si la lectura ya tiene MAX_SUBVALUES subvalores
+ */
+template <typename Reading>
+inline bool addSubValue(Reading& reading, float value) {
+    if (reading.subValueCount >= MAX_SUBVALUES) {
+        return false;
+    }
+    reading.subValues[reading.subValueCount++].value = value;
+    return true;
+}
+
 /**
  * @brief Estructura de configuración para sensores "normales" (no Modbus).
  */
@@ -74,6 +89,10 @@ struct SensorConfig {
     char sensorId[20];
     SensorType type;
     bool enable;
+    uint8_t periodTicks;    // Leer cada N ticks de muestreo (0 o 1 = en todos)
+    uint8_t aggWindow;      // Enviar un resumen cada N muestras (0 o 1 = cada muestra)
+    uint8_t aggStats;       // Estadísticas del resumen (AGG_STAT_*)
+    float predictTolerance; // Predicción dual: error máximo sin transmitir (0 = siempre)
 };
 
 #if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
@@ -89,6 +108,10 @@ struct ModbusSensorConfig {
     SensorType type;           // Tipo de sensor Modbus
     uint8_t address;           // Dirección Modbus del dispositivo
     bool enable;               // Si está habilitado o no
+    uint8_t periodTicks;       // Leer cada N ticks de muestreo (0 o 1 = en todos)
+    uint8_t aggWindow;         // Enviar un resumen cada N muestras (0 o 1 = cada muestra)
+    uint8_t aggStats;          // Estadísticas del resumen (AGG_STAT_*)
+    float predictTolerance;    // Predicción dual: error máximo sin transmitir (0 = siempre)
 };
 
 /**
@@ -97,7 +120,8 @@ struct ModbusSensorConfig {
 struct ModbusSensorReading {
     char sensorId[20];         // Identificador del sensor
     SensorType type;           // Tipo de sensor Modbus
-    std::vector<SubValue> subValues; // Subvalores reportados por el sensor
+    SubValue subValues[MAX_SUBVALUES]; // Subvalores reportados por el sensor
+    uint8_t subValueCount;     // Número de subvalores válidos
 };
 #endif // defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
 
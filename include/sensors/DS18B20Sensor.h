@@ -11,6 +11,9 @@
 // Variable externa
 extern DallasTemperature dallasTemp;
 
+// Tiempo máximo de conversión a 12 bits (ms)
+#define DS18B20_CONVERSION_TIME_MS 750
+
 /**
  * @brief Clase para manejar el sensor de temperatura DS18B20
  */
@@ -22,6 +25,28 @@ public:
      * @return float Temperatura en °C, o NAN si hay error
      */
     static float read();
+
+    /**
+     * @brief Inicializa el bus OneWire y deja las conversiones en modo no bloqueante
+     */
+    static void begin();
+
+    /**
+     * @brief Inicia una conversión sin esperar a que termine
+     */
+    static void startConversion();
+
+    /**
+     * @brief Indica si la conversión iniciada con startConversion() terminó
+     */
+    static bool conversionReady();
+
+    /**
+     * @brief Lee la temperatura de la última conversión
+     * 
+     * @return float Temperatura en °C, o NAN si hay error
+     */
+    static float readLatest();
 };
 
 #endif // defined(DEVICE_TYPE_BASIC) || defined(DEVICE_TYPE_ANALOGIC)
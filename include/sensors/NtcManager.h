@@ -3,6 +3,9 @@
 
 #include <Arduino.h>
 
+// NTC10K (NTC3) en el canal AIN11 con AIN8 como referencia
+#define NTC10K_MUX_CONFIG (ADS_P_AIN11 | ADS_N_AIN8)
+
 /**
  * @brief Clase para gestionar los cálculos y lecturas de sensores NTC100K
  */
@@ -65,6 +68,14 @@ public:
      * @return Temperatura en °C o NAN en caso de error
      */
     static double readNtc10kTemperature();
+
+    /**
+     * @brief Convierte el voltaje del divisor del NTC10K a temperatura con su calibración.
+     *        Permite reutilizar una conversión ya medida en el ciclo.
+     * @param voltage Voltaje medido en AIN11/AIN8 (V)
+     * @return Temperatura en °C o NAN en caso de error
+     */
+    static double ntc10kTemperatureFromVoltage(float voltage);
 };
 
 #endif // NTC_MANAGER_H 
\ No newline at end of file
@@ -9,11 +9,25 @@
 // Variable externa
 extern MAX31865_RTD rtd;
 
+// Primera conversión del MAX31865 tras activar VBIAS y la conversión automática con filtro
+// de 50 Hz (ms); hasta entonces el registro RTD vale 0 con estado 0
+#define RTD_FIRST_CONVERSION_MS 65
+
 /**
  * @brief Clase para manejar el sensor de temperatura RTD (PT100)
  */
 class RTDSensor {
 public:
+    /**
+     * @brief Inicializa y configura el MAX31865 (tras encender su riel)
+     */
+    static void begin();
+
+    /**
+     * @brief true si ya pasó la primera conversión desde begin() (DRDY no está cableado)
+     */
+    static bool conversionReady();
+
     /**
      * @brief Lee la temperatura del sensor RTD (PT100)
      * 
@@ -0,0 +1,38 @@
+/*******************************************************************************************
+ * Archivo: include/util/airtime.h
+ * Descripción: Tiempo en el aire de una trama LoRa según la fórmula de Semtech (AN1200.13):
+ *              preámbulo de (n + 4,25) símbolos, cabecera explícita y CRC activado, con
+ *              optimización de baja tasa cuando el símbolo dura 16 ms o más.
+ *******************************************************************************************/
+
+#ifndef UTIL_AIRTIME_H
+#define UTIL_AIRTIME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Cabecera MAC de LoRaWAN sin FOpts: MHDR (1) + FHDR (7) + FPort (1) + MIC (4)
+#define AIRTIME_LORAWAN_OVERHEAD    13
+#define AIRTIME_PREAMBLE_SYMBOLS    8
+
+/**
+ * @brief Tiempo en el aire en microsegundos
+ * @param sf Factor de ensanchamiento (7..12)
+ * @param bandwidthHz Ancho de banda (125000, 250000 o 500000)
+ * @param crDenominator Denominador de la tasa de código (5 = 4/5 ... 8 = 4/8)
+ * @param phyLength Bytes de la trama física (payload de la aplicación + cabecera MAC)
+ */
+inline uint32_t loraAirtimeUs(uint8_t sf, uint32_t bandwidthHz, uint8_t crDenominator, size_t phyLength) {
+    uint32_t symbolUs = (uint32_t)(((uint64_t)1 << sf) * 1000000ULL / bandwidthHz);
+    bool lowDataRate = symbolUs >= 16000;
+
+    int32_t numerator = 8 * (int32_t)phyLength - 4 * sf + 28 + 16;
+    int32_t denominator = 4 * (sf - (lowDataRate ? 2 : 0));
+    int32_t blocks = numerator > 0 ? (numerator + denominator - 1) / denominator : 0;
+    uint32_t payloadSymbols = 8 + (uint32_t)blocks * crDenominator;
+
+    uint32_t preambleUs = (uint32_t)(((uint64_t)(AIRTIME_PREAMBLE_SYMBOLS * 4 + 17) * symbolUs) / 4);
+    return preambleUs + payloadSymbols * symbolUs;
+}
+
+#endif // UTIL_AIRTIME_H
@@ -0,0 +1,475 @@
+/*******************************************************************************************
+ * Archivo: include/util/batch_codec.h
+ * Descripción: Codificación columnar de lotes de lecturas para un solo uplink. Cada columna
+ *              (sensor o subvalor) lleva sus propios decimales, un valor base cuantizado y
+ *              las diferencias entre muestras consecutivas menos una pendiente fija de la
+ *              columna, en código Rice con el parámetro óptimo de la columna. Los timestamps
+ *              van como delta con signo y delta-of-delta.
+ *              Lógica pura (sin Arduino): el mismo archivo sirve de decodificador en el host.
+ *
+ *              Formato:
+ *                byte 0      versión (4 bits altos) | filas - 1 (4 bits bajos)
+ *                byte 1      columnas
+ *                bytes 2..5  timestamp de la primera fila (u32, little-endian)
+ *                bits (MSB primero):
+ *                  si filas >= 2: primer delta de tiempo zigzag (campo)
+ *                  si filas >= 3: serie Rice con los (filas - 2) delta-of-delta zigzag
+ *                  completo (1 bit): todas las columnas tienen valor en todas las filas
+ *                  por columna:
+ *                    salto de tag: EG2 de (tag - tag anterior - 1) mod 128
+ *                    decimales (2 bits) [+ máscara de filas presentes si no es completo]
+ *                    si hay al menos una muestra: EG0 zigzag de (ancho de la base - ancho
+ *                    de la base anterior) + base zigzag en ese ancho
+ *                    si hay dos o más: EG0 zigzag de la pendiente + serie Rice de las
+ *                    diferencias menos la pendiente, zigzag
+ *                campo = ancho (5 bits) + valor de ese ancho
+ *                EGk = gamma de Elias de (v >> k) + 1 y los k bits bajos
+ *                serie Rice = EG0 de k + por valor: (v >> k) unos, un cero y los k bits bajos
+ *              Los valores cuantizados deben estar en ±BATCH_CODEC_VALUE_LIMIT (ver
+ *              batchQuantize) y los saltos entre timestamps por debajo de ±2^30 s.
+ *******************************************************************************************/
+
+#ifndef UTIL_BATCH_CODEC_H
+#define UTIL_BATCH_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define BATCH_CODEC_VERSION         2
+#define BATCH_CODEC_MAX_ROWS        16
+#define BATCH_CODEC_MAX_COLUMNS     24
+#define BATCH_CODEC_MAX_DECIMALS    3
+#define BATCH_CODEC_HEADER_SIZE     6
+#define BATCH_CODEC_TAG_LIMIT       128
+#define BATCH_CODEC_TAG_ORDER       2           // Exp-Golomb de los saltos de tag (4 subvalores por posición)
+#define BATCH_CODEC_WIDTH_BITS      5
+#define BATCH_CODEC_BASE_WIDTH      9           // Ancho de referencia de la primera base
+#define BATCH_CODEC_MAX_WIDTH       31
+#define BATCH_CODEC_VALUE_LIMIT     (1L << 29)  // |valor cuantizado| < 2^29: deltas en 31 bits
+
+struct BatchColumn {
+    uint8_t tag;                            // Identificador de la columna (7 bits)
+    uint8_t decimals;                       // Valor real = valor / 10^decimals (0..3)
+    uint16_t presentMask;                   // Filas con valor (bit = fila)
+    int32_t values[BATCH_CODEC_MAX_ROWS];   // Valores cuantizados (válidos según la máscara)
+};
+
+struct BatchFrame {
+    uint8_t rows;
+    uint8_t columnCount;
+    uint32_t timestamps[BATCH_CODEC_MAX_ROWS];
+    BatchColumn columns[BATCH_CODEC_MAX_COLUMNS];
+};
+
+// -------------------------------------------------------------------------------------
+// Flujo de bits
+// -------------------------------------------------------------------------------------
+struct BatchBitStream {
+    uint8_t* data;
+    size_t size;                            // Bytes disponibles
+    size_t bitPos;
+    bool overflow;
+};
+
+inline uint32_t batchZigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+inline int32_t batchUnzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+inline uint8_t batchBitWidth(uint32_t value) {
+    uint8_t width = 0;
+    while (value) {
+        width++;
+        value >>= 1;
+    }
+    return width;
+}
+
+inline void batchWriteBits(BatchBitStream& stream, uint32_t value, uint8_t bits) {
+    while (bits > 0) {
+        bits--;
+        if (stream.bitPos >= stream.size * 8) {
+            stream.overflow = true;
+            return;
+        }
+        if ((value >> bits) & 1) {
+            stream.data[stream.bitPos >> 3] |= (uint8_t)(0x80 >> (stream.bitPos & 7));
+        }
+        stream.bitPos++;
+    }
+}
+
+inline uint32_t batchReadBits(BatchBitStream& stream, uint8_t bits) {
+    uint32_t value = 0;
+    while (bits > 0) {
+        bits--;
+        if (stream.bitPos >= stream.size * 8) {
+            stream.overflow = true;
+            return 0;
+        }
+        uint32_t bit = (stream.data[stream.bitPos >> 3] >> (7 - (stream.bitPos & 7))) & 1;
+        value |= bit << bits;
+        stream.bitPos++;
+    }
+    return value;
+}
+
+inline void batchWriteWidth(BatchBitStream& stream, uint8_t width) {
+    if (width > BATCH_CODEC_MAX_WIDTH) {
+        stream.overflow = true;     // Fuera del rango admitido por el formato
+        return;
+    }
+    batchWriteBits(stream, width, BATCH_CODEC_WIDTH_BITS);
+}
+
+inline void batchWriteField(BatchBitStream& stream, uint32_t value) {
+    uint8_t width = batchBitWidth(value);
+    batchWriteWidth(stream, width);
+    batchWriteBits(stream, value, width);
+}
+
+inline uint32_t batchReadField(BatchBitStream& stream) {
+    uint8_t width = (uint8_t)batchReadBits(stream, BATCH_CODEC_WIDTH_BITS);
+    return batchReadBits(stream, width);
+}
+
+/**
+ * @brief Código gamma de Elias (value >= 1): ancho - 1 ceros y el valor en su ancho
+ */
+inline void batchWriteGamma(BatchBitStream& stream, uint32_t value) {
+    uint8_t width = batchBitWidth(value);
+    if (width == 0) {
+        stream.overflow = true;     // El 0 no tiene código gamma
+        return;
+    }
+    batchWriteBits(stream, 0, width - 1);
+    batchWriteBits(stream, value, width);
+}
+
+inline uint32_t batchReadGamma(BatchBitStream& stream) {
+    uint8_t zeros = 0;
+    while (batchReadBits(stream, 1) == 0) {
+        if (stream.overflow || ++zeros > BATCH_CODEC_MAX_WIDTH) {
+            stream.overflow = true;
+            return 1;
+        }
+    }
+    return (1UL << zeros) | batchReadBits(stream, zeros);
+}
+
+/**
+ * @brief Código Exp-Golomb de orden k: gamma de (value >> k) + 1 y los k bits bajos
+ */
+inline void batchWriteExpGolomb(BatchBitStream& stream, uint32_t value, uint8_t k) {
+    batchWriteGamma(stream, (value >> k) + 1);
+    batchWriteBits(stream, value, k);
+}
+
+inline uint32_t batchReadExpGolomb(BatchBitStream& stream, uint8_t k) {
+    uint32_t high = batchReadGamma(stream) - 1;
+    return (high << k) | batchReadBits(stream, k);
+}
+
+inline uint8_t batchGammaBits(uint32_t value) {
+    return (uint8_t)(2 * batchBitWidth(value) - 1);
+}
+
+/**
+ * @brief Bits que ocupa una serie en código Rice con parámetro k
+ */
+inline uint64_t batchRiceCost(const uint32_t* values, uint8_t count, uint8_t k) {
+    uint64_t bits = batchGammaBits(k + 1);
+    for (uint8_t i = 0; i < count; i++) {
+        bits += (uint64_t)(values[i] >> k) + 1 + k;
+    }
+    return bits;
+}
+
+/**
+ * @brief Parámetro k que minimiza la serie (las diferencias pequeñas cuestan 1-2 bits)
+ */
+inline uint8_t batchRiceParameter(const uint32_t* values, uint8_t count, uint64_t* cost) {
+    uint8_t best = 0;
+    uint64_t bestCost = batchRiceCost(values, count, 0);
+    for (uint8_t k = 1; k <= BATCH_CODEC_MAX_WIDTH; k++) {
+        uint64_t bits = batchRiceCost(values, count, k);
+        if (bits < bestCost) {
+            best = k;
+            bestCost = bits;
+        }
+    }
+    if (cost) {
+        *cost = bestCost;
+    }
+    return best;
+}
+
+inline void batchWriteRiceSeries(BatchBitStream& stream, const uint32_t* values, uint8_t count) {
+    uint8_t k = batchRiceParameter(values, count, nullptr);
+    batchWriteGamma(stream, k + 1);
+    for (uint8_t i = 0; i < count && !stream.overflow; i++) {
+        for (uint32_t q = values[i] >> k; q > 0 && !stream.overflow; q--) {
+            batchWriteBits(stream, 1, 1);
+        }
+        batchWriteBits(stream, 0, 1);
+        batchWriteBits(stream, values[i], k);
+    }
+}
+
+inline uint8_t batchReadRiceParameter(BatchBitStream& stream) {
+    uint32_t k = batchReadGamma(stream) - 1;
+    if (k > BATCH_CODEC_MAX_WIDTH) {
+        stream.overflow = true;
+        return 0;
+    }
+    return (uint8_t)k;
+}
+
+inline uint32_t batchReadRice(BatchBitStream& stream, uint8_t k) {
+    uint32_t q = 0;
+    while (batchReadBits(stream, 1) == 1) {
+        q++;
+    }
+    return (q << k) | batchReadBits(stream, k);
+}
+
+/**
+ * @brief Cuantiza un valor real con los decimales de su columna
+ * @return false si el valor es NaN o queda fuera del rango del formato
+ */
+inline bool batchQuantize(float value, uint8_t decimals, int32_t& quantized) {
+    if (value != value) {
+        return false;
+    }
+    double scaled = value;
+    for (uint8_t i = 0; i < decimals; i++) {
+        scaled *= 10.0;
+    }
+    scaled += (scaled < 0) ? -0.5 : 0.5;
+    if (scaled <= -(double)BATCH_CODEC_VALUE_LIMIT || scaled >= (double)BATCH_CODEC_VALUE_LIMIT) {
+        return false;
+    }
+    quantized = (int32_t)scaled;
+    return true;
+}
+
+/**
+ * @brief Valor real de un valor cuantizado (lado del decodificador)
+ */
+inline double batchDequantize(int32_t quantized, uint8_t decimals) {
+    double value = quantized;
+    for (uint8_t i = 0; i < decimals; i++) {
+        value /= 10.0;
+    }
+    return value;
+}
+
+// -------------------------------------------------------------------------------------
+// Codificación y decodificación
+// -------------------------------------------------------------------------------------
+
+/**
+ * @brief Pendiente de una columna: media de las diferencias, redondeada
+ */
+inline int32_t batchSlope(int32_t first, int32_t last, uint8_t steps) {
+    int64_t span = (int64_t)last - first;
+    int64_t half = steps / 2;
+    return (int32_t)((span >= 0 ? span + half : span - half) / steps);
+}
+
+/**
+ * @brief Residuos zigzag de las diferencias frente a una pendiente y bits que ocupan
+ */
+inline uint64_t batchSlopeCost(const int32_t* deltas, uint8_t count, int32_t slope,
+                               uint32_t* residuals) {
+    for (uint8_t i = 0; i < count; i++) {
+        residuals[i] = batchZigzag(deltas[i] - slope);
+    }
+    uint64_t cost;
+    batchRiceParameter(residuals, count, &cost);
+    return cost + batchGammaBits(batchZigzag(slope) + 1);
+}
+
+/**
+ * @brief Codifica el lote completo
+ * @return Bytes escritos, o 0 si no cabe en el buffer o el lote no es válido
+ */
+inline size_t batchEncode(const BatchFrame& frame, uint8_t* out, size_t outSize) {
+    if (outSize < BATCH_CODEC_HEADER_SIZE || frame.rows == 0 ||
+        frame.rows > BATCH_CODEC_MAX_ROWS || frame.columnCount > BATCH_CODEC_MAX_COLUMNS) {
+        return 0;
+    }
+    memset(out, 0, outSize);
+    out[0] = (uint8_t)((BATCH_CODEC_VERSION << 4) | (frame.rows - 1));
+    out[1] = frame.columnCount;
+    uint32_t first = frame.timestamps[0];
+    for (uint8_t i = 0; i < 4; i++) {
+        out[2 + i] = (uint8_t)(first >> (8 * i));
+    }
+
+    BatchBitStream stream = { out + BATCH_CODEC_HEADER_SIZE, outSize - BATCH_CODEC_HEADER_SIZE, 0, false };
+    uint32_t series[BATCH_CODEC_MAX_ROWS];
+    uint32_t residuals[BATCH_CODEC_MAX_ROWS];
+
+    // Timestamps: primer delta con signo (el DS3231 puede retroceder al sincronizarse) y
+    // luego delta-of-delta, 0 con despertares en la rejilla de slots
+    if (frame.rows >= 2) {
+        batchWriteField(stream, batchZigzag((int32_t)(frame.timestamps[1] - frame.timestamps[0])));
+    }
+    if (frame.rows >= 3) {
+        for (uint8_t i = 2; i < frame.rows; i++) {
+            uint32_t delta = frame.timestamps[i] - frame.timestamps[i - 1];
+            uint32_t previous = frame.timestamps[i - 1] - frame.timestamps[i - 2];
+            series[i - 2] = batchZigzag((int32_t)(delta - previous));
+        }
+        batchWriteRiceSeries(stream, series, frame.rows - 2);
+    }
+
+    uint16_t allRows = (uint16_t)((1UL << frame.rows) - 1);
+    bool complete = true;
+    for (uint8_t c = 0; c < frame.columnCount; c++) {
+        complete = complete && (frame.columns[c].presentMask & allRows) == allRows;
+    }
+    batchWriteBits(stream, complete, 1);
+
+    uint8_t previousTag = BATCH_CODEC_TAG_LIMIT - 1;
+    uint8_t previousWidth = BATCH_CODEC_BASE_WIDTH;
+    for (uint8_t c = 0; c < frame.columnCount; c++) {
+        const BatchColumn& column = frame.columns[c];
+        if (column.tag >= BATCH_CODEC_TAG_LIMIT || column.decimals > BATCH_CODEC_MAX_DECIMALS) {
+            return 0;
+        }
+        uint16_t mask = column.presentMask & allRows;
+        batchWriteExpGolomb(stream, (column.tag - previousTag - 1) & (BATCH_CODEC_TAG_LIMIT - 1),
+                            BATCH_CODEC_TAG_ORDER);
+        previousTag = column.tag;
+        batchWriteBits(stream, column.decimals, 2);
+        if (!complete) {
+            batchWriteBits(stream, mask, frame.rows);
+        }
+
+        int32_t present[BATCH_CODEC_MAX_ROWS];
+        uint8_t count = 0;
+        for (uint8_t r = 0; r < frame.rows; r++) {
+            if (mask & (1u << r)) {
+                present[count++] = column.values[r];
+            }
+        }
+        if (count == 0) {
+            continue;
+        }
+
+        // Base con su ancho relativo al de la columna anterior (lecturas del mismo tipo
+        // tienen anchos parecidos)
+        uint32_t base = batchZigzag(present[0]);
+        uint8_t width = batchBitWidth(base);
+        batchWriteExpGolomb(stream, batchZigzag((int32_t)width - previousWidth), 0);
+        batchWriteBits(stream, base, width);
+        previousWidth = width;
+        if (count < 2) {
+            continue;
+        }
+
+        // Diferencias menos una pendiente fija (las tendencias lentas de temperatura o
+        // humedad quedan en residuos de 0 y ±1). Candidatas: 0, la media y cada diferencia
+        int32_t deltas[BATCH_CODEC_MAX_ROWS];
+        for (uint8_t i = 1; i < count; i++) {
+            deltas[i - 1] = present[i] - present[i - 1];
+        }
+        int32_t slope = 0;
+        uint64_t bestCost = batchSlopeCost(deltas, count - 1, 0, residuals);
+        for (uint8_t i = 0; i < count; i++) {
+            int32_t candidate = (i == 0) ? batchSlope(present[0], present[count - 1], count - 1)
+                                         : deltas[i - 1];
+            uint64_t cost = batchSlopeCost(deltas, count - 1, candidate, residuals);
+            if (cost < bestCost) {
+                slope = candidate;
+                bestCost = cost;
+            }
+        }
+        batchSlopeCost(deltas, count - 1, slope, residuals);
+        batchWriteExpGolomb(stream, batchZigzag(slope), 0);
+        batchWriteRiceSeries(stream, residuals, count - 1);
+    }
+
+    if (stream.overflow) {
+        return 0;
+    }
+    return BATCH_CODEC_HEADER_SIZE + (stream.bitPos + 7) / 8;
+}
+
+/**
+ * @brief Decodifica un lote generado por batchEncode()
+ * @return false si el buffer está truncado o la versión no es compatible
+ */
+inline bool batchDecode(const uint8_t* in, size_t length, BatchFrame& frame) {
+    if (length < BATCH_CODEC_HEADER_SIZE || (in[0] >> 4) != BATCH_CODEC_VERSION) {
+        return false;
+    }
+    memset(&frame, 0, sizeof(frame));
+    frame.rows = (uint8_t)((in[0] & 0x0F) + 1);
+    frame.columnCount = in[1];
+    if (frame.columnCount > BATCH_CODEC_MAX_COLUMNS) {
+        return false;
+    }
+    frame.timestamps[0] = (uint32_t)in[2] | ((uint32_t)in[3] << 8) |
+                          ((uint32_t)in[4] << 16) | ((uint32_t)in[5] << 24);
+
+    BatchBitStream stream = { (uint8_t*)in + BATCH_CODEC_HEADER_SIZE, length - BATCH_CODEC_HEADER_SIZE, 0, false };
+
+    if (frame.rows >= 2) {
+        frame.timestamps[1] = frame.timestamps[0] + (uint32_t)batchUnzigzag(batchReadField(stream));
+    }
+    if (frame.rows >= 3) {
+        uint8_t k = batchReadRiceParameter(stream);
+        for (uint8_t i = 2; i < frame.rows && !stream.overflow; i++) {
+            uint32_t previous = frame.timestamps[i - 1] - frame.timestamps[i - 2];
+            uint32_t delta = previous + (uint32_t)batchUnzigzag(batchReadRice(stream, k));
+            frame.timestamps[i] = frame.timestamps[i - 1] + delta;
+        }
+    }
+
+    uint16_t allRows = (uint16_t)((1UL << frame.rows) - 1);
+    bool complete = batchReadBits(stream, 1) != 0;
+    uint8_t previousTag = BATCH_CODEC_TAG_LIMIT - 1;
+    int32_t previousWidth = BATCH_CODEC_BASE_WIDTH;
+    for (uint8_t c = 0; c < frame.columnCount && !stream.overflow; c++) {
+        BatchColumn& column = frame.columns[c];
+        uint32_t gap = batchReadExpGolomb(stream, BATCH_CODEC_TAG_ORDER);
+        column.tag = (uint8_t)((previousTag + gap + 1) & (BATCH_CODEC_TAG_LIMIT - 1));
+        previousTag = column.tag;
+        column.decimals = (uint8_t)batchReadBits(stream, 2);
+        column.presentMask = complete ? allRows : (uint16_t)batchReadBits(stream, frame.rows);
+        if (!column.presentMask) {
+            continue;
+        }
+
+        int32_t width = previousWidth + batchUnzigzag(batchReadExpGolomb(stream, 0));
+        if (width < 0 || width > 32) {
+            return false;
+        }
+        previousWidth = width;
+        uint32_t value = (uint32_t)batchUnzigzag(batchReadBits(stream, (uint8_t)width));
+        bool single = (column.presentMask & (column.presentMask - 1)) == 0;
+        uint32_t slope = single ? 0 : (uint32_t)batchUnzigzag(batchReadExpGolomb(stream, 0));
+        uint8_t k = single ? 0 : batchReadRiceParameter(stream);
+        bool firstSample = true;
+        for (uint8_t r = 0; r < frame.rows && !stream.overflow; r++) {
+            if (!(column.presentMask & (1u << r))) {
+                continue;
+            }
+            if (!firstSample) {
+                value += slope + (uint32_t)batchUnzigzag(batchReadRice(stream, k));
+            }
+            column.values[r] = (int32_t)value;
+            firstSample = false;
+        }
+    }
+    return !stream.overflow;
+}
+
+#endif // UTIL_BATCH_CODEC_H
@@ -0,0 +1,144 @@
+/*******************************************************************************************
+ * Archivo: include/util/dual_predictor.h
+ * Descripción: Predictor compartido entre el dispositivo y el servidor (predicción dual).
+ *              Ambos lados alimentan el modelo solo con los valores transmitidos, en la
+ *              resolución del payload (milésimas, como formatFloatTo3Decimals) y con el
+ *              timestamp del uplink; la predicción usa aritmética entera, de modo que los
+ *              dos lados obtienen exactamente el mismo valor. El servidor rellena los ciclos
+ *              sin dato con dualPredict().
+ *              Lógica pura (sin Arduino): sirve de implementación de referencia en el host.
+ *******************************************************************************************/
+
+#ifndef UTIL_DUAL_PREDICTOR_H
+#define UTIL_DUAL_PREDICTOR_H
+
+#include <stdint.h>
+
+enum DualPredictorModel : uint8_t {
+    DUAL_PREDICT_HOLD = 0,      // Último valor transmitido
+    DUAL_PREDICT_LINEAR = 1     // Extrapolación lineal de los dos últimos valores transmitidos
+};
+
+struct DualPredictorState {
+    uint8_t count;              // Valores transmitidos conocidos (0..2)
+    uint32_t t0;                // Penúltimo valor transmitido
+    int32_t v0;
+    uint32_t t1;                // Último valor transmitido
+    int32_t v1;
+};
+
+inline void dualPredictorReset(DualPredictorState& state) {
+    state.count = 0;
+    state.t0 = state.t1 = 0;
+    state.v0 = state.v1 = 0;
+}
+
+/**
+ * @brief Convierte el texto de un valor del payload ("-12.5", "3.142") a milésimas.
+ *        Se trunca a 3 decimales, igual que el texto que se transmite.
+ * @return false si el texto no es un número (p.ej. "nan")
+ */
+inline bool dualPredictorParse(const char* text, int32_t& milli) {
+    bool negative = (*text == '-');
+    if (*text == '-' || *text == '+') {
+        text++;
+    }
+    if (*text < '0' || *text > '9') {
+        return false;
+    }
+    int64_t value = 0;
+    while (*text >= '0' && *text <= '9') {
+        value = value * 10 + (*text++ - '0');
+        if (value > INT32_MAX / 1000) {
+            return false;
+        }
+    }
+    int64_t fraction = 0;
+    uint8_t digits = 0;
+    if (*text == '.') {
+        text++;
+        while (*text >= '0' && *text <= '9') {
+            if (digits < 3) {
+                fraction = fraction * 10 + (*text - '0');
+                digits++;
+            }
+            text++;
+        }
+    }
+    if (*text != '\0') {
+        return false;
+    }
+    while (digits < 3) {
+        fraction *= 10;
+        digits++;
+    }
+    value = value * 1000 + fraction;
+    milli = (int32_t)(negative ? -value : value);
+    return true;
+}
+
+/**
+ * @brief Valor predicho para el instante t
+ * @return false si el modelo aún no tiene ningún valor transmitido
+ */
+inline bool dualPredict(const DualPredictorState& state, DualPredictorModel model, uint32_t t,
+                        int32_t& predicted) {
+    if (state.count == 0) {
+        return false;
+    }
+    predicted = state.v1;
+    if (model != DUAL_PREDICT_LINEAR || state.count < 2 || state.t1 <= state.t0) {
+        return true;
+    }
+    // v1 + pendiente * (t - t1), redondeando al entero más cercano (mitad hacia fuera)
+    int64_t numerator = (int64_t)((int64_t)state.v1 - state.v0) * (int64_t)((int64_t)t - state.t1);
+    int64_t denominator = (int64_t)state.t1 - state.t0;
+    int64_t half = denominator / 2;
+    int64_t step = (numerator >= 0) ? (numerator + half) / denominator
+                                    : (numerator - half) / denominator;
+    int64_t value = state.v1 + step;
+    if (value > INT32_MAX) value = INT32_MAX;
+    if (value < INT32_MIN) value = INT32_MIN;
+    predicted = (int32_t)value;
+    return true;
+}
+
+/**
+ * @brief Incorpora un valor transmitido (los dos lados, con el mismo t y valor)
+ */
+inline void dualPredictorUpdate(DualPredictorState& state, uint32_t t, int32_t milli) {
+    if (state.count > 0 && t == state.t1) {
+        state.v1 = milli;   // Mismo instante: se sustituye, la pendiente no admite dt = 0
+        return;
+    }
+    state.t0 = state.t1;
+    state.v0 = state.v1;
+    state.t1 = t;
+    state.v1 = milli;
+    if (state.count < 2) {
+        state.count++;
+    }
+}
+
+/**
+ * @brief true si el valor debe transmitirse: sin modelo, error mayor que la tolerancia o
+ *        silencio de al menos maxSilence segundos (0 = sin límite)
+ */
+inline bool dualPredictorMispredicts(const DualPredictorState& state, DualPredictorModel model,
+                                     uint32_t t, int32_t milli, int32_t toleranceMilli,
+                                     uint32_t maxSilence) {
+    int32_t predicted;
+    if (!dualPredict(state, model, t, predicted)) {
+        return true;
+    }
+    if (maxSilence != 0 && t - state.t1 >= maxSilence) {
+        return true;
+    }
+    int64_t error = (int64_t)milli - predicted;
+    if (error < 0) {
+        error = -error;
+    }
+    return error > toleranceMilli;
+}
+
+#endif // UTIL_DUAL_PREDICTOR_H
@@ -0,0 +1,29 @@
+/*******************************************************************************************
+ * Archivo: include/util/fnv1a.h
+ * Descripción: Hash FNV-1a de 32 bits para identificar canales por su sensorId en los
+ *              estados guardados en memoria RTC.
+ *******************************************************************************************/
+
+#ifndef UTIL_FNV1A_H
+#define UTIL_FNV1A_H
+
+#include <stdint.h>
+
+#define FNV1A_OFFSET_BASIS  2166136261UL
+#define FNV1A_PRIME         16777619UL
+
+inline uint32_t fnv1a32(const char* text, uint32_t hash = FNV1A_OFFSET_BASIS) {
+    while (*text) {
+        hash = (hash ^ (uint8_t)*text++) * FNV1A_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief Mezcla un byte adicional (p.ej. el índice de subvalor) en el hash
+ */
+inline uint32_t fnv1a32Byte(uint32_t hash, uint8_t value) {
+    return (hash ^ value) * FNV1A_PRIME;
+}
+
+#endif // UTIL_FNV1A_H
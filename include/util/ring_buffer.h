@@ -0,0 +1,65 @@
+/*******************************************************************************************
+ * Archivo: include/util/ring_buffer.h
+ * Descripción: Buffer circular de capacidad fija, sin memoria dinámica.
+ *              Un único productor y un único consumidor.
+ *******************************************************************************************/
+
+#ifndef UTIL_RING_BUFFER_H
+#define UTIL_RING_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+template <typename T, size_t N>
+class RingBuffer {
+public:
+    RingBuffer() : _head(0), _tail(0), _count(0), _overflows(0) {}
+
+    /**
+     * @brief Inserta un elemento. Si el buffer está lleno se descarta el más antiguo.
+     * @return false si hubo que descartar un elemento
+     */
+    bool push(const T& item) {
+        bool overwrote = false;
+        if (_count == N) {
+            _tail = (_tail + 1) % N;
+            _count--;
+            _overflows++;
+            overwrote = true;
+        }
+        _items[_head] = item;
+        _head = (_head + 1) % N;
+        _count++;
+        return !overwrote;
+    }
+
+    /**
+     * @brief Extrae el elemento más antiguo
+     * @return false si el buffer está vacío
+     */
+    bool pop(T& item) {
+        if (_count == 0) {
+            return false;
+        }
+        item = _items[_tail];
+        _tail = (_tail + 1) % N;
+        _count--;
+        return true;
+    }
+
+    void clear() { _head = _tail = _count = 0; }
+    size_t size() const { return _count; }
+    bool empty() const { return _count == 0; }
+    bool full() const { return _count == N; }
+    static size_t capacity() { return N; }
+    uint32_t overflows() const { return _overflows; }
+
+private:
+    T _items[N];
+    size_t _head;
+    size_t _tail;
+    size_t _count;
+    uint32_t _overflows;
+};
+
+#endif // UTIL_RING_BUFFER_H
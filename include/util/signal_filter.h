@@ -0,0 +1,112 @@
+/*******************************************************************************************
+ * Archivo: include/util/signal_filter.h
+ * Descripción: Filtros escalares de un canal (EMA, mediana deslizante y Kalman 1-D). El
+ *              estado es una estructura plana de tamaño fijo para poder guardarla en memoria
+ *              RTC; la lógica es pura (sin Arduino) para compilarla en el host.
+ *******************************************************************************************/
+
+#ifndef UTIL_SIGNAL_FILTER_H
+#define UTIL_SIGNAL_FILTER_H
+
+#include <stdint.h>
+
+#define SIGNAL_FILTER_MEDIAN_MAX    7
+
+/**
+ * @brief Tipo de filtro de un canal
+ */
+enum SignalFilterKind : uint8_t {
+    SIGNAL_FILTER_NONE = 0,
+    SIGNAL_FILTER_EMA,          // Media móvil exponencial
+    SIGNAL_FILTER_MEDIAN,       // Mediana de las últimas N muestras (rechaza picos)
+    SIGNAL_FILTER_KALMAN        // Kalman 1-D con modelo de nivel constante
+};
+
+/**
+ * @brief Parámetros comunes (se ignoran los que no usa el filtro)
+ */
+struct SignalFilterParams {
+    float emaAlpha;
+    uint8_t medianWindow;
+    float kalmanQ;
+    float kalmanR;
+};
+
+struct SignalFilterState {
+    uint8_t count;              // Muestras acumuladas (satura en 255)
+    uint8_t head;               // Posición de escritura de la mediana
+    float estimate;             // EMA / estimación de Kalman
+    float variance;             // Covarianza del error de Kalman
+    float window[SIGNAL_FILTER_MEDIAN_MAX];
+};
+
+inline void signalFilterReset(SignalFilterState& state) {
+    state.count = 0;
+    state.head = 0;
+    state.estimate = 0.0f;
+    state.variance = 0.0f;
+}
+
+/**
+ * @brief Incorpora una muestra y devuelve el valor filtrado. La primera muestra se
+ *        devuelve tal cual e inicializa el estado.
+ */
+inline float signalFilterUpdate(SignalFilterState& state, SignalFilterKind kind,
+                                const SignalFilterParams& params, float sample) {
+    bool first = (state.count == 0);
+    if (state.count < 255) {
+        state.count++;
+    }
+
+    switch (kind) {
+        case SIGNAL_FILTER_EMA:
+            state.estimate = first ? sample : state.estimate + params.emaAlpha * (sample - state.estimate);
+            return state.estimate;
+
+        case SIGNAL_FILTER_MEDIAN: {
+            uint8_t window = params.medianWindow;
+            if (window < 1) {
+                window = 1;
+            } else if (window > SIGNAL_FILTER_MEDIAN_MAX) {
+                window = SIGNAL_FILTER_MEDIAN_MAX;
+            }
+            if (state.head >= window) {
+                state.head = 0;
+            }
+            state.window[state.head] = sample;
+            state.head = (uint8_t)((state.head + 1) % window);
+
+            // Ordenar una copia de las muestras disponibles (inserción, N <= 7)
+            uint8_t n = (state.count < window) ? state.count : window;
+            float sorted[SIGNAL_FILTER_MEDIAN_MAX];
+            for (uint8_t i = 0; i < n; i++) {
+                float v = state.window[i];
+                uint8_t j = i;
+                while (j > 0 && sorted[j - 1] > v) {
+                    sorted[j] = sorted[j - 1];
+                    j--;
+                }
+                sorted[j] = v;
+            }
+            return (n % 2) ? sorted[n / 2] : 0.5f * (sorted[n / 2 - 1] + sorted[n / 2]);
+        }
+
+        case SIGNAL_FILTER_KALMAN: {
+            if (first) {
+                state.estimate = sample;
+                state.variance = params.kalmanR;
+                return sample;
+            }
+            float predicted = state.variance + params.kalmanQ;
+            float gain = predicted / (predicted + params.kalmanR);
+            state.estimate += gain * (sample - state.estimate);
+            state.variance = (1.0f - gain) * predicted;
+            return state.estimate;
+        }
+
+        default:
+            return sample;
+    }
+}
+
+#endif // UTIL_SIGNAL_FILTER_H
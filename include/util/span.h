@@ -0,0 +1,38 @@
+/*******************************************************************************************
+ * Archivo: include/util/span.h
+ * Descripción: Vista no propietaria sobre un arreglo contiguo (puntero + longitud).
+ *              Sustituye a std::span, que no está disponible con gnu++11.
+ *******************************************************************************************/
+
+#ifndef UTIL_SPAN_H
+#define UTIL_SPAN_H
+
+#include <stddef.h>
+
+template <typename T>
+class Span {
+public:
+    Span() : _data(nullptr), _size(0) {}
+    Span(T* data, size_t size) : _data(data), _size(size) {}
+
+    template <size_t N>
+    Span(T (&array)[N]) : _data(array), _size(N) {}
+
+    // Conversión implícita de Span<U> a Span<const U>
+    template <typename U>
+    Span(const Span<U>& other) : _data(other.data()), _size(other.size()) {}
+
+    T* data() const { return _data; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    T* begin() const { return _data; }
+    T* end() const { return _data + _size; }
+    T& operator[](size_t index) const { return _data[index]; }
+
+private:
+    T* _data;
+    size_t _size;
+};
+
+#endif // UTIL_SPAN_H
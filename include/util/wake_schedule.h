@@ -0,0 +1,119 @@
+/*******************************************************************************************
+ * Archivo: include/util/wake_schedule.h
+ * Descripción: Planificación multi-tasa residente en memoria RTC. Cada despertar del
+ *              temporizador es un "tick"; cada tarea se ejecuta cada periodTicks ticks con
+ *              un desfase phaseTicks. La decisión es lógica pura (sin Arduino ni ESP-IDF)
+ *              para poder usarla desde el wake stub y compilarla en el host.
+ *
+ *              Las funciones se fuerzan inline: el wake stub solo puede ejecutar código
+ *              que esté en memoria RTC.
+ *******************************************************************************************/
+
+#ifndef UTIL_WAKE_SCHEDULE_H
+#define UTIL_WAKE_SCHEDULE_H
+
+#include <stdint.h>
+
+#define WAKE_SCHEDULE_MAX_TASKS     4
+#define WAKE_SCHEDULE_INLINE        static inline __attribute__((always_inline))
+
+/**
+ * @brief Tipo de trabajo de una tarea
+ */
+enum WakeTaskKind : uint8_t {
+    WAKE_TASK_SAMPLE = 0,       // Leer sensores sin transmitir
+    WAKE_TASK_REPORT = 1        // Leer sensores y transmitir
+};
+
+/**
+ * @brief Decisión para un tick (ordenadas de menor a mayor trabajo)
+ */
+enum WakeDecision : uint8_t {
+    WAKE_DECISION_IDLE = 0,     // Nada pendiente: volver a dormir desde el stub
+    WAKE_DECISION_SAMPLE,       // Arranque completo, solo muestreo
+    WAKE_DECISION_REPORT        // Arranque completo, muestreo y envío
+};
+
+struct WakeTask {
+    uint16_t periodTicks;       // 0 = tarea deshabilitada
+    uint16_t phaseTicks;
+    uint8_t kind;               // WakeTaskKind
+};
+
+struct WakeSchedule {
+    uint32_t tick;              // Ticks transcurridos desde el arranque en frío
+    uint8_t taskCount;
+    WakeTask tasks[WAKE_SCHEDULE_MAX_TASKS];
+    uint8_t dueMask;            // Tareas pendientes en el último tick evaluado (bit = índice)
+};
+
+/**
+ * @brief Reinicia la planificación (tick 0) con la tabla de tareas indicada
+ */
+WAKE_SCHEDULE_INLINE void wakeScheduleInit(WakeSchedule* schedule, const WakeTask* tasks, uint8_t count) {
+    if (count > WAKE_SCHEDULE_MAX_TASKS) {
+        count = WAKE_SCHEDULE_MAX_TASKS;
+    }
+    schedule->tick = 0;
+    schedule->taskCount = count;
+    schedule->dueMask = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        schedule->tasks[i] = tasks[i];
+    }
+}
+
+/**
+ * @brief Evalúa qué tareas tocan en un tick sin modificar la planificación
+ * @param dueMask Salida: máscara de tareas pendientes (puede ser nullptr)
+ */
+WAKE_SCHEDULE_INLINE WakeDecision wakeScheduleEvaluate(const WakeSchedule* schedule, uint32_t tick,
+                                                       uint8_t* dueMask) {
+    uint8_t mask = 0;
+    WakeDecision decision = WAKE_DECISION_IDLE;
+    uint8_t count = schedule->taskCount;
+    if (count > WAKE_SCHEDULE_MAX_TASKS) {
+        count = WAKE_SCHEDULE_MAX_TASKS;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        const WakeTask& task = schedule->tasks[i];
+        if (task.periodTicks == 0 || (tick % task.periodTicks) != (uint32_t)(task.phaseTicks % task.periodTicks)) {
+            continue;
+        }
+        mask |= (uint8_t)(1u << i);
+        WakeDecision taskDecision = (task.kind == WAKE_TASK_REPORT) ? WAKE_DECISION_REPORT
+                                                                   : WAKE_DECISION_SAMPLE;
+        if (taskDecision > decision) {
+            decision = taskDecision;
+        }
+    }
+    if (dueMask) {
+        *dueMask = mask;
+    }
+    return decision;
+}
+
+/**
+ * @brief Avanza un tick y decide si hace falta un arranque completo
+ */
+WAKE_SCHEDULE_INLINE WakeDecision wakeScheduleAdvance(WakeSchedule* schedule) {
+    schedule->tick++;
+    return wakeScheduleEvaluate(schedule, schedule->tick, &schedule->dueMask);
+}
+
+/**
+ * @brief Siguiente despertar de un tick sin trabajo, en ticks absolutos del reloj lento.
+ *        Se cuenta desde el despertar previsto (no desde el real) para no perder la
+ *        alineación con los slots; si ese instante ya pasó, se reancla en 'now'.
+ * @param scheduled Despertar previsto del tick actual (0 = desconocido)
+ * @param period Duración de un tick
+ * @param now Tiempo actual del reloj lento
+ */
+WAKE_SCHEDULE_INLINE uint64_t wakeScheduleNextWake(uint64_t scheduled, uint64_t period, uint64_t now) {
+    uint64_t next = scheduled + period;
+    if (scheduled == 0 || next <= now) {
+        next = now + period;
+    }
+    return next;
+}
+
+#endif // UTIL_WAKE_SCHEDULE_H
@@ -0,0 +1,55 @@
+/*******************************************************************************************
+ * Archivo: include/util/welford.h
+ * Descripción: Acumulador de Welford para media y varianza en una sola pasada, numéricamente
+ *              estable, junto con mínimo y máximo. Estructura plana para memoria RTC.
+ *******************************************************************************************/
+
+#ifndef UTIL_WELFORD_H
+#define UTIL_WELFORD_H
+
+#include <stdint.h>
+#include <math.h>
+
+struct WelfordAccumulator {
+    uint16_t count;
+    float min;
+    float max;
+    float mean;
+    float m2;                   // Suma de cuadrados de las desviaciones respecto a la media
+};
+
+inline void welfordReset(WelfordAccumulator& acc) {
+    acc.count = 0;
+    acc.min = 0.0f;
+    acc.max = 0.0f;
+    acc.mean = 0.0f;
+    acc.m2 = 0.0f;
+}
+
+inline void welfordAdd(WelfordAccumulator& acc, float sample) {
+    if (acc.count == 0) {
+        acc.min = sample;
+        acc.max = sample;
+    } else {
+        if (sample < acc.min) acc.min = sample;
+        if (sample > acc.max) acc.max = sample;
+    }
+    if (acc.count < UINT16_MAX) {
+        acc.count++;
+    }
+    float delta = sample - acc.mean;
+    acc.mean += delta / acc.count;
+    acc.m2 += delta * (sample - acc.mean);
+}
+
+/**
+ * @brief Desviación estándar muestral (0 con menos de dos muestras)
+ */
+inline float welfordStddev(const WelfordAccumulator& acc) {
+    if (acc.count < 2 || acc.m2 <= 0.0f) {
+        return 0.0f;
+    }
+    return sqrtf(acc.m2 / (acc.count - 1));
+}
+
+#endif // UTIL_WELFORD_H
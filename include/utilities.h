@@ -6,6 +6,15 @@
 void parseKeyString(const String &keyStr, uint8_t *outArray, size_t expectedSize);
 bool parseEUIString(const char* euiStr, uint64_t* eui);
 
+/**
+ * @brief Formatea bytes como "xx,xx,..." (formato de EUIs y claves en la interfaz BLE).
+ * @param bytes Bytes a formatear.
+ * @param len Número de bytes.
+ * @param buffer Buffer de salida (al menos 3 * len caracteres).
+ * @param bufferSize Tamaño del buffer.
+ */
+void formatKeyString(const uint8_t* bytes, size_t len, char* buffer, size_t bufferSize);
+
 /**
  * @brief Formatea un valor flotante con hasta 3 decimales, eliminando ceros finales.
  * @param value Valor flotante a formatear.
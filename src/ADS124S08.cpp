@@ -32,6 +32,7 @@
 
 #include "ADS124S08.h"
 #include "debug.h"
+#include "util/crc8.h"
 
 #ifdef DEVICE_TYPE_ANALOGIC
 
@@ -45,34 +46,47 @@
  */
 
 /*
- * Writes the nCS pin low and waits a while for the device to finish working before
+ * Takes the shared SPI bus and writes the nCS pin low (via SpiBusManager) before
  * handing control back to the caller for a SPI transfer.
+ * Returns false (CS left high) if the bus could not be taken; the caller must not transfer.
  */
-void ADS124S08::selectDeviceCSLow(void){
-	if (_initialized) {
-		_ioExpander->digitalWrite(ADS124S08_CS_PIN, LOW);
+bool ADS124S08::selectDeviceCSLow(void){
+	if (!_initialized) return false;
+	if (!_busHeld) {
+		if (!SpiBusManager::beginTransaction(_spiDevice)) {
+			return false;
+		}
+		_busHeld = true;
+		SpiBusManager::select(_spiDevice);
 	}
+	return true;
 }
 
 /*
- * Pulls the nCS pin high. Performs no waiting.
+ * Pulls the nCS pin high and releases the shared SPI bus. Performs no waiting.
  */
 void ADS124S08::releaseChipSelect(void){
-	if (_initialized) {
-		_ioExpander->digitalWrite(ADS124S08_CS_PIN, HIGH);
+	if (_initialized && _busHeld) {
+		SpiBusManager::deselect(_spiDevice);
+		SpiBusManager::endTransaction(_spiDevice);
+		_busHeld = false;
 	}
 }
 
 /*
  * Constructor - solo almacena referencias a los objetos pasados
  */
-ADS124S08::ADS124S08(PCA9555& ioExpander, SPIClass& spi, SPISettings& spiSettings)
+ADS124S08::ADS124S08(PCA9555& ioExpander, SpiDeviceHandle spiDevice)
 {
 	_ioExpander = &ioExpander;
-	_spi = &spi;
-	_spiSettings = spiSettings;
+	_spiDevice = spiDevice;
+	_busHeld = false;
 	_initialized = false;
 	fStart = false;
+	_drdyTimeoutMs = 100;
+	_streaming = false;
+	_streamMux = 0;
+	memset(_channelErrors, 0, sizeof(_channelErrors));
 }
 
 /*
@@ -134,10 +148,6 @@ void ADS124S08::begin()
 	
 	// Resetear el ADC antes de comenzar
 	ADS124S08_Reset();
-	
-	_spi->begin();
-	_spi->beginTransaction(_spiSettings);
-	_spi->endTransaction();
 }
 
 /*
@@ -156,17 +166,13 @@ char ADS124S08::regRead(unsigned int regnum)
 	ulDataTx[0] = REGRD_OPCODE_MASK + (regnum & 0x1f);
 	ulDataTx[1] = 0x00;
 	ulDataTx[2] = 0x00;
-	selectDeviceCSLow();
-
-	_spi->beginTransaction(_spiSettings);
+	if (!selectDeviceCSLow()) return 0;
 
 	for(i = 0; i < 3; i++)
-		ulDataRx[i] = _spi->transfer(ulDataTx[i]);
+		ulDataRx[i] = SpiBusManager::transfer(ulDataTx[i]);
 	if(regnum < NUM_REGISTERS)
 			registers[regnum] = ulDataRx[2];
 
-	_spi->endTransaction();
-
 	releaseChipSelect();
 	return ulDataRx[2];
 }
@@ -187,21 +193,17 @@ void ADS124S08::readRegs(unsigned int regnum, unsigned int count, uint8_t *data)
 	uint8_t ulDataTx[2];
 	ulDataTx[0] = REGRD_OPCODE_MASK + (regnum & 0x1f);
 	ulDataTx[1] = count-1;
-	selectDeviceCSLow();
+	if (!selectDeviceCSLow()) return;
 
-	_spi->beginTransaction(_spiSettings);
-	
-	_spi->transfer(ulDataTx[0]);
-	_spi->transfer(ulDataTx[1]);
+	SpiBusManager::transfer(ulDataTx[0]);
+	SpiBusManager::transfer(ulDataTx[1]);
 	for(i = 0; i < count; i++)
 	{
-		data[i] = _spi->transfer(0);
+		data[i] = SpiBusManager::transfer(0);
 		if(regnum+i < NUM_REGISTERS)
 			registers[regnum+i] = data[i];
 	}
 	
-	_spi->endTransaction();
-	
 	releaseChipSelect();
 }
 
@@ -220,15 +222,13 @@ void ADS124S08::regWrite(unsigned int regnum, unsigned char data)
 	ulDataTx[0] = REGWR_OPCODE_MASK + (regnum & 0x1f);
 	ulDataTx[1] = 0x00;
 	ulDataTx[2] = data;
-	selectDeviceCSLow();
-	
-	_spi->beginTransaction(_spiSettings);
+	if (!selectDeviceCSLow()) return;
 	
-	_spi->transfer(ulDataTx[0]);
-	_spi->transfer(ulDataTx[1]);
-	_spi->transfer(ulDataTx[2]);
-	
-	_spi->endTransaction();
+	SpiBusManager::transfer(ulDataTx[0]);
+	SpiBusManager::transfer(ulDataTx[1]);
+	SpiBusManager::transfer(ulDataTx[2]);
+	if(regnum < NUM_REGISTERS)
+		registers[regnum] = data;
 	
 	releaseChipSelect();
 	return;
@@ -250,21 +250,17 @@ void ADS124S08::writeRegs(unsigned int regnum, unsigned int howmuch, unsigned ch
 	uint8_t ulDataTx[2];
 	ulDataTx[0] = REGWR_OPCODE_MASK + (regnum & 0x1f);
 	ulDataTx[1] = howmuch-1;
-	selectDeviceCSLow();
+	if (!selectDeviceCSLow()) return;
 	
-	_spi->beginTransaction(_spiSettings);
-	
-	_spi->transfer(ulDataTx[0]);
-	_spi->transfer(ulDataTx[1]);
+	SpiBusManager::transfer(ulDataTx[0]);
+	SpiBusManager::transfer(ulDataTx[1]);
 	for(i=0; i < howmuch; i++)
 	{
-		_spi->transfer(data[i]);
+		SpiBusManager::transfer(data[i]);
 		if(regnum+i < NUM_REGISTERS)
 			registers[regnum+i] = data[i];
 	}
 	
-	_spi->endTransaction();
-	
 	releaseChipSelect();
 	return;
 }
@@ -279,11 +275,9 @@ void ADS124S08::sendCommand(uint8_t op_code)
 {
 	if (!_initialized) return;
 	
-	selectDeviceCSLow();
+	if (!selectDeviceCSLow()) return;
 	
-	_spi->beginTransaction(_spiSettings);
-	_spi->transfer(op_code);
-	_spi->endTransaction();
+	SpiBusManager::transfer(op_code);
 
 	releaseChipSelect();
 	return;
@@ -327,67 +321,235 @@ void ADS124S08::deassertStart()
 }
 
 /*
- * Reads data using the RDATA command
- * Espera a que el pin DRDY esté en LOW (activo bajo) para indicar que los datos están listos
- * antes de enviar el comando RDATA y leer los datos del ADC.
+ * Ajusta el tiempo máximo de espera de DRDY en rData/dataRead.
+ * Debe cubrir la latencia de la primera conversión al data rate configurado.
+ *
  */
-int ADS124S08::rData(uint8_t *dStatus, uint8_t *dData, uint8_t *dCRC)
+void ADS124S08::setDataReadyTimeout(uint32_t timeoutMs)
 {
-	if (!_initialized) return -1;
-	
-	// Esperar a que el pin DRDY esté en LOW (datos disponibles)
-	// DRDY es activo bajo, por lo que cuando está en LOW, los datos están listos
-	uint32_t timeout = millis() + 100; // Timeout de 100 ms
+	_drdyTimeoutMs = timeoutMs;
+}
+
+/*
+ * Espera a que el pin DRDY esté en LOW (activo bajo) indicando que hay datos listos.
+ * Devuelve false si se supera el timeout configurado.
+ *
+ */
+bool ADS124S08::waitDataReady(void)
+{
+	uint32_t timeout = millis() + _drdyTimeoutMs;
 	while (_ioExpander->digitalRead(ADS124S08_DRDY_PIN) == HIGH) {
-		// Si se supera el timeout, retornar error
 		if (millis() > timeout) {
-			return -1;
+			return false;
 		}
-		delayMicroseconds(100); // Pequeña pausa para no saturar el CPU
+		delayMicroseconds(100); // Pequeña pausa para no saturar el bus I2C
 	}
-	
-	int result = -1;
-	selectDeviceCSLow();
+	return true;
+}
 
-	_spi->beginTransaction(_spiSettings);
+/*
+ * Longitud en bytes de una trama de conversión: [STATUS] + DATA + [CRC]
+ *
+ */
+uint8_t ADS124S08::frameLength(void) const
+{
+	uint8_t len = DATA_LENGTH;
+	if (registers[SYS_ADDR_MASK] & DATA_MODE_STATUS) len += STATUS_LENGTH;
+	if (registers[SYS_ADDR_MASK] & DATA_MODE_CRC) len += CRC_LENGTH;
+	return len;
+}
 
-	// according to datasheet chapter 9.5.4.2 Read Data by RDATA Command
-	sendCommand(RDATA_OPCODE_MASK);
+/*
+ * Inicia el modo streaming: configura el MUX, deja CS en bajo durante toda la ráfaga
+ * y arranca la conversión continua con el pin START (el bit MODE de DATARATE debe
+ * estar en conversión continua). CS y DRDY están en el PCA9555, así que sostener CS
+ * evita dos escrituras I2C por muestra.
+ *
+ * Mientras dure el streaming no debe usarse ningún otro dispositivo del bus SPI.
+ *
+ */
+void ADS124S08::startStreaming(uint8_t muxConfig)
+{
+	if (!_initialized || _streaming) return;
 
-	// if the Status byte is set - grab it
-	uint8_t shouldWeReceiveTheStatusByte = (registers[SYS_ADDR_MASK] & 0x01) == DATA_MODE_STATUS;
-	if(shouldWeReceiveTheStatusByte)
-	{
-		dStatus[0] = _spi->transfer(0x00);
-	}
+	regWrite(INPMUX_ADDR_MASK, muxConfig);
+	_streamMux = muxConfig;
+	_stream.clear();
 
-	// get the conversion data (3 bytes)
-	uint8_t data[3];
-	data[0] = _spi->transfer(0x00);
-	data[1] = _spi->transfer(0x00);
-	data[2] = _spi->transfer(0x00);
-	
-	// Armar el entero de 24 bits con extensión de signo
-	uint32_t raw = ((uint32_t)data[0] << 16) | ((uint32_t)data[1] << 8) | data[2];
-	
-	// Extender el signo si el bit 23 es 1
-	if (raw & 0x800000) {
-		raw |= 0xFF000000;  // Extensión de signo
+	if (!selectDeviceCSLow()) return;
+	assertStart();
+	_streaming = true;
+}
+
+/*
+ * Captura hasta maxFrames conversiones en el buffer circular. Cada trama
+ * [status][data][crc] se lee con una única transferencia en bloque tras DRDY y se
+ * valida; una trama corrupta se vuelve a leer con RDATA antes de descartarla.
+ * Devuelve el número de tramas válidas capturadas (menor que maxFrames si expira DRDY).
+ *
+ */
+uint8_t ADS124S08::pollStream(uint8_t maxFrames)
+{
+	if (!_streaming) return 0;
+
+	uint8_t captured = 0;
+	uint8_t attempts = 0;
+
+	while (captured < maxFrames && attempts < maxFrames + ADS_FRAME_MAX_RETRIES) {
+		if (!waitDataReady()) {
+			break;
+		}
+		attempts++;
+
+		// Una trama descartada se sustituye por la siguiente conversión (acotado por attempts)
+		ADS124S08Sample sample;
+		if (!readValidatedFrame(sample, _streamMux, false)) {
+			continue;
+		}
+
+		if (!_stream.push(sample)) {
+			DEBUG_PRINTLN("ADS124S08: buffer de streaming lleno, se descartó la muestra más antigua");
+		}
+		captured++;
 	}
-	
-	result = (int)raw;
+	return captured;
+}
 
-	// is CRC enabled?
-	uint8_t isCrcEnabled = (registers[SYS_ADDR_MASK] & 0x02) == DATA_MODE_CRC;
-	if(isCrcEnabled)
-	{
-		dCRC[0] = _spi->transfer(0x00);
+/*
+ * Detiene la conversión continua (START en bajo) y libera CS.
+ * Las muestras ya capturadas siguen disponibles en el buffer.
+ *
+ */
+void ADS124S08::stopStreaming(void)
+{
+	if (!_streaming) return;
+
+	deassertStart();
+	releaseChipSelect();
+	_streaming = false;
+}
+
+/*
+ * Extrae la muestra más antigua del buffer de streaming
+ *
+ */
+bool ADS124S08::readSample(ADS124S08Sample &sample)
+{
+	return _stream.pop(sample);
+}
+
+size_t ADS124S08::samplesAvailable(void) const
+{
+	return _stream.size();
+}
+
+bool ADS124S08::isStreaming(void) const
+{
+	return _streaming;
+}
+
+/*
+ * Lee una trama de conversión con CS ya en bajo y la valida (bit nRDY del STATUS y CRC-8).
+ * Si falla, vuelve a leer la misma conversión con RDATA (el buffer de salida conserva el
+ * último resultado) hasta ADS_FRAME_MAX_RETRIES veces. Actualiza los contadores del canal.
+ *
+ * \param sample muestra de salida
+ * \param mux INPMUX con el que se tomó la conversión (para los contadores por canal)
+ * \param useRdata true para leer con el comando RDATA desde el primer intento
+ *
+ */
+bool ADS124S08::readValidatedFrame(ADS124S08Sample &sample, uint8_t mux, bool useRdata)
+{
+	const uint8_t sys = registers[SYS_ADDR_MASK];
+	const bool hasStatus = (sys & DATA_MODE_STATUS) != 0;
+	const bool hasCrc = (sys & DATA_MODE_CRC) != 0;
+	const uint8_t len = frameLength();
+	ADS124S08ChannelErrors &errors = _channelErrors[(mux >> 4) & 0x0F];
+
+	for (uint8_t attempt = 0; attempt <= ADS_FRAME_MAX_RETRIES; attempt++) {
+		uint8_t frame[STATUS_LENGTH + DATA_LENGTH + CRC_LENGTH] = {0};
+
+		if (useRdata || attempt > 0) {
+			// according to datasheet chapter 9.5.4.2 Read Data by RDATA Command
+			SpiBusManager::transfer(RDATA_OPCODE_MASK);
+		}
+		SpiBusManager::transfer(frame, frame, len);
+
+		uint8_t idx = 0;
+		sample.status = hasStatus ? frame[idx++] : 0;
+		const uint8_t *data = &frame[idx];
+		idx += DATA_LENGTH;
+		sample.crc = hasCrc ? frame[idx] : 0;
+		sample.mux = mux;
+
+		uint32_t raw = ((uint32_t)data[0] << 16) | ((uint32_t)data[1] << 8) | data[2];
+		if (raw & 0x800000) {
+			raw |= 0xFF000000;  // Extensión de signo
+		}
+		sample.raw = (int32_t)raw;
+
+		// El CRC cubre solo los bytes de datos (el STATUS no entra en el cálculo)
+		if (hasCrc && crc8Poly07(data, DATA_LENGTH) != sample.crc) {
+			errors.crcErrors++;
+			continue;
+		}
+		// nRDY en alto: el dispositivo no estaba listo, la conversión no es válida
+		if (hasStatus && (sample.status & ADS_STATUS_NRDY)) {
+			errors.statusErrors++;
+			continue;
+		}
+
+		if (attempt > 0) {
+			errors.recovered++;
+		}
+		return true;
 	}
 
-	_spi->endTransaction();
+	errors.dropped++;
+	DEBUG_PRINTF("ADS124S08: conversión descartada en mux 0x%02X tras %u reintentos\n",
+	             mux, ADS_FRAME_MAX_RETRIES);
+	return false;
+}
+
+/*
+ * Contadores de error del canal cuyo MUXP coincide con el de muxConfig
+ *
+ */
+const ADS124S08ChannelErrors &ADS124S08::channelErrors(uint8_t muxConfig) const
+{
+	return _channelErrors[(muxConfig >> 4) & 0x0F];
+}
+
+void ADS124S08::clearChannelErrors(void)
+{
+	memset(_channelErrors, 0, sizeof(_channelErrors));
+}
 
+/*
+ * Reads data using the RDATA command
+ * Espera a que el pin DRDY esté en LOW (activo bajo) para indicar que los datos están listos
+ * antes de enviar el comando RDATA y leer los datos del ADC.
+ * Devuelve -1 si expira DRDY o si la trama no supera la validación tras los reintentos.
+ */
+int ADS124S08::rData(uint8_t *dStatus, uint8_t *dData, uint8_t *dCRC)
+{
+	if (!_initialized) return -1;
+
+	if (!waitDataReady()) {
+		return -1;
+	}
+
+	ADS124S08Sample sample;
+	if (!selectDeviceCSLow()) return -1;
+	bool valid = readValidatedFrame(sample, registers[INPMUX_ADDR_MASK], true);
 	releaseChipSelect();
-	return result;
+
+	if (!valid) {
+		return -1;
+	}
+	if (dStatus) dStatus[0] = sample.status;
+	if (dCRC) dCRC[0] = sample.crc;
+	return (int)sample.raw;
 }
 
 /*
@@ -395,62 +557,28 @@ int ADS124S08::rData(uint8_t *dStatus, uint8_t *dData, uint8_t *dCRC)
  * Read the last conversion result
  * Espera a que el pin DRDY esté en LOW (activo bajo) para indicar que los datos están listos
  * antes de leer los datos del ADC.
+ * Devuelve -1 si expira DRDY o si la trama no supera la validación tras los reintentos.
  *
  */
 int ADS124S08::dataRead(uint8_t *dStatus, uint8_t *dData, uint8_t *dCRC)
 {
 	if (!_initialized) return -1;
-	
-	// Esperar a que el pin DRDY esté en LOW (datos disponibles)
-	// DRDY es activo bajo, por lo que cuando está en LOW, los datos están listos
-	uint32_t timeout = millis() + 100; // Timeout de 100 ms
-	while (_ioExpander->digitalRead(ADS124S08_DRDY_PIN) == HIGH) {
-		// Si se supera el timeout, retornar error
-		if (millis() > timeout) {
-			return -1;
-		}
-		delayMicroseconds(100); // Pequeña pausa para no saturar el CPU
-	}
-	
-	uint8_t xcrc;
-	uint8_t xstatus;
-	int iData = 0;
-	selectDeviceCSLow();
-	
-	_spi->beginTransaction(_spiSettings);
-	
-	if((registers[SYS_ADDR_MASK] & 0x01) == DATA_MODE_STATUS)
-	{
-		xstatus = _spi->transfer(0x00);
-		dStatus[0] = (uint8_t)xstatus;
+
+	if (!waitDataReady()) {
+		return -1;
 	}
 
-	// get the conversion data (3 bytes)
-	uint8_t data[3];
-	data[0] = _spi->transfer(0x00);
-	data[1] = _spi->transfer(0x00);
-	data[2] = _spi->transfer(0x00);
+	ADS124S08Sample sample;
+	if (!selectDeviceCSLow()) return -1;
+	bool valid = readValidatedFrame(sample, registers[INPMUX_ADDR_MASK], false);
+	releaseChipSelect();
 
-	// Armar el entero de 24 bits con extensión de signo
-	uint32_t raw = ((uint32_t)data[0] << 16) | ((uint32_t)data[1] << 8) | data[2];
-	
-	// Extender el signo si el bit 23 es 1
-	if (raw & 0x800000) {
-		raw |= 0xFF000000;  // Extensión de signo
-	}
-	
-	iData = (int)raw;
-	
-	if((registers[SYS_ADDR_MASK] & 0x02) == DATA_MODE_CRC)
-	{
-		xcrc = _spi->transfer(0x00);
-		dCRC[0] = (uint8_t)xcrc;
+	if (!valid) {
+		return -1;
 	}
-	
-	_spi->endTransaction();
-	
-	releaseChipSelect();
-	return iData;
+	if (dStatus) dStatus[0] = sample.status;
+	if (dCRC) dCRC[0] = sample.crc;
+	return (int)sample.raw;
 }
 
 #endif // DEVICE_TYPE_ANALOGIC
\ No newline at end of file
@@ -1,39 +1,213 @@
 #include "AdcUtilities.h"
 #include "config_manager.h"
 #include "debug.h"
+#include "Diagnostics.h"
 
 #ifdef DEVICE_TYPE_ANALOGIC
+#include <cmath>
 #include "ADS124S08.h"
 extern ADS124S08 ADC;
 
+// Periodo de conversión (µs) indexado por código ADS_DR_* (2.5 SPS ... 4000 SPS)
+static const uint32_t kConversionPeriodUs[] = {
+    400000, 200000, 100000, 60000, 50000, 20000, 16667,
+    10000, 5000, 2500, 1250, 1000, 500, 250
+};
+
+uint32_t AdcUtilities::conversionPeriodUs(uint8_t dataRate)
+{
+    uint8_t index = dataRate & 0x0F;
+    if (index >= sizeof(kConversionPeriodUs) / sizeof(kConversionPeriodUs[0])) {
+        index = ADS_DR_4000;
+    }
+    return kConversionPeriodUs[index];
+}
+
+float AdcUtilities::rawToVoltage(int32_t rawData)
+{
+    if (rawData & 0x00800000) {
+        // Extender signo si el bit 23 está en 1
+        rawData |= 0xFF000000;
+    }
+
+    // Convertir a voltaje asumiendo referencia interna de 2.5V
+    // ADC de 24 bits => rango ±2^23
+    return (float)rawData / 8388608.0f * 2.5f;
+}
+
 float AdcUtilities::measureAdcDifferential(uint8_t muxConfig)
 {
     // Configurar MUX
     ADC.regWrite(INPMUX_ADDR_MASK, muxConfig);
-    
+
     // Iniciar una conversión single shot
     ADC.sendCommand(START_OPCODE_MASK);
-    
+
     // Leer el resultado
     uint8_t dummy1 = 0, dummy2 = 0;
     int32_t rawData = ADC.dataRead(&dummy1, &dummy2, &dummy2);
-    
+
     // Detener la conversión
     ADC.sendCommand(STOP_OPCODE_MASK);
-    
+
     if (rawData == -1) {  // Error en la lectura
         return NAN;
     }
-    
-    if (rawData & 0x00800000) {
-        // Extender signo si el bit 23 está en 1
-        rawData |= 0xFF000000;
+
+    return rawToVoltage(rawData);
+}
+
+float AdcUtilities::measureAdcDifferential(uint8_t muxConfig,
+                                           const AdcAcquisitionProfile& profile)
+{
+    uint8_t numSamples = constrain(profile.numSamples, 1, ADC_MAX_SAMPLES_PER_BURST);
+    float samples[ADC_MAX_SAMPLES_PER_BURST];
+    uint8_t count = 0;
+
+    // La primera conversión tras START incluye el settling del filtro (3 periodos en sinc3)
+    uint32_t periodUs = conversionPeriodUs(profile.dataRate);
+    ADC.setDataReadyTimeout((periodUs * 4) / 1000 + 10);
+
+    // Data rate en modo conversión continua (bit MODE = 0)
+    uint8_t datarate = (profile.dataRate & 0x0F);
+    if (profile.filter == ADC_FILTER_LOW_LATENCY) {
+        datarate |= ADS_FILTERTYPE_LL;
     }
+    ADC.regWrite(DATARATE_ADDR_MASK, datarate);
 
-    // Convertir a voltaje asumiendo referencia interna de 2.5V
-    // ADC de 24 bits => rango ±2^23
-    float voltage = (float)rawData / 8388608.0f * 2.5f;
-    return voltage;
+    // Una única ráfaga en streaming: START por pin, CS sostenido y tramas leídas tras DRDY
+    ADC.startStreaming(muxConfig);
+    ADC.pollStream(numSamples);
+    ADC.stopStreaming();
+
+    ADS124S08Sample sample;
+    while (count < numSamples && ADC.readSample(sample)) {
+        samples[count++] = rawToVoltage(sample.raw);
+    }
+
+    // Restaurar el modo single-shot configurado en SensorManager::beginAdc
+    ADC.regWrite(DATARATE_ADDR_MASK, ADS_DR_4000 | ADS_CONVMODE_SS);
+    ADC.setDataReadyTimeout(100);
+
+    if (count == 0) {
+        return NAN;
+    }
+
+    // Ruido de la ráfaga (antes de que la reducción reordene las muestras)
+    trackNoise(muxConfig, samples, count);
+
+    return reduceSamples(samples, count, profile.reduction);
+}
+
+// Totales desde el arranque en frío: los contadores del driver empiezan de cero en cada despertar
+RTC_DATA_ATTR static AdcErrorsDiag adcErrorTotals;
+
+static uint16_t saturatingAdd(uint16_t total, uint32_t count)
+{
+    uint32_t sum = (uint32_t)total + count;
+    return sum > UINT16_MAX ? UINT16_MAX : (uint16_t)sum;
+}
+
+void AdcUtilities::reportChannelErrors()
+{
+    bool fresh = false;
+    for (uint8_t channel = 0; channel < 16; channel++) {
+        const ADS124S08ChannelErrors& errors = ADC.channelErrors((uint8_t)(channel << 4));
+        if (errors.crcErrors == 0 && errors.statusErrors == 0 && errors.dropped == 0) {
+            continue;
+        }
+        adcErrorTotals.channelMask |= (uint16_t)(1u << channel);
+        adcErrorTotals.crcErrors = saturatingAdd(adcErrorTotals.crcErrors, errors.crcErrors);
+        adcErrorTotals.statusErrors = saturatingAdd(adcErrorTotals.statusErrors, errors.statusErrors);
+        adcErrorTotals.dropped = saturatingAdd(adcErrorTotals.dropped, errors.dropped);
+        fresh = true;
+    }
+    ADC.clearChannelErrors();
+
+    if (fresh) {
+        Diagnostics::add(DIAG_TAG_ADC_ERRORS, &adcErrorTotals, sizeof(adcErrorTotals));
+    }
+}
+
+// Ráfaga con mayor desviación desde el último reportNoise() (sigmaUv = 0: ninguna)
+static AdcNoiseDiag noisiestBurst;
+
+static uint16_t toMicrovolts(double volts)
+{
+    double uv = volts * 1e6;
+    return uv >= UINT16_MAX ? UINT16_MAX : (uint16_t)(uv + 0.5);
+}
+
+void AdcUtilities::trackNoise(uint8_t muxConfig, const float* samples, uint8_t count)
+{
+    if (count < 2) {
+        return;
+    }
+    double sum = 0.0;
+    float minV = samples[0], maxV = samples[0];
+    for (uint8_t i = 0; i < count; i++) {
+        sum += samples[i];
+        if (samples[i] < minV) minV = samples[i];
+        if (samples[i] > maxV) maxV = samples[i];
+    }
+    double mean = sum / count;
+    double sqSum = 0.0;
+    for (uint8_t i = 0; i < count; i++) {
+        double d = samples[i] - mean;
+        sqSum += d * d;
+    }
+    uint16_t sigmaUv = toMicrovolts(sqrt(sqSum / (count - 1)));
+    if (sigmaUv > noisiestBurst.sigmaUv) {
+        noisiestBurst.channel = (muxConfig >> 4) & 0x0F;
+        noisiestBurst.samples = count;
+        noisiestBurst.sigmaUv = sigmaUv;
+        noisiestBurst.spanUv = toMicrovolts(maxV - minV);
+    }
+}
+
+void AdcUtilities::reportNoise()
+{
+    if (noisiestBurst.sigmaUv > ADC_NOISE_REPORT_UV) {
+        Diagnostics::add(DIAG_TAG_ADC_NOISE, &noisiestBurst, sizeof(noisiestBurst));
+    }
+    memset(&noisiestBurst, 0, sizeof(noisiestBurst));
+}
+
+float AdcUtilities::reduceSamples(float* samples, uint8_t count, AdcReduction reduction)
+{
+    if (reduction == ADC_REDUCE_MEAN || count < 3) {
+        double sum = 0.0;
+        for (uint8_t i = 0; i < count; i++) {
+            sum += samples[i];
+        }
+        return (float)(sum / count);
+    }
+
+    // Ordenamiento por inserción (ráfagas pequeñas)
+    for (uint8_t i = 1; i < count; i++) {
+        float key = samples[i];
+        int8_t j = i - 1;
+        while (j >= 0 && samples[j] > key) {
+            samples[j + 1] = samples[j];
+            j--;
+        }
+        samples[j + 1] = key;
+    }
+
+    if (reduction == ADC_REDUCE_MEDIAN) {
+        if (count % 2) {
+            return samples[count / 2];
+        }
+        return (samples[count / 2 - 1] + samples[count / 2]) * 0.5f;
+    }
+
+    // Media recortada: descartar el 25% inferior y el 25% superior
+    uint8_t trim = count / 4;
+    double sum = 0.0;
+    for (uint8_t i = trim; i < count - trim; i++) {
+        sum += samples[i];
+    }
+    return (float)(sum / (count - 2 * trim));
 }
 
-#endif // DEVICE_TYPE_ANALOGIC 
\ No newline at end of file
+#endif // DEVICE_TYPE_ANALOGIC
@@ -0,0 +1,264 @@
+/*******************************************************************************************
+ * Archivo: src/Aggregator.cpp
+ * Descripción: Implementación de la agregación por ventana entre uplinks.
+ *******************************************************************************************/
+
+#include "Aggregator.h"
+#include "debug.h"
+#include "util/fnv1a.h"
+#include "util/welford.h"
+
+#define AGGREGATOR_MAGIC    0xA66E
+
+/**
+ * @brief Canal agregado (sensor o subvalor)
+ */
+struct AggChannel {
+    uint32_t id;                    // fnv1a(sensorId, subIndex); 0 = libre
+    char sensorId[20];
+    uint8_t type;
+    uint8_t subIndex;
+    uint8_t window;
+    uint8_t stats;
+    WelfordAccumulator current;     // Ventana en curso
+    WelfordAccumulator closed;      // Última ventana cerrada (count 0 = nada pendiente)
+    uint32_t closedAt;
+    uint8_t closedStats;
+    uint8_t encoded;                // Incluido en el último encode()
+};
+
+struct AggregatorState {
+    uint16_t magic;
+    AggChannel channels[AGG_MAX_CHANNELS];
+};
+
+RTC_DATA_ATTR static AggregatorState aggState;
+
+SensorReading Aggregator::_passNormal[MAX_NORMAL_SENSORS];
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+ModbusSensorReading Aggregator::_passModbus[MAX_MODBUS_SENSORS];
+#endif
+
+static uint32_t channelId(const char* sensorId, uint8_t subIndex) {
+    uint32_t id = fnv1a32Byte(fnv1a32(sensorId), subIndex);
+    return id ? id : 1;
+}
+
+void Aggregator::begin(BootMode bootMode) {
+    if (bootMode == BOOT_MODE_WARM && aggState.magic == AGGREGATOR_MAGIC) {
+        return;
+    }
+    memset(&aggState, 0, sizeof(aggState));
+    aggState.magic = AGGREGATOR_MAGIC;
+}
+
+int8_t Aggregator::channelFor(const char* sensorId, SensorType type, uint8_t subIndex,
+                              uint8_t window, uint8_t stats) {
+    uint32_t id = channelId(sensorId, subIndex);
+    int8_t freeSlot = -1;
+    for (uint8_t i = 0; i < AGG_MAX_CHANNELS; i++) {
+        AggChannel& channel = aggState.channels[i];
+        if (channel.id == id) {
+            if (channel.window != window || channel.stats != stats) {
+                // Configuración nueva: la ventana en curso ya no es comparable
+                channel.window = window;
+                channel.stats = stats;
+                welfordReset(channel.current);
+            }
+            return i;
+        }
+        if (channel.id == 0 && freeSlot < 0) {
+            freeSlot = i;
+        }
+    }
+    if (freeSlot < 0) {
+        return -1;
+    }
+
+    AggChannel& channel = aggState.channels[freeSlot];
+    memset(&channel, 0, sizeof(channel));
+    channel.id = id;
+    strlcpy(channel.sensorId, sensorId, sizeof(channel.sensorId));
+    channel.type = (uint8_t)type;
+    channel.subIndex = subIndex;
+    channel.window = window;
+    channel.stats = stats;
+    return freeSlot;
+}
+
+bool Aggregator::accumulate(const char* sensorId, SensorType type, uint8_t window, uint8_t stats,
+                            const float* values, uint8_t count, uint32_t timestamp) {
+    if (window <= 1 || count == 0) {
+        return false;
+    }
+    if (stats == 0) {
+        stats = AGG_STAT_ALL;
+    }
+
+    // Asignar todos los canales antes de consumir la lectura; si no caben se envía tal cual
+    int8_t slots[MAX_SUBVALUES];
+    for (uint8_t i = 0; i < count; i++) {
+        slots[i] = channelFor(sensorId, type, i, window, stats);
+        if (slots[i] < 0) {
+            DEBUG_PRINTF("Agregación: sin canales libres para %s\n", sensorId);
+            return false;
+        }
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (isnan(values[i])) {
+            continue;   // Las muestras fallidas no cuentan en la ventana
+        }
+        AggChannel& channel = aggState.channels[slots[i]];
+        welfordAdd(channel.current, values[i]);
+        if (channel.current.count >= channel.window) {
+            if (channel.closed.count != 0) {
+                DEBUG_PRINTF("Agregación: resumen de %s/%u sin enviar, se reemplaza\n",
+                             sensorId, i);
+            }
+            channel.closed = channel.current;
+            channel.closedAt = timestamp;
+            channel.closedStats = channel.stats;
+            channel.encoded = 0;
+            welfordReset(channel.current);
+        }
+    }
+    return true;
+}
+
+void Aggregator::feed(Span<const SensorConfig> configs, Span<const SensorReading>& readings,
+                      uint32_t timestamp) {
+    size_t passCount = 0;
+    for (size_t i = 0; i < readings.size(); i++) {
+        const SensorReading& reading = readings[i];
+        bool aggregated = false;
+        if (i < configs.size() && strcmp(configs[i].sensorId, reading.sensorId) == 0) {
+            const SensorConfig& cfg = configs[i];
+            float values[MAX_SUBVALUES];
+            uint8_t count = 0;
+            if (reading.subValueCount == 0) {
+                values[count++] = reading.value;
+            }
+            for (uint8_t j = 0; j < reading.subValueCount && count < MAX_SUBVALUES; j++) {
+                values[count++] = reading.subValues[j].value;
+            }
+            aggregated = accumulate(reading.sensorId, reading.type, cfg.aggWindow, cfg.aggStats,
+                                    values, count, timestamp);
+        }
+        if (!aggregated && passCount < MAX_NORMAL_SENSORS) {
+            _passNormal[passCount++] = reading;
+        }
+    }
+    readings = Span<const SensorReading>(_passNormal, passCount);
+}
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+void Aggregator::feed(Span<const ModbusSensorConfig> configs, Span<const ModbusSensorReading>& readings,
+                      uint32_t timestamp) {
+    size_t passCount = 0;
+    for (size_t i = 0; i < readings.size(); i++) {
+        const ModbusSensorReading& reading = readings[i];
+        bool aggregated = false;
+        if (i < configs.size() && strcmp(configs[i].sensorId, reading.sensorId) == 0) {
+            const ModbusSensorConfig& cfg = configs[i];
+            float values[MAX_SUBVALUES];
+            uint8_t count = 0;
+            for (uint8_t j = 0; j < reading.subValueCount && count < MAX_SUBVALUES; j++) {
+                values[count++] = reading.subValues[j].value;
+            }
+            aggregated = accumulate(reading.sensorId, reading.type, cfg.aggWindow, cfg.aggStats,
+                                    values, count, timestamp);
+        }
+        if (!aggregated && passCount < MAX_MODBUS_SENSORS) {
+            _passModbus[passCount++] = reading;
+        }
+    }
+    readings = Span<const ModbusSensorReading>(_passModbus, passCount);
+}
+#endif
+
+bool Aggregator::pending() {
+    for (uint8_t i = 0; i < AGG_MAX_CHANNELS; i++) {
+        if (aggState.channels[i].id != 0 && aggState.channels[i].closed.count != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static size_t putBytes(uint8_t* buffer, size_t offset, const void* data, size_t length) {
+    memcpy(buffer + offset, data, length);
+    return offset + length;
+}
+
+size_t Aggregator::encode(uint32_t timestamp, uint8_t* buffer, size_t bufferSize) {
+    const size_t headerSize = 6;
+    if (bufferSize < headerSize) {
+        return 0;
+    }
+    buffer[0] = AGG_RECORD_VERSION;
+    memcpy(buffer + 1, &timestamp, sizeof(timestamp));
+    uint8_t included = 0;
+    size_t offset = headerSize;
+
+    for (uint8_t i = 0; i < AGG_MAX_CHANNELS; i++) {
+        AggChannel& channel = aggState.channels[i];
+        channel.encoded = 0;
+        if (channel.id == 0 || channel.closed.count == 0) {
+            continue;
+        }
+
+        uint8_t stats = channel.closedStats;
+        uint8_t idLen = strnlen(channel.sensorId, sizeof(channel.sensorId));
+        size_t needed = 1 + idLen + 3 + sizeof(uint16_t);
+        if (stats & AGG_STAT_COUNT) needed += sizeof(uint16_t);
+        for (uint8_t bit = AGG_STAT_MIN; bit <= AGG_STAT_STDDEV; bit <<= 1) {
+            if (stats & bit) needed += sizeof(float);
+        }
+        if (offset + needed > bufferSize) {
+            continue;   // Queda para el siguiente uplink
+        }
+
+        uint32_t ageS = (timestamp >= channel.closedAt) ? timestamp - channel.closedAt : 0;
+        uint16_t age = (ageS > UINT16_MAX) ? UINT16_MAX : (uint16_t)ageS;
+        const WelfordAccumulator& acc = channel.closed;
+
+        buffer[offset++] = idLen;
+        offset = putBytes(buffer, offset, channel.sensorId, idLen);
+        buffer[offset++] = channel.type;
+        buffer[offset++] = channel.subIndex;
+        buffer[offset++] = stats;
+        offset = putBytes(buffer, offset, &age, sizeof(age));
+        if (stats & AGG_STAT_COUNT) {
+            offset = putBytes(buffer, offset, &acc.count, sizeof(acc.count));
+        }
+        if (stats & AGG_STAT_MIN) {
+            offset = putBytes(buffer, offset, &acc.min, sizeof(float));
+        }
+        if (stats & AGG_STAT_MAX) {
+            offset = putBytes(buffer, offset, &acc.max, sizeof(float));
+        }
+        if (stats & AGG_STAT_MEAN) {
+            offset = putBytes(buffer, offset, &acc.mean, sizeof(float));
+        }
+        if (stats & AGG_STAT_STDDEV) {
+            float stddev = welfordStddev(acc);
+            offset = putBytes(buffer, offset, &stddev, sizeof(float));
+        }
+        channel.encoded = 1;
+        included++;
+    }
+
+    buffer[5] = included;
+    return included ? offset : 0;
+}
+
+void Aggregator::markSent() {
+    for (uint8_t i = 0; i < AGG_MAX_CHANNELS; i++) {
+        AggChannel& channel = aggState.channels[i];
+        if (channel.encoded) {
+            welfordReset(channel.closed);
+            channel.encoded = 0;
+        }
+    }
+}
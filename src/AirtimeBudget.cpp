@@ -0,0 +1,157 @@
+/*******************************************************************************************
+ * Archivo: src/AirtimeBudget.cpp
+ * Descripción: Implementación de la contabilidad y el presupuesto de tiempo en el aire.
+ *******************************************************************************************/
+
+#include "AirtimeBudget.h"
+#include <RadioLib.h>
+#include "debug.h"
+#include "Diagnostics.h"
+#include "LinkPolicy.h"
+#include "util/airtime.h"
+
+#define AIRTIME_BUDGET_MAGIC    0xA1B6D00CUL
+#define AIRTIME_HOURS           24
+#define AIRTIME_HOUR_S          3600UL
+
+/**
+ * @brief Estado que sobrevive al deep sleep y a los resets sin pérdida de alimentación.
+ *        RTC_NOINIT_ATTR: el bootloader no lo reinicia, así que tras encender la placa
+ *        solo el magic de 32 bits lo valida.
+ */
+struct AirtimeState {
+    uint32_t magic;
+    uint32_t hour;                      // Hora Unix (s / 3600) de la cubeta actual
+    uint32_t bucketsMs[AIRTIME_HOURS];  // ToA por hora, índice hour % AIRTIME_HOURS
+    uint16_t uplinks;
+    uint16_t deferred;
+    uint8_t lastDatarate;
+    uint8_t lastDataLength;
+};
+
+RTC_NOINIT_ATTR static AirtimeState airtimeState;
+
+RTC_DS3231* AirtimeBudget::_rtc = nullptr;
+
+void AirtimeBudget::begin(RTC_DS3231& rtc) {
+    _rtc = &rtc;
+    // Ni un reset (brown-out, WDT, pánico) ni un cambio de configuración deben liberar
+    // tiempo en el aire: solo se empieza de cero al perder la alimentación
+    if (airtimeState.magic == AIRTIME_BUDGET_MAGIC) {
+        return;
+    }
+    memset(&airtimeState, 0, sizeof(airtimeState));
+    airtimeState.magic = AIRTIME_BUDGET_MAGIC;
+    airtimeState.lastDatarate = LINK_DR_START;
+}
+
+/**
+ * @brief ToA en ms de un uplink LoRaWAN en un DR de la región (0 si el DR no es LoRa)
+ */
+static uint32_t airtimeMs(uint8_t datarate, size_t payloadLength) {
+    if (datarate >= RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES) {
+        return 0;
+    }
+    uint8_t code = LORA_REGION.dataRates[datarate];
+    if (code == RADIOLIB_LORAWAN_DATA_RATE_UNUSED || (code & RADIOLIB_LORAWAN_DATA_RATE_FSK_50_K)) {
+        return 0;
+    }
+    uint8_t sf = ((code >> 4) & 0x07) + 6;
+    uint32_t bandwidthHz = 500000UL >> ((code >> 2) & 0x03);
+    uint8_t crDenominator = (code & 0x03) + 5;
+    uint32_t us = loraAirtimeUs(sf, bandwidthHz, crDenominator, payloadLength + AIRTIME_LORAWAN_OVERHEAD);
+    return (us + 999) / 1000;
+}
+
+void AirtimeBudget::advance() {
+    if (_rtc == nullptr) {
+        return;
+    }
+    uint32_t hour = _rtc->now().unixtime() / AIRTIME_HOUR_S;
+    if (hour == airtimeState.hour) {
+        return;
+    }
+
+    // Hora cerrada: se publica antes de rotar (no en el primer uso ni si el reloj retrocede)
+    if (airtimeState.hour != 0 && hour > airtimeState.hour) {
+        AirtimeDiag diag;
+        diag.hourMs = airtimeState.bucketsMs[airtimeState.hour % AIRTIME_HOURS];
+        diag.dayMs = dayMs();
+        diag.uplinks = airtimeState.uplinks;
+        diag.deferred = airtimeState.deferred;
+        diag.lastDatarate = airtimeState.lastDatarate;
+        if (diag.hourMs > 0 || diag.deferred > 0) {
+            Diagnostics::add(DIAG_TAG_AIRTIME, &diag, sizeof(diag));
+        }
+    }
+
+    if (hour < airtimeState.hour || hour - airtimeState.hour >= AIRTIME_HOURS) {
+        memset(airtimeState.bucketsMs, 0, sizeof(airtimeState.bucketsMs));
+    } else {
+        for (uint32_t h = airtimeState.hour + 1; h <= hour; h++) {
+            airtimeState.bucketsMs[h % AIRTIME_HOURS] = 0;
+        }
+    }
+    airtimeState.hour = hour;
+}
+
+uint32_t AirtimeBudget::hourMs() {
+    advance();
+    // Hora móvil: la cubeta actual más la parte de la anterior que sigue dentro de la ventana
+    uint32_t elapsed = _rtc ? _rtc->now().unixtime() % AIRTIME_HOUR_S : 0;
+    uint32_t current = airtimeState.bucketsMs[airtimeState.hour % AIRTIME_HOURS];
+    uint32_t previous = airtimeState.bucketsMs[(airtimeState.hour + AIRTIME_HOURS - 1) % AIRTIME_HOURS];
+    return current + (uint32_t)((uint64_t)previous * (AIRTIME_HOUR_S - elapsed) / AIRTIME_HOUR_S);
+}
+
+uint32_t AirtimeBudget::dayMs() {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < AIRTIME_HOURS; i++) {
+        total += airtimeState.bucketsMs[i];
+    }
+    return total;
+}
+
+uint32_t AirtimeBudget::estimateMs(size_t payloadLength) {
+#if LINK_NETWORK_ADR
+    // Con ADR el DR lo fija el servidor: se supone el del último uplink
+    return airtimeMs(airtimeState.lastDatarate, payloadLength);
+#else
+    return airtimeMs(LinkPolicy::datarateFor(payloadLength), payloadLength);
+#endif
+}
+
+bool AirtimeBudget::allows(size_t payloadLength) {
+    uint32_t needed = estimateMs(payloadLength);
+    bool overHour = AIRTIME_BUDGET_HOUR_MS > 0 && hourMs() + needed > AIRTIME_BUDGET_HOUR_MS;
+    bool overDay = AIRTIME_BUDGET_DAY_MS > 0 && dayMs() + needed > AIRTIME_BUDGET_DAY_MS;
+    if (overHour || overDay) {
+        if (airtimeState.deferred < UINT16_MAX) {
+            airtimeState.deferred++;
+        }
+        DEBUG_PRINTF("Tiempo en el aire: %lu ms no caben (hora %lu ms, día %lu ms), se aplaza\n",
+                     (unsigned long)needed, (unsigned long)hourMs(), (unsigned long)dayMs());
+        return false;
+    }
+    return true;
+}
+
+void AirtimeBudget::record(uint8_t datarate, size_t payloadLength) {
+    advance();
+    uint32_t ms = airtimeMs(datarate, payloadLength);
+    airtimeState.bucketsMs[airtimeState.hour % AIRTIME_HOURS] += ms;
+    airtimeState.lastDatarate = datarate;
+    if (airtimeState.uplinks < UINT16_MAX) {
+        airtimeState.uplinks++;
+    }
+    DEBUG_PRINTF("Tiempo en el aire: %lu ms en DR%u (hora %lu ms, día %lu ms)\n",
+                 (unsigned long)ms, datarate, (unsigned long)hourMs(), (unsigned long)dayMs());
+}
+
+size_t AirtimeBudget::lastDataLength() {
+    return airtimeState.lastDataLength;
+}
+
+void AirtimeBudget::noteDataLength(size_t payloadLength) {
+    airtimeState.lastDataLength = (uint8_t)(payloadLength > UINT8_MAX ? UINT8_MAX : payloadLength);
+}
@@ -4,6 +4,7 @@
  *******************************************************************************************/
 
 #include "BLE.h"
+#include "BootManager.h"
 
 // Inicialización de variables estáticas
 bool BLEHandler::isConnected = false;
@@ -56,6 +57,9 @@ bool BLEHandler::checkConfigMode(PCA9555& ioExpander) {
                 
                 // Entrar en bucle de configuración
                 runConfigLoop(ioExpander);
+
+                // La configuración pudo cambiar: no reutilizar el estado RTC al despertar
+                BootManager::invalidate();
                 return true;
             }
         }
@@ -555,6 +559,10 @@ void BLEHandler::SensorsConfigCallback::onWrite(BLECharacteristic *pCharacterist
         strncpy(config.sensorId, sensor[KEY_SENSOR_ID] | "", sizeof(config.sensorId));
         config.type = static_cast<SensorType>(sensor[KEY_SENSOR_TYPE] | 0);
         config.enable = sensor[KEY_SENSOR_ENABLE] | false;
+        config.periodTicks = sensor[KEY_SENSOR_PERIOD] | 1;
+        config.aggWindow = sensor[KEY_SENSOR_AGG_WINDOW] | 0;
+        config.aggStats = sensor[KEY_SENSOR_AGG_STATS] | 0;
+        config.predictTolerance = sensor[KEY_SENSOR_PREDICT_TOL] | 0.0f;
         
         DEBUG_PRINT(F("DEBUG: Sensor config parsed - key: "));
         DEBUG_PRINT(config.configKey);
@@ -563,7 +571,11 @@ void BLEHandler::SensorsConfigCallback::onWrite(BLECharacteristic *pCharacterist
         DEBUG_PRINT(F(", type: "));
         DEBUG_PRINT(static_cast<int>(config.type));
         DEBUG_PRINT(F(", enable: "));
-        DEBUG_PRINTLN(config.enable ? "true" : "false");
+        DEBUG_PRINT(config.enable ? "true" : "false");
+        DEBUG_PRINT(F(", period: "));
+        DEBUG_PRINT(config.periodTicks);
+        DEBUG_PRINT(F(", window: "));
+        DEBUG_PRINTLN(config.aggWindow);
         
         configs.push_back(config);
     }
@@ -593,6 +605,10 @@ void BLEHandler::SensorsConfigCallback::onRead(BLECharacteristic *pCharacteristi
         obj[KEY_SENSOR_ID]          = sensor.sensorId;
         obj[KEY_SENSOR_TYPE]        = static_cast<int>(sensor.type);
         obj[KEY_SENSOR_ENABLE]      = sensor.enable;
+        obj[KEY_SENSOR_PERIOD]      = sensor.periodTicks ? sensor.periodTicks : 1;
+        obj[KEY_SENSOR_AGG_WINDOW]  = sensor.aggWindow;
+        obj[KEY_SENSOR_AGG_STATS]   = sensor.aggStats;
+        obj[KEY_SENSOR_PREDICT_TOL] = sensor.predictTolerance;
     }
 
     String jsonString;
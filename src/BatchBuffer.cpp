@@ -0,0 +1,224 @@
+/*******************************************************************************************
+ * Archivo: src/BatchBuffer.cpp
+ * Descripción: Implementación del lote de muestras entre uplinks.
+ *******************************************************************************************/
+
+#include "BatchBuffer.h"
+#include "debug.h"
+#include "MeasurementContext.h"
+#include "util/batch_codec.h"
+
+#define BATCH_BUFFER_MAGIC  0xBA7D
+
+/**
+ * @brief Estado que sobrevive al deep sleep. Las columnas se asignan al primer valor y
+ *        se liberan cuando ya no tienen filas pendientes.
+ */
+struct BatchStore {
+    uint16_t magic;
+    uint8_t rows;
+    uint8_t columns;
+    uint32_t timestamps[BATCH_MAX_ROWS];
+    uint8_t tags[BATCH_MAX_COLUMNS];
+    uint8_t decimals[BATCH_MAX_COLUMNS];
+    uint16_t masks[BATCH_MAX_COLUMNS];
+    int32_t values[BATCH_MAX_COLUMNS][BATCH_MAX_ROWS];
+};
+
+RTC_DATA_ATTR static BatchStore batchStore;
+
+uint8_t BatchBuffer::_encodedRows = 0;
+
+void BatchBuffer::begin(BootMode bootMode) {
+    if (bootMode == BOOT_MODE_WARM && batchStore.magic == BATCH_BUFFER_MAGIC &&
+        batchStore.rows <= BATCH_MAX_ROWS && batchStore.columns <= BATCH_MAX_COLUMNS) {
+        return;
+    }
+    memset(&batchStore, 0, sizeof(batchStore));
+    batchStore.magic = BATCH_BUFFER_MAGIC;
+}
+
+void BatchBuffer::dropRows(uint8_t count) {
+    if (count > batchStore.rows) {
+        count = batchStore.rows;
+    }
+    uint8_t remaining = batchStore.rows - count;
+    memmove(batchStore.timestamps, batchStore.timestamps + count, remaining * sizeof(uint32_t));
+
+    uint8_t kept = 0;
+    for (uint8_t c = 0; c < batchStore.columns; c++) {
+        uint16_t mask = batchStore.masks[c] >> count;
+        if (mask == 0) {
+            continue;   // Columna sin filas pendientes: se libera
+        }
+        batchStore.tags[kept] = batchStore.tags[c];
+        batchStore.decimals[kept] = batchStore.decimals[c];
+        batchStore.masks[kept] = mask;
+        memmove(batchStore.values[kept], batchStore.values[c] + count, remaining * sizeof(int32_t));
+        kept++;
+    }
+    batchStore.columns = kept;
+    batchStore.rows = remaining;
+}
+
+uint8_t BatchBuffer::beginRow(uint32_t timestamp) {
+    if (batchStore.rows >= BATCH_MAX_ROWS) {
+        DEBUG_PRINTLN("Lote lleno: se descarta la fila más antigua");
+        dropRows(1);
+    }
+    uint8_t row = batchStore.rows++;
+    batchStore.timestamps[row] = timestamp;
+    put(row, BATCH_TAG_BATTERY, MeasurementContext::get(MEAS_INPUT_BATTERY_VOLTAGE),
+        BATCH_DECIMALS_FINE);
+    return row;
+}
+
+/**
+ * @brief Decimales de la columna según la magnitud: lo justo para la resolución útil del
+ *        sensor, que cada decimal de más cuesta bits en todas las filas del lote
+ */
+static uint8_t decimalsFor(SensorType type, uint8_t subValue) {
+    switch (type) {
+        case PH:
+            return BATCH_DECIMALS_FINE;
+        case HDS10:
+        case COND:
+        case CONDH:
+        case SOILH:
+        case HUM_A:
+        case CO2:
+        case LIGHT:
+        case ROOTH:
+        case LEAFH:
+            return BATCH_DECIMALS_COARSE;
+        case SHT30:
+            return subValue == 1 ? BATCH_DECIMALS_COARSE : BATCH_DECIMALS;
+        case ENV4:
+            return (subValue == 0 || subValue == 3) ? BATCH_DECIMALS_COARSE : BATCH_DECIMALS;
+        default:
+            return BATCH_DECIMALS;
+    }
+}
+
+void BatchBuffer::put(uint8_t row, uint8_t tag, float value, uint8_t decimals) {
+    uint8_t c = 0;
+    while (c < batchStore.columns && batchStore.tags[c] != tag) {
+        c++;
+    }
+    if (c < batchStore.columns) {
+        decimals = batchStore.decimals[c];  // La columna conserva sus decimales
+    }
+    int32_t quantized;
+    if (!batchQuantize(value, decimals, quantized)) {
+        return;     // NaN o fuera de rango: la fila queda sin valor en esta columna
+    }
+    if (c == batchStore.columns) {
+        if (c >= BATCH_MAX_COLUMNS) {
+            DEBUG_PRINTF("Lote: sin columnas libres para el tag %u\n", tag);
+            return;
+        }
+        batchStore.tags[c] = tag;
+        batchStore.decimals[c] = decimals;
+        batchStore.masks[c] = 0;
+        batchStore.columns++;
+    }
+    batchStore.values[c][row] = quantized;
+    batchStore.masks[c] |= (uint16_t)(1u << row);
+}
+
+void BatchBuffer::putReading(uint8_t row, uint8_t position, const SensorReading& reading) {
+    if (reading.subValueCount == 0) {
+        put(row, position << 2, reading.value, decimalsFor(reading.type, 0));
+    }
+    for (uint8_t i = 0; i < reading.subValueCount && i < MAX_SUBVALUES; i++) {
+        put(row, (position << 2) | i, reading.subValues[i].value, decimalsFor(reading.type, i));
+    }
+}
+
+/**
+ * @brief Posición de un sensor en la lista de habilitados (-1 si no está)
+ */
+template <typename Config>
+static int8_t positionOf(Span<const Config> enabled, const char* sensorId) {
+    for (size_t i = 0; i < enabled.size(); i++) {
+        if (strcmp(enabled[i].sensorId, sensorId) == 0) {
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
+
+void BatchBuffer::append(Span<const SensorConfig> enabled, Span<const SensorReading> readings,
+                         uint32_t timestamp) {
+    uint8_t row = beginRow(timestamp);
+    for (size_t i = 0; i < readings.size(); i++) {
+        int8_t position = positionOf(enabled, readings[i].sensorId);
+        if (position >= 0 && position < BATCH_POSITION_MODBUS) {
+            putReading(row, position, readings[i]);
+        }
+    }
+}
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+void BatchBuffer::append(Span<const SensorConfig> enabled, Span<const SensorReading> readings,
+                         Span<const ModbusSensorConfig> enabledModbus,
+                         Span<const ModbusSensorReading> modbusReadings, uint32_t timestamp) {
+    append(enabled, readings, timestamp);
+    uint8_t row = batchStore.rows - 1;
+    for (size_t i = 0; i < modbusReadings.size(); i++) {
+        const ModbusSensorReading& reading = modbusReadings[i];
+        int8_t position = positionOf(enabledModbus, reading.sensorId);
+        if (position < 0) {
+            continue;
+        }
+        uint8_t tag = (uint8_t)((BATCH_POSITION_MODBUS + position) << 2);
+        for (uint8_t j = 0; j < reading.subValueCount && j < MAX_SUBVALUES; j++) {
+            put(row, tag | j, reading.subValues[j].value, decimalsFor(reading.type, j));
+        }
+    }
+}
+#endif
+
+bool BatchBuffer::pending() {
+    return batchStore.rows > 0;
+}
+
+size_t BatchBuffer::encode(uint8_t* buffer, size_t bufferSize) {
+    _encodedRows = 0;
+    BatchFrame frame;
+
+    while (batchStore.rows > 0) {
+        // Tantas filas antiguas como quepan; el resto queda para la siguiente trama
+        for (uint8_t rows = batchStore.rows; rows > 0; rows--) {
+            frame.rows = rows;
+            frame.columnCount = 0;
+            memcpy(frame.timestamps, batchStore.timestamps, rows * sizeof(uint32_t));
+            uint16_t rowMask = (uint16_t)((1UL << rows) - 1);
+            for (uint8_t c = 0; c < batchStore.columns; c++) {
+                if ((batchStore.masks[c] & rowMask) == 0) {
+                    continue;
+                }
+                BatchColumn& column = frame.columns[frame.columnCount++];
+                column.tag = batchStore.tags[c];
+                column.decimals = batchStore.decimals[c];
+                column.presentMask = batchStore.masks[c] & rowMask;
+                memcpy(column.values, batchStore.values[c], rows * sizeof(int32_t));
+            }
+
+            size_t length = batchEncode(frame, buffer, bufferSize);
+            if (length > 0) {
+                _encodedRows = rows;
+                return length;
+            }
+        }
+        // Ni una fila cabe en la trama: se descarta para no bloquear el lote
+        DEBUG_PRINTLN("Lote: fila demasiado grande para la trama, se descarta");
+        dropRows(1);
+    }
+    return 0;
+}
+
+void BatchBuffer::markSent() {
+    dropRows(_encodedRows);
+    _encodedRows = 0;
+}
@@ -0,0 +1,163 @@
+/*******************************************************************************************
+ * Archivo: src/BootManager.cpp
+ * Descripción: Implementación de la clasificación del arranque y del estado caliente.
+ *******************************************************************************************/
+
+#include "BootManager.h"
+#include "debug.h"
+#include "esp_sleep.h"
+#include "util/crc16.h"
+#include "SlotScheduler.h"
+
+RTC_DATA_ATTR static WarmState warmState;
+
+BootMode BootManager::_mode = BOOT_MODE_COLD;
+bool BootManager::_sealAllowed = true;
+bool BootManager::_configReloaded = false;
+
+static uint16_t warmStateCrc() {
+    const uint8_t* bytes = (const uint8_t*)&warmState;
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < offsetof(WarmState, crc); i++) {
+        crc = crc16_update(crc, bytes[i]);
+    }
+    return crc;
+}
+
+BootMode BootManager::begin() {
+    switch (esp_sleep_get_wakeup_cause()) {
+        case ESP_SLEEP_WAKEUP_TIMER:
+            _mode = isValid() ? BOOT_MODE_WARM : BOOT_MODE_COLD;
+            break;
+        case ESP_SLEEP_WAKEUP_GPIO:
+#ifdef RTC_ALARM_WAKE_PIN
+            // La alarma del DS3231 equivale a un despertar por temporizador
+            if (SlotScheduler::alarmWake()) {
+                _mode = isValid() ? BOOT_MODE_WARM : BOOT_MODE_COLD;
+                break;
+            }
+#endif
+            _mode = BOOT_MODE_CONFIG;
+            break;
+        default:
+            _mode = BOOT_MODE_COLD;
+            break;
+    }
+
+    // Solo el arranque en caliente confía en el estado RTC
+    if (_mode != BOOT_MODE_WARM) {
+        warmState.magic = 0;
+        warmState.hardwareValid = 0;
+    }
+    DEBUG_PRINTF("Modo de arranque: %u\n", _mode);
+    return _mode;
+}
+
+BootMode BootManager::mode() {
+    return _mode;
+}
+
+bool BootManager::isValid() {
+    return warmState.magic == WARM_STATE_MAGIC &&
+           warmState.schemaVersion == CONFIG_SCHEMA_VERSION &&
+           warmState.crc == warmStateCrc();
+}
+
+void BootManager::seal() {
+    warmState.magic = WARM_STATE_MAGIC;
+    warmState.schemaVersion = CONFIG_SCHEMA_VERSION;
+    warmState.crc = warmStateCrc();
+}
+
+void BootManager::invalidate() {
+    warmState.magic = 0;
+    warmState.hardwareValid = 0;
+    // La configuración en RAM puede estar desactualizada: el próximo arranque será en frío
+    _sealAllowed = false;
+}
+
+void BootManager::requestConfigReload() {
+    // Queda dentro del registro sellado por commitBeforeSleep()
+    warmState.reloadConfig = 1;
+}
+
+bool BootManager::configReloaded() {
+    return _configReloaded;
+}
+
+void BootManager::storeConfig(uint32_t timeToSleep, const char* deviceId, const char* stationId,
+                              Span<const SensorConfig> normalSensors
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+                              , Span<const ModbusSensorConfig> modbusSensors
+#endif
+                              ) {
+    warmState.timeToSleep = timeToSleep;
+    strlcpy(warmState.deviceId, deviceId, sizeof(warmState.deviceId));
+    strlcpy(warmState.stationId, stationId, sizeof(warmState.stationId));
+
+    warmState.normalCount = 0;
+    for (const auto& sensor : normalSensors) {
+        if (warmState.normalCount >= MAX_NORMAL_SENSORS) {
+            break;
+        }
+        warmState.normalSensors[warmState.normalCount++] = sensor;
+    }
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    warmState.modbusCount = 0;
+    for (const auto& sensor : modbusSensors) {
+        if (warmState.modbusCount >= MAX_MODBUS_SENSORS) {
+            break;
+        }
+        warmState.modbusSensors[warmState.modbusCount++] = sensor;
+    }
+#endif
+    // El registro se sella en commitBeforeSleep(), cuando el hardware también está guardado
+    warmState.hardwareValid = 0;
+    warmState.reloadConfig = 0;
+    warmState.magic = 0;
+}
+
+bool BootManager::restoreConfig(uint32_t& timeToSleep,
+                                char* deviceId, size_t deviceIdSize,
+                                char* stationId, size_t stationIdSize,
+                                SensorConfig* normalSensors, size_t& normalCount
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+                                , ModbusSensorConfig* modbusSensors, size_t& modbusCount
+#endif
+                                ) {
+    if (_mode != BOOT_MODE_WARM) {
+        return false;
+    }
+    if (warmState.reloadConfig) {
+        _configReloaded = true;
+        return false;
+    }
+    timeToSleep = warmState.timeToSleep;
+    strlcpy(deviceId, warmState.deviceId, deviceIdSize);
+    strlcpy(stationId, warmState.stationId, stationIdSize);
+
+    normalCount = warmState.normalCount;
+    memcpy(normalSensors, warmState.normalSensors, normalCount * sizeof(SensorConfig));
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    modbusCount = warmState.modbusCount;
+    memcpy(modbusSensors, warmState.modbusSensors, modbusCount * sizeof(ModbusSensorConfig));
+#endif
+    return true;
+}
+
+bool BootManager::restoreExpander(PCA9555& ioExpander) {
+    if (_mode != BOOT_MODE_WARM || !warmState.hardwareValid) {
+        return false;
+    }
+    return ioExpander.restoreRegisters(warmState.ioConfiguration, warmState.ioOutput);
+}
+
+void BootManager::commitBeforeSleep(PCA9555& ioExpander) {
+    if (!_sealAllowed) {
+        return;
+    }
+    warmState.ioConfiguration = ioExpander.configurationRegister();
+    warmState.ioOutput = ioExpander.outputRegister();
+    warmState.hardwareValid = 1;
+    seal();
+}
@@ -0,0 +1,53 @@
+/*******************************************************************************************
+ * Archivo: src/Diagnostics.cpp
+ * Descripción: Implementación del buffer de diagnóstico en memoria RTC.
+ *******************************************************************************************/
+
+#include "Diagnostics.h"
+
+// Sobrevive al deep sleep para no perder entradas de ciclos sin envío
+RTC_DATA_ATTR static uint8_t diagBuffer[DIAG_MAX_PAYLOAD];
+RTC_DATA_ATTR static uint8_t diagLength = 0;
+
+/**
+ * @brief Elimina la entrada con la etiqueta indicada, si existe
+ */
+static void removeEntry(DiagnosticTag tag) {
+    uint8_t offset = 0;
+    while (offset + 2 <= diagLength) {
+        uint8_t entrySize = 2 + diagBuffer[offset + 1];
+        if (diagBuffer[offset] == tag) {
+            memmove(diagBuffer + offset, diagBuffer + offset + entrySize, diagLength - offset - entrySize);
+            diagLength -= entrySize;
+            return;
+        }
+        offset += entrySize;
+    }
+}
+
+bool Diagnostics::add(DiagnosticTag tag, const void* data, uint8_t length) {
+    if (diagLength > DIAG_MAX_PAYLOAD) {
+        diagLength = 0;
+    }
+    removeEntry(tag);
+    if (diagLength + 2 + length > DIAG_MAX_PAYLOAD) {
+        return false;
+    }
+    diagBuffer[diagLength++] = tag;
+    diagBuffer[diagLength++] = length;
+    memcpy(diagBuffer + diagLength, data, length);
+    diagLength += length;
+    return true;
+}
+
+bool Diagnostics::pending() {
+    return diagLength > 0 && diagLength <= DIAG_MAX_PAYLOAD;
+}
+
+Span<const uint8_t> Diagnostics::payload() {
+    return Span<const uint8_t>(diagBuffer, pending() ? diagLength : 0);
+}
+
+void Diagnostics::clear() {
+    diagLength = 0;
+}
@@ -0,0 +1,294 @@
+/*******************************************************************************************
+ * Archivo: src/DownlinkCommands.cpp
+ * Descripción: Implementación del canal de comandos por downlink.
+ *******************************************************************************************/
+
+#include "DownlinkCommands.h"
+#include <RadioLib.h>
+#include "config.h"
+#include "debug.h"
+#include "config_manager.h"
+#include "BootManager.h"
+#include "Diagnostics.h"
+
+/**
+ * @brief Copia de trabajo de la configuración: los comandos se aplican sobre ella y solo
+ *        se guarda en NVS si el downlink completo es válido. Tablas fijas acotadas por
+ *        MAX_*_SENSORS: el ciclo de envío no reserva memoria dinámica
+ */
+struct ConfigDraft {
+    bool initialized;
+    uint32_t sleepTime;
+    char deviceId[MAX_ID_LENGTH];
+    char stationId[MAX_ID_LENGTH];
+    uint32_t minInterval;
+    uint32_t maxInterval;
+    uint8_t drMin;
+    uint8_t drMax;
+    SensorConfig sensors[MAX_NORMAL_SENSORS];
+    uint8_t sensorCount;
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    ModbusSensorConfig modbusSensors[MAX_MODBUS_SENSORS];
+    uint8_t modbusCount;
+#endif
+    bool systemChanged;
+    bool intervalChanged;
+    bool linkChanged;
+    bool sensorsChanged;
+    bool modbusChanged;
+};
+
+/**
+ * @brief Lector de argumentos little-endian con control de longitud
+ */
+class CommandReader {
+public:
+    CommandReader(const uint8_t* data, size_t length) : _data(data), _length(length), _pos(0) {}
+
+    bool done() const { return _pos >= _length; }
+
+    bool readU8(uint8_t& value) {
+        if (_pos + 1 > _length) {
+            return false;
+        }
+        value = _data[_pos++];
+        return true;
+    }
+
+    bool readU32(uint32_t& value) {
+        if (_pos + 4 > _length) {
+            return false;
+        }
+        value = (uint32_t)_data[_pos] | ((uint32_t)_data[_pos + 1] << 8) |
+                ((uint32_t)_data[_pos + 2] << 16) | ((uint32_t)_data[_pos + 3] << 24);
+        _pos += 4;
+        return true;
+    }
+
+    bool readF32(float& value) {
+        uint32_t bits;
+        if (!readU32(bits)) {
+            return false;
+        }
+        memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+
+private:
+    const uint8_t* _data;
+    size_t _length;
+    size_t _pos;
+};
+
+/**
+ * @brief Campos ajustables comunes a SensorConfig y ModbusSensorConfig
+ */
+struct SensorFields {
+    bool* enable;
+    uint8_t* periodTicks;
+    uint8_t* aggWindow;
+    uint8_t* aggStats;
+    float* predictTolerance;
+    bool* changed;
+};
+
+template <typename Config>
+static bool fieldsOf(Config* configs, uint8_t count, uint8_t index, bool& changed,
+                     SensorFields& fields) {
+    if (index >= count) {
+        return false;
+    }
+    Config& config = configs[index];
+    fields.enable = &config.enable;
+    fields.periodTicks = &config.periodTicks;
+    fields.aggWindow = &config.aggWindow;
+    fields.aggStats = &config.aggStats;
+    fields.predictTolerance = &config.predictTolerance;
+    fields.changed = &changed;
+    return true;
+}
+
+static bool sensorFields(ConfigDraft& draft, uint8_t sensor, SensorFields& fields) {
+    uint8_t index = sensor & ~CMD_SENSOR_MODBUS_FLAG;
+    if (sensor & CMD_SENSOR_MODBUS_FLAG) {
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+        return fieldsOf(draft.modbusSensors, draft.modbusCount, index, draft.modbusChanged, fields);
+#else
+        return false;
+#endif
+    }
+    return fieldsOf(draft.sensors, draft.sensorCount, index, draft.sensorsChanged, fields);
+}
+
+/**
+ * @brief DR utilizable en la región configurada
+ */
+static bool validDatarate(uint8_t datarate) {
+    return datarate < RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES && LORA_REGION.payloadLenMax[datarate] > 0;
+}
+
+/**
+ * @brief Aplica un comando sobre la copia de trabajo
+ */
+static CommandStatus applyCommand(uint8_t opcode, CommandReader& reader, ConfigDraft& draft) {
+    switch (opcode) {
+        case CMD_SET_INTERVAL: {
+            uint32_t sleepTime;
+            if (!reader.readU32(sleepTime)) return CMD_STATUS_TRUNCATED;
+            if (sleepTime == 0) return CMD_STATUS_INVALID_ARGUMENT;
+            draft.sleepTime = sleepTime;
+            draft.systemChanged = true;
+            return CMD_STATUS_OK;
+        }
+        case CMD_SET_INTERVAL_BOUNDS: {
+            uint32_t minInterval, maxInterval;
+            if (!reader.readU32(minInterval) || !reader.readU32(maxInterval)) return CMD_STATUS_TRUNCATED;
+            if (minInterval == 0 || minInterval > maxInterval) return CMD_STATUS_INVALID_ARGUMENT;
+            draft.minInterval = minInterval;
+            draft.maxInterval = maxInterval;
+            draft.intervalChanged = true;
+            return CMD_STATUS_OK;
+        }
+        case CMD_SET_DR_LIMITS: {
+            uint8_t drMin, drMax;
+            if (!reader.readU8(drMin) || !reader.readU8(drMax)) return CMD_STATUS_TRUNCATED;
+            if (drMin > drMax || !validDatarate(drMin) || !validDatarate(drMax)) {
+                return CMD_STATUS_INVALID_ARGUMENT;
+            }
+            draft.drMin = drMin;
+            draft.drMax = drMax;
+            draft.linkChanged = true;
+            return CMD_STATUS_OK;
+        }
+        case CMD_SENSOR_ENABLE:
+        case CMD_SENSOR_PERIOD:
+        case CMD_SENSOR_AGGREGATE:
+        case CMD_SENSOR_TOLERANCE:
+            break;
+        default:
+            return CMD_STATUS_UNKNOWN_OPCODE;
+    }
+
+    // Comandos por sensor
+    uint8_t sensor;
+    if (!reader.readU8(sensor)) return CMD_STATUS_TRUNCATED;
+    SensorFields fields;
+    bool found = sensorFields(draft, sensor, fields);
+
+    switch (opcode) {
+        case CMD_SENSOR_ENABLE: {
+            uint8_t enable;
+            if (!reader.readU8(enable)) return CMD_STATUS_TRUNCATED;
+            if (!found || enable > 1) return CMD_STATUS_INVALID_ARGUMENT;
+            *fields.enable = enable != 0;
+            break;
+        }
+        case CMD_SENSOR_PERIOD: {
+            uint8_t periodTicks;
+            if (!reader.readU8(periodTicks)) return CMD_STATUS_TRUNCATED;
+            if (!found) return CMD_STATUS_INVALID_ARGUMENT;
+            *fields.periodTicks = periodTicks;
+            break;
+        }
+        case CMD_SENSOR_AGGREGATE: {
+            uint8_t aggWindow, aggStats;
+            if (!reader.readU8(aggWindow) || !reader.readU8(aggStats)) return CMD_STATUS_TRUNCATED;
+            if (!found) return CMD_STATUS_INVALID_ARGUMENT;
+            *fields.aggWindow = aggWindow;
+            *fields.aggStats = aggStats;
+            break;
+        }
+        default: {
+            float tolerance;
+            if (!reader.readF32(tolerance)) return CMD_STATUS_TRUNCATED;
+            if (!found || isnan(tolerance) || tolerance < 0.0f) return CMD_STATUS_INVALID_ARGUMENT;
+            *fields.predictTolerance = tolerance;
+            break;
+        }
+    }
+    *fields.changed = true;
+    return CMD_STATUS_OK;
+}
+
+static void loadDraft(ConfigDraft& draft) {
+    ConfigManager::getSystemConfig(draft.initialized, draft.sleepTime,
+                                   draft.deviceId, sizeof(draft.deviceId),
+                                   draft.stationId, sizeof(draft.stationId));
+    ConfigManager::getIntervalBounds(draft.minInterval, draft.maxInterval);
+    ConfigManager::getDatarateLimits(draft.drMin, draft.drMax);
+    draft.sensorCount = (uint8_t)ConfigManager::getAllSensorConfigs(draft.sensors, MAX_NORMAL_SENSORS);
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    draft.modbusCount = (uint8_t)ConfigManager::getAllModbusSensorConfigs(draft.modbusSensors,
+                                                                          MAX_MODBUS_SENSORS);
+#endif
+    draft.systemChanged = false;
+    draft.intervalChanged = false;
+    draft.linkChanged = false;
+    draft.sensorsChanged = false;
+    draft.modbusChanged = false;
+}
+
+static void storeDraft(const ConfigDraft& draft) {
+    if (draft.systemChanged) {
+        ConfigManager::setSystemConfig(draft.initialized, draft.sleepTime,
+                                       draft.deviceId, draft.stationId);
+    }
+    if (draft.intervalChanged) {
+        ConfigManager::setIntervalBounds(draft.minInterval, draft.maxInterval);
+    }
+    if (draft.linkChanged) {
+        ConfigManager::setDatarateLimits(draft.drMin, draft.drMax);
+    }
+    if (draft.sensorsChanged) {
+        ConfigManager::setSensorsConfigs(draft.sensors, draft.sensorCount);
+    }
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    if (draft.modbusChanged) {
+        ConfigManager::setModbusSensorsConfigs(draft.modbusSensors, draft.modbusCount);
+    }
+#endif
+}
+
+void DownlinkCommands::handle(const uint8_t* payload, size_t length) {
+    CommandAckDiag ack;
+    memset(&ack, 0, sizeof(ack));
+
+    if (length == 0) {
+        ack.status = CMD_STATUS_EMPTY;
+        Diagnostics::add(DIAG_TAG_COMMAND_ACK, &ack, sizeof(ack));
+        return;
+    }
+    ack.seq = payload[0];
+
+    static ConfigDraft draft;     // ~1 KB: fuera de la pila de loop()
+    loadDraft(draft);
+
+    CommandReader reader(payload + 1, length - 1);
+    uint8_t applied = 0;
+    CommandStatus status = CMD_STATUS_OK;
+    uint8_t opcode = 0;
+    while (!reader.done()) {
+        reader.readU8(opcode);
+        status = applyCommand(opcode, reader, draft);
+        if (status != CMD_STATUS_OK) {
+            break;
+        }
+        applied++;
+    }
+
+    ack.status = status;
+    if (status == CMD_STATUS_OK) {
+        storeDraft(draft);
+        ack.applied = applied;
+        if (applied > 0) {
+            // El siguiente arranque relee la configuración de NVS sin perder el estado RTC
+            BootManager::requestConfigReload();
+        }
+        DEBUG_PRINTF("Downlink de comandos %u: %u aplicados\n", ack.seq, applied);
+    } else {
+        ack.failedOpcode = opcode;
+        DEBUG_PRINTF("Downlink de comandos %u rechazado: opcode 0x%02X, estado %u\n",
+                     ack.seq, opcode, status);
+    }
+    Diagnostics::add(DIAG_TAG_COMMAND_ACK, &ack, sizeof(ack));
+}
@@ -0,0 +1,193 @@
+/*******************************************************************************************
+ * Archivo: src/DualPredictor.cpp
+ * Descripción: Implementación de la supresión por predicción dual.
+ *******************************************************************************************/
+
+#include "DualPredictor.h"
+#include "debug.h"
+#include "utilities.h"
+#include "util/dual_predictor.h"
+#include "util/fnv1a.h"
+
+#define DUAL_PREDICTOR_MAGIC    0xD0A2
+
+/**
+ * @brief Estado que sobrevive al deep sleep. Los canales se asignan al primer uso y se
+ *        identifican por el hash de sensorId y subvalor.
+ */
+struct DualPredictorStore {
+    uint16_t magic;
+    bool resetPending;          // Modelos descartados sin que el servidor lo sepa aún
+    uint8_t used;
+    uint32_t ids[PREDICT_MAX_CHANNELS];
+    DualPredictorState states[PREDICT_MAX_CHANNELS];
+};
+
+RTC_DATA_ATTR static DualPredictorStore predictorStore;
+
+uint8_t DualPredictor::_sent = 0;
+uint8_t DualPredictor::_suppressed = 0;
+uint8_t DualPredictor::_pendingCount = 0;
+uint32_t DualPredictor::_pendingTime = 0;
+int8_t DualPredictor::_pendingSlots[PREDICT_MAX_CHANNELS];
+int32_t DualPredictor::_pendingValues[PREDICT_MAX_CHANNELS];
+SensorReading DualPredictor::_sendNormal[MAX_NORMAL_SENSORS];
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+ModbusSensorReading DualPredictor::_sendModbus[MAX_MODBUS_SENSORS];
+#endif
+
+void DualPredictor::begin(BootMode bootMode) {
+    if (bootMode == BOOT_MODE_WARM && predictorStore.magic == DUAL_PREDICTOR_MAGIC &&
+        predictorStore.used <= PREDICT_MAX_CHANNELS) {
+        return;
+    }
+    memset(&predictorStore, 0, sizeof(predictorStore));
+    predictorStore.magic = DUAL_PREDICTOR_MAGIC;
+    predictorStore.resetPending = true;
+}
+
+void DualPredictor::beginCycle() {
+    _sent = 0;
+    _suppressed = 0;
+    _pendingCount = 0;
+}
+
+bool DualPredictor::resetPending() {
+    return predictorStore.resetPending;
+}
+
+void DualPredictor::commit() {
+    for (uint8_t i = 0; i < _pendingCount; i++) {
+        dualPredictorUpdate(predictorStore.states[_pendingSlots[i]], _pendingTime, _pendingValues[i]);
+    }
+    _pendingCount = 0;
+    predictorStore.resetPending = false;
+}
+
+bool DualPredictor::silent() {
+    return _suppressed > 0 && _sent == 0;
+}
+
+/**
+ * @brief Canal del modelo (-1 si no queda espacio)
+ */
+static int8_t slotFor(const char* sensorId, uint8_t subIndex) {
+    uint32_t id = fnv1a32Byte(fnv1a32(sensorId), subIndex);
+    uint8_t slot = 0;
+    while (slot < predictorStore.used && predictorStore.ids[slot] != id) {
+        slot++;
+    }
+    if (slot == predictorStore.used) {
+        if (slot >= PREDICT_MAX_CHANNELS) {
+            return -1;
+        }
+        predictorStore.ids[slot] = id;
+        dualPredictorReset(predictorStore.states[slot]);
+        predictorStore.used++;
+    }
+    return (int8_t)slot;
+}
+
+bool DualPredictor::mustSend(const char* sensorId, float tolerance, const float* values, uint8_t count,
+                             uint32_t timestamp) {
+    if (tolerance <= 0.0f || count == 0) {
+        return true;    // Sensor sin predicción: se envía siempre
+    }
+
+    // El modelo trabaja con el mismo texto que recibe el servidor
+    int8_t slots[MAX_SUBVALUES];
+    int32_t milli[MAX_SUBVALUES];
+    bool valid[MAX_SUBVALUES];
+    int32_t toleranceMilli = (int32_t)(tolerance * 1000.0f + 0.5f);
+    bool send = false;
+    for (uint8_t i = 0; i < count; i++) {
+        char text[16];
+        formatFloatTo3Decimals(values[i], text, sizeof(text));
+        valid[i] = dualPredictorParse(text, milli[i]);
+        slots[i] = slotFor(sensorId, i);
+        if (!valid[i] || slots[i] < 0 ||
+            dualPredictorMispredicts(predictorStore.states[slots[i]], PREDICT_MODEL, timestamp,
+                                     milli[i], toleranceMilli, PREDICT_MAX_SILENCE_S)) {
+            send = true;
+        }
+    }
+
+    if (!send) {
+        return false;
+    }
+    // El modelo solo avanza con lo que el servidor recibió: se aplica en commit()
+    _pendingTime = timestamp;
+    for (uint8_t i = 0; i < count; i++) {
+        if (valid[i] && slots[i] >= 0 && _pendingCount < PREDICT_MAX_CHANNELS) {
+            _pendingSlots[_pendingCount] = slots[i];
+            _pendingValues[_pendingCount++] = milli[i];
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Tolerancia configurada para un sensor (0 si no se encuentra)
+ */
+template <typename Config>
+static float toleranceOf(Span<const Config> configs, const char* sensorId) {
+    for (size_t i = 0; i < configs.size(); i++) {
+        if (strcmp(configs[i].sensorId, sensorId) == 0) {
+            return configs[i].predictTolerance;
+        }
+    }
+    return 0.0f;
+}
+
+void DualPredictor::filter(Span<const SensorConfig> configs, Span<const SensorReading>& readings,
+                           uint32_t timestamp) {
+    size_t sendCount = 0;
+    for (size_t i = 0; i < readings.size(); i++) {
+        const SensorReading& reading = readings[i];
+        float values[MAX_SUBVALUES];
+        uint8_t count = 0;
+        if (reading.subValueCount == 0) {
+            values[count++] = reading.value;
+        }
+        for (uint8_t j = 0; j < reading.subValueCount && count < MAX_SUBVALUES; j++) {
+            values[count++] = reading.subValues[j].value;
+        }
+
+        if (mustSend(reading.sensorId, toleranceOf(configs, reading.sensorId), values, count, timestamp)) {
+            if (sendCount < MAX_NORMAL_SENSORS) {
+                _sendNormal[sendCount++] = reading;
+            }
+            _sent++;
+        } else {
+            DEBUG_PRINTF("Predicción dual: %s dentro de tolerancia, no se envía\n", reading.sensorId);
+            _suppressed++;
+        }
+    }
+    readings = Span<const SensorReading>(_sendNormal, sendCount);
+}
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+void DualPredictor::filter(Span<const ModbusSensorConfig> configs, Span<const ModbusSensorReading>& readings,
+                           uint32_t timestamp) {
+    size_t sendCount = 0;
+    for (size_t i = 0; i < readings.size(); i++) {
+        const ModbusSensorReading& reading = readings[i];
+        float values[MAX_SUBVALUES];
+        uint8_t count = 0;
+        for (uint8_t j = 0; j < reading.subValueCount && count < MAX_SUBVALUES; j++) {
+            values[count++] = reading.subValues[j].value;
+        }
+
+        if (mustSend(reading.sensorId, toleranceOf(configs, reading.sensorId), values, count, timestamp)) {
+            if (sendCount < MAX_MODBUS_SENSORS) {
+                _sendModbus[sendCount++] = reading;
+            }
+            _sent++;
+        } else {
+            DEBUG_PRINTF("Predicción dual: %s dentro de tolerancia, no se envía\n", reading.sensorId);
+            _suppressed++;
+        }
+    }
+    readings = Span<const ModbusSensorReading>(_sendModbus, sendCount);
+}
+#endif
@@ -5,8 +5,10 @@
 
 #include "HardwareManager.h"
 #include "debug.h"
+#include "SpiBusManager.h"
+#include "BootManager.h"
 // time execution < 10 ms
-bool HardwareManager::initHardware(PCA9555& ioExpander, PowerManager& powerManager, SHT31& sht30Sensor, SPIClass& spi, const std::vector<SensorConfig>& enabledNormalSensors) {
+bool HardwareManager::initHardware(PCA9555& ioExpander, PowerManager& powerManager, SHT31& sht30Sensor, SPIClass& spi, Span<const SensorConfig> enabledNormalSensors, bool warmBoot) {
     #ifdef DEVICE_TYPE_ANALOGIC || DEVICE_TYPE_BASIC
     // Configurar GPIO one wire con pull-up
     pinMode(ONE_WIRE_BUS, INPUT_PULLUP);
@@ -15,8 +17,23 @@ bool HardwareManager::initHardware(PCA9555& ioExpander, PowerManager& powerManag
     // Inicializar I2C con pines definidos
     Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
     
-    // Inicializar SPI con pines definidos
-    spi.begin(SPI_SCK_PIN, SPI_MISO_PIN, SPI_MOSI_PIN);
+    // Inicializar el bus SPI compartido con pines definidos
+    SpiBusManager::begin(spi);
+
+    // Despertar en caliente: no se repite lo que ya está en el estado guardado al dormir.
+    //  - restoreExpander reescribe los registros de dirección y salida del PCA9555, tomados
+    //    después de allPowerOff(): incluyen los CS del expansor en alto (initializeSPISSPins)
+    //    y los pines de riel como salida y apagados (PowerManager::begin; refCount ya parte
+    //    de cero en el constructor).
+    //  - El SHT30 va en el riel de 3V3, que se apaga al dormir: cada encendido del riel le
+    //    hace un reset por alimentación, así que el reset por comando solo se hace en frío.
+    //  - El NSS del LoRa es un GPIO nativo: su hold se liberó al arrancar y hay que volver a
+    //    configurarlo.
+    if (warmBoot && BootManager::restoreExpander(ioExpander)) {
+        pinMode(LORA_NSS_PIN, OUTPUT);
+        digitalWrite(LORA_NSS_PIN, HIGH);
+        return true;
+    }
 
     // Verificar si hay algún sensor SHT30
     bool sht30SensorEnabled = false;
@@ -0,0 +1,52 @@
+#include "HeapProbe.h"
+
+#ifdef HEAP_PROBE_ENABLED
+#include <stddef.h>
+#include <freertos/FreeRTOS.h>
+
+// Contadores actualizados por los wrappers del enlazador. Asignan la tarea del loop y las
+// de BLE/WiFi: el incremento va en sección crítica (el C3 no tiene instrucciones atómicas)
+static volatile uint32_t heapAllocations = 0;
+static uint32_t heapMark = 0;
+static portMUX_TYPE heapProbeMux = portMUX_INITIALIZER_UNLOCKED;
+
+static inline void countAllocation() {
+    portENTER_CRITICAL_SAFE(&heapProbeMux);
+    heapAllocations++;
+    portEXIT_CRITICAL_SAFE(&heapProbeMux);
+}
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    countAllocation();
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    countAllocation();
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    countAllocation();
+    return __real_realloc(ptr, size);
+}
+}
+
+void HeapProbe::mark() {
+    heapMark = heapAllocations;
+}
+
+uint32_t HeapProbe::sinceMark() {
+    return heapAllocations - heapMark;
+}
+
+uint32_t HeapProbe::allocationCount() {
+    return heapAllocations;
+}
+
+#endif // HEAP_PROBE_ENABLED
@@ -0,0 +1,164 @@
+/*******************************************************************************************
+ * Archivo: src/IntervalPolicy.cpp
+ * Descripción: Implementación del intervalo de muestreo adaptativo.
+ *******************************************************************************************/
+
+#include "IntervalPolicy.h"
+#include <cmath>
+#include "debug.h"
+#include "config_manager.h"
+#include "MeasurementContext.h"
+#include "Diagnostics.h"
+#include "util/fnv1a.h"
+
+#define INTERVAL_POLICY_MAGIC   0x1A7E
+
+/**
+ * @brief Estado que sobrevive al deep sleep
+ */
+struct IntervalPolicyState {
+    uint16_t magic;
+    uint8_t band;                               // Banda de batería actual
+    uint8_t trackedCount;
+    uint32_t minInterval;                       // Límites leídos de NVS al cargar la configuración
+    uint32_t maxInterval;
+    uint32_t lastInterval;                      // Último intervalo aplicado
+    uint32_t trackedIds[INTERVAL_POLICY_TRACKED];   // Hash del sensorId de cada valor seguido
+    float lastValues[INTERVAL_POLICY_TRACKED];  // Primer valor de cada lectura en su última medición
+};
+
+RTC_DATA_ATTR static IntervalPolicyState policyState;
+
+static const float kBandThresholds[BATTERY_BAND_COUNT - 1] = {
+    BATTERY_BAND_GOOD_V, BATTERY_BAND_LOW_V, BATTERY_BAND_CRITICAL_V
+};
+static const uint8_t kBandStretch[BATTERY_BAND_COUNT] = BATTERY_BAND_STRETCH;
+
+static uint8_t bandFor(float voltage) {
+    for (uint8_t i = 0; i < BATTERY_BAND_COUNT - 1; i++) {
+        if (voltage >= kBandThresholds[i]) {
+            return i;
+        }
+    }
+    return BATTERY_BAND_COUNT - 1;
+}
+
+void IntervalPolicy::begin(BootMode bootMode) {
+    if (bootMode == BOOT_MODE_WARM && policyState.magic == INTERVAL_POLICY_MAGIC) {
+        if (BootManager::configReloaded()) {
+            // Un downlink cambió los límites: se releen sin perder la banda ni los valores
+            ConfigManager::getIntervalBounds(policyState.minInterval, policyState.maxInterval);
+        }
+        return;
+    }
+    memset(&policyState, 0, sizeof(policyState));
+    ConfigManager::getIntervalBounds(policyState.minInterval, policyState.maxInterval);
+    policyState.magic = INTERVAL_POLICY_MAGIC;
+}
+
+uint8_t IntervalPolicy::batteryBand(float voltage, uint8_t currentBand) {
+    if (std::isnan(voltage)) {
+        return currentBand;
+    }
+    uint8_t band = bandFor(voltage);
+    if (band < currentBand) {
+        // Volver a una banda mejor solo con margen, para no oscilar en el umbral
+        uint8_t withMargin = bandFor(voltage - BATTERY_BAND_HYSTERESIS_V);
+        band = (withMargin < currentBand) ? withMargin : currentBand;
+    }
+    return band;
+}
+
+float IntervalPolicy::trackChange(const char* sensorId, float value) {
+    // Cada sensor tiene su propio periodo: el valor anterior se busca por identificador
+    uint32_t id = fnv1a32(sensorId);
+    uint8_t index = 0;
+    while (index < policyState.trackedCount && policyState.trackedIds[index] != id) {
+        index++;
+    }
+    if (index >= INTERVAL_POLICY_TRACKED) {
+        return 0.0f;
+    }
+    float change = 0.0f;
+    float previous = policyState.lastValues[index];
+    if (index < policyState.trackedCount && !std::isnan(previous) && !std::isnan(value)) {
+        float scale = fabsf(previous);
+        if (scale < ADAPTIVE_CHANGE_FLOOR) {
+            scale = ADAPTIVE_CHANGE_FLOOR;
+        }
+        change = fabsf(value - previous) / scale;
+    }
+    if (index == policyState.trackedCount) {
+        policyState.trackedIds[index] = id;
+        policyState.trackedCount++;
+    }
+    policyState.lastValues[index] = value;
+    return change;
+}
+
+uint32_t IntervalPolicy::update(uint32_t baseInterval,
+                                Span<const SensorReading> normalReadings
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+                                , Span<const ModbusSensorReading> modbusReadings
+#endif
+                                ) {
+#if ADAPTIVE_INTERVAL_ENABLED
+    float battery = MeasurementContext::get(MEAS_INPUT_BATTERY_VOLTAGE);
+    uint8_t band = batteryBand(battery, policyState.band);
+
+    // Mayor cambio relativo respecto a la medición anterior de cada sensor (primer valor)
+    float maxChange = 0.0f;
+    for (const SensorReading& reading : normalReadings) {
+        float value = (reading.subValueCount > 0) ? reading.subValues[0].value : reading.value;
+        float change = trackChange(reading.sensorId, value);
+        if (change > maxChange) {
+            maxChange = change;
+        }
+    }
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    for (const ModbusSensorReading& reading : modbusReadings) {
+        float value = (reading.subValueCount > 0) ? reading.subValues[0].value : NAN;
+        float change = trackChange(reading.sensorId, value);
+        if (change > maxChange) {
+            maxChange = change;
+        }
+    }
+#endif
+
+    uint8_t reasons = 0;
+    uint32_t interval = baseInterval * kBandStretch[band];
+    if (kBandStretch[band] > 1) {
+        reasons |= INTERVAL_REASON_BATTERY;
+    }
+    // Con batería crítica no se acorta: la prioridad es no quedarse sin energía
+    if (maxChange > ADAPTIVE_FAST_CHANGE_RATIO && band < BATTERY_BAND_COUNT - 2) {
+        interval /= ADAPTIVE_FAST_CHANGE_DIVISOR;
+        reasons |= INTERVAL_REASON_FAST_CHANGE;
+    }
+    if (interval < policyState.minInterval) {
+        interval = policyState.minInterval;
+        reasons |= INTERVAL_REASON_CLAMPED;
+    } else if (policyState.maxInterval != 0 && interval > policyState.maxInterval) {
+        interval = policyState.maxInterval;
+        reasons |= INTERVAL_REASON_CLAMPED;
+    }
+
+    // Registrar solo los cambios de decisión
+    if (interval != policyState.lastInterval || band != policyState.band) {
+        IntervalPolicyDiag diag;
+        diag.interval = interval;
+        diag.batteryMv = std::isnan(battery) ? 0 : (uint16_t)(battery * 1000.0f);
+        diag.band = band;
+        diag.reasons = reasons;
+        diag.changePermille = (uint16_t)((maxChange > 65.0f ? 65.0f : maxChange) * 1000.0f);
+        Diagnostics::add(DIAG_TAG_INTERVAL_POLICY, &diag, sizeof(diag));
+        DEBUG_PRINTF("Intervalo adaptativo: %lu s (banda %u, motivos 0x%02X, cambio %u‰)\n",
+                     (unsigned long)interval, band, reasons, diag.changePermille);
+    }
+    policyState.band = band;
+    policyState.lastInterval = interval;
+    return interval;
+#else
+    return baseInterval;
+#endif
+}
@@ -0,0 +1,120 @@
+/*******************************************************************************************
+ * Archivo: src/JoinPolicy.cpp
+ * Descripción: Implementación del back-off de join y la memoria de sub-banda.
+ *******************************************************************************************/
+
+#include "JoinPolicy.h"
+#include <Preferences.h>
+#include "debug.h"
+
+#define JOIN_POLICY_MAGIC       0x1015B0FFUL
+#define JOIN_NVS_NAMESPACE      "radiolib"
+#define JOIN_NVS_KEY_SUBBAND    "subband"
+
+/**
+ * @brief Estado que sobrevive al deep sleep y a los resets sin pérdida de alimentación
+ *        (brown-out, WDT, pánico, esp_restart). RTC_NOINIT_ATTR: el bootloader no lo
+ *        reinicia, así que tras encender la placa solo el magic de 32 bits lo valida.
+ */
+struct JoinPolicyState {
+    uint32_t magic;
+    uint8_t goodSubBand;        // Última sub-banda con join correcto
+    uint16_t failures;          // Joins fallidos seguidos
+    uint32_t nextAttempt;       // Hora del DS3231 a partir de la que se puede reintentar
+};
+
+RTC_NOINIT_ATTR static JoinPolicyState joinState;
+
+RTC_DS3231* JoinPolicy::_rtc = nullptr;
+
+void JoinPolicy::begin(RTC_DS3231& rtc, BootMode bootMode) {
+    _rtc = &rtc;
+    if (bootMode != BOOT_MODE_COLD && joinState.magic == JOIN_POLICY_MAGIC) {
+        return;
+    }
+    if (joinState.magic != JOIN_POLICY_MAGIC) {
+        memset(&joinState, 0, sizeof(joinState));
+        joinState.magic = JOIN_POLICY_MAGIC;
+    }
+
+    Preferences store;
+    store.begin(JOIN_NVS_NAMESPACE, true);
+    joinState.goodSubBand = store.getUChar(JOIN_NVS_KEY_SUBBAND, LORA_SUBBAND);
+    store.end();
+    if (joinState.goodSubBand > JOIN_SUBBAND_COUNT) {
+        joinState.goodSubBand = LORA_SUBBAND;
+    }
+}
+
+uint32_t JoinPolicy::now() {
+    return _rtc ? _rtc->now().unixtime() : 0;
+}
+
+uint8_t JoinPolicy::subBand() {
+    if (joinState.goodSubBand == 0) {
+        return 0;   // Banda dinámica o elección de RadioLib: nada que explorar
+    }
+#if JOIN_SUBBAND_SCAN
+    // Empezar por la sub-banda conocida y recorrer el resto según los fallos acumulados
+    uint16_t step = joinState.failures / JOIN_ATTEMPTS_PER_SUBBAND;
+    return (uint8_t)((joinState.goodSubBand - 1 + step) % JOIN_SUBBAND_COUNT) + 1;
+#else
+    return joinState.goodSubBand;
+#endif
+}
+
+bool JoinPolicy::mayJoin() {
+    if (joinState.failures == 0) {
+        return true;
+    }
+    uint32_t current = now();
+    // Un reloj que retrocede (DS3231 sin hora) no debe bloquear el join indefinidamente
+    return current >= joinState.nextAttempt ||
+           joinState.nextAttempt - current > JOIN_BACKOFF_MAX_S + JOIN_BACKOFF_MAX_S / 2;
+}
+
+void JoinPolicy::onJoinFailed() {
+    if (joinState.failures < UINT16_MAX) {
+        joinState.failures++;
+    }
+    uint16_t failures = joinState.failures;
+
+    uint8_t shift = failures > 16 ? 15 : (uint8_t)(failures - 1);
+    uint32_t backoff = (uint32_t)JOIN_BACKOFF_BASE_S << shift;
+    if (backoff > JOIN_BACKOFF_MAX_S || (backoff >> shift) != JOIN_BACKOFF_BASE_S) {
+        backoff = JOIN_BACKOFF_MAX_S;
+    }
+    int32_t jitter = (int32_t)(backoff * JOIN_BACKOFF_JITTER_PERCENT / 100);
+    if (jitter > 0) {
+        backoff += random(-jitter, jitter + 1);
+    }
+    joinState.nextAttempt = now() + backoff;
+
+    DEBUG_PRINTF("Join fallido %u: siguiente intento en %lu s (sub-banda %u)\n",
+                 failures, (unsigned long)backoff, subBand());
+}
+
+void JoinPolicy::onJoinSucceeded() {
+    uint8_t used = subBand();
+    joinState.failures = 0;
+    joinState.nextAttempt = 0;
+    if (used == joinState.goodSubBand) {
+        return;
+    }
+    joinState.goodSubBand = used;
+
+    Preferences store;
+    store.begin(JOIN_NVS_NAMESPACE, false);
+    store.putUChar(JOIN_NVS_KEY_SUBBAND, used);
+    store.end();
+    DEBUG_PRINTF("Sub-banda %u guardada\n", used);
+}
+
+uint32_t JoinPolicy::retrySleep(uint32_t interval) {
+    if (joinState.failures == 0) {
+        return interval;
+    }
+    uint32_t current = now();
+    uint32_t wait = current < joinState.nextAttempt ? joinState.nextAttempt - current : 0;
+    return wait > interval ? wait : interval;
+}
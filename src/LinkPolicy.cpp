@@ -0,0 +1,207 @@
+/*******************************************************************************************
+ * Archivo: src/LinkPolicy.cpp
+ * Descripción: Implementación de la política de DR y potencia según el margen del enlace.
+ *******************************************************************************************/
+
+#include "LinkPolicy.h"
+#include "debug.h"
+#include "Diagnostics.h"
+#include "config_manager.h"
+
+#define LINK_POLICY_MAGIC       0x11AC
+#define LINK_POWER_STEP_DB      2       // Paso de potencia de LoRaWAN
+#define LINK_DR_STEP_DB         3       // Ganancia aproximada por SF (2,5 dB), redondeada arriba
+
+/**
+ * @brief Estado que sobrevive al deep sleep
+ */
+struct LinkPolicyState {
+    uint16_t magic;
+    uint8_t sinceCheck;             // Uplinks de datos desde el último LinkCheck
+    uint8_t drMin;                  // Límites de DR configurados (ConfigManager)
+    uint8_t drMax;
+    LinkStats stats;
+};
+
+RTC_DATA_ATTR static LinkPolicyState linkState;
+
+static void loadDatarateLimits() {
+    ConfigManager::getDatarateLimits(linkState.drMin, linkState.drMax);
+    if (linkState.drMin > linkState.drMax) {
+        linkState.drMin = LINK_DR_MIN;
+        linkState.drMax = LINK_DR_MAX;
+    }
+}
+
+void LinkPolicy::begin(BootMode bootMode) {
+    if (bootMode == BOOT_MODE_WARM && linkState.magic == LINK_POLICY_MAGIC) {
+        if (BootManager::configReloaded()) {
+            // Un downlink cambió el rango de DR: se conserva lo aprendido dentro del nuevo rango
+            loadDatarateLimits();
+            linkState.stats.datarate = constrain(linkState.stats.datarate,
+                                                 linkState.drMin, linkState.drMax);
+        }
+        return;
+    }
+    memset(&linkState, 0, sizeof(linkState));
+    linkState.magic = LINK_POLICY_MAGIC;
+    loadDatarateLimits();
+    linkState.stats.datarate = constrain(LINK_DR_START, linkState.drMin, linkState.drMax);
+    linkState.stats.txPower = LINK_TX_POWER_MAX;
+    linkState.stats.lastMargin = LINK_MARGIN_UNKNOWN;
+    linkState.sinceCheck = LINK_CHECK_EVERY;    // Medir el enlace en el primer uplink
+}
+
+const LinkStats& LinkPolicy::stats() {
+    return linkState.stats;
+}
+
+/**
+ * @brief DR más robusto en el que cabe el payload junto con los comandos MAC
+ */
+static uint8_t minDatarateFor(size_t payloadLength) {
+    for (uint8_t dr = linkState.drMin; dr <= linkState.drMax; dr++) {
+        if (payloadLength + LINK_FOPTS_RESERVE <= LORA_REGION.payloadLenMax[dr]) {
+            return dr;
+        }
+    }
+    return linkState.drMax;
+}
+
+/**
+ * @brief Umbral de demodulación (SNR en dB) del SF de un DR de 125 kHz
+ */
+static float demodFloorDb(uint8_t datarate) {
+    int8_t sf = LINK_DR0_SF - (int8_t)datarate;
+    return -5.0f - 2.5f * (float)(sf - 6);
+}
+
+uint8_t LinkPolicy::datarateFor(size_t payloadLength) {
+    uint8_t datarate = linkState.stats.datarate;
+    uint8_t needed = minDatarateFor(payloadLength);
+    if (needed > datarate) {
+        datarate = needed;      // Solo para este uplink: la política no cambia
+    }
+    return datarate;
+}
+
+void LinkPolicy::apply(LoRaWANNode& node, size_t payloadLength) {
+#if LINK_NETWORK_ADR
+    (void)payloadLength;
+    node.setADR(true);
+#else
+    node.setADR(false);
+    node.setDatarate(datarateFor(payloadLength));
+    node.setTxPower(linkState.stats.txPower);
+#endif
+}
+
+bool LinkPolicy::requestLinkCheck(LoRaWANNode& node) {
+    // Con pérdidas recientes se mide en cada uplink hasta recuperar respuesta
+    if (linkState.sinceCheck + 1 < LINK_CHECK_EVERY && linkState.stats.lossStreak == 0) {
+        linkState.sinceCheck++;
+        return false;
+    }
+    if (node.sendMacCommandReq(RADIOLIB_LORAWAN_MAC_LINK_CHECK) != RADIOLIB_ERR_NONE) {
+        return false;
+    }
+    linkState.sinceCheck = 0;
+    linkState.stats.linkChecks++;
+    return true;
+}
+
+void LinkPolicy::applyMargin(int8_t margin) {
+    LinkStats& stats = linkState.stats;
+    int16_t excess = (int16_t)margin - LINK_TARGET_MARGIN_DB;
+
+    // Un paso por medición: primero menos airtime, luego menos potencia; al faltar margen,
+    // primero más potencia y luego un DR más robusto
+    if (excess >= LINK_DR_STEP_DB && stats.datarate < linkState.drMax) {
+        stats.datarate++;
+    } else if (excess >= LINK_POWER_STEP_DB && stats.txPower - LINK_POWER_STEP_DB >= LINK_TX_POWER_MIN) {
+        stats.txPower -= LINK_POWER_STEP_DB;
+    } else if (excess < 0 && stats.txPower + LINK_POWER_STEP_DB <= LINK_TX_POWER_MAX) {
+        stats.txPower += LINK_POWER_STEP_DB;
+    } else if (excess < 0 && stats.datarate > linkState.drMin) {
+        stats.datarate--;
+    }
+}
+
+void LinkPolicy::fallBack() {
+    LinkStats& stats = linkState.stats;
+    if (stats.txPower < LINK_TX_POWER_MAX) {
+        stats.txPower = LINK_TX_POWER_MAX;
+    } else if (stats.datarate > linkState.drMin) {
+        stats.datarate--;
+    }
+    stats.lossStreak = 0;
+}
+
+void LinkPolicy::onUplink(LoRaWANNode& node, int16_t state, bool linkCheckRequested,
+                          const LoRaWANEvent_t& downEvent, float snr) {
+    LinkStats& stats = linkState.stats;
+    uint8_t previousDr = stats.datarate;
+    int8_t previousPower = stats.txPower;
+
+    if (state != RADIOLIB_ERR_NONE && state != RADIOLIB_LORAWAN_NO_DOWNLINK) {
+        return;     // El uplink no salió: no hay información del enlace
+    }
+    stats.uplinks++;
+
+    bool measured = false;
+    if (state == RADIOLIB_ERR_NONE) {
+        stats.downlinks++;
+        stats.lastRssi = downEvent.power;
+        stats.lastSnrQuarterDb = (int8_t)constrain(snr * 4.0f, -128.0f, 127.0f);
+
+        uint8_t margin = 0;
+        uint8_t gateways = 0;
+        if (linkCheckRequested && node.getMacLinkCheckAns(&margin, &gateways) == RADIOLIB_ERR_NONE) {
+            stats.linkAnswers++;
+            stats.lastGatewayCount = gateways;
+            stats.lastMargin = (int8_t)(margin > 127 ? 127 : margin);
+            measured = true;
+        } else if (!isnan(snr)) {
+            // Sin LinkCheck: estimar el margen de uplink con el SNR del downlink
+            float estimate = snr - demodFloorDb(previousDr) + LINK_DOWNLINK_SNR_OFFSET_DB;
+            stats.lastMargin = (int8_t)constrain(estimate, -127.0f, 127.0f);
+            measured = true;
+        }
+    }
+
+    if (measured) {
+        stats.lossStreak = 0;   // Hubo downlink: el enlace funciona en ambos sentidos
+    } else if (linkCheckRequested) {
+        stats.lossStreak++;
+    }
+
+#if !LINK_NETWORK_ADR
+    if (measured) {
+        applyMargin(stats.lastMargin);
+    } else if (stats.lossStreak >= LINK_LOSSES_BEFORE_FALLBACK) {
+        DEBUG_PRINTF("Enlace: %u LinkCheck sin respuesta, se retrocede un paso\n", stats.lossStreak);
+        fallBack();
+    }
+#endif
+
+    if (stats.datarate != previousDr || stats.txPower != previousPower) {
+        report();
+    }
+}
+
+void LinkPolicy::report() {
+    const LinkStats& stats = linkState.stats;
+    LinkPolicyDiag diag;
+    diag.datarate = stats.datarate;
+    diag.txPower = stats.txPower;
+    diag.margin = stats.lastMargin;
+    diag.gatewayCount = stats.lastGatewayCount;
+    diag.rssi = stats.lastRssi;
+    diag.snrQuarterDb = stats.lastSnrQuarterDb;
+    diag.lossStreak = stats.lossStreak;
+    diag.uplinks = stats.uplinks;
+    diag.linkAnswers = stats.linkAnswers;
+    Diagnostics::add(DIAG_TAG_LINK_POLICY, &diag, sizeof(diag));
+    DEBUG_PRINTF("Enlace: DR%u, %d dBm (margen %d dB, %u gateways)\n",
+                 stats.datarate, stats.txPower, stats.lastMargin, stats.lastGatewayCount);
+}
@@ -14,7 +14,18 @@
 #include "config.h"     // Incluido para acceder a MAX_PAYLOAD
 #include "sensor_types.h"  // Incluido para acceder a ModbusSensorReading
 #include "config_manager.h"
-#include "sensors/BatterySensor.h"
+#include "MeasurementContext.h"
+#include "Diagnostics.h"
+#include "SlotScheduler.h"
+#include "Aggregator.h"
+#include "BatchBuffer.h"
+#include "LinkPolicy.h"
+#include "DownlinkCommands.h"
+#include "AirtimeBudget.h"
+#include "TxScheduler.h"
+#include "SessionStore.h"
+#include "JoinPolicy.h"
+#include "DualPredictor.h"
 
 // Inicialización de variables estáticas
 LoRaWANNode* LoRaManager::node = nullptr;
@@ -22,8 +33,8 @@ SX1262* LoRaManager::radioModule = nullptr;
 
 // Referencias externas
 extern RTC_DATA_ATTR uint8_t LWsession[RADIOLIB_LORAWAN_SESSION_BUF_SIZE];
-extern RTC_DATA_ATTR uint16_t bootCountSinceUnsuccessfulJoin;
 extern RTC_DS3231 rtc;
+extern SX1262 radio;
 
 int16_t LoRaManager::begin(SX1262* radio, const LoRaWANBand_t* region, uint8_t subBand) {
     radioModule = radio;
@@ -41,20 +52,12 @@ int16_t LoRaManager::lwActivate(LoRaWANNode& node) {
     int16_t state = RADIOLIB_ERR_UNKNOWN;
     Preferences store;
     
-    // Obtener configuración LoRa
-    LoRaConfig loraConfig = ConfigManager::getLoRaConfig();
-    
-    // Convertir strings de EUIs a uint64_t
+    // EUIs y claves guardados en binario (sin parsear texto en cada join)
     uint64_t joinEUI = 0, devEUI = 0;
-    if (!parseEUIString(loraConfig.joinEUI.c_str(), &joinEUI) ||
-        !parseEUIString(loraConfig.devEUI.c_str(), &devEUI)) {
+    uint8_t nwkKey[16], appKey[16];
+    if (!ConfigManager::getLoRaKeys(joinEUI, devEUI, nwkKey, appKey)) {
         return state;
     }
-    
-    // Parsear las claves
-    uint8_t nwkKey[16], appKey[16];
-    parseKeyString(loraConfig.nwkKey, nwkKey, 16);
-    parseKeyString(loraConfig.appKey, appKey, 16);
 
     // Configurar la sesión OTAA
     node.beginOTAA(joinEUI, devEUI, nwkKey, appKey);
@@ -68,8 +71,12 @@ int16_t LoRaManager::lwActivate(LoRaWANNode& node) {
         state = node.setBufferNonces(buffer);
         
         if (state == RADIOLIB_ERR_NONE) {
-            // Intentar restaurar sesión desde RTC
+            // Intentar restaurar sesión desde RTC y, si se perdió (corte de alimentación),
+            // desde la copia en flash
             state = node.setBufferSession(LWsession);
+            if (state != RADIOLIB_ERR_NONE && SessionStore::restore(LWsession)) {
+                state = node.setBufferSession(LWsession);
+            }
             
             if (state == RADIOLIB_ERR_NONE) {
                 state = node.activateOTAA();
@@ -84,7 +91,12 @@ int16_t LoRaManager::lwActivate(LoRaWANNode& node) {
         DEBUG_PRINTLN("No hay nonces guardados - iniciando nuevo join");
     }
 
-    // Si llegamos aquí, necesitamos hacer un nuevo join
+    // Si llegamos aquí, necesitamos hacer un nuevo join, salvo que siga el back-off
+    if (!JoinPolicy::mayJoin()) {
+        DEBUG_PRINTLN("Join aplazado por back-off");
+        store.end();
+        return RADIOLIB_ERR_NETWORK_NOT_JOINED;
+    }
     state = RADIOLIB_ERR_NETWORK_NOT_JOINED;
     while (state != RADIOLIB_LORAWAN_NEW_SESSION) {
         state = node.activateOTAA();
@@ -95,10 +107,12 @@ int16_t LoRaManager::lwActivate(LoRaWANNode& node) {
             uint8_t *persist = node.getBufferNonces();
             memcpy(buffer, persist, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
             store.putBytes("nonces", buffer, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+            SessionStore::save(node);
+            JoinPolicy::onJoinSucceeded();
 
             // Solicitar DeviceTime después de un join exitoso
             delay(1000); // Pausa para estabilización
-            node.setDatarate(3);
+            LinkPolicy::apply(node, 0);
             
             // Variable para controlar el número de intentos
             int rtcAttempts = 0;
@@ -109,8 +123,8 @@ int16_t LoRaManager::lwActivate(LoRaWANNode& node) {
             while (!rtcUpdated && rtcAttempts < maxAttempts) {
                 rtcAttempts++;
                 
-                bool macCommandSuccess = node.sendMacCommandReq(RADIOLIB_LORAWAN_MAC_DEVICE_TIME);
-                if (macCommandSuccess) {
+                // sendMacCommandReq() devuelve un código de estado: RADIOLIB_ERR_NONE (0) si se encoló
+                if (node.sendMacCommandReq(RADIOLIB_LORAWAN_MAC_DEVICE_TIME) == RADIOLIB_ERR_NONE) {
                     // Enviar mensaje vacío
                     uint8_t fPort = 1;
                     uint8_t downlinkPayload[255];
@@ -175,17 +189,15 @@ int16_t LoRaManager::lwActivate(LoRaWANNode& node) {
             // Si no se pudo actualizar el RTC después de los intentos máximos, retornar error
             if (!rtcUpdated) {
                 DEBUG_PRINTLN("No se pudo actualizar el RTC después de los intentos máximos, entrando en deep sleep");
-                bootCountSinceUnsuccessfulJoin = 0;
                 store.end();
                 return RADIOLIB_ERR_RTC_SYNC_FAILED; // Error personalizado para indicar fallo en sincronización RTC
             }
             
-            bootCountSinceUnsuccessfulJoin = 0;
             store.end();
             return RADIOLIB_LORAWAN_NEW_SESSION;
         } else {
             DEBUG_PRINTF("Join falló: %d\n", state);
-            bootCountSinceUnsuccessfulJoin++;
+            JoinPolicy::onJoinFailed();
             store.end();
             return state;
         }
@@ -202,16 +214,18 @@ int16_t LoRaManager::lwActivate(LoRaWANNode& node) {
  * @param stationId ID de la estación.
  * @param battery Valor de la batería.
  * @param timestamp Timestamp del sistema.
+ * @param predictorReset Marca el timestamp con '*' (modelos de predicción dual descartados).
  * @param buffer Buffer donde se almacenará el payload.
  * @param bufferSize Tamaño del buffer.
  * @return Tamaño del payload generado.
  */
 size_t LoRaManager::createDelimitedPayload(
-    const std::vector<SensorReading>& readings,
-    const String& deviceId,
-    const String& stationId,
+    Span<const SensorReading> readings,
+    const char* deviceId,
+    const char* stationId,
     float battery,
     uint32_t timestamp,
+    bool predictorReset,
     char* buffer,
     size_t bufferSize
 ) {
@@ -223,15 +237,17 @@ size_t LoRaManager::createDelimitedPayload(
     char batteryStr[16];
     formatFloatTo3Decimals(battery, batteryStr, sizeof(batteryStr));
     
-    // Formato: st|d|vt|ts|sensor1_id,sensor1_type,val1,val2,...|sensor2_id,...
+    // Formato: st|d|vt|ts[*]|sensor1_id,sensor1_type,val1,val2,...|sensor2_id,...
+    // ('*' tras el timestamp: el servidor debe descartar sus modelos de predicción dual)
     
     // Añadir encabezado: st|d|vt|ts
     offset += snprintf(buffer + offset, bufferSize - offset, 
-                      "%s|%s|%s|%lu", 
-                      stationId.c_str(), 
-                      deviceId.c_str(), 
+                      "%s|%s|%s|%lu%s", 
+                      stationId, 
+                      deviceId, 
                       batteryStr, 
-                      timestamp);
+                      timestamp,
+                      predictorReset ? "*" : "");
     
     // Añadir cada sensor
     for (const auto& reading : readings) {
@@ -248,16 +264,16 @@ size_t LoRaManager::createDelimitedPayload(
                           reading.type);
         
         // Añadir valores
-        if (reading.subValues.empty()) {
+        if (reading.subValueCount == 0) {
             // Un solo valor
             char valStr[16];
             formatFloatTo3Decimals(reading.value, valStr, sizeof(valStr));
             offset += snprintf(buffer + offset, bufferSize - offset, ",%s", valStr);
         } else {
             // Múltiples valores (subValues)
-            for (const auto& sv : reading.subValues) {
+            for (uint8_t i = 0; i < reading.subValueCount; i++) {
                 char valStr[16];
-                formatFloatTo3Decimals(sv.value, valStr, sizeof(valStr));
+                formatFloatTo3Decimals(reading.subValues[i].value, valStr, sizeof(valStr));
                 offset += snprintf(buffer + offset, bufferSize - offset, ",%s", valStr);
             }
         }
@@ -275,17 +291,19 @@ size_t LoRaManager::createDelimitedPayload(
  * @param stationId ID de la estación.
  * @param battery Valor de la batería.
  * @param timestamp Timestamp del sistema.
+ * @param predictorReset Marca el timestamp con '*' (modelos de predicción dual descartados).
  * @param buffer Buffer donde se almacenará el payload.
  * @param bufferSize Tamaño del buffer.
  * @return Tamaño del payload generado.
  */
 size_t LoRaManager::createDelimitedPayload(
-    const std::vector<SensorReading>& normalReadings,
-    const std::vector<ModbusSensorReading>& modbusReadings,
-    const String& deviceId,
-    const String& stationId,
+    Span<const SensorReading> normalReadings,
+    Span<const ModbusSensorReading> modbusReadings,
+    const char* deviceId,
+    const char* stationId,
     float battery,
     uint32_t timestamp,
+    bool predictorReset,
     char* buffer,
     size_t bufferSize
 ) {
@@ -297,15 +315,17 @@ size_t LoRaManager::createDelimitedPayload(
     char batteryStr[16];
     formatFloatTo3Decimals(battery, batteryStr, sizeof(batteryStr));
     
-    // Formato: st|d|vt|ts|sensor1_id,sensor1_type,val1,val2,...|sensor2_id,...
+    // Formato: st|d|vt|ts[*]|sensor1_id,sensor1_type,val1,val2,...|sensor2_id,...
+    // ('*' tras el timestamp: el servidor debe descartar sus modelos de predicción dual)
     
     // Añadir encabezado: st|d|vt|ts
     offset += snprintf(buffer + offset, bufferSize - offset, 
-                      "%s|%s|%s|%lu", 
-                      stationId.c_str(), 
-                      deviceId.c_str(), 
+                      "%s|%s|%s|%lu%s", 
+                      stationId, 
+                      deviceId, 
                       batteryStr, 
-                      timestamp);
+                      timestamp,
+                      predictorReset ? "*" : "");
     
     // Añadir sensores normales
     for (const auto& reading : normalReadings) {
@@ -322,16 +342,16 @@ size_t LoRaManager::createDelimitedPayload(
                           reading.type);
         
         // Añadir valores
-        if (reading.subValues.empty()) {
+        if (reading.subValueCount == 0) {
             // Un solo valor
             char valStr[16];
             formatFloatTo3Decimals(reading.value, valStr, sizeof(valStr));
             offset += snprintf(buffer + offset, bufferSize - offset, ",%s", valStr);
         } else {
             // Múltiples valores (subValues)
-            for (const auto& sv : reading.subValues) {
+            for (uint8_t i = 0; i < reading.subValueCount; i++) {
                 char valStr[16];
-                formatFloatTo3Decimals(sv.value, valStr, sizeof(valStr));
+                formatFloatTo3Decimals(reading.subValues[i].value, valStr, sizeof(valStr));
                 offset += snprintf(buffer + offset, bufferSize - offset, ",%s", valStr);
             }
         }
@@ -352,9 +372,9 @@ size_t LoRaManager::createDelimitedPayload(
                           reading.type);
         
         // Añadir valores
-        for (const auto& sv : reading.subValues) {
+        for (uint8_t i = 0; i < reading.subValueCount; i++) {
             char valStr[16];
-            formatFloatTo3Decimals(sv.value, valStr, sizeof(valStr));
+            formatFloatTo3Decimals(reading.subValues[i].value, valStr, sizeof(valStr));
             offset += snprintf(buffer + offset, bufferSize - offset, ",%s", valStr);
         }
     }
@@ -366,20 +386,19 @@ size_t LoRaManager::createDelimitedPayload(
 /**
  * @brief Envía el payload de sensores estándar usando formato delimitado.
  */
-void LoRaManager::sendDelimitedPayload(const std::vector<SensorReading>& readings, 
+int16_t LoRaManager::sendDelimitedPayload(Span<const SensorReading> readings, 
                                      LoRaWANNode& node,
-                                     const String& deviceId, 
-                                     const String& stationId, 
-                                     RTC_DS3231& rtc) 
+                                     const char* deviceId, 
+                                     const char* stationId, 
+                                     uint32_t timestamp) 
 {
     char payloadBuffer[MAX_LORA_PAYLOAD + 1];
     
     // Crear payload delimitado
-    float battery = BatterySensor::readVoltage();
-    uint32_t timestamp = rtc.now().unixtime();
+    float battery = MeasurementContext::get(MEAS_INPUT_BATTERY_VOLTAGE);
     
     size_t payloadLength = createDelimitedPayload(
-        readings, deviceId, stationId, battery, timestamp, 
+        readings, deviceId, stationId, battery, timestamp, DualPredictor::resetPending(),
         payloadBuffer, sizeof(payloadBuffer)
     );
     
@@ -387,58 +406,35 @@ void LoRaManager::sendDelimitedPayload(const std::vector<SensorReading>& reading
     DEBUG_PRINTLN(payloadBuffer);
     
     // Enviar
-    uint8_t fPort = 1;
-    uint8_t downlinkPayload[255];
-    size_t downlinkSize = 0;
-    
-    int16_t state = node.sendReceive(
-        (uint8_t*)payloadBuffer, 
-        payloadLength, 
-        fPort, 
-        downlinkPayload, 
-        &downlinkSize
-    );
-    
-    if (state == RADIOLIB_ERR_NONE) {
-        DEBUG_PRINTLN("Transmisión exitosa!");
-        if (downlinkSize > 0) {
-            DEBUG_PRINTF("Recibidos %d bytes de downlink\n", downlinkSize);
-        }
-    } else {
-        DEBUG_PRINTF("Error en transmisión: %d\n", state);
-    }
+    AirtimeBudget::noteDataLength(payloadLength);
+    return sendData(node, (uint8_t*)payloadBuffer, payloadLength, 1);
 }
 
 #if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
 /**
  * @brief Envía el payload de sensores estándar y Modbus usando formato delimitado.
  */
-void LoRaManager::sendDelimitedPayload(const std::vector<SensorReading>& normalReadings, 
-                                     const std::vector<ModbusSensorReading>& modbusReadings,
+int16_t LoRaManager::sendDelimitedPayload(Span<const SensorReading> normalReadings, 
+                                     Span<const ModbusSensorReading> modbusReadings,
                                      LoRaWANNode& node,
-                                     const String& deviceId, 
-                                     const String& stationId, 
-                                     RTC_DS3231& rtc)
+                                     const char* deviceId, 
+                                     const char* stationId, 
+                                     uint32_t timestamp)
 {
     char payloadBuffer[MAX_LORA_PAYLOAD + 1];
     
     // Crear payload delimitado
-    float battery = BatterySensor::readVoltage();
-    uint32_t timestamp = rtc.now().unixtime();
+    float battery = MeasurementContext::get(MEAS_INPUT_BATTERY_VOLTAGE);
     
     size_t payloadLength = createDelimitedPayload(
-        normalReadings, modbusReadings, deviceId, stationId, battery, timestamp, 
-        payloadBuffer, sizeof(payloadBuffer)
+        normalReadings, modbusReadings, deviceId, stationId, battery, timestamp,
+        DualPredictor::resetPending(), payloadBuffer, sizeof(payloadBuffer)
     );
     
     DEBUG_PRINTF("Enviando payload delimitado con tamaño %d bytes\n", payloadLength);
     DEBUG_PRINTLN(payloadBuffer);
     
-    // Enviar
-    uint8_t fPort = 1;
-    uint8_t downlinkPayload[255];
-    size_t downlinkSize = 0;
-
+    // Enviar (DR y potencia según LinkPolicy)
     /*
     Lista de Data Rates (DR) para LoRaWAN US915
 
@@ -473,33 +469,117 @@ void LoRaManager::sendDelimitedPayload(const std::vector<SensorReading>& normalR
     - DR8 a DR13 se usan para **downlink** en los 8 canales de 500kHz.
     - El payload máximo puede verse afectado por la opción **FOpt** en el MAC layer.
     */
-    LoRaManager::setDatarate(node, 3);
+    AirtimeBudget::noteDataLength(payloadLength);
+    return sendData(node, (uint8_t*)payloadBuffer, payloadLength, 1);
+}
+#endif
 
-    
-    // int16_t state = node.sendReceive(
-    //     (uint8_t*)payloadBuffer, 
-    //     payloadLength, 
-    //     fPort, 
-    //     downlinkPayload, 
-    //     &downlinkSize
-    // );
+int16_t LoRaManager::sendData(LoRaWANNode& node, uint8_t* payload, size_t length, uint8_t fPort) {
+    if (!AirtimeBudget::allows(length)) {
+        return AIRTIME_ERR_OVER_BUDGET;
+    }
+    TxScheduler::waitForSlot(&radio);
+    LinkPolicy::apply(node, length);
+    bool linkCheck = LinkPolicy::requestLinkCheck(node);
 
-    int16_t state = node.uplink(
-        (uint8_t*)payloadBuffer, 
-        payloadLength, 
-        fPort
-    );
-    
-    if (state == RADIOLIB_ERR_NONE) {
+    // Con ventanas de recepción: respuestas LinkCheck, comandos ADR, margen del downlink y
+    // comandos de configuración
+    uint8_t downlinkPayload[255];
+    size_t downlinkSize = 0;
+    LoRaWANEvent_t upEvent;
+    LoRaWANEvent_t downEvent;
+    memset(&upEvent, 0, sizeof(upEvent));
+    memset(&downEvent, 0, sizeof(downEvent));
+    int16_t state = node.sendReceive(payload, length, fPort, downlinkPayload, &downlinkSize,
+                                     false, &upEvent, &downEvent);
+    LinkPolicy::onUplink(node, state, linkCheck, downEvent, radio.getSNR());
+
+    if (state == RADIOLIB_ERR_NONE || state == RADIOLIB_LORAWAN_NO_DOWNLINK) {
         DEBUG_PRINTLN("Transmisión exitosa!");
+        AirtimeBudget::record(upEvent.datarate, length);
         if (downlinkSize > 0) {
             DEBUG_PRINTF("Recibidos %d bytes de downlink\n", downlinkSize);
         }
+        if (state == RADIOLIB_ERR_NONE && downEvent.fPort == LORA_CMD_FPORT) {
+            DownlinkCommands::handle(downlinkPayload, downlinkSize);
+        }
     } else {
         DEBUG_PRINTF("Error en transmisión: %d\n", state);
     }
+    return state;
+}
+
+void LoRaManager::sendAggregates(LoRaWANNode& node, RTC_DS3231& rtc) {
+    if (!Aggregator::pending()) {
+        return;
+    }
+    uint8_t payload[MAX_LORA_PAYLOAD];
+    size_t length = Aggregator::encode(SlotScheduler::timestamp(rtc), payload, sizeof(payload));
+    if (length == 0) {
+        return;
+    }
+    DEBUG_PRINTF("Enviando resúmenes de ventana: %u bytes\n", (unsigned)length);
+
+    if (!AirtimeBudget::allows(length)) {
+        return;     // Los resúmenes siguen pendientes
+    }
+    TxScheduler::waitForSlot(&radio);
+    LinkPolicy::apply(node, length);
+    LoRaWANEvent_t upEvent;
+    memset(&upEvent, 0, sizeof(upEvent));
+    int16_t state = node.uplink(payload, length, LORA_AGG_FPORT, false, &upEvent);
+    if (state == RADIOLIB_ERR_NONE) {
+        AirtimeBudget::record(upEvent.datarate, length);
+        Aggregator::markSent();
+    } else {
+        // Los resúmenes siguen pendientes para el siguiente ciclo de reporte
+        DEBUG_PRINTF("Error enviando resúmenes: %d\n", state);
+    }
+}
+
+void LoRaManager::sendBatch(LoRaWANNode& node) {
+    uint8_t payload[BATCH_FRAME_MAX_BYTES];
+    for (uint8_t frame = 0; frame < BATCH_MAX_FRAMES && BatchBuffer::pending(); frame++) {
+        size_t length = BatchBuffer::encode(payload, sizeof(payload));
+        if (length == 0) {
+            return;
+        }
+        DEBUG_PRINTF("Enviando lote: %u bytes\n", (unsigned)length);
+
+        // Con ventanas de recepción: en modo lote es el único uplink periódico
+        int16_t state = sendData(node, payload, length, LORA_BATCH_FPORT);
+        if (state != RADIOLIB_ERR_NONE && state != RADIOLIB_LORAWAN_NO_DOWNLINK) {
+            // Las filas siguen pendientes para el siguiente ciclo de reporte
+            DEBUG_PRINTF("Error enviando lote: %d\n", state);
+            return;
+        }
+        BatchBuffer::markSent();
+    }
+}
+
+void LoRaManager::sendDiagnostics(LoRaWANNode& node) {
+    if (!Diagnostics::pending()) {
+        return;
+    }
+    Span<const uint8_t> payload = Diagnostics::payload();
+    DEBUG_PRINTF("Enviando diagnóstico: %u bytes\n", (unsigned)payload.size());
+
+    if (!AirtimeBudget::allows(payload.size())) {
+        return;     // Las entradas siguen pendientes
+    }
+    TxScheduler::waitForSlot(&radio);
+    LinkPolicy::apply(node, payload.size());
+    LoRaWANEvent_t upEvent;
+    memset(&upEvent, 0, sizeof(upEvent));
+    int16_t state = node.uplink((uint8_t*)payload.data(), payload.size(), LORA_DIAG_FPORT, false, &upEvent);
+    if (state == RADIOLIB_ERR_NONE) {
+        AirtimeBudget::record(upEvent.datarate, payload.size());
+        Diagnostics::clear();
+    } else {
+        // Se reintenta en el siguiente ciclo de reporte
+        DEBUG_PRINTF("Error enviando diagnóstico: %d\n", state);
+    }
 }
-#endif
 
 void LoRaManager::prepareForSleep(SX1262* radio) {
     if (radio) {
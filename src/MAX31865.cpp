@@ -2,42 +2,15 @@
 #include <math.h>   // Para sqrt
 
 /**
- * @brief Constructor con PCA9555.
+ * @brief Constructor. El CS (PCA9555 o pin nativo) lo define el registro en SpiBusManager.
  */
 MAX31865_RTD::MAX31865_RTD(
     ptd_type type,
-    SPIClass& spi,
-    SPISettings& spiSettings,
-    PCA9555& pca,
-    uint8_t pcaPinCS
+    SpiDeviceHandle spiDevice
 )
 {
-  _spi = &spi;
-  _spiSettings = &spiSettings;
+  _spiDevice = spiDevice;
   this->type = type;
-  this->_usePCA = true;
-  this->_pca = &pca;
-  this->_pcaPinCS = pcaPinCS;
-  this->_csPinMCU = 0xFF;
-}
-
-/**
- * @brief Constructor con pin nativo de MCU.
- */
-MAX31865_RTD::MAX31865_RTD(
-    ptd_type type,
-    SPIClass& spi,
-    SPISettings& spiSettings,
-    uint8_t csPin
-)
-{
-  _spi = &spi;
-  _spiSettings = &spiSettings;
-  this->type = type;
-  this->_usePCA = false;
-  this->_pca = nullptr;
-  this->_pcaPinCS = 0xFF;
-  this->_csPinMCU = csPin;
 }
 
 // -----------------------------------------------------------------------
@@ -66,28 +39,31 @@ void MAX31865_RTD::configure(bool v_bias, bool conversion_mode, bool one_shot,
 }
 
 // -----------------------------------------------------------------------
-void MAX31865_RTD::reconfigure()
+bool MAX31865_RTD::reconfigure()
 {
   // Inicia transacción SPI
-  _spi->beginTransaction(*_spiSettings);
+  if (!SpiBusManager::beginTransaction(_spiDevice)) {
+    return false;
+  }
 
   // Escribe config
   setCSLow();
-  _spi->transfer(0x80); // Dirección de escritura del registro config
-  _spi->transfer(this->configuration_control_bits);
+  SpiBusManager::transfer(0x80); // Dirección de escritura del registro config
+  SpiBusManager::transfer(this->configuration_control_bits);
   setCSHigh();
 
   // Umbrales
   setCSLow();
-  _spi->transfer(0x83); // Registro de umbrales
-  _spi->transfer( (this->configuration_high_threshold >> 8) & 0xFF );
-  _spi->transfer(  this->configuration_high_threshold       & 0xFF );
-  _spi->transfer( (this->configuration_low_threshold  >> 8) & 0xFF );
-  _spi->transfer(  this->configuration_low_threshold        & 0xFF );
+  SpiBusManager::transfer(0x83); // Registro de umbrales
+  SpiBusManager::transfer( (this->configuration_high_threshold >> 8) & 0xFF );
+  SpiBusManager::transfer(  this->configuration_high_threshold       & 0xFF );
+  SpiBusManager::transfer( (this->configuration_low_threshold  >> 8) & 0xFF );
+  SpiBusManager::transfer(  this->configuration_low_threshold        & 0xFF );
   setCSHigh();
 
   // Cierra transacción
-  _spi->endTransaction();
+  SpiBusManager::endTransaction(_spiDevice);
+  return true;
 }
 
 // -----------------------------------------------------------------------
@@ -95,32 +71,37 @@ uint8_t MAX31865_RTD::read_all()
 {
   uint16_t combined_bytes = 0;
 
-  _spi->beginTransaction(*_spiSettings);
+  if (!SpiBusManager::beginTransaction(_spiDevice)) {
+    // Sin bus no hay lectura: invalidar la medida anterior
+    measured_resistance = 0;
+    measured_status = MAX31865_BUS_ERROR;
+    return measured_status;
+  }
 
   setCSLow();
   // Indica que leeremos desde la dirección 0 (se manda 0x00)
-  _spi->transfer(0x00);
+  SpiBusManager::transfer(0x00);
 
   // Orden de lectura: Config, RTD, High Fault Th, Low Fault Th, Status
-  measured_configuration = _spi->transfer(0x00);
+  measured_configuration = SpiBusManager::transfer(0x00);
 
-  combined_bytes  = ((uint16_t)_spi->transfer(0x00) << 8);
-  combined_bytes |=          _spi->transfer(0x00);
+  combined_bytes  = ((uint16_t)SpiBusManager::transfer(0x00) << 8);
+  combined_bytes |=          SpiBusManager::transfer(0x00);
   measured_resistance = (combined_bytes >> 1);
 
-  combined_bytes  = ((uint16_t)_spi->transfer(0x00) << 8);
-  combined_bytes |=          _spi->transfer(0x00);
+  combined_bytes  = ((uint16_t)SpiBusManager::transfer(0x00) << 8);
+  combined_bytes |=          SpiBusManager::transfer(0x00);
   measured_high_threshold = (combined_bytes >> 1);
 
-  combined_bytes  = ((uint16_t)_spi->transfer(0x00) << 8);
-  combined_bytes |=          _spi->transfer(0x00);
+  combined_bytes  = ((uint16_t)SpiBusManager::transfer(0x00) << 8);
+  combined_bytes |=          SpiBusManager::transfer(0x00);
   measured_low_threshold = (combined_bytes >> 1);
 
-  measured_status = _spi->transfer(0x00);
+  measured_status = SpiBusManager::transfer(0x00);
 
   delayMicroseconds(20);
   setCSHigh();
-  _spi->endTransaction();
+  SpiBusManager::endTransaction(_spiDevice);
 
   // Reconfigura si resistencia=0 o hay falla
   if ((measured_resistance == 0) || (measured_status != 0)) {
@@ -156,20 +137,12 @@ double MAX31865_RTD::temperature() const
 }
 
 void MAX31865_RTD::setCSLow() {
-  if (_usePCA && _pca) {
-    _pca->digitalWrite(_pcaPinCS, LOW);
-    delayMicroseconds(5);
-  } else {
-    digitalWrite(_csPinMCU, LOW);
-  }
+  SpiBusManager::select(_spiDevice);
+  delayMicroseconds(5);
 }
 
 void MAX31865_RTD::setCSHigh() {
-  if (_usePCA && _pca) {
-    _pca->digitalWrite(_pcaPinCS, HIGH);
-  } else {
-    digitalWrite(_csPinMCU, HIGH);
-  }
+  SpiBusManager::deselect(_spiDevice);
 }
 
 double MAX31865_RTD::singleMeasurement(uint16_t conversionDelayMs) {
@@ -199,12 +172,6 @@ double MAX31865_RTD::singleMeasurement(uint16_t conversionDelayMs) {
 
 // Nuevo método begin para inicializar los pines
 bool MAX31865_RTD::begin() {
-    if (_usePCA && _pca) {
-        _pca->pinMode(_pcaPinCS, OUTPUT);
-        _pca->digitalWrite(_pcaPinCS, HIGH);
-    } else {
-        pinMode(_csPinMCU, OUTPUT);
-        digitalWrite(_csPinMCU, HIGH);
-    }
+    SpiBusManager::initChipSelect(_spiDevice);
     return true;
 }
@@ -0,0 +1,111 @@
+/*******************************************************************************************
+ * Archivo: src/MeasurementContext.cpp
+ * Descripción: Implementación del contexto de medición por ciclo.
+ *******************************************************************************************/
+
+#include "MeasurementContext.h"
+#include "debug.h"
+#include "SensorDriver.h"
+#include "sensors/BatterySensor.h"
+
+#ifdef DEVICE_TYPE_ANALOGIC
+#include "ADS124S08.h"
+#include "AdcUtilities.h"
+#include "sensors/NtcManager.h"
+extern ADS124S08 ADC;
+#endif
+
+// Última batería leída, para los ticks en que no toca medirla
+RTC_DATA_ATTR static float lastBatteryVoltage = NAN;
+
+float MeasurementContext::_values[MEAS_INPUT_COUNT];
+uint32_t MeasurementContext::_validMask = 0;
+uint32_t MeasurementContext::_pendingMask = 0;
+
+// Dependencias de cada entrada (se evalúan antes que la entrada)
+static const uint32_t kInputDependencies[MEAS_INPUT_COUNT] = {
+    0,                                          // MEAS_INPUT_NTC10K_VOLTAGE
+    MEAS_INPUT_BIT(MEAS_INPUT_NTC10K_VOLTAGE),  // MEAS_INPUT_NTC10K_TEMPERATURE
+    0                                           // MEAS_INPUT_BATTERY_VOLTAGE
+};
+
+void MeasurementContext::beginCycle() {
+    _validMask = 0;
+    _pendingMask = 0;
+}
+
+uint32_t MeasurementContext::inputsFor(SensorType type) {
+    // Cada driver declara sus entradas (p.ej. pH y conductividad usan la temperatura del NTC10K)
+    const SensorDriver* driver = SensorDriverRegistry::find(type);
+    return driver ? driver->inputs : 0;
+}
+
+void MeasurementContext::prepare(Span<const SensorConfig> enabledSensors, bool readBattery) {
+    uint32_t required = MEAS_INPUT_BIT(MEAS_INPUT_BATTERY_VOLTAGE);
+    if (!readBattery) {
+        // Sin encender el ADC: se reutiliza el valor anterior (NAN si nunca se leyó)
+        _values[MEAS_INPUT_BATTERY_VOLTAGE] = lastBatteryVoltage;
+        _validMask |= MEAS_INPUT_BIT(MEAS_INPUT_BATTERY_VOLTAGE);
+        required = 0;
+    }
+    for (const auto& sensor : enabledSensors) {
+        if (sensor.enable) {
+            required |= inputsFor(sensor.type);
+        }
+    }
+
+    for (uint8_t i = 0; i < MEAS_INPUT_COUNT; i++) {
+        if (required & MEAS_INPUT_BIT(i)) {
+            get((MeasurementInput)i);
+        }
+    }
+}
+
+float MeasurementContext::get(MeasurementInput input) {
+    if (input >= MEAS_INPUT_COUNT) {
+        return NAN;
+    }
+    if (_validMask & MEAS_INPUT_BIT(input)) {
+        return _values[input];
+    }
+    if (_pendingMask & MEAS_INPUT_BIT(input)) {
+        // Dependencia circular en la tabla: no debería ocurrir
+        DEBUG_PRINTF("MeasurementContext: dependencia circular en entrada %u\n", input);
+        return NAN;
+    }
+
+    _pendingMask |= MEAS_INPUT_BIT(input);
+    for (uint8_t dep = 0; dep < MEAS_INPUT_COUNT; dep++) {
+        if (kInputDependencies[input] & MEAS_INPUT_BIT(dep)) {
+            get((MeasurementInput)dep);
+        }
+    }
+
+    _values[input] = evaluate(input);
+    _pendingMask &= ~MEAS_INPUT_BIT(input);
+    _validMask |= MEAS_INPUT_BIT(input);
+    return _values[input];
+}
+
+float MeasurementContext::evaluate(MeasurementInput input) {
+    switch (input) {
+#ifdef DEVICE_TYPE_ANALOGIC
+        case MEAS_INPUT_NTC10K_VOLTAGE:
+        {
+            ADC.sendCommand(WAKE_OPCODE_MASK);
+            static const AdcAcquisitionProfile profile = ADC_PROFILE_NTC10K;
+            return AdcUtilities::measureAdcDifferential(NTC10K_MUX_CONFIG, profile);
+        }
+
+        case MEAS_INPUT_NTC10K_TEMPERATURE:
+            return (float)NtcManager::ntc10kTemperatureFromVoltage(_values[MEAS_INPUT_NTC10K_VOLTAGE]);
+#endif
+
+        case MEAS_INPUT_BATTERY_VOLTAGE:
+            lastBatteryVoltage = BatterySensor::readVoltage();
+            return lastBatteryVoltage;
+
+        default:
+            return NAN;
+    }
+}
@@ -74,9 +74,9 @@ bool ModbusSensorManager::readHoldingRegisters(uint8_t address, uint16_t startRe
 
 ModbusSensorReading ModbusSensorManager::readEnvSensor(const ModbusSensorConfig &cfg) {
     ModbusSensorReading reading;
-    strncpy(reading.sensorId, cfg.sensorId, sizeof(reading.sensorId));
+    strlcpy(reading.sensorId, cfg.sensorId, sizeof(reading.sensorId));
     reading.type = cfg.type;
-    reading.subValues.clear();
+    reading.subValueCount = 0;
 
     // Lectura de 8 registros (500..507)
     const uint16_t startReg = 500;
@@ -89,9 +89,7 @@ ModbusSensorReading ModbusSensorManager::readEnvSensor(const ModbusSensorConfig
         // Llenar con NAN si falló
         // Respetamos el orden: [0]=Humedad, [1]=Temperatura, [2]=Presión, [3]=Iluminación
         for (int i=0; i<4; i++){
-            SubValue sv;
-            sv.value = NAN;
-            reading.subValues.push_back(sv);
+            addSubValue(reading, NAN);
         }
         return reading;
     }
@@ -105,35 +103,17 @@ ModbusSensorReading ModbusSensorManager::readEnvSensor(const ModbusSensorConfig
     // Los demás registros (ruido, PM2.5, PM10) vienen en 0 y se ignoran
 
     // Agregar Humedad como primer valor [0]
-    {
-        SubValue sH;
-        sH.value = rawData[0] / 10.0f;
-        reading.subValues.push_back(sH);
-    }
+    addSubValue(reading, rawData[0] / 10.0f);
     
-    // Agregar Temperatura como segundo valor [1]
-    {
-        SubValue sT;
-        // Ver si es negativo
-        int16_t temp16 = (int16_t)rawData[1];
-        sT.value = temp16 / 10.0f;
-        reading.subValues.push_back(sT);
-    }
+    // Agregar Temperatura como segundo valor [1] (16 bits con signo)
+    addSubValue(reading, (int16_t)rawData[1] / 10.0f);
     
     // Agregar Presión Atmosférica como tercer valor [2]
-    {
-        SubValue sP;
-        sP.value = rawData[5] / 10.0f;
-        reading.subValues.push_back(sP);
-    }
+    addSubValue(reading, rawData[5] / 10.0f);
     
     // Agregar Iluminación como cuarto valor [3]
-    {
-        SubValue sL;
-        uint32_t lux = ((uint32_t)rawData[6] << 16) | rawData[7];
-        sL.value = (float)lux;
-        reading.subValues.push_back(sL);
-    }
+    uint32_t lux = ((uint32_t)rawData[6] << 16) | rawData[7];
+    addSubValue(reading, (float)lux);
     
     return reading;
 }
@@ -1,61 +1,143 @@
 #include "PowerManager.h"
+#include "debug.h"
+#include "Diagnostics.h"
+
+// Rieles presentes en este dispositivo
+#if defined(DEVICE_TYPE_ANALOGIC)
+static const uint8_t kSupportedRails = SENSOR_RAIL_3V3 | SENSOR_RAIL_2V5 | SENSOR_RAIL_12V;
+#elif defined(DEVICE_TYPE_MODBUS)
+static const uint8_t kSupportedRails = SENSOR_RAIL_3V3 | SENSOR_RAIL_12V;
+#else
+static const uint8_t kSupportedRails = SENSOR_RAIL_3V3;
+#endif
+
+// Tiempo de encendido acumulado por riel; sobrevive al deep sleep
+RTC_DATA_ATTR static uint32_t railOnTotalMs[POWER_RAIL_COUNT];
+
+/**
+ * @brief Pin del expansor que conmuta el riel con índice i (posición del bit SENSOR_RAIL_*)
+ */
+static uint8_t railPin(uint8_t index) {
+    switch (index) {
+#ifdef DEVICE_TYPE_ANALOGIC
+        case 1: return POWER_2V5_PIN;
+#endif
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+        case 2: return POWER_12V_PIN;
+#endif
+        default: return POWER_3V3_PIN;
+    }
+}
 
 PowerManager::PowerManager(PCA9555& expander) : ioExpander(expander) {
+    memset(refCount, 0, sizeof(refCount));
+    memset(onSinceMs, 0, sizeof(onSinceMs));
 }
 
 void PowerManager::begin() {
     // Configurar pines como salidas
-    ioExpander.pinMode(POWER_3V3_PIN, OUTPUT);
-    
-#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
-    ioExpander.pinMode(POWER_12V_PIN, OUTPUT);
-#endif
+    for (uint8_t i = 0; i < POWER_RAIL_COUNT; i++) {
+        if (kSupportedRails & (1 << i)) {
+            ioExpander.pinMode(railPin(i), OUTPUT);
+        }
+    }
 
-#ifdef DEVICE_TYPE_ANALOGIC
-    ioExpander.pinMode(POWER_2V5_PIN, OUTPUT);
-#endif
-    
     // Asegurar que todas las fuentes están apagadas al inicio
     allPowerOff();
 }
 
-void PowerManager::power3V3On() {
-    ioExpander.digitalWrite(POWER_3V3_PIN, HIGH);
-    delay(POWER_STABILIZE_DELAY);
+void PowerManager::writeRails(uint8_t rails, bool on) {
+    uint16_t mask = 0;
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < POWER_RAIL_COUNT; i++) {
+        if (!(rails & (1 << i))) {
+            continue;
+        }
+        mask |= (uint16_t)1 << railPin(i);
+        if (on) {
+            onSinceMs[i] = now;
+        } else if (onSinceMs[i] != 0) {
+            uint32_t onMs = now - onSinceMs[i];
+            railOnTotalMs[i] += onMs;
+            onSinceMs[i] = 0;
+            DEBUG_PRINTF("Riel 0x%02X apagado tras %lu ms\n", 1 << i, (unsigned long)onMs);
+        }
+    }
+    // Una sola transacción I2C para todos los rieles
+    ioExpander.writePins(mask, on ? mask : 0);
 }
 
-void PowerManager::power3V3Off() {
-    ioExpander.digitalWrite(POWER_3V3_PIN, LOW);
+uint8_t PowerManager::acquire(uint8_t rails) {
+    rails &= kSupportedRails;
+    uint8_t newRails = 0;
+    for (uint8_t i = 0; i < POWER_RAIL_COUNT; i++) {
+        if (rails & (1 << i)) {
+            if (refCount[i]++ == 0) {
+                newRails |= (1 << i);
+            }
+        }
+    }
+
+    if (newRails) {
+        writeRails(newRails, true);
+        delay(POWER_STABILIZE_DELAY);
+    }
+    return newRails;
 }
 
-#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
-void PowerManager::power12VOn() {
-    ioExpander.digitalWrite(POWER_12V_PIN, HIGH);
-    delay(POWER_STABILIZE_DELAY);
+void PowerManager::release(uint8_t rails) {
+    rails &= kSupportedRails;
+    uint8_t offRails = 0;
+    for (uint8_t i = 0; i < POWER_RAIL_COUNT; i++) {
+        if ((rails & (1 << i)) && refCount[i] > 0) {
+            if (--refCount[i] == 0) {
+                offRails |= (1 << i);
+            }
+        }
+    }
+
+    if (offRails) {
+        writeRails(offRails, false);
+    }
 }
 
-void PowerManager::power12VOff() {
-    ioExpander.digitalWrite(POWER_12V_PIN, LOW);
+uint8_t PowerManager::activeRails() const {
+    uint8_t rails = 0;
+    for (uint8_t i = 0; i < POWER_RAIL_COUNT; i++) {
+        if (refCount[i] > 0) {
+            rails |= (1 << i);
+        }
+    }
+    return rails;
 }
-#endif
 
-#ifdef DEVICE_TYPE_ANALOGIC
-void PowerManager::power2V5On() {
-    ioExpander.digitalWrite(POWER_2V5_PIN, HIGH);
-    delay(POWER_STABILIZE_DELAY);
+uint32_t PowerManager::railOnTimeMs(uint8_t rail) const {
+    for (uint8_t i = 0; i < POWER_RAIL_COUNT; i++) {
+        if (rail == (1 << i)) {
+            uint32_t total = railOnTotalMs[i];
+            if (onSinceMs[i] != 0) {
+                total += millis() - onSinceMs[i];
+            }
+            return total;
+        }
+    }
+    return 0;
 }
 
-void PowerManager::power2V5Off() {
-    ioExpander.digitalWrite(POWER_2V5_PIN, LOW);
+void PowerManager::reportRailTime() const {
+    // Sin uplink propio: acompaña a las demás entradas (al menos la de AirtimeBudget cada
+    // hora con tráfico). El total es acumulado, así que un envío perdido no pierde tiempo.
+    if (!Diagnostics::pending()) {
+        return;
+    }
+    RailTimeDiag diag;
+    for (uint8_t i = 0; i < POWER_RAIL_COUNT; i++) {
+        diag.onMs[i] = railOnTimeMs(1 << i);
+    }
+    Diagnostics::add(DIAG_TAG_RAIL_TIME, &diag, sizeof(diag));
 }
-#endif
 
 void PowerManager::allPowerOff() {
-#ifdef DEVICE_TYPE_ANALOGIC
-    power2V5Off();
-#endif
-    power3V3Off();
-#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
-    power12VOff();
-#endif
-}
\ No newline at end of file
+    memset(refCount, 0, sizeof(refCount));
+    writeRails(kSupportedRails, false);
+}
@@ -0,0 +1,209 @@
+/*******************************************************************************************
+ * Archivo: src/SensorDriver.cpp
+ * Descripción: Tabla de drivers de sensores y adaptadores de cada sensor a sus hooks.
+ *******************************************************************************************/
+
+#include "SensorDriver.h"
+#include "MeasurementContext.h"
+
+#include "sensors/RTDSensor.h"
+#include "sensors/SHT30Sensor.h"
+#if defined(DEVICE_TYPE_BASIC) || defined(DEVICE_TYPE_ANALOGIC)
+#include "sensors/DS18B20Sensor.h"
+#endif
+#ifdef DEVICE_TYPE_ANALOGIC
+#include "sensors/NtcManager.h"
+#include "sensors/PHSensor.h"
+#include "sensors/ConductivitySensor.h"
+#include "sensors/HDS10Sensor.h"
+#endif
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+#include "ModbusSensorManager.h"
+#endif
+
+// -------------------------------------------------------------------------------------
+// Adaptadores de cada sensor a los hooks del driver
+// -------------------------------------------------------------------------------------
+
+static bool pollRtd(const SensorConfig& cfg) {
+    return RTDSensor::conversionReady();
+}
+
+static void collectRtd(const SensorConfig& cfg, SensorReading& reading) {
+    reading.value = RTDSensor::read();
+}
+
+static void collectSht30(const SensorConfig& cfg, SensorReading& reading) {
+    float tmp = 0.0f, hum = 0.0f;
+    SHT30Sensor::read(tmp, hum);
+
+    // [0] = temperatura, [1] = humedad
+    addSubValue(reading, tmp);
+    addSubValue(reading, hum);
+
+    // Valor principal NAN si alguno de los valores falló
+    reading.value = (isnan(tmp) || isnan(hum)) ? NAN : tmp;
+}
+
+#if defined(DEVICE_TYPE_BASIC) || defined(DEVICE_TYPE_ANALOGIC)
+static void startDs18b20(const SensorConfig& cfg) {
+    DS18B20Sensor::startConversion();
+}
+
+static bool pollDs18b20(const SensorConfig& cfg) {
+    return DS18B20Sensor::conversionReady();
+}
+
+static void collectDs18b20(const SensorConfig& cfg, SensorReading& reading) {
+    reading.value = DS18B20Sensor::readLatest();
+}
+#endif
+
+#ifdef DEVICE_TYPE_ANALOGIC
+static void collectNtc100k(const SensorConfig& cfg, SensorReading& reading) {
+    reading.value = NtcManager::readNtc100kTemperature(cfg.configKey);
+}
+
+static void collectNtc10k(const SensorConfig& cfg, SensorReading& reading) {
+    // Temperatura del NTC de 10k compartida con pH y conductividad
+    reading.value = MeasurementContext::get(MEAS_INPUT_NTC10K_TEMPERATURE);
+}
+
+static void collectHds10(const SensorConfig& cfg, SensorReading& reading) {
+    reading.value = HDS10Sensor::read();
+}
+
+static void collectPh(const SensorConfig& cfg, SensorReading& reading) {
+    reading.value = PHSensor::read();
+}
+
+static void collectConductivity(const SensorConfig& cfg, SensorReading& reading) {
+    reading.value = ConductivitySensor::read();
+}
+#endif
+
+// -------------------------------------------------------------------------------------
+// Tabla de drivers registrados (un tipo por entrada)
+// -------------------------------------------------------------------------------------
+static const SensorDriver kSensorDrivers[] = {
+    // type, subValues, bus, rails, warmupMs, inputs, filter, begin, start, poll, collect
+    { RTD, 0, SENSOR_BUS_SPI, SENSOR_RAIL_3V3, RTD_FIRST_CONVERSION_MS, 0, SIGNAL_FILTER_NONE,
+      RTDSensor::begin, nullptr, pollRtd, collectRtd },
+    { SHT30, 2, SENSOR_BUS_I2C, SENSOR_RAIL_3V3, 0, 0, SIGNAL_FILTER_NONE,
+      nullptr, nullptr, nullptr, collectSht30 },
+#if defined(DEVICE_TYPE_BASIC) || defined(DEVICE_TYPE_ANALOGIC)
+    { DS18B20, 0, SENSOR_BUS_ONEWIRE, SENSOR_RAIL_3V3, DS18B20_CONVERSION_TIME_MS, 0, SIGNAL_FILTER_NONE,
+      DS18B20Sensor::begin, startDs18b20, pollDs18b20, collectDs18b20 },
+#endif
+#ifdef DEVICE_TYPE_ANALOGIC
+    { N100K, 0, SENSOR_BUS_ADC, SENSOR_RAIL_3V3 | SENSOR_RAIL_2V5, 0, 0, SIGNAL_FILTER_EMA,
+      nullptr, nullptr, nullptr, collectNtc100k },
+    { N10K, 0, SENSOR_BUS_ADC, SENSOR_RAIL_3V3 | SENSOR_RAIL_2V5, 0,
+      MEAS_INPUT_BIT(MEAS_INPUT_NTC10K_TEMPERATURE), SIGNAL_FILTER_EMA,
+      nullptr, nullptr, nullptr, collectNtc10k },
+    { HDS10, 0, SENSOR_BUS_ADC, SENSOR_RAIL_3V3 | SENSOR_RAIL_2V5, 0, 0, SIGNAL_FILTER_EMA,
+      nullptr, nullptr, nullptr, collectHds10 },
+    { PH, 0, SENSOR_BUS_ADC, SENSOR_RAIL_3V3 | SENSOR_RAIL_2V5, 0,
+      MEAS_INPUT_BIT(MEAS_INPUT_NTC10K_TEMPERATURE), SIGNAL_FILTER_MEDIAN,
+      nullptr, nullptr, nullptr, collectPh },
+    { COND, 0, SENSOR_BUS_ADC, SENSOR_RAIL_3V3 | SENSOR_RAIL_2V5, 0,
+      MEAS_INPUT_BIT(MEAS_INPUT_NTC10K_TEMPERATURE), SIGNAL_FILTER_KALMAN,
+      nullptr, nullptr, nullptr, collectConductivity },
+#endif
+};
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+static void collectEnv4(const ModbusSensorConfig& cfg, ModbusSensorReading& reading) {
+    reading = ModbusSensorManager::readEnvSensor(cfg);
+}
+
+static const ModbusSensorDriver kModbusSensorDrivers[] = {
+    // type, subValues, rails, warmupMs, filter, collect
+    { ENV4, 4, SENSOR_RAIL_12V, MODBUS_ENV4_STABILIZATION_TIME, SIGNAL_FILTER_NONE, collectEnv4 },
+};
+#endif
+
+// -------------------------------------------------------------------------------------
+// Métodos de SensorDriverRegistry
+// -------------------------------------------------------------------------------------
+
+const SensorDriver* SensorDriverRegistry::find(SensorType type) {
+    for (size_t i = 0; i < sizeof(kSensorDrivers) / sizeof(kSensorDrivers[0]); i++) {
+        if (kSensorDrivers[i].type == type) {
+            return &kSensorDrivers[i];
+        }
+    }
+    return nullptr;
+}
+
+SensorBus SensorDriverRegistry::busOf(SensorType type) {
+    const SensorDriver* driver = find(type);
+    return driver ? driver->bus : SENSOR_BUS_NONE;
+}
+
+Span<const SensorBus> SensorDriverRegistry::collectOrder() {
+    static const SensorBus kCollectOrder[] = {
+        SENSOR_BUS_NONE, SENSOR_BUS_ADC, SENSOR_BUS_I2C, SENSOR_BUS_SPI, SENSOR_BUS_ONEWIRE
+    };
+    return Span<const SensorBus>(kCollectOrder, sizeof(kCollectOrder) / sizeof(kCollectOrder[0]));
+}
+
+void SensorDriverRegistry::beginDrivers(Span<const SensorConfig> sensors, uint8_t poweredRails) {
+    for (size_t i = 0; i < sizeof(kSensorDrivers) / sizeof(kSensorDrivers[0]); i++) {
+        if (!kSensorDrivers[i].begin || !(kSensorDrivers[i].rails & poweredRails)) {
+            continue;
+        }
+        for (const auto& sensor : sensors) {
+            if (sensor.enable && sensor.type == kSensorDrivers[i].type) {
+                kSensorDrivers[i].begin();
+                break;
+            }
+        }
+    }
+}
+
+uint8_t SensorDriverRegistry::requiredRails(Span<const SensorConfig> sensors) {
+    uint8_t rails = 0;
+    for (const auto& sensor : sensors) {
+        const SensorDriver* driver = find(sensor.type);
+        if (sensor.enable && driver) {
+            rails |= driver->rails;
+        }
+    }
+    return rails;
+}
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+const ModbusSensorDriver* SensorDriverRegistry::findModbus(SensorType type) {
+    for (size_t i = 0; i < sizeof(kModbusSensorDrivers) / sizeof(kModbusSensorDrivers[0]); i++) {
+        if (kModbusSensorDrivers[i].type == type) {
+            return &kModbusSensorDrivers[i];
+        }
+    }
+    return nullptr;
+}
+
+uint8_t SensorDriverRegistry::requiredRails(Span<const ModbusSensorConfig> sensors) {
+    uint8_t rails = 0;
+    for (const auto& sensor : sensors) {
+        const ModbusSensorDriver* driver = findModbus(sensor.type);
+        if (sensor.enable && driver) {
+            rails |= driver->rails;
+        }
+    }
+    return rails;
+}
+
+uint16_t SensorDriverRegistry::maxWarmupMs(Span<const ModbusSensorConfig> sensors) {
+    uint16_t maxWarmup = 0;
+    for (const auto& sensor : sensors) {
+        const ModbusSensorDriver* driver = findModbus(sensor.type);
+        // Tipos sin driver: tiempo predeterminado
+        uint16_t warmup = driver ? driver->warmupMs : MODBUS_DEFAULT_STABILIZATION_TIME;
+        if (warmup > maxWarmup) {
+            maxWarmup = warmup;
+        }
+    }
+    return maxWarmup;
+}
+#endif
@@ -0,0 +1,101 @@
+/*******************************************************************************************
+ * Archivo: src/SensorFilter.cpp
+ * Descripción: Implementación de la etapa de filtrado por sensor.
+ *******************************************************************************************/
+
+#include "SensorFilter.h"
+#include <cmath>
+#include "debug.h"
+#include "SensorDriver.h"
+#include "util/fnv1a.h"
+
+#define SENSOR_FILTER_MAGIC     0xF17E
+
+/**
+ * @brief Estado que sobrevive al deep sleep. Los canales se asignan al primer uso y se
+ *        identifican por el hash de sensorId y subvalor.
+ */
+struct SensorFilterStore {
+    uint16_t magic;
+    uint8_t used;
+    uint32_t ids[FILTER_MAX_CHANNELS];
+    uint8_t kinds[FILTER_MAX_CHANNELS];
+    SignalFilterState states[FILTER_MAX_CHANNELS];
+};
+
+RTC_DATA_ATTR static SensorFilterStore filterStore;
+
+static const SignalFilterParams kFilterParams = {
+    FILTER_EMA_ALPHA, FILTER_MEDIAN_WINDOW, FILTER_KALMAN_Q, FILTER_KALMAN_R
+};
+
+void SensorFilter::begin(BootMode bootMode) {
+    if (bootMode == BOOT_MODE_WARM && filterStore.magic == SENSOR_FILTER_MAGIC &&
+        filterStore.used <= FILTER_MAX_CHANNELS) {
+        return;
+    }
+    memset(&filterStore, 0, sizeof(filterStore));
+    filterStore.magic = SENSOR_FILTER_MAGIC;
+}
+
+float SensorFilter::filterValue(const char* sensorId, uint8_t subIndex, uint8_t kind, float value) {
+    if (kind == SIGNAL_FILTER_NONE || std::isnan(value)) {
+        return value;   // Una lectura fallida no altera el estado
+    }
+
+    uint32_t id = fnv1a32Byte(fnv1a32(sensorId), subIndex);
+    uint8_t slot = 0;
+    while (slot < filterStore.used && filterStore.ids[slot] != id) {
+        slot++;
+    }
+    if (slot == filterStore.used) {
+        if (slot >= FILTER_MAX_CHANNELS) {
+            return value;   // Sin espacio: el canal se envía sin filtrar
+        }
+        filterStore.ids[slot] = id;
+        filterStore.kinds[slot] = kind;
+        signalFilterReset(filterStore.states[slot]);
+        filterStore.used++;
+    } else if (filterStore.kinds[slot] != kind) {
+        // El driver cambió de filtro (nuevo firmware): empezar de cero
+        filterStore.kinds[slot] = kind;
+        signalFilterReset(filterStore.states[slot]);
+    }
+
+    return signalFilterUpdate(filterStore.states[slot], (SignalFilterKind)kind, kFilterParams, value);
+}
+
+void SensorFilter::apply(SensorReading& reading) {
+#if SENSOR_FILTERS_ENABLED
+    const SensorDriver* driver = SensorDriverRegistry::find(reading.type);
+    if (!driver || driver->filter == SIGNAL_FILTER_NONE) {
+        return;
+    }
+    if (reading.subValueCount == 0) {
+        reading.value = filterValue(reading.sensorId, 0, driver->filter, reading.value);
+    }
+    for (uint8_t i = 0; i < reading.subValueCount; i++) {
+        reading.subValues[i].value = filterValue(reading.sensorId, i, driver->filter,
+                                                 reading.subValues[i].value);
+    }
+#else
+    (void)reading;
+#endif
+}
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+void SensorFilter::apply(ModbusSensorReading& reading) {
+#if SENSOR_FILTERS_ENABLED
+    const ModbusSensorDriver* driver = SensorDriverRegistry::findModbus(reading.type);
+    if (!driver || driver->filter == SIGNAL_FILTER_NONE) {
+        return;
+    }
+    for (uint8_t i = 0; i < reading.subValueCount; i++) {
+        reading.subValues[i].value = filterValue(reading.sensorId, i, driver->filter,
+                                                 reading.subValues[i].value);
+    }
+#else
+    (void)reading;
+#endif
+}
+#endif
@@ -13,72 +13,56 @@
 #include "debug.h"
 #include "utilities.h"
 
+#include "MeasurementContext.h"
+#include "SensorDriver.h"
+#include "SensorScheduler.h"
+#include "SensorFilter.h"
+
 #ifdef DEVICE_TYPE_ANALOGIC
 #include "ADS124S08.h"
-#include "sensors/NtcManager.h"
 #include "AdcUtilities.h"
-#include "sensors/PHSensor.h"
-#include "sensors/ConductivitySensor.h"
-#include "sensors/HDS10Sensor.h"
 extern ADS124S08 ADC;
 #endif
 
-// Inclusión de nuevos sensores
-#include "sensors/RTDSensor.h"
-#include "sensors/SHT30Sensor.h"
-#if defined(DEVICE_TYPE_BASIC) || defined(DEVICE_TYPE_ANALOGIC)
-#include "sensors/DS18B20Sensor.h"
-#endif
-
 // -------------------------------------------------------------------------------------
 // Métodos de la clase SensorManager
 // -------------------------------------------------------------------------------------
 
-void SensorManager::beginSensors(const std::vector<SensorConfig>& enabledNormalSensors) {
-    // Encender alimentación 3.3V
-    powerManager.power3V3On();
-    
+// Tablas estáticas de lecturas (sin memoria dinámica en el ciclo de medición)
+SensorReading SensorManager::_normalReadings[MAX_NORMAL_SENSORS];
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+ModbusSensorReading SensorManager::_modbusReadings[MAX_MODBUS_SENSORS];
+#endif
+unsigned long SensorManager::_cycleStartMs = 0;
+
+// Rieles que necesita la medición de la batería (ADS124S08 en ANALOGIC, ADC interno en el resto)
 #ifdef DEVICE_TYPE_ANALOGIC
-    // Encender alimentación 2.5V solo para dispositivos ANALOGIC
-    powerManager.power2V5On();
+#define MEASUREMENT_BASE_RAILS  (SENSOR_RAIL_3V3 | SENSOR_RAIL_2V5)
+#else
+#define MEASUREMENT_BASE_RAILS  0
 #endif
 
-    // Inicializar RTD y configurarlo
-    rtd.begin();
-    {
-        bool vBias = true;
-        bool autoConvert = true;
-        bool oneShot = false;
-        bool threeWire = false;
-        uint8_t faultCycle = 0; // MAX31865_FAULT_DETECTION_NONE
-        bool faultClear = true;
-        bool filter50Hz = true;
-        uint16_t lowTh = 0x0000;
-        uint16_t highTh = 0x7fff;
-        rtd.configure(vBias, autoConvert, oneShot, threeWire, faultCycle, faultClear, filter50Hz, lowTh, highTh);
+void SensorManager::powerUp(uint8_t rails, Span<const SensorConfig> enabledNormalSensors) {
+    // Un solo encendido y una sola estabilización para todos los rieles del grupo
+    uint8_t powered = powerManager.acquire(rails);
+    if (!powered) {
+        return;
     }
 
-#if defined(DEVICE_TYPE_BASIC) || defined(DEVICE_TYPE_ANALOGIC)
-    // Verificar si hay algún sensor DS18B20
-    bool ds18b20SensorEnabled = false;
-    for (const auto& sensor : enabledNormalSensors) {
-        if (sensor.type == DS18B20 && sensor.enable) {
-            ds18b20SensorEnabled = true;
-            break;
-        }
-    }
+    // Los dispositivos de los rieles recién encendidos perdieron su configuración
+    // (p.ej. MAX31865, bus OneWire del DS18B20)
+    SensorDriverRegistry::beginDrivers(enabledNormalSensors, powered);
 
-    // Inicializar DS18B20 solo si está habilitado en la configuración
-    if (ds18b20SensorEnabled) {
-        // TIEMPO ejecución ≈ 65 ms
-        // Inicializar DS18B20
-        dallasTemp.begin();
-        dallasTemp.requestTemperatures();
+#ifdef DEVICE_TYPE_ANALOGIC
+    const uint8_t adcRails = SENSOR_RAIL_3V3 | SENSOR_RAIL_2V5;
+    if ((powered & adcRails) && (powerManager.activeRails() & adcRails) == adcRails) {
+        beginAdc();
     }
-    ////////////////////////////////////////////////////////////////
 #endif
+}
 
 #ifdef DEVICE_TYPE_ANALOGIC
+void SensorManager::beginAdc() {
     // TIEMPO ejecución ≈ 15 ms
     ADC.begin();
     // Reset del ADC
@@ -95,9 +79,12 @@ void SensorManager::beginSensors(const std::vector<SensorConfig>& enabledNormalS
     
     // Ajustar velocidad de muestreo y modo single shot
     ADC.regWrite(DATARATE_ADDR_MASK, ADS_DR_4000 | ADS_CONVMODE_SS); // Modo single shot
-        ////////////////////////////////////////////////////////////////
-#endif
+
+    // Byte STATUS y CRC en cada conversión para validar las lecturas SPI
+    ADC.regWrite(SYS_ADDR_MASK, ADS_SYS_MON_OFF | ADS_CALSAMPLE_8 | ADS_TIMEOUT_DISABLE |
+                                ADS_CRC_ENABLE | ADS_SENDSTATUS_ENABLE);
 }
+#endif
 
 SensorReading SensorManager::getSensorReading(const SensorConfig &cfg) {
     SensorReading reading;
@@ -105,6 +92,7 @@ SensorReading SensorManager::getSensorReading(const SensorConfig &cfg) {
     reading.sensorId[sizeof(reading.sensorId) - 1] = '\0';
     reading.type = cfg.type;
     reading.value = NAN;
+    reading.subValueCount = 0;
 
     readSensorValue(cfg, reading);
 
@@ -112,99 +100,35 @@ SensorReading SensorManager::getSensorReading(const SensorConfig &cfg) {
 }
 
 /**
- * @brief Lógica principal para leer el valor de cada sensor normal (no Modbus) según su tipo.
+ * @brief Lee un sensor normal (no Modbus) a través de su driver registrado.
+ *        La conversión ya se inició en startConversions().
  */
 float SensorManager::readSensorValue(const SensorConfig &cfg, SensorReading &reading) {
-    switch (cfg.type) {
-        case N100K:
-#ifdef DEVICE_TYPE_ANALOGIC
-            // Usar NtcManager para obtener la temperatura
-            reading.value = NtcManager::readNtc100kTemperature(cfg.configKey);
-#else
-            reading.value = NAN;
-#endif
-            break;
-
-        case N10K:
-#ifdef DEVICE_TYPE_ANALOGIC
-            // Usar NtcManager para obtener la temperatura del NTC de 10k
-            reading.value = NtcManager::readNtc10kTemperature();
-#else
-            reading.value = NAN;
-#endif
-            break;
-            
-        case HDS10:
-#ifdef DEVICE_TYPE_ANALOGIC
-            // Leer sensor HDS10 y obtener el porcentaje de humedad
-            reading.value = HDS10Sensor::read();
-#else
-            reading.value = NAN;
-#endif
-            break;
-            
-        case PH:
-#ifdef DEVICE_TYPE_ANALOGIC
-            // Leer sensor de pH y obtener valor
-            reading.value = PHSensor::read();
-#else
-            reading.value = NAN;
-#endif
-            break;
-
-        case COND:
-#ifdef DEVICE_TYPE_ANALOGIC
-            // Leer sensor de conductividad y obtener valor en ppm
-            reading.value = ConductivitySensor::read();
-#else
-            reading.value = NAN;
-#endif
-            break;
-        
-        case SOILH:
-            reading.value = NAN; 
-            break;
+    const SensorDriver* driver = SensorDriverRegistry::find(cfg.type);
+    if (!driver || !driver->collect) {
+        reading.value = NAN;
+        return reading.value;
+    }
 
-        case RTD:
-            reading.value = RTDSensor::read();
-            break;
+    // Esperar a que la conversión esté lista (acotado por el calentamiento del driver)
+    if (driver->poll) {
+        while (!driver->poll(cfg) && millis() - _cycleStartMs < driver->warmupMs) {
+            delay(1);
+        }
+    }
 
-#if defined(DEVICE_TYPE_BASIC) || defined(DEVICE_TYPE_ANALOGIC)
-        case DS18B20:
-            reading.value = DS18B20Sensor::read();
-            break;
-#endif
+    driver->collect(cfg, reading);
+    return reading.value;
+}
 
-        case SHT30:
-        {
-            float tmp = 0.0f, hum = 0.0f;
-            SHT30Sensor::read(tmp, hum);
-            reading.subValues.clear();
-            
-            // Agregar temperatura como primer valor [0]
-            {
-                SubValue sT; 
-                sT.value = tmp;
-                reading.subValues.push_back(sT);
-            }
-            
-            // Agregar humedad como segundo valor [1]
-            {
-                SubValue sH; 
-                sH.value = hum;
-                reading.subValues.push_back(sH);
-            }
-            
-            // Asignar el valor principal como NAN si alguno de los valores falló
-            reading.value = (isnan(tmp) || isnan(hum)) ? NAN : tmp;
+void SensorManager::startConversions(Span<const SensorConfig> enabledNormalSensors) {
+    _cycleStartMs = millis();
+    for (const auto &sensor : enabledNormalSensors) {
+        const SensorDriver* driver = SensorDriverRegistry::find(sensor.type);
+        if (driver && driver->start) {
+            driver->start(sensor);
         }
-        break;
-
-        default:
-            reading.value = NAN;
-            break;
     }
-    return reading.value;
 }
 
 #if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
@@ -214,95 +138,120 @@ ModbusSensorReading SensorManager::getModbusSensorReading(const ModbusSensorConf
     // Copiar el ID del sensor
     strlcpy(reading.sensorId, cfg.sensorId, sizeof(reading.sensorId));
     reading.type = cfg.type;
+    reading.subValueCount = 0;
     
-    // Leer sensor según su tipo
-    switch (cfg.type) {
-        case ENV4:
-            reading = ModbusSensorManager::readEnvSensor(cfg);
-            break;
-        // Añadir casos para otros tipos de sensores Modbus
-        default:
-            DEBUG_PRINTLN("Tipo de sensor Modbus no soportado");
-            break;
+    // Leer sensor mediante su driver
+    const ModbusSensorDriver* driver = SensorDriverRegistry::findModbus(cfg.type);
+    if (driver && driver->collect) {
+        driver->collect(cfg, reading);
+    } else {
+        DEBUG_PRINTLN("Tipo de sensor Modbus no soportado");
     }
     
     return reading;
 }
 #endif
 
-void SensorManager::getAllSensorReadings(std::vector<SensorReading>& normalReadings,
+void SensorManager::getAllSensorReadings(Span<const SensorReading>& normalReadings,
 #if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
-                                        std::vector<ModbusSensorReading>& modbusReadings,
+                                        Span<const ModbusSensorReading>& modbusReadings,
 #endif
-                                        const std::vector<SensorConfig>& enabledNormalSensors
+                                        Span<const SensorConfig> enabledNormalSensors
 #if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
-                                        , const std::vector<ModbusSensorConfig>& enabledModbusSensors
+                                        , Span<const ModbusSensorConfig> enabledModbusSensors
 #endif
                                         ) {
-    // Reservar espacio para los vectores
-    normalReadings.reserve(enabledNormalSensors.size());
+    // Las lecturas se escriben en las tablas estáticas; el tamaño activo lo fija la
+    // configuración cargada al arrancar (acotada por MAX_NORMAL_SENSORS / MAX_MODBUS_SENSORS)
+    size_t normalCount = 0;
 #if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
-    modbusReadings.reserve(enabledModbusSensors.size());
+    size_t modbusCount = 0;
 #endif
     
-    // Leer sensores normales
-    for (const auto &sensor : enabledNormalSensors) {
-        normalReadings.push_back(getSensorReading(sensor));
+    // Rieles de cada grupo de consumidores según los metadatos de los drivers
+    bool batteryDue = SensorScheduler::batteryDue();
+    uint8_t normalRails = (batteryDue ? MEASUREMENT_BASE_RAILS : 0) |
+                          SensorDriverRegistry::requiredRails(enabledNormalSensors);
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    uint8_t modbusRails = 0;
+    uint32_t maxStabilizationTime = 0;
+    if (!enabledModbusSensors.empty()) {
+        modbusRails = SensorDriverRegistry::requiredRails(enabledModbusSensors);
+        maxStabilizationTime = SensorDriverRegistry::maxWarmupMs(enabledModbusSensors);
+    }
+
+    // Encender todos los rieles a la vez: la estabilización de los sensores Modbus transcurre
+    // mientras se leen los sensores normales. Un riel compartido recibe una referencia por
+    // grupo para que siga encendido hasta que termine el último.
+    powerUp(normalRails | modbusRails, enabledNormalSensors);
+    powerManager.acquire(normalRails & modbusRails);
+    unsigned long railsOnMs = millis();
+#else
+    powerUp(normalRails, enabledNormalSensors);
+#endif
+
+    // Evaluar una sola vez las entradas compartidas del ciclo (compensaciones, batería)
+    MeasurementContext::beginCycle();
+    MeasurementContext::prepare(enabledNormalSensors, batteryDue);
+
+    // Iniciar conversiones asíncronas (p.ej. DS18B20) antes de recorrer los sensores
+    startConversions(enabledNormalSensors);
+
+    // Leer sensores normales agrupados por bus (el canal del ADC no se alterna con otros
+    // buses y las conversiones en segundo plano se recogen al final). Cada lectura conserva
+    // la posición de su sensor en la lista de habilitados.
+    normalCount = enabledNormalSensors.size() < MAX_NORMAL_SENSORS ?
+                  enabledNormalSensors.size() : MAX_NORMAL_SENSORS;
+    for (SensorBus bus : SensorDriverRegistry::collectOrder()) {
+        for (size_t i = 0; i < normalCount; i++) {
+            const SensorConfig& sensor = enabledNormalSensors[i];
+            if (SensorDriverRegistry::busOf(sensor.type) != bus) {
+                continue;
+            }
+            // Filtrado con estado entre despertares antes de codificar
+            _normalReadings[i] = getSensorReading(sensor);
+            SensorFilter::apply(_normalReadings[i]);
+        }
     }
+    normalReadings = Span<const SensorReading>(_normalReadings, normalCount);
+#ifdef DEVICE_TYPE_ANALOGIC
+    // Todas las conversiones del ciclo (sensores y batería) ya pasaron por el ADC
+    AdcUtilities::reportChannelErrors();
+    AdcUtilities::reportNoise();
+#endif
+
+    // Los sensores normales ya terminaron: apagar sus rieles si nadie más los usa
+    powerManager.release(normalRails);
     
 #if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
     // Si hay sensores Modbus, inicializar comunicación, leerlos y finalizar
     if (!enabledModbusSensors.empty()) {
-        // Determinar el tiempo máximo de estabilización necesario
-        uint32_t maxStabilizationTime = 0;
-        
-        // Revisar cada sensor habilitado para encontrar el tiempo máximo
-        for (const auto &sensor : enabledModbusSensors) {
-            uint32_t sensorStabilizationTime = 0;
-            
-            // Obtener el tiempo de estabilización según el tipo de sensor
-            switch (sensor.type) {
-                case ENV4:
-                    sensorStabilizationTime = MODBUS_ENV4_STABILIZATION_TIME;
-                    break;
-                // Añadir casos para otros tipos de sensores Modbus con sus respectivos tiempos
-                default:
-                    sensorStabilizationTime = 500; // Tiempo predeterminado si no se especifica
-                    break;
-            }
-            
-            // Actualizar el tiempo máximo si este sensor necesita más tiempo
-            if (sensorStabilizationTime > maxStabilizationTime) {
-                maxStabilizationTime = sensorStabilizationTime;
-            }
+        // Esperar solo lo que falte de la estabilización tras encender los rieles
+        uint32_t elapsed = millis() - railsOnMs;
+        if (elapsed < maxStabilizationTime) {
+            DEBUG_PRINTF("Esperando %lu ms para estabilización de sensores Modbus\n",
+                         (unsigned long)(maxStabilizationTime - elapsed));
+            delay(maxStabilizationTime - elapsed);
         }
         
-        // Encender alimentación de 12V para sensores Modbus
-#if defined(DEVICE_TYPE_MODBUS) || defined(DEVICE_TYPE_ANALOGIC)
-        powerManager.power12VOn();
-        DEBUG_PRINTF("Esperando %u ms para estabilización de sensores Modbus\n", maxStabilizationTime);
-        delay(maxStabilizationTime);
-#endif
-        
         // Inicializar comunicación Modbus antes de comenzar las mediciones
         ModbusSensorManager::beginModbus();
         
         // Leer todos los sensores Modbus
         for (const auto &sensor : enabledModbusSensors) {
-            modbusReadings.push_back(getModbusSensorReading(sensor));
+            if (modbusCount >= MAX_MODBUS_SENSORS) {
+                break;
+            }
+            _modbusReadings[modbusCount] = getModbusSensorReading(sensor);
+            SensorFilter::apply(_modbusReadings[modbusCount++]);
         }
         
         // Finalizar comunicación Modbus después de completar todas las lecturas
         ModbusSensorManager::endModbus();
         
-        // Apagar alimentación de 12V después de completar las lecturas
-#if defined(DEVICE_TYPE_MODBUS) || defined(DEVICE_TYPE_ANALOGIC)
-        powerManager.power12VOff();
-#endif
+        // Apagar los rieles Modbus después de completar las lecturas
+        powerManager.release(modbusRails);
     }
+    modbusReadings = Span<const ModbusSensorReading>(_modbusReadings, modbusCount);
 #endif
 }
-
-#ifdef DEVICE_TYPE_ANALOGIC
-// Las funciones de sensores se han movido a sus propias clases
-#endif
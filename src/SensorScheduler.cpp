@@ -0,0 +1,94 @@
+/*******************************************************************************************
+ * Archivo: src/SensorScheduler.cpp
+ * Descripción: Implementación de la planificación multi-tasa por sensor.
+ *******************************************************************************************/
+
+#include "SensorScheduler.h"
+#include "WakeStub.h"
+#include "debug.h"
+
+#define SENSOR_SCHEDULER_MAGIC  0x5C4E
+#define SENSOR_NEVER_READ       0xFFFFFFFFUL
+
+/**
+ * @brief Estado que sobrevive al deep sleep. Los sensores se identifican por su posición
+ *        en la lista de habilitados, que solo cambia al reconfigurar (arranque completo).
+ */
+struct SensorSchedulerState {
+    uint16_t magic;
+    uint32_t batteryTick;
+    uint32_t normalTicks[MAX_NORMAL_SENSORS];
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    uint32_t modbusTicks[MAX_MODBUS_SENSORS];
+#endif
+};
+
+RTC_DATA_ATTR static SensorSchedulerState schedulerState;
+
+uint32_t SensorScheduler::_tick = 0;
+bool SensorScheduler::_batteryDue = true;
+SensorConfig SensorScheduler::_dueNormal[MAX_NORMAL_SENSORS];
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+ModbusSensorConfig SensorScheduler::_dueModbus[MAX_MODBUS_SENSORS];
+#endif
+
+void SensorScheduler::begin(BootMode bootMode) {
+    if (bootMode == BOOT_MODE_WARM && schedulerState.magic == SENSOR_SCHEDULER_MAGIC) {
+        return;
+    }
+    // Mismas condiciones de reinicio que la planificación del wake stub (tick 0)
+    memset(&schedulerState, 0xFF, sizeof(schedulerState));
+    schedulerState.magic = SENSOR_SCHEDULER_MAGIC;
+}
+
+bool SensorScheduler::due(uint32_t& lastTick, uint8_t periodTicks) {
+    // Se compara con el tiempo desde la última lectura y no con tick % periodo: los ticks
+    // en que el stub no arrancó el firmware no deben hacer perder la lectura
+    uint32_t period = (periodTicks == 0) ? 1 : periodTicks;
+    if (lastTick != SENSOR_NEVER_READ && _tick >= lastTick && _tick - lastTick < period) {
+        return false;
+    }
+    lastTick = _tick;
+    return true;
+}
+
+void SensorScheduler::beginTick() {
+    _tick = WakeStub::tick();
+    _batteryDue = due(schedulerState.batteryTick, BATTERY_SAMPLE_EVERY_TICKS);
+}
+
+Span<const SensorConfig> SensorScheduler::dueNormal(Span<const SensorConfig> sensors) {
+    size_t count = 0;
+    size_t index = 0;
+    for (const SensorConfig& sensor : sensors) {
+        if (index >= MAX_NORMAL_SENSORS) {
+            break;
+        }
+        if (due(schedulerState.normalTicks[index++], sensor.periodTicks)) {
+            _dueNormal[count++] = sensor;
+        }
+    }
+    DEBUG_PRINTF("Tick %lu: %u de %u sensores\n", (unsigned long)_tick,
+                 (unsigned)count, (unsigned)sensors.size());
+    return Span<const SensorConfig>(_dueNormal, count);
+}
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+Span<const ModbusSensorConfig> SensorScheduler::dueModbus(Span<const ModbusSensorConfig> sensors) {
+    size_t count = 0;
+    size_t index = 0;
+    for (const ModbusSensorConfig& sensor : sensors) {
+        if (index >= MAX_MODBUS_SENSORS) {
+            break;
+        }
+        if (due(schedulerState.modbusTicks[index++], sensor.periodTicks)) {
+            _dueModbus[count++] = sensor;
+        }
+    }
+    return Span<const ModbusSensorConfig>(_dueModbus, count);
+}
+#endif
+
+bool SensorScheduler::batteryDue() {
+    return _batteryDue;
+}
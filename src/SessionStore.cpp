@@ -0,0 +1,107 @@
+/*******************************************************************************************
+ * Archivo: src/SessionStore.cpp
+ * Descripción: Implementación de la copia de la sesión LoRaWAN en NVS.
+ *******************************************************************************************/
+
+#include "SessionStore.h"
+#include <Preferences.h>
+#include "debug.h"
+
+#define SESSION_STORE_MAGIC     0x5E55
+#define SESSION_NVS_NAMESPACE   "radiolib"     // Junto a los nonces
+#define SESSION_NVS_KEY         "session"
+
+/**
+ * @brief Estado que sobrevive al deep sleep
+ */
+struct SessionStoreState {
+    uint16_t magic;
+    uint32_t checkpointFCnt;    // FCnt de subida del último checkpoint
+};
+
+RTC_DATA_ATTR static SessionStoreState sessionState;
+
+// Campos del buffer de sesión de RadioLib (little-endian)
+static uint32_t readLe32(const uint8_t* buffer) {
+    return (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) |
+           ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+static void writeLe32(uint8_t* buffer, uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) {
+        buffer[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+/**
+ * @brief Firma del buffer de sesión (misma suma XOR de 16 bits que RadioLib)
+ */
+static uint16_t sessionSignature(const uint8_t* session) {
+    const size_t length = RADIOLIB_LORAWAN_SESSION_BUF_SIZE - 2;
+    uint16_t sum = 0;
+    for (size_t i = 0; i + 1 < length; i += 2) {
+        sum ^= ((uint16_t)session[i] << 8) | session[i + 1];
+    }
+    if (length % 2 == 1) {
+        sum ^= (uint16_t)session[length - 1] << 8;
+    }
+    return sum;
+}
+
+static void writeSession(const uint8_t* session, uint32_t fCntUp) {
+    Preferences store;
+    store.begin(SESSION_NVS_NAMESPACE, false);
+    store.putBytes(SESSION_NVS_KEY, session, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+    store.end();
+    sessionState.magic = SESSION_STORE_MAGIC;
+    sessionState.checkpointFCnt = fCntUp;
+    DEBUG_PRINTF("Sesión guardada en flash (FCnt %lu)\n", (unsigned long)fCntUp);
+}
+
+void SessionStore::begin(BootMode bootMode) {
+    if (bootMode == BOOT_MODE_COLD || sessionState.magic != SESSION_STORE_MAGIC) {
+        sessionState.magic = 0;
+    }
+}
+
+bool SessionStore::restore(uint8_t* session) {
+    Preferences store;
+    store.begin(SESSION_NVS_NAMESPACE, true);
+    bool found = store.getBytesLength(SESSION_NVS_KEY) == RADIOLIB_LORAWAN_SESSION_BUF_SIZE &&
+                 store.getBytes(SESSION_NVS_KEY, session, RADIOLIB_LORAWAN_SESSION_BUF_SIZE) ==
+                     RADIOLIB_LORAWAN_SESSION_BUF_SIZE;
+    store.end();
+
+    uint8_t* signature = &session[RADIOLIB_LORAWAN_SESSION_BUF_SIZE - 2];
+    if (!found || sessionSignature(session) != (uint16_t)(signature[0] | (signature[1] << 8))) {
+        return false;
+    }
+
+    // Los uplinks posteriores al checkpoint no quedaron en flash: saltar por encima de ellos
+    uint32_t fCntUp = readLe32(&session[RADIOLIB_LORAWAN_SESSION_FCNT_UP]) + SESSION_FCNT_GAP;
+    writeLe32(&session[RADIOLIB_LORAWAN_SESSION_FCNT_UP], fCntUp);
+    uint16_t sum = sessionSignature(session);
+    signature[0] = (uint8_t)sum;
+    signature[1] = (uint8_t)(sum >> 8);
+
+    // Guardar ya el salto: otro corte antes del siguiente checkpoint no debe repetir FCnt
+    writeSession(session, fCntUp);
+    DEBUG_PRINTLN("Sesión restaurada desde flash");
+    return true;
+}
+
+void SessionStore::save(LoRaWANNode& node) {
+    writeSession(node.getBufferSession(), node.getFCntUp());
+}
+
+void SessionStore::checkpoint(LoRaWANNode& node) {
+    if (!node.isActivated()) {
+        return;
+    }
+    uint32_t fCntUp = node.getFCntUp();
+    if (sessionState.magic == SESSION_STORE_MAGIC &&
+        fCntUp - sessionState.checkpointFCnt < SESSION_CHECKPOINT_EVERY) {
+        return;
+    }
+    save(node);
+}
@@ -6,6 +6,12 @@
 #include "SleepManager.h"
 #include "debug.h"
 #include "LoRaManager.h"
+#include "BootManager.h"
+#include "WakeStub.h"
+#include "SlotScheduler.h"
+
+// Duración media de un arranque en caliente (ms, 0 = sin medir)
+RTC_DATA_ATTR static uint32_t bootCostMs = 0;
 
 void SleepManager::goToDeepSleep(uint32_t timeToSleep, 
                                PowerManager& powerManager,
@@ -14,9 +20,15 @@ void SleepManager::goToDeepSleep(uint32_t timeToSleep,
                                LoRaWANNode& node,
                                uint8_t* LWsession,
                                SPIClass& spi) {
-    // Guardar sesión en RTC y otras rutinas de apagado
-    uint8_t *persist = node.getBufferSession();
-    memcpy(LWsession, persist, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+    // Próximo slot alineado (usa el DS3231, antes de apagar I2C)
+    uint64_t sleepUs = SlotScheduler::nextSleepUs(timeToSleep, true);
+
+    // Guardar sesión en RTC y otras rutinas de apagado. En un ciclo de solo muestreo el nodo
+    // no se activó y la sesión guardada sigue siendo la vigente.
+    if (node.isActivated()) {
+        uint8_t *persist = node.getBufferSession();
+        memcpy(LWsession, persist, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+    }
     
     // Apagar todos los reguladores
     powerManager.allPowerOff();
@@ -29,6 +41,9 @@ void SleepManager::goToDeepSleep(uint32_t timeToSleep,
     LoRaManager::prepareForSleep(radio);
     btStop();
 
+    // Guardar el estado del expansor para el siguiente despertar en caliente
+    BootManager::commitBeforeSleep(ioExpander);
+
     // Poner el PCA9555 en modo sleep
     ioExpander.sleep();
 
@@ -37,17 +52,71 @@ void SleepManager::goToDeepSleep(uint32_t timeToSleep,
     spi.end();
     
     // Configurar el temporizador y GPIO para despertar
-    esp_sleep_enable_timer_wakeup(timeToSleep * 1000000ULL);
+    esp_sleep_enable_timer_wakeup(sleepUs);
     gpio_wakeup_enable((gpio_num_t)CONFIG_PIN, GPIO_INTR_LOW_LEVEL);
     esp_sleep_enable_gpio_wakeup();
+#ifdef RTC_ALARM_WAKE_PIN
+    esp_deep_sleep_enable_gpio_wakeup(BIT(CONFIG_PIN) | BIT(RTC_ALARM_WAKE_PIN), ESP_GPIO_WAKEUP_GPIO_LOW);
+#else
     esp_deep_sleep_enable_gpio_wakeup(BIT(CONFIG_PIN), ESP_GPIO_WAKEUP_GPIO_LOW);
+#endif
     
     // Configurar pines para deep sleep
     configurePinsForDeepSleep();
+
+    // Rejilla para que el wake stub pueda volver a dormir en los ticks sin trabajo
+    WakeStub::prepareSleep(SlotScheduler::plannedSleepUs(), SlotScheduler::tickSleepUs(timeToSleep));
     
     esp_deep_sleep_start();
 }
 
+/**
+ * @brief Sueño ligero hasta el temporizador o el pin de configuración
+ * @return true si despertó por el temporizador
+ */
+static bool enterLightSleep(uint64_t sleepUs, SX1262* radio) {
+    // La radio y el PCA9555 conservan su configuración; los rieles de sensores ya están apagados
+    LoRaManager::prepareForSleep(radio);
+    DEBUG_FLUSH();
+
+    esp_sleep_enable_timer_wakeup(sleepUs);
+    gpio_wakeup_enable((gpio_num_t)CONFIG_PIN, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    esp_light_sleep_start();
+
+    return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER;
+}
+
+bool SleepManager::lightSleep(uint32_t timeToSleep, SX1262* radio) {
+    bool timerWake = enterLightSleep(SlotScheduler::nextSleepUs(timeToSleep, false), radio);
+    SlotScheduler::noteLightWake(timerWake);
+    return timerWake;
+}
+
+bool SleepManager::napMs(uint32_t durationMs, SX1262* radio) {
+    return enterLightSleep((uint64_t)durationMs * 1000ULL, radio);
+}
+
+bool SleepManager::useLightSleep(uint32_t timeToSleep) {
+#if LIGHT_SLEEP_ENABLED
+    uint32_t bootMs = (bootCostMs != 0) ? bootCostMs : BOOT_COST_DEFAULT_MS;
+
+    // Energías en µA·ms
+    uint64_t bootEnergy = (uint64_t)(bootMs + BOOT_ROM_OVERHEAD_MS) * BOOT_ACTIVE_CURRENT_UA;
+    uint64_t lightExtra = (uint64_t)timeToSleep * 1000ULL * (LIGHT_SLEEP_CURRENT_UA - DEEP_SLEEP_CURRENT_UA);
+    return lightExtra < bootEnergy;
+#else
+    return false;
+#endif
+}
+
+void SleepManager::recordBootCost(uint32_t setupMs) {
+    // Media móvil exponencial (1/4) para suavizar arranques con reintentos
+    bootCostMs = (bootCostMs == 0) ? setupMs : (bootCostMs * 3 + setupMs) / 4;
+    DEBUG_PRINTF("Coste de arranque: %lu ms (media %lu ms)\n",
+                 (unsigned long)setupMs, (unsigned long)bootCostMs);
+}
+
 /**
  * @brief Configura los pines no utilizados en alta impedancia para reducir el consumo durante deep sleep.
  */
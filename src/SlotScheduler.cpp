@@ -0,0 +1,186 @@
+/*******************************************************************************************
+ * Archivo: src/SlotScheduler.cpp
+ * Descripción: Implementación de los despertares alineados al reloj de pared.
+ *******************************************************************************************/
+
+#include "SlotScheduler.h"
+#include "debug.h"
+#include "WakeStub.h"
+
+#define SLOT_SCHEDULER_MAGIC    0x5107
+
+/**
+ * @brief Estado que sobrevive al deep sleep
+ */
+struct SlotSchedulerState {
+    uint16_t magic;
+    uint32_t sleepStartUnix;        // Hora del DS3231 al calcular el último deep sleep
+    uint32_t requestedMs;           // Sueño pedido al temporizador (tiempo del reloj lento)
+    uint32_t targetSlot;            // Slot al que apunta el siguiente despertar
+    uint32_t interval;              // Periodo de los slots del último deep sleep (s)
+    uint32_t tickMs;                // Ese periodo en tiempo del reloj lento (ticks del stub)
+    int32_t driftPpm;               // Deriva del reloj lento (+ = el sueño real dura más)
+    uint32_t latencyDeepMs;         // Despertar → inicio de medición, desde deep sleep
+    uint32_t latencyLightMs;        // Ídem desde sueño ligero
+};
+
+RTC_DATA_ATTR static SlotSchedulerState slotState;
+
+RTC_DS3231* SlotScheduler::_rtc = nullptr;
+bool SlotScheduler::_rtcValid = false;
+uint32_t SlotScheduler::_wakeMs = 0;
+bool SlotScheduler::_deepWake = true;
+bool SlotScheduler::_scheduledWake = false;
+uint32_t SlotScheduler::_currentSlot = 0;
+uint64_t SlotScheduler::_plannedSleepUs = 0;
+
+void SlotScheduler::begin(RTC_DS3231& rtc, BootMode bootMode) {
+    _rtc = &rtc;
+    uint32_t now = rtc.now().unixtime();
+    _rtcValid = !rtc.lostPower() && now >= SLOT_MIN_VALID_UNIX;
+
+#ifdef RTC_ALARM_WAKE_PIN
+    // INT/SQW en modo alarma; limpiar la alarma que pudo despertarnos
+    rtc.writeSqwPinMode(DS3231_OFF);
+    rtc.clearAlarm(1);
+#endif
+
+    if (slotState.magic != SLOT_SCHEDULER_MAGIC || bootMode == BOOT_MODE_COLD) {
+        memset(&slotState, 0, sizeof(slotState));
+        slotState.latencyDeepMs = BOOT_COST_DEFAULT_MS + BOOT_ROM_OVERHEAD_MS;
+        slotState.magic = SLOT_SCHEDULER_MAGIC;
+    }
+
+    // Los ticks que resolvió el wake stub sin arrancar siguen la rejilla: el despertar
+    // actual apunta a tantos slots más allá y el sueño pedido creció otro tanto
+    uint32_t idleTicks = WakeStub::idleTicksSinceBoot();
+    if (bootMode == BOOT_MODE_WARM && idleTicks != 0 && slotState.targetSlot != 0) {
+        slotState.targetSlot += idleTicks * slotState.interval;
+        uint64_t requestedMs = slotState.requestedMs + (uint64_t)idleTicks * slotState.tickMs;
+        slotState.requestedMs = (requestedMs <= UINT32_MAX) ? (uint32_t)requestedMs : 0;
+    }
+
+    _wakeMs = 0;
+    _deepWake = true;
+    _scheduledWake = (bootMode == BOOT_MODE_WARM);
+    _currentSlot = _scheduledWake ? slotState.targetSlot : 0;
+
+    // Deriva: tiempo real en el DS3231 frente al sueño pedido más lo que llevamos despiertos.
+    // El DS3231 tiene resolución de 1 s, por eso solo se usan sueños largos y se promedia.
+    if (_scheduledWake && _rtcValid && slotState.requestedMs >= SLOT_DRIFT_MIN_SLEEP_MS &&
+        now >= slotState.sleepStartUnix) {
+        int64_t actualMs = (int64_t)(now - slotState.sleepStartUnix) * 1000 -
+                           (int64_t)(millis() + BOOT_ROM_OVERHEAD_MS);
+        int32_t samplePpm = (int32_t)((actualMs - (int64_t)slotState.requestedMs) * 1000000LL /
+                                      (int64_t)slotState.requestedMs);
+        if (samplePpm >= -SLOT_DRIFT_MAX_PPM && samplePpm <= SLOT_DRIFT_MAX_PPM) {
+            slotState.driftPpm += (samplePpm - slotState.driftPpm) / 8;
+        }
+        DEBUG_PRINTF("Deriva del reloj lento: muestra %ld ppm, media %ld ppm\n",
+                     (long)samplePpm, (long)slotState.driftPpm);
+    }
+}
+
+void SlotScheduler::noteLightWake(bool timerWake) {
+    _wakeMs = millis();
+    _deepWake = false;
+    _scheduledWake = timerWake;
+    _currentSlot = timerWake ? slotState.targetSlot : 0;
+}
+
+void SlotScheduler::markMeasurementStart() {
+    if (!_scheduledWake) {
+        return;
+    }
+    _scheduledWake = false;
+
+    uint32_t latency = millis() - _wakeMs;
+    if (_deepWake) {
+        latency += BOOT_ROM_OVERHEAD_MS;
+    }
+    uint32_t& learned = _deepWake ? slotState.latencyDeepMs : slotState.latencyLightMs;
+    learned = (learned == 0) ? latency : (learned * 3 + latency) / 4;
+}
+
+uint64_t SlotScheduler::nextSleepUs(uint32_t interval, bool deepSleep) {
+    uint64_t plainUs = (uint64_t)interval * 1000000ULL;
+    _plannedSleepUs = plainUs;
+    slotState.targetSlot = 0;
+#if SLOT_ALIGNMENT_ENABLED
+    if (_rtc == nullptr || !_rtcValid || interval == 0) {
+        slotState.requestedMs = 0;
+        return plainUs;
+    }
+
+    // El DS3231 solo da segundos enteros: se supone la mitad del segundo en curso
+    uint32_t nowS = _rtc->now().unixtime();
+    uint64_t nowMs = (uint64_t)nowS * 1000ULL + 500;
+    uint32_t latencyMs = deepSleep ? slotState.latencyDeepMs : slotState.latencyLightMs;
+
+    uint64_t slot = ((uint64_t)(nowS - SLOT_OFFSET_S) / interval + 1) * interval + SLOT_OFFSET_S;
+    while (slot * 1000ULL < nowMs + latencyMs + SLOT_MIN_SLEEP_MS) {
+        slot += interval;
+    }
+    uint64_t wallMs = slot * 1000ULL - latencyMs - nowMs;
+
+    // Corregir la deriva del reloj lento medida frente al DS3231
+    uint64_t requestedMs = wallMs * 1000000ULL / (uint64_t)(1000000LL + slotState.driftPpm);
+
+    slotState.targetSlot = (uint32_t)slot;
+    slotState.sleepStartUnix = nowS;
+    slotState.requestedMs = deepSleep ? (uint32_t)requestedMs : 0;
+    slotState.interval = interval;
+    slotState.tickMs = (uint32_t)(tickSleepUs(interval) / 1000ULL);
+    _plannedSleepUs = requestedMs * 1000ULL;
+
+    DEBUG_PRINTF("Próximo slot %lu: dormir %lu ms (latencia %lu ms, deriva %ld ppm)\n",
+                 (unsigned long)slot, (unsigned long)requestedMs,
+                 (unsigned long)latencyMs, (long)slotState.driftPpm);
+
+#ifdef RTC_ALARM_WAKE_PIN
+    if (deepSleep) {
+        // La alarma tiene resolución de 1 s; el temporizador queda como respaldo
+        _rtc->clearAlarm(1);
+        _rtc->setAlarm1(DateTime((uint32_t)((nowMs + wallMs) / 1000ULL)), DS3231_A1_Date);
+        return (requestedMs + SLOT_ALARM_FALLBACK_MS) * 1000ULL;
+    }
+#endif
+    return requestedMs * 1000ULL;
+#else
+    (void)deepSleep;
+    return plainUs;
+#endif
+}
+
+uint64_t SlotScheduler::plannedSleepUs() {
+    return _plannedSleepUs;
+}
+
+uint64_t SlotScheduler::tickSleepUs(uint32_t interval) {
+    uint64_t wallUs = (uint64_t)interval * 1000000ULL;
+#if SLOT_ALIGNMENT_ENABLED
+    return wallUs * 1000000ULL / (uint64_t)(1000000LL + slotState.driftPpm);
+#else
+    return wallUs;
+#endif
+}
+
+uint32_t SlotScheduler::timestamp(RTC_DS3231& rtc) {
+    uint32_t now = rtc.now().unixtime();
+    if (_currentSlot != 0) {
+        int32_t offset = (int32_t)(now - _currentSlot);
+        if (offset >= -SLOT_TIMESTAMP_TOLERANCE_S && offset <= SLOT_TIMESTAMP_TOLERANCE_S) {
+            return _currentSlot;
+        }
+    }
+    return now;
+}
+
+#ifdef RTC_ALARM_WAKE_PIN
+bool SlotScheduler::alarmWake() {
+    // La salida INT del DS3231 queda en bajo hasta limpiar la alarma
+    pinMode(RTC_ALARM_WAKE_PIN, INPUT);
+    pinMode(CONFIG_PIN, INPUT);
+    return digitalRead(RTC_ALARM_WAKE_PIN) == LOW && digitalRead(CONFIG_PIN) == HIGH;
+}
+#endif
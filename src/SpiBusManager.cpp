@@ -0,0 +1,220 @@
+/*******************************************************************************************
+ * Archivo: src/SpiBusManager.cpp
+ * Descripción: Implementación de la gestión del bus SPI compartido.
+ *******************************************************************************************/
+
+#include "SpiBusManager.h"
+#include "debug.h"
+
+SPIClass* SpiBusManager::_spi = nullptr;
+SemaphoreHandle_t SpiBusManager::_mutex = nullptr;
+SpiDevice SpiBusManager::_devices[SPI_BUS_MAX_DEVICES];
+uint8_t SpiBusManager::_deviceCount = 0;
+SpiDeviceHandle SpiBusManager::_stack[SPI_BUS_MAX_DEPTH];
+uint8_t SpiBusManager::_depth = 0;
+
+void SpiBusManager::begin(SPIClass& spi) {
+    _spi = &spi;
+    _spi->begin(SPI_SCK_PIN, SPI_MISO_PIN, SPI_MOSI_PIN);
+
+    if (_mutex == nullptr) {
+        // Mutex recursivo: una ráfaga puede anidar transacciones del mismo dispositivo.
+        // Las tareas en espera se atienden por prioridad (herencia de prioridad incluida).
+        _mutex = xSemaphoreCreateRecursiveMutex();
+    }
+}
+
+SpiDeviceHandle SpiBusManager::registerDevice(const char* name, uint32_t clock, uint8_t dataMode,
+                                              SpiCsStrategy csStrategy, uint8_t csPin,
+                                              PCA9555* ioExpander) {
+    if (_deviceCount >= SPI_BUS_MAX_DEVICES) {
+        return SPI_DEVICE_INVALID;
+    }
+    SpiDevice& dev = _devices[_deviceCount];
+    dev.name = name;
+    dev.clock = clock;
+    dev.dataMode = dataMode;
+    dev.csStrategy = csStrategy;
+    dev.csPin = csPin;
+    dev.ioExpander = ioExpander;
+    return (SpiDeviceHandle)_deviceCount++;
+}
+
+const SpiDevice* SpiBusManager::getDevice(SpiDeviceHandle device) {
+    if (device < 0 || device >= _deviceCount) {
+        return nullptr;
+    }
+    return &_devices[device];
+}
+
+void SpiBusManager::applySettings(SpiDeviceHandle device) {
+    const SpiDevice* dev = getDevice(device);
+    _spi->beginTransaction(SPISettings(dev->clock, MSBFIRST, dev->dataMode));
+}
+
+bool SpiBusManager::ownsBus() {
+    return _mutex == nullptr || xSemaphoreGetMutexHolder(_mutex) == xTaskGetCurrentTaskHandle();
+}
+
+bool SpiBusManager::beginTransaction(SpiDeviceHandle device) {
+    const SpiDevice* dev = getDevice(device);
+    if (dev == nullptr || _spi == nullptr) {
+        return false;
+    }
+
+    if (_mutex != nullptr &&
+        xSemaphoreTakeRecursive(_mutex, pdMS_TO_TICKS(SPI_BUS_LOCK_TIMEOUT_MS)) != pdTRUE) {
+        DEBUG_PRINTF("SPI: timeout esperando el bus (%s)\n", dev->name);
+        return false;
+    }
+
+    if (_depth >= SPI_BUS_MAX_DEPTH) {
+        DEBUG_PRINTF("SPI: demasiadas transacciones anidadas (%s)\n", dev->name);
+        if (_mutex != nullptr) {
+            xSemaphoreGiveRecursive(_mutex);
+        }
+        return false;
+    }
+
+    if (_depth == 0) {
+        applySettings(device);
+    } else if (_stack[_depth - 1] != device) {
+        // Transacción anidada de otro dispositivo: reaplicar reloj y modo
+        _spi->endTransaction();
+        applySettings(device);
+    }
+    _stack[_depth++] = device;
+    return true;
+}
+
+void SpiBusManager::endTransaction(SpiDeviceHandle device) {
+    if (_depth == 0 || _stack[_depth - 1] != device || !ownsBus()) {
+        return;
+    }
+
+    _depth--;
+    if (_depth == 0) {
+        _spi->endTransaction();
+    } else if (_stack[_depth - 1] != device) {
+        // Vuelve la transacción exterior de otro dispositivo: restaurar su reloj y modo
+        _spi->endTransaction();
+        applySettings(_stack[_depth - 1]);
+    }
+
+    if (_mutex != nullptr) {
+        xSemaphoreGiveRecursive(_mutex);
+    }
+}
+
+void SpiBusManager::initChipSelect(SpiDeviceHandle device) {
+    const SpiDevice* dev = getDevice(device);
+    if (dev == nullptr) {
+        return;
+    }
+    if (dev->csStrategy == SPI_CS_NATIVE_GPIO) {
+        pinMode(dev->csPin, OUTPUT);
+    } else if (dev->csStrategy == SPI_CS_PCA9555 && dev->ioExpander) {
+        dev->ioExpander->pinMode(dev->csPin, OUTPUT);
+    }
+    deselect(device);
+}
+
+void SpiBusManager::select(SpiDeviceHandle device) {
+    const SpiDevice* dev = getDevice(device);
+    if (dev == nullptr) {
+        return;
+    }
+    switch (dev->csStrategy) {
+        case SPI_CS_NATIVE_GPIO:
+            digitalWrite(dev->csPin, LOW);
+            break;
+        case SPI_CS_PCA9555:
+            if (dev->ioExpander) {
+                dev->ioExpander->digitalWrite(dev->csPin, LOW);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void SpiBusManager::deselect(SpiDeviceHandle device) {
+    const SpiDevice* dev = getDevice(device);
+    if (dev == nullptr) {
+        return;
+    }
+    switch (dev->csStrategy) {
+        case SPI_CS_NATIVE_GPIO:
+            digitalWrite(dev->csPin, HIGH);
+            break;
+        case SPI_CS_PCA9555:
+            if (dev->ioExpander) {
+                dev->ioExpander->digitalWrite(dev->csPin, HIGH);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+uint8_t SpiBusManager::transfer(uint8_t data) {
+    return _spi->transfer(data);
+}
+
+void SpiBusManager::transfer(const uint8_t* tx, uint8_t* rx, size_t len) {
+    if (len >= SPI_BUS_BULK_THRESHOLD) {
+        // Transferencia en bloque por la FIFO del periférico (sin intervención por byte)
+        if (rx != nullptr) {
+            if (tx == nullptr) {
+                // Enviar ceros (NOP) en lugar del 0xFF que usa transferBytes sin datos
+                memset(rx, 0, len);
+                tx = rx;
+            }
+            _spi->transferBytes(tx, rx, len);
+        } else if (tx != nullptr) {
+            _spi->writeBytes(tx, len);
+        } else {
+            for (size_t i = 0; i < len; i++) {
+                _spi->transfer(0x00);
+            }
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t in = _spi->transfer(tx ? tx[i] : 0x00);
+        if (rx) {
+            rx[i] = in;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------
+// SpiBusHal
+//--------------------------------------------------------------------------------------------
+SpiBusHal::SpiBusHal(SPIClass& spi, SpiDeviceHandle device)
+    : ArduinoHal(spi), _device(device), _acquired(false) {
+}
+
+void SpiBusHal::spiBeginTransaction() {
+    _acquired = SpiBusManager::beginTransaction(_device);
+}
+
+void SpiBusHal::spiTransfer(uint8_t* out, size_t len, uint8_t* in) {
+    if (!_acquired) {
+        // Sin bus no se transfiere: RadioLib lee un estado 0x00 y devuelve un error
+        if (in != nullptr) {
+            memset(in, 0, len);
+        }
+        return;
+    }
+    SpiBusManager::transfer(out, in, len);
+}
+
+void SpiBusHal::spiEndTransaction() {
+    if (!_acquired) {
+        return;
+    }
+    _acquired = false;
+    SpiBusManager::endTransaction(_device);
+}
@@ -0,0 +1,85 @@
+/*******************************************************************************************
+ * Archivo: src/TxScheduler.cpp
+ * Descripción: Implementación de los slots de transmisión por nodo.
+ *******************************************************************************************/
+
+#include "TxScheduler.h"
+#include "debug.h"
+#include "config_manager.h"
+#include "LinkPolicy.h"
+#include "SleepManager.h"
+#include "util/fnv1a.h"
+
+#define TX_SCHEDULER_MAGIC      0x7C51
+
+/**
+ * @brief Estado que sobrevive al deep sleep
+ */
+struct TxSchedulerState {
+    uint16_t magic;
+    uint32_t devEuiHash;
+};
+
+RTC_DATA_ATTR static TxSchedulerState txState;
+
+RTC_DS3231* TxScheduler::_rtc = nullptr;
+uint32_t TxScheduler::_cycleStart = 0;
+uint32_t TxScheduler::_interval = 0;
+bool TxScheduler::_waited = true;
+
+void TxScheduler::begin(RTC_DS3231& rtc, BootMode bootMode) {
+    _rtc = &rtc;
+    if (bootMode == BOOT_MODE_WARM && txState.magic == TX_SCHEDULER_MAGIC) {
+        return;
+    }
+    uint64_t joinEUI = 0, devEUI = 0;
+    uint8_t nwkKey[16], appKey[16];
+    ConfigManager::getLoRaKeys(joinEUI, devEUI, nwkKey, appKey);
+
+    uint32_t hash = FNV1A_OFFSET_BASIS;
+    for (uint8_t i = 0; i < 8; i++) {
+        hash = fnv1a32Byte(hash, (uint8_t)(devEUI >> (8 * i)));
+    }
+    txState.devEuiHash = hash;
+    txState.magic = TX_SCHEDULER_MAGIC;
+}
+
+void TxScheduler::beginCycle(uint32_t sampleTime, uint32_t interval) {
+    _cycleStart = sampleTime;
+    _interval = interval;
+    _waited = false;
+}
+
+void TxScheduler::waitForSlot(SX1262* radio) {
+#if TX_SLOT_ENABLED
+    if (_waited || _rtc == nullptr) {
+        return;
+    }
+    _waited = true;
+
+    uint32_t window = (uint32_t)((uint64_t)_interval * TX_SLOT_SPREAD_PERCENT / 100);
+    if (window > TX_SLOT_WINDOW_MAX_S) {
+        window = TX_SLOT_WINDOW_MAX_S;
+    }
+    uint32_t slots = window / TX_SLOT_LENGTH_S;
+    if (slots < 2) {
+        return;     // Periodo demasiado corto para repartir
+    }
+
+    // Con pérdidas recientes el slot propio puede estar chocando con otro nodo: reintento
+    // en un slot aleatorio
+    bool retry = LinkPolicy::stats().lossStreak > 0;
+    uint32_t slot = retry ? (uint32_t)random((long)slots) : txState.devEuiHash % slots;
+    uint32_t target = _cycleStart + slot * TX_SLOT_LENGTH_S;
+    uint32_t now = _rtc->now().unixtime();
+    if (target <= now || target - now > window) {
+        return;     // El slot ya pasó (medición larga) o la hora no es coherente
+    }
+
+    DEBUG_PRINTF("Slot de transmisión %lu/%lu%s: esperar %lu s\n", (unsigned long)slot,
+                 (unsigned long)slots, retry ? " (aleatorio)" : "", (unsigned long)(target - now));
+    SleepManager::napMs((target - now) * 1000UL, radio);
+#else
+    (void)radio;
+#endif
+}
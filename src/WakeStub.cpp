@@ -0,0 +1,174 @@
+/*******************************************************************************************
+ * Archivo: src/WakeStub.cpp
+ * Descripción: Implementación del wake stub y de la planificación de despertares.
+ *
+ * El stub corre antes de que exista el runtime: solo puede tocar memoria RTC, registros y
+ * funciones de ROM. Todo lo que usa está marcado RTC_IRAM_ATTR / RTC_DATA_ATTR o es inline.
+ *******************************************************************************************/
+
+#include "WakeStub.h"
+#include "debug.h"
+#include "esp_sleep.h"
+#include "esp_attr.h"
+#include "soc/rtc.h"
+#include "soc/rtc_cntl_reg.h"
+#include "esp32c3/rom/rtc.h"
+
+RTC_DATA_ATTR static WakeStubState stubState;
+
+static WakeDecision currentDecision = WAKE_DECISION_REPORT;
+static uint32_t idleTicksAtBoot = 0;
+
+// Tabla de tareas por defecto: un tick es el intervalo de sueño configurado
+static const WakeTask kDefaultWakeTasks[] = {
+    { WAKE_SAMPLE_EVERY_TICKS, 0, WAKE_TASK_SAMPLE },
+    { WAKE_REPORT_EVERY_TICKS, 0, WAKE_TASK_REPORT },
+};
+
+/**
+ * @brief Tiempo actual del reloj lento (ciclos)
+ */
+static inline __attribute__((always_inline)) uint64_t stubRtcNow() {
+    SET_PERI_REG_MASK(RTC_CNTL_TIME_UPDATE_REG, RTC_CNTL_TIME_UPDATE);
+    uint64_t now = READ_PERI_REG(RTC_CNTL_TIME0_REG);
+    now |= ((uint64_t)READ_PERI_REG(RTC_CNTL_TIME1_REG)) << 32;
+    return now;
+}
+
+/**
+ * @brief Vuelve a armar el temporizador RTC y entra en deep sleep desde el stub.
+ *        Los demás ajustes de sueño (fuentes de despertar, pines retenidos) se conservan
+ *        de la configuración hecha antes de esp_deep_sleep_start().
+ * @param wakeAt Despertar en ciclos absolutos del reloj lento
+ */
+static inline __attribute__((always_inline)) void stubSleepAgain(uint64_t wakeAt) {
+    WRITE_PERI_REG(RTC_CNTL_SLP_TIMER0_REG, (uint32_t)wakeAt);
+    WRITE_PERI_REG(RTC_CNTL_SLP_TIMER1_REG, (uint32_t)(wakeAt >> 32));
+    SET_PERI_REG_MASK(RTC_CNTL_INT_CLR_REG, RTC_CNTL_MAIN_TIMER_INT_CLR_M);
+    SET_PERI_REG_MASK(RTC_CNTL_SLP_TIMER1_REG, RTC_CNTL_MAIN_TIMER_ALARM_EN_M);
+
+    // Olvidar el pin que nos despertó antes de volver a dormir
+    SET_PERI_REG_MASK(RTC_CNTL_GPIO_WAKEUP_REG, RTC_CNTL_GPIO_WAKEUP_STATUS_CLR);
+    CLEAR_PERI_REG_MASK(RTC_CNTL_GPIO_WAKEUP_REG, RTC_CNTL_GPIO_WAKEUP_STATUS_CLR);
+
+    // Volver a entrar en este stub al despertar
+    REG_WRITE(RTC_ENTRY_ADDR_REG, (uint32_t)(uintptr_t)&esp_wake_deep_sleep);
+    SET_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_SLEEP_EN);
+    while (true) {
+        // El sueño empieza unos ciclos después
+    }
+}
+
+/**
+ * @brief Wake stub: sustituye al stub débil por defecto de ESP-IDF
+ */
+extern "C" void RTC_IRAM_ATTR esp_wake_deep_sleep(void) {
+    stubState.stubWakes++;
+
+    uint32_t cause = REG_GET_FIELD(RTC_CNTL_SLP_WAKEUP_CAUSE_REG, RTC_CNTL_WAKEUP_CAUSE);
+    bool scheduledWake = (cause & RTC_TIMER_TRIG_EN) != 0;
+#ifdef RTC_ALARM_WAKE_PIN
+    // La alarma del DS3231 es un despertar programado si no se pulsó a la vez el pin de
+    // configuración (mismo criterio que SlotScheduler::alarmWake)
+    bool alarmWake = false;
+    if (!scheduledWake && (cause & RTC_GPIO_TRIG_EN) != 0) {
+        uint32_t pins = REG_GET_FIELD(RTC_CNTL_GPIO_WAKEUP_REG, RTC_CNTL_GPIO_WAKEUP_STATUS);
+        alarmWake = (pins & (1UL << RTC_ALARM_WAKE_PIN)) != 0 && (pins & (1UL << CONFIG_PIN)) == 0;
+        scheduledWake = alarmWake;
+    }
+#endif
+
+    if (stubState.magic == WAKE_STUB_MAGIC && stubState.sleepRtcTicks != 0 && scheduledWake) {
+        WakeDecision decision = wakeScheduleAdvance(&stubState.schedule);
+        stubState.decision = decision;
+        stubState.dueMask = stubState.schedule.dueMask;
+        if (decision == WAKE_DECISION_IDLE) {
+            stubState.idleWakes++;
+            stubState.idleSinceBoot++;
+#ifdef RTC_ALARM_WAKE_PIN
+            if (alarmWake) {
+                // La salida INT sigue activa hasta limpiar la alarma por I2C (en el próximo
+                // arranque): hasta entonces el temporizador es la única fuente programada
+                CLEAR_PERI_REG_MASK(RTC_CNTL_GPIO_WAKEUP_REG,
+                                    RTC_CNTL_GPIO_PIN0_WAKEUP_ENABLE >> RTC_ALARM_WAKE_PIN);
+            }
+#endif
+            stubState.nextWakeRtc = wakeScheduleNextWake(stubState.nextWakeRtc,
+                                                         stubState.sleepRtcTicks, stubRtcNow());
+            stubSleepAgain(stubState.nextWakeRtc);
+        }
+    } else {
+        // Pin de configuración u otro origen: arranque completo con reporte
+        stubState.decision = WAKE_DECISION_REPORT;
+    }
+
+    esp_default_wake_deep_sleep();
+}
+
+WakeDecision WakeStub::begin(BootMode bootMode) {
+    bool stubValid = stubState.magic == WAKE_STUB_MAGIC;
+    if (bootMode == BOOT_MODE_COLD || bootMode == BOOT_MODE_CONFIG || !stubValid) {
+        // Tras un arranque en frío la memoria RTC no es fiable: empezar de cero
+        memset(&stubState, 0, sizeof(stubState));
+        wakeScheduleInit(&stubState.schedule, kDefaultWakeTasks,
+                         sizeof(kDefaultWakeTasks) / sizeof(kDefaultWakeTasks[0]));
+        stubState.magic = WAKE_STUB_MAGIC;
+        stubState.decision = WAKE_DECISION_REPORT;
+        wakeScheduleEvaluate(&stubState.schedule, 0, &stubState.dueMask);
+    }
+
+    idleTicksAtBoot = stubState.idleSinceBoot;
+    stubState.idleSinceBoot = 0;
+
+    currentDecision = (WakeDecision)stubState.decision;
+    if (currentDecision == WAKE_DECISION_IDLE) {
+        // No debería llegar aquí: el stub habría vuelto a dormir
+        currentDecision = WAKE_DECISION_REPORT;
+    }
+    stubState.fullBoots++;
+
+    DEBUG_PRINTF("Wake stub: tick %lu, decisión %u, despertares %lu (sin arranque %lu), arranques %lu\n",
+                 (unsigned long)stubState.schedule.tick, currentDecision,
+                 (unsigned long)stubState.stubWakes, (unsigned long)stubState.idleWakes,
+                 (unsigned long)stubState.fullBoots);
+    return currentDecision;
+}
+
+WakeDecision WakeStub::decision() {
+    return currentDecision;
+}
+
+WakeDecision WakeStub::advanceTick() {
+    WakeDecision decision = wakeScheduleAdvance(&stubState.schedule);
+    stubState.decision = decision;
+    stubState.dueMask = stubState.schedule.dueMask;
+    if (decision != WAKE_DECISION_IDLE) {
+        currentDecision = decision;
+    }
+    return decision;
+}
+
+uint8_t WakeStub::dueMask() {
+    return stubState.dueMask;
+}
+
+uint32_t WakeStub::tick() {
+    return stubState.schedule.tick;
+}
+
+uint32_t WakeStub::idleTicksSinceBoot() {
+    return idleTicksAtBoot;
+}
+
+void WakeStub::prepareSleep(uint64_t firstSleepUs, uint64_t tickUs) {
+    // Periodo del reloj lento en µs, formato Q13.19 (calibrado por ESP-IDF al arrancar)
+    uint32_t calPeriod = REG_READ(RTC_SLOW_CLK_CAL_REG);
+    if (calPeriod == 0) {
+        stubState.sleepRtcTicks = 0;    // Sin calibración el stub deja pasar el arranque
+        return;
+    }
+    stubState.sleepRtcTicks = (tickUs << RTC_CLK_CAL_FRACT) / calPeriod;
+    // El temporizador se arma unos ms más tarde, en esp_deep_sleep_start(): el error queda
+    // muy por debajo de la tolerancia del sello de tiempo
+    stubState.nextWakeRtc = stubRtcNow() + (firstSleepUs << RTC_CLK_CAL_FRACT) / calPeriod;
+}
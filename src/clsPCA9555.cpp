@@ -195,6 +195,22 @@ void PCA9555::digitalWrite(uint8_t pin, uint8_t value) {
     I2CSetValue(_address, NXP_OUTPUT + 1, _valueRegister_high);
 }
 
+/**
+ * @name writePins
+ * @param mask   pines a modificar (bit = pin)
+ * @param values nivel de cada pin de la máscara
+ * Cambia varias salidas a la vez con una sola escritura con auto-incremento, de modo que
+ * todas conmutan en el mismo instante.
+ */
+void PCA9555::writePins(uint16_t mask, uint16_t values) {
+    _valueRegister = (_valueRegister & ~mask) | (values & mask);
+    Wire.beginTransmission(_address);
+    Wire.write(NXP_OUTPUT);
+    Wire.write(_valueRegister_low);
+    Wire.write(_valueRegister_high);
+    _error = Wire.endTransmission();
+}
+
 // This is the actual ISR
 // Stores states of all pins in _stateOfPins
 void PCA9555::pinStates(){
@@ -292,6 +308,35 @@ void PCA9555::I2CSetValue(uint8_t address, uint8_t reg, uint8_t value){
     _error = Wire.endTransmission();
 }
 
+/**
+ * @name restoreRegisters
+ * @param configuration registro de configuración (1 = INPUT)
+ * @param output        registro de salida
+ * Escribe ambos pares de registros con auto-incremento (dos transacciones I2C) y
+ * actualiza la copia local. Se usa en el arranque en caliente en lugar de begin().
+ * @return true si el PCA9555 respondió
+ */
+bool PCA9555::restoreRegisters(uint16_t configuration, uint16_t output) {
+    _valueRegister = output;
+    _configurationRegister = configuration;
+
+    Wire.beginTransmission(_address);
+    Wire.write(NXP_OUTPUT);
+    Wire.write(_valueRegister_low);
+    Wire.write(_valueRegister_high);
+    _error = Wire.endTransmission();
+    if (_error != 0) {
+        return false;
+    }
+
+    Wire.beginTransmission(_address);
+    Wire.write(NXP_CONFIG);
+    Wire.write(_configurationRegister_low);
+    Wire.write(_configurationRegister_high);
+    _error = Wire.endTransmission();
+    return _error == 0;
+}
+
 void PCA9555::sleep() {
     // 1) Prepara registros locales (16 bits) para la configuración y el valor de salida
     //    Empezamos con todo en 0 (por defecto, consideraremos OUTPUT=0 y LOW=0).
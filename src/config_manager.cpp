@@ -5,29 +5,471 @@
 #include "sensor_types.h"
 #include <Preferences.h>
 #include <Arduino.h> // Incluido para usar Serial
+#include "debug.h"
+#include "config_records.h"
+#include "utilities.h"
+#include "util/crc16.h"
 
 /* =========================================================================
-   FUNCIONES AUXILIARES
+   REGISTROS BINARIOS Y CACHÉ EN RAM
    ========================================================================= */
-// Funciones auxiliares para leer y escribir el JSON completo en cada namespace.
-static void writeNamespace(const char* ns, const StaticJsonDocument<JSON_DOC_SIZE_MEDIUM>& doc) {
+// Cada registro se lee de NVS una sola vez por arranque y queda en RAM; los setters
+// actualizan la caché y reescriben el blob completo (escritura atómica en NVS).
+template <typename Record>
+struct CachedRecord {
+    Record data;
+    bool loaded;
+};
+
+static CachedRecord<SystemConfigRecord> systemRecord;
+static CachedRecord<LoRaConfigRecord> loraRecord;
+static CachedRecord<IntervalBoundsRecord> intervalRecord;
+static CachedRecord<LinkLimitsRecord> linkRecord;
+static CachedRecord<SensorsConfigRecord> sensorsRecord;
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+static CachedRecord<ModbusSensorsConfigRecord> modbusRecord;
+#endif
+#ifdef DEVICE_TYPE_ANALOGIC
+static CachedRecord<NtcConfigRecord> ntc100kRecord;
+static CachedRecord<NtcConfigRecord> ntc10kRecord;
+static CachedRecord<ConductivityConfigRecord> condRecord;
+static CachedRecord<PhConfigRecord> phRecord;
+#endif
+
+static uint16_t recordCrc(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc = crc16_update(crc, data[i]);
+    }
+    return crc;
+}
+
+static bool writeRecord(const char* key, const void* payload, size_t size) {
+    uint8_t buffer[CONFIG_RECORD_MAX_SIZE];
+    ConfigRecordHeader header;
+    header.magic = CONFIG_RECORD_MAGIC;
+    header.version = CONFIG_SCHEMA_VERSION;
+    header.length = size;
+    header.crc = recordCrc((const uint8_t*)payload, size);
+    memcpy(buffer, &header, sizeof(header));
+    memcpy(buffer + sizeof(header), payload, size);
+
     Preferences prefs;
-    prefs.begin(ns, false);
-    String jsonString;
-    serializeJson(doc, jsonString);
-    // Se usa el mismo nombre del namespace como clave interna
-    prefs.putString(ns, jsonString.c_str());
+    prefs.begin(NAMESPACE_CONFIG_BIN, false);
+    size_t written = prefs.putBytes(key, buffer, sizeof(header) + size);
     prefs.end();
+    if (written != sizeof(header) + size) {
+        DEBUG_PRINTF("Error escribiendo registro de configuración '%s'\n", key);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Migra las entradas de sensores de un esquema anterior. Los campos nuevos se
+ *        añaden siempre al final de la entrada:
+ *          - esquema 2: periodTicks (1 = todos los ticks)
+ *          - esquema 3: aggWindow y aggStats (0 = sin agregación)
+ *          - esquema 4: predictTolerance (0 = transmitir siempre)
+ *        Copia cada entrada con su tamaño anterior y completa los campos que faltan.
+ */
+template <typename Record, typename Entry>
+static bool migrateSensorEntries(uint8_t fromVersion, const uint8_t* data, size_t length,
+                                 void* payload, size_t maxCount) {
+    const size_t oldEntrySize = (fromVersion == 1) ? offsetof(Entry, periodTicks)
+                              : (fromVersion == 2) ? offsetof(Entry, aggWindow)
+                                                   : offsetof(Entry, predictTolerance);
+    if (length != 1 + maxCount * oldEntrySize) {
+        return false;
+    }
+    Record rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.count = data[0] > maxCount ? maxCount : data[0];
+    for (size_t i = 0; i < maxCount; i++) {
+        memcpy(&rec.sensors[i], data + 1 + i * oldEntrySize, oldEntrySize);
+        if (fromVersion == 1) {
+            rec.sensors[i].periodTicks = 1;
+        }
+    }
+    memcpy(payload, &rec, sizeof(rec));
+    return true;
+}
+
+static bool migrateRecord(uint8_t fromVersion, const char* key, const uint8_t* data, size_t length,
+                          void* payload, size_t size) {
+    if (strcmp(key, CFG_RECORD_SENSORS) == 0) {
+        return migrateSensorEntries<SensorsConfigRecord, SensorConfigEntry>(
+            fromVersion, data, length, payload, MAX_NORMAL_SENSORS);
+    }
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    if (strcmp(key, CFG_RECORD_MODBUS) == 0) {
+        return migrateSensorEntries<ModbusSensorsConfigRecord, ModbusSensorConfigEntry>(
+            fromVersion, data, length, payload, MAX_MODBUS_SENSORS);
+    }
+#endif
+    // El resto de registros no cambió
+    if (length != size) {
+        return false;
+    }
+    memcpy(payload, data, size);
+    return true;
+}
+
+/**
+ * @brief Lee y valida un registro. Devuelve false si no existe, está corrupto o su
+ *        esquema no se puede migrar; el llamador recurre entonces al JSON heredado.
+ */
+static bool readRecord(const char* key, void* payload, size_t size) {
+    uint8_t buffer[CONFIG_RECORD_MAX_SIZE];
+    Preferences prefs;
+    if (!prefs.begin(NAMESPACE_CONFIG_BIN, true)) {
+        return false;
+    }
+    size_t len = prefs.getBytes(key, buffer, sizeof(buffer));
+    prefs.end();
+    if (len < sizeof(ConfigRecordHeader)) {
+        return false;
+    }
+
+    ConfigRecordHeader header;
+    memcpy(&header, buffer, sizeof(header));
+    if (header.magic != CONFIG_RECORD_MAGIC ||
+        header.length != len - sizeof(header) ||
+        header.crc != recordCrc(buffer + sizeof(header), header.length)) {
+        DEBUG_PRINTF("Registro de configuración '%s' corrupto\n", key);
+        return false;
+    }
+
+    // Migraciones de esquema: agregar aquí un caso por cada versión anterior
+    switch (header.version) {
+        case CONFIG_SCHEMA_VERSION:
+            if (header.length != size) {
+                return false;
+            }
+            break;
+        case 1:
+        case 2:
+        case 3:
+            DEBUG_PRINTF("Migrando registro '%s' del esquema %u\n", key, header.version);
+            return migrateRecord(header.version, key, buffer + sizeof(header), header.length,
+                                 payload, size);
+        default:
+            DEBUG_PRINTF("Versión de esquema %u no soportada en '%s'\n", header.version, key);
+            return false;
+    }
+
+    memcpy(payload, buffer + sizeof(header), size);
+    return true;
+}
+
+/**
+ * @brief Obtiene un registro de la caché, cargándolo la primera vez. Si no hay registro
+ *        binario válido se migra desde el JSON heredado (y se persiste) o se usan los
+ *        valores por defecto (sin escribir en NVS).
+ */
+template <typename Record>
+static Record& loadRecord(CachedRecord<Record>& slot, const char* key,
+                          bool (*fromLegacy)(Record&), void (*setDefaults)(Record&)) {
+    if (!slot.loaded) {
+        if (!readRecord(key, &slot.data, sizeof(Record))) {
+            memset(&slot.data, 0, sizeof(Record));
+            if (fromLegacy(slot.data)) {
+                DEBUG_PRINTF("Migrando configuración JSON a registro '%s'\n", key);
+                writeRecord(key, &slot.data, sizeof(Record));
+            } else {
+                setDefaults(slot.data);
+            }
+        }
+        slot.loaded = true;
+    }
+    return slot.data;
+}
+
+template <typename Record>
+static void storeRecord(CachedRecord<Record>& slot, const char* key, const Record& data) {
+    slot.data = data;
+    slot.loaded = true;
+    writeRecord(key, &slot.data, sizeof(Record));
 }
 
-static void readNamespace(const char* ns, StaticJsonDocument<JSON_DOC_SIZE_MEDIUM>& doc) {
+/* =========================================================================
+   MIGRACIÓN DESDE EL FORMATO JSON HEREDADO
+   ========================================================================= */
+// Lee el JSON que versiones anteriores guardaban en cada namespace. La clave heredada
+// se conserva: el registro binario tiene prioridad y permite volver a un firmware previo.
+static bool readLegacyNamespace(const char* ns, StaticJsonDocument<JSON_DOC_SIZE_MEDIUM>& doc) {
     Preferences prefs;
-    prefs.begin(ns, true);
+    if (!prefs.begin(ns, true)) {
+        return false;
+    }
+    if (!prefs.isKey(ns)) {
+        prefs.end();
+        return false;
+    }
     String jsonString = prefs.getString(ns, "{}");
     prefs.end();
-    deserializeJson(doc, jsonString);
+    return deserializeJson(doc, jsonString) == DeserializationError::Ok;
+}
+
+static void parseLoRaBytes(const char* eui, uint8_t* out) {
+    uint64_t value = 0;
+    parseEUIString(eui, &value);
+    for (int i = 7; i >= 0; i--) {
+        out[i] = (uint8_t)(value & 0xFF);
+        value >>= 8;
+    }
+}
+
+static void setSystemDefaults(SystemConfigRecord& rec) {
+    rec.initialized = false;
+    rec.sleepTime = DEFAULT_TIME_TO_SLEEP;
+    strlcpy(rec.deviceId, DEFAULT_DEVICE_ID, sizeof(rec.deviceId));
+    strlcpy(rec.stationId, DEFAULT_STATION_ID, sizeof(rec.stationId));
+}
+
+static bool systemFromLegacy(SystemConfigRecord& rec) {
+    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
+    if (!readLegacyNamespace(NAMESPACE_SYSTEM, doc)) {
+        return false;
+    }
+    rec.initialized = doc[KEY_INITIALIZED] | false;
+    rec.sleepTime = doc[KEY_SLEEP_TIME] | DEFAULT_TIME_TO_SLEEP;
+    strlcpy(rec.deviceId, doc[KEY_DEVICE_ID] | DEFAULT_DEVICE_ID, sizeof(rec.deviceId));
+    strlcpy(rec.stationId, doc[KEY_STATION_ID] | DEFAULT_STATION_ID, sizeof(rec.stationId));
+    return true;
+}
+
+static void setLoRaDefaults(LoRaConfigRecord& rec) {
+    parseLoRaBytes(DEFAULT_JOIN_EUI, rec.joinEUI);
+    parseLoRaBytes(DEFAULT_DEV_EUI, rec.devEUI);
+    parseKeyString(DEFAULT_NWK_KEY, rec.nwkKey, sizeof(rec.nwkKey));
+    parseKeyString(DEFAULT_APP_KEY, rec.appKey, sizeof(rec.appKey));
 }
 
+static bool loraFromLegacy(LoRaConfigRecord& rec) {
+    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
+    if (!readLegacyNamespace(NAMESPACE_LORAWAN, doc)) {
+        return false;
+    }
+    parseLoRaBytes(doc[KEY_LORA_JOIN_EUI] | DEFAULT_JOIN_EUI, rec.joinEUI);
+    parseLoRaBytes(doc[KEY_LORA_DEV_EUI] | DEFAULT_DEV_EUI, rec.devEUI);
+    parseKeyString(doc[KEY_LORA_NWK_KEY] | DEFAULT_NWK_KEY, rec.nwkKey, sizeof(rec.nwkKey));
+    parseKeyString(doc[KEY_LORA_APP_KEY] | DEFAULT_APP_KEY, rec.appKey, sizeof(rec.appKey));
+    return true;
+}
+
+static void setSensorsFrom(SensorsConfigRecord& rec, const SensorConfig* configs, size_t count) {
+    rec.count = 0;
+    for (size_t i = 0; i < count && rec.count < MAX_NORMAL_SENSORS; i++) {
+        SensorConfigEntry& entry = rec.sensors[rec.count++];
+        strlcpy(entry.configKey, configs[i].configKey, sizeof(entry.configKey));
+        strlcpy(entry.sensorId, configs[i].sensorId, sizeof(entry.sensorId));
+        entry.type = (uint8_t)configs[i].type;
+        entry.enable = configs[i].enable;
+        entry.periodTicks = configs[i].periodTicks;
+        entry.aggWindow = configs[i].aggWindow;
+        entry.aggStats = configs[i].aggStats;
+        entry.predictTolerance = configs[i].predictTolerance;
+    }
+}
+
+static void setSensorsDefaults(SensorsConfigRecord& rec) {
+    static const SensorConfig defaults[] = DEFAULT_SENSOR_CONFIGS;
+    setSensorsFrom(rec, defaults, sizeof(defaults) / sizeof(defaults[0]));
+}
+
+static bool sensorsFromLegacy(SensorsConfigRecord& rec) {
+    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
+    if (!readLegacyNamespace(NAMESPACE_SENSORS, doc) || !doc.is<JsonArray>()) {
+        return false;
+    }
+    rec.count = 0;
+    for (JsonObject sensorObj : doc.as<JsonArray>()) {
+        if (rec.count >= MAX_NORMAL_SENSORS) {
+            break;
+        }
+        SensorConfigEntry& entry = rec.sensors[rec.count++];
+        strlcpy(entry.configKey, sensorObj[KEY_SENSOR] | "", sizeof(entry.configKey));
+        strlcpy(entry.sensorId, sensorObj[KEY_SENSOR_ID] | "", sizeof(entry.sensorId));
+        entry.type = (uint8_t)(sensorObj[KEY_SENSOR_TYPE] | 0);
+        entry.enable = sensorObj[KEY_SENSOR_ENABLE] | false;
+        entry.periodTicks = 1;
+        entry.aggWindow = 0;
+        entry.aggStats = 0;
+        entry.predictTolerance = 0.0f;
+    }
+    return true;
+}
+
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+static void setModbusFrom(ModbusSensorsConfigRecord& rec, const ModbusSensorConfig* configs, size_t count) {
+    rec.count = 0;
+    for (size_t i = 0; i < count && rec.count < MAX_MODBUS_SENSORS; i++) {
+        ModbusSensorConfigEntry& entry = rec.sensors[rec.count++];
+        strlcpy(entry.sensorId, configs[i].sensorId, sizeof(entry.sensorId));
+        entry.type = (uint8_t)configs[i].type;
+        entry.address = configs[i].address;
+        entry.enable = configs[i].enable;
+        entry.periodTicks = configs[i].periodTicks;
+        entry.aggWindow = configs[i].aggWindow;
+        entry.aggStats = configs[i].aggStats;
+        entry.predictTolerance = configs[i].predictTolerance;
+    }
+}
+
+static void setModbusDefaults(ModbusSensorsConfigRecord& rec) {
+    static const ModbusSensorConfig defaults[] = DEFAULT_MODBUS_SENSOR_CONFIGS;
+    setModbusFrom(rec, defaults, sizeof(defaults) / sizeof(defaults[0]));
+}
+
+static bool modbusFromLegacy(ModbusSensorsConfigRecord& rec) {
+    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
+    if (!readLegacyNamespace(NAMESPACE_SENSORS_MODBUS, doc) || !doc.is<JsonArray>()) {
+        return false;
+    }
+    rec.count = 0;
+    for (JsonObject sensorObj : doc.as<JsonArray>()) {
+        if (rec.count >= MAX_MODBUS_SENSORS) {
+            break;
+        }
+        ModbusSensorConfigEntry& entry = rec.sensors[rec.count++];
+        strlcpy(entry.sensorId, sensorObj[KEY_MODBUS_SENSOR_ID] | "", sizeof(entry.sensorId));
+        entry.type = (uint8_t)(sensorObj[KEY_MODBUS_SENSOR_TYPE] | 0);
+        entry.address = sensorObj[KEY_MODBUS_SENSOR_ADDR] | 1;
+        entry.enable = sensorObj[KEY_MODBUS_SENSOR_ENABLE] | false;
+        entry.periodTicks = 1;
+        entry.aggWindow = 0;
+        entry.aggStats = 0;
+        entry.predictTolerance = 0.0f;
+    }
+    return true;
+}
+#endif
+
+#ifdef DEVICE_TYPE_ANALOGIC
+static void setNtc100kDefaults(NtcConfigRecord& rec) {
+    rec.t1 = DEFAULT_T1_100K; rec.r1 = DEFAULT_R1_100K;
+    rec.t2 = DEFAULT_T2_100K; rec.r2 = DEFAULT_R2_100K;
+    rec.t3 = DEFAULT_T3_100K; rec.r3 = DEFAULT_R3_100K;
+}
+
+static bool ntc100kFromLegacy(NtcConfigRecord& rec) {
+    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
+    if (!readLegacyNamespace(NAMESPACE_NTC100K, doc)) {
+        return false;
+    }
+    rec.t1 = doc[KEY_NTC100K_T1] | DEFAULT_T1_100K;
+    rec.r1 = doc[KEY_NTC100K_R1] | DEFAULT_R1_100K;
+    rec.t2 = doc[KEY_NTC100K_T2] | DEFAULT_T2_100K;
+    rec.r2 = doc[KEY_NTC100K_R2] | DEFAULT_R2_100K;
+    rec.t3 = doc[KEY_NTC100K_T3] | DEFAULT_T3_100K;
+    rec.r3 = doc[KEY_NTC100K_R3] | DEFAULT_R3_100K;
+    return true;
+}
+
+static void setNtc10kDefaults(NtcConfigRecord& rec) {
+    rec.t1 = DEFAULT_T1_10K; rec.r1 = DEFAULT_R1_10K;
+    rec.t2 = DEFAULT_T2_10K; rec.r2 = DEFAULT_R2_10K;
+    rec.t3 = DEFAULT_T3_10K; rec.r3 = DEFAULT_R3_10K;
+}
+
+static bool ntc10kFromLegacy(NtcConfigRecord& rec) {
+    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
+    if (!readLegacyNamespace(NAMESPACE_NTC10K, doc)) {
+        return false;
+    }
+    rec.t1 = doc[KEY_NTC10K_T1] | DEFAULT_T1_10K;
+    rec.r1 = doc[KEY_NTC10K_R1] | DEFAULT_R1_10K;
+    rec.t2 = doc[KEY_NTC10K_T2] | DEFAULT_T2_10K;
+    rec.r2 = doc[KEY_NTC10K_R2] | DEFAULT_R2_10K;
+    rec.t3 = doc[KEY_NTC10K_T3] | DEFAULT_T3_10K;
+    rec.r3 = doc[KEY_NTC10K_R3] | DEFAULT_R3_10K;
+    return true;
+}
+
+static void setCondDefaults(ConductivityConfigRecord& rec) {
+    rec.calTemp = CONDUCTIVITY_DEFAULT_TEMP;
+    rec.coefComp = TEMP_COEF_COMPENSATION;
+    rec.v1 = CONDUCTIVITY_DEFAULT_V1; rec.t1 = CONDUCTIVITY_DEFAULT_T1;
+    rec.v2 = CONDUCTIVITY_DEFAULT_V2; rec.t2 = CONDUCTIVITY_DEFAULT_T2;
+    rec.v3 = CONDUCTIVITY_DEFAULT_V3; rec.t3 = CONDUCTIVITY_DEFAULT_T3;
+}
+
+static bool condFromLegacy(ConductivityConfigRecord& rec) {
+    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
+    if (!readLegacyNamespace(NAMESPACE_COND, doc)) {
+        return false;
+    }
+    rec.calTemp = doc[KEY_CONDUCT_CT] | CONDUCTIVITY_DEFAULT_TEMP;
+    rec.coefComp = doc[KEY_CONDUCT_CC] | TEMP_COEF_COMPENSATION;
+    rec.v1 = doc[KEY_CONDUCT_V1] | CONDUCTIVITY_DEFAULT_V1;
+    rec.t1 = doc[KEY_CONDUCT_T1] | CONDUCTIVITY_DEFAULT_T1;
+    rec.v2 = doc[KEY_CONDUCT_V2] | CONDUCTIVITY_DEFAULT_V2;
+    rec.t2 = doc[KEY_CONDUCT_T2] | CONDUCTIVITY_DEFAULT_T2;
+    rec.v3 = doc[KEY_CONDUCT_V3] | CONDUCTIVITY_DEFAULT_V3;
+    rec.t3 = doc[KEY_CONDUCT_T3] | CONDUCTIVITY_DEFAULT_T3;
+    return true;
+}
+
+static void setPhDefaults(PhConfigRecord& rec) {
+    rec.v1 = PH_DEFAULT_V1; rec.t1 = PH_DEFAULT_T1;
+    rec.v2 = PH_DEFAULT_V2; rec.t2 = PH_DEFAULT_T2;
+    rec.v3 = PH_DEFAULT_V3; rec.t3 = PH_DEFAULT_T3;
+    rec.calTemp = PH_DEFAULT_TEMP;
+}
+
+static bool phFromLegacy(PhConfigRecord& rec) {
+    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
+    if (!readLegacyNamespace(NAMESPACE_PH, doc)) {
+        return false;
+    }
+    rec.v1 = doc[KEY_PH_V1] | PH_DEFAULT_V1;
+    rec.t1 = doc[KEY_PH_T1] | PH_DEFAULT_T1;
+    rec.v2 = doc[KEY_PH_V2] | PH_DEFAULT_V2;
+    rec.t2 = doc[KEY_PH_T2] | PH_DEFAULT_T2;
+    rec.v3 = doc[KEY_PH_V3] | PH_DEFAULT_V3;
+    rec.t3 = doc[KEY_PH_T3] | PH_DEFAULT_T3;
+    rec.calTemp = doc[KEY_PH_CT] | PH_DEFAULT_TEMP;
+    return true;
+}
+#endif
+
+static void setIntervalDefaults(IntervalBoundsRecord& rec) {
+    rec.minInterval = INTERVAL_MIN_DEFAULT;
+    rec.maxInterval = INTERVAL_MAX_DEFAULT;
+}
+
+// Registro nuevo: no existe en el formato JSON heredado
+static bool intervalFromLegacy(IntervalBoundsRecord&) {
+    return false;
+}
+
+static void setLinkDefaults(LinkLimitsRecord& rec) {
+    rec.drMin = LINK_DR_MIN;
+    rec.drMax = LINK_DR_MAX;
+}
+
+// Registro nuevo: no existe en el formato JSON heredado
+static bool linkFromLegacy(LinkLimitsRecord&) {
+    return false;
+}
+
+// Accesores de cada registro en caché
+static SystemConfigRecord& systemConfig() {
+    return loadRecord(systemRecord, CFG_RECORD_SYSTEM, systemFromLegacy, setSystemDefaults);
+}
+static LoRaConfigRecord& loraConfig() {
+    return loadRecord(loraRecord, CFG_RECORD_LORAWAN, loraFromLegacy, setLoRaDefaults);
+}
+static SensorsConfigRecord& sensorsConfig() {
+    return loadRecord(sensorsRecord, CFG_RECORD_SENSORS, sensorsFromLegacy, setSensorsDefaults);
+}
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+static ModbusSensorsConfigRecord& modbusConfig() {
+    return loadRecord(modbusRecord, CFG_RECORD_MODBUS, modbusFromLegacy, setModbusDefaults);
+}
+#endif
+
 // Configuración por defecto de sensores NO-modbus
 const SensorConfig ConfigManager::defaultConfigs[] = DEFAULT_SENSOR_CONFIGS;
 
@@ -35,258 +477,239 @@ const SensorConfig ConfigManager::defaultConfigs[] = DEFAULT_SENSOR_CONFIGS;
    INICIALIZACIÓN Y CONFIGURACIÓN DEL SISTEMA
    ========================================================================= */
 bool ConfigManager::checkInitialized() {
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    readNamespace(NAMESPACE_SYSTEM, doc);
-    return doc[KEY_INITIALIZED] | false;
+    return systemConfig().initialized;
 }
 
 void ConfigManager::initializeDefaultConfig() {
-    /* -------------------------------------------------------------------------
-       1. INICIALIZACIÓN DE CONFIGURACIÓN DEL SISTEMA
-       ------------------------------------------------------------------------- */
-    // Sistema unificado: NAMESPACE_SYSTEM (incluye system, sleep y device)
-    // Común para todos los tipos de dispositivo
+    // Un registro por bloque de configuración; cada escritura es atómica
     {
-        StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-        doc[KEY_STATION_ID] = DEFAULT_STATION_ID;
-        doc[KEY_INITIALIZED] = true;
-        doc[KEY_SLEEP_TIME] = DEFAULT_TIME_TO_SLEEP;
-        doc[KEY_DEVICE_ID] = DEFAULT_DEVICE_ID;
-        writeNamespace(NAMESPACE_SYSTEM, doc);
+        SystemConfigRecord rec;
+        setSystemDefaults(rec);
+        rec.initialized = true;
+        storeRecord(systemRecord, CFG_RECORD_SYSTEM, rec);
     }
-    
-#ifdef DEVICE_TYPE_ANALOGIC
-    /* -------------------------------------------------------------------------
-       2. INICIALIZACIÓN DE SENSORES ANALÓGICOS (Solo para dispositivo analógico)
-       ------------------------------------------------------------------------- */
-    // NTC 100K: NAMESPACE_NTC100K
     {
-        StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-        doc[KEY_NTC100K_T1] = DEFAULT_T1_100K;
-        doc[KEY_NTC100K_R1] = DEFAULT_R1_100K;
-        doc[KEY_NTC100K_T2] = DEFAULT_T2_100K;
-        doc[KEY_NTC100K_R2] = DEFAULT_R2_100K;
-        doc[KEY_NTC100K_T3] = DEFAULT_T3_100K;
-        doc[KEY_NTC100K_R3] = DEFAULT_R3_100K;
-        writeNamespace(NAMESPACE_NTC100K, doc);
+        LoRaConfigRecord rec;
+        setLoRaDefaults(rec);
+        storeRecord(loraRecord, CFG_RECORD_LORAWAN, rec);
     }
-    
-    // NTC 10K: NAMESPACE_NTC10K
-    {
-        StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-        doc[KEY_NTC10K_T1] = DEFAULT_T1_10K;
-        doc[KEY_NTC10K_R1] = DEFAULT_R1_10K;
-        doc[KEY_NTC10K_T2] = DEFAULT_T2_10K;
-        doc[KEY_NTC10K_R2] = DEFAULT_R2_10K;
-        doc[KEY_NTC10K_T3] = DEFAULT_T3_10K;
-        doc[KEY_NTC10K_R3] = DEFAULT_R3_10K;
-        writeNamespace(NAMESPACE_NTC10K, doc);
-    }
-    
-    // Conductividad: NAMESPACE_COND
     {
-        StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-        doc[KEY_CONDUCT_CT] = CONDUCTIVITY_DEFAULT_TEMP;
-        doc[KEY_CONDUCT_CC] = TEMP_COEF_COMPENSATION;
-        doc[KEY_CONDUCT_V1] = CONDUCTIVITY_DEFAULT_V1;
-        doc[KEY_CONDUCT_T1] = CONDUCTIVITY_DEFAULT_T1;
-        doc[KEY_CONDUCT_V2] = CONDUCTIVITY_DEFAULT_V2;
-        doc[KEY_CONDUCT_T2] = CONDUCTIVITY_DEFAULT_T2;
-        doc[KEY_CONDUCT_V3] = CONDUCTIVITY_DEFAULT_V3;
-        doc[KEY_CONDUCT_T3] = CONDUCTIVITY_DEFAULT_T3;
-        writeNamespace(NAMESPACE_COND, doc);
+        SensorsConfigRecord rec;
+        memset(&rec, 0, sizeof(rec));
+        setSensorsFrom(rec, defaultConfigs, sizeof(defaultConfigs) / sizeof(defaultConfigs[0]));
+        storeRecord(sensorsRecord, CFG_RECORD_SENSORS, rec);
     }
-    
-    // pH: NAMESPACE_PH
+#if defined(DEVICE_TYPE_MODBUS) || defined(DEVICE_TYPE_ANALOGIC)
     {
-        StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-        doc[KEY_PH_V1] = PH_DEFAULT_V1;
-        doc[KEY_PH_T1] = PH_DEFAULT_T1;
-        doc[KEY_PH_V2] = PH_DEFAULT_V2;
-        doc[KEY_PH_T2] = PH_DEFAULT_T2;
-        doc[KEY_PH_V3] = PH_DEFAULT_V3;
-        doc[KEY_PH_T3] = PH_DEFAULT_T3;
-        doc[KEY_PH_CT] = PH_DEFAULT_TEMP;
-        writeNamespace(NAMESPACE_PH, doc);
+        ModbusSensorsConfigRecord rec;
+        memset(&rec, 0, sizeof(rec));
+        setModbusDefaults(rec);
+        storeRecord(modbusRecord, CFG_RECORD_MODBUS, rec);
     }
 #endif
-    
-    /* -------------------------------------------------------------------------
-       3. INICIALIZACIÓN DE SENSORES NO-MODBUS
-       ------------------------------------------------------------------------- */
+#ifdef DEVICE_TYPE_ANALOGIC
     {
-        Preferences prefs;
-        prefs.begin(NAMESPACE_SENSORS, false);
-        StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-        JsonArray sensorArray = doc.to<JsonArray>(); // Array raíz
-
-        for (const auto& config : ConfigManager::defaultConfigs) {
-            JsonObject sensorObj = sensorArray.createNestedObject();
-            sensorObj[KEY_SENSOR] = config.configKey;
-            sensorObj[KEY_SENSOR_ID] = config.sensorId;
-            sensorObj[KEY_SENSOR_TYPE] = static_cast<int>(config.type);
-            sensorObj[KEY_SENSOR_ENABLE] = config.enable;
-        }
-        
-        String jsonString;
-        serializeJson(doc, jsonString);
-        prefs.putString(NAMESPACE_SENSORS, jsonString.c_str());
-        prefs.end();
+        NtcConfigRecord rec;
+        setNtc100kDefaults(rec);
+        storeRecord(ntc100kRecord, CFG_RECORD_NTC100K, rec);
+        setNtc10kDefaults(rec);
+        storeRecord(ntc10kRecord, CFG_RECORD_NTC10K, rec);
     }
-    
-    /* -------------------------------------------------------------------------
-       4. INICIALIZACIÓN DE CONFIGURACIÓN DE LORA
-       ------------------------------------------------------------------------- */
     {
-        StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-        doc[KEY_LORA_JOIN_EUI]      = DEFAULT_JOIN_EUI;
-        doc[KEY_LORA_DEV_EUI]       = DEFAULT_DEV_EUI;
-        doc[KEY_LORA_NWK_KEY]       = DEFAULT_NWK_KEY;
-        doc[KEY_LORA_APP_KEY]       = DEFAULT_APP_KEY;
-        writeNamespace(NAMESPACE_LORAWAN, doc);
+        ConductivityConfigRecord rec;
+        setCondDefaults(rec);
+        storeRecord(condRecord, CFG_RECORD_COND, rec);
     }
-
-#if defined(DEVICE_TYPE_MODBUS) || defined(DEVICE_TYPE_ANALOGIC)
-    /* -------------------------------------------------------------------------
-       5. INICIALIZACIÓN DE SENSORES MODBUS
-       ------------------------------------------------------------------------- */
     {
-        Preferences prefs;
-        prefs.begin(NAMESPACE_SENSORS_MODBUS, false);
-        StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-        JsonArray sensorArray = doc.to<JsonArray>(); 
-
-        // Cargamos un default (definido en config.h)
-        static const ModbusSensorConfig defaultModbusSensors[] = DEFAULT_MODBUS_SENSOR_CONFIGS;
-        size_t count = sizeof(defaultModbusSensors)/sizeof(defaultModbusSensors[0]);
-
-        for (size_t i = 0; i < count; i++) {
-            JsonObject sensorObj = sensorArray.createNestedObject();
-            sensorObj[KEY_MODBUS_SENSOR_ID]    = defaultModbusSensors[i].sensorId;
-            sensorObj[KEY_MODBUS_SENSOR_TYPE]  = (int)defaultModbusSensors[i].type;
-            sensorObj[KEY_MODBUS_SENSOR_ADDR] = defaultModbusSensors[i].address;
-            sensorObj[KEY_MODBUS_SENSOR_ENABLE]   = defaultModbusSensors[i].enable;
-        }
-        
-        String jsonString;
-        serializeJson(doc, jsonString);
-        prefs.putString(NAMESPACE_SENSORS_MODBUS, jsonString.c_str());
-        prefs.end();
+        PhConfigRecord rec;
+        setPhDefaults(rec);
+        storeRecord(phRecord, CFG_RECORD_PH, rec);
     }
 #endif
 }
 
 void ConfigManager::getSystemConfig(bool &initialized, uint32_t &sleepTime, String &deviceId, String &stationId) {
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    readNamespace(NAMESPACE_SYSTEM, doc);
-    initialized = doc[KEY_INITIALIZED] | false;
-    sleepTime = doc[KEY_SLEEP_TIME] | DEFAULT_TIME_TO_SLEEP;
-    deviceId = String(doc[KEY_DEVICE_ID] | DEFAULT_DEVICE_ID);
-    stationId = String(doc[KEY_STATION_ID] | DEFAULT_STATION_ID);
+    const SystemConfigRecord& rec = systemConfig();
+    initialized = rec.initialized;
+    sleepTime = rec.sleepTime;
+    deviceId = String(rec.deviceId);
+    stationId = String(rec.stationId);
+}
+
+void ConfigManager::getSystemConfig(bool &initialized, uint32_t &sleepTime,
+                                    char *deviceId, size_t deviceIdSize,
+                                    char *stationId, size_t stationIdSize) {
+    const SystemConfigRecord& rec = systemConfig();
+    initialized = rec.initialized;
+    sleepTime = rec.sleepTime;
+    strlcpy(deviceId, rec.deviceId, deviceIdSize);
+    strlcpy(stationId, rec.stationId, stationIdSize);
 }
 
 void ConfigManager::setSystemConfig(bool initialized, uint32_t sleepTime, const String &deviceId, const String &stationId) {
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    readNamespace(NAMESPACE_SYSTEM, doc);
-    doc[KEY_INITIALIZED] = initialized;
-    doc[KEY_SLEEP_TIME] = sleepTime;
-    doc[KEY_DEVICE_ID] = deviceId;
-    doc[KEY_STATION_ID] = stationId;
-    writeNamespace(NAMESPACE_SYSTEM, doc);
+    setSystemConfig(initialized, sleepTime, deviceId.c_str(), stationId.c_str());
+}
+
+void ConfigManager::setSystemConfig(bool initialized, uint32_t sleepTime,
+                                    const char *deviceId, const char *stationId) {
+    SystemConfigRecord rec = systemConfig();
+    rec.initialized = initialized;
+    rec.sleepTime = sleepTime;
+    strlcpy(rec.deviceId, deviceId, sizeof(rec.deviceId));
+    strlcpy(rec.stationId, stationId, sizeof(rec.stationId));
+    storeRecord(systemRecord, CFG_RECORD_SYSTEM, rec);
+}
+
+void ConfigManager::getIntervalBounds(uint32_t &minInterval, uint32_t &maxInterval) {
+    const IntervalBoundsRecord& rec = loadRecord(intervalRecord, CFG_RECORD_INTERVAL,
+                                                 intervalFromLegacy, setIntervalDefaults);
+    minInterval = rec.minInterval;
+    maxInterval = rec.maxInterval;
+}
+
+void ConfigManager::setIntervalBounds(uint32_t minInterval, uint32_t maxInterval) {
+    IntervalBoundsRecord rec;
+    rec.minInterval = minInterval;
+    rec.maxInterval = maxInterval;
+    storeRecord(intervalRecord, CFG_RECORD_INTERVAL, rec);
+}
+
+void ConfigManager::getDatarateLimits(uint8_t &drMin, uint8_t &drMax) {
+    const LinkLimitsRecord& rec = loadRecord(linkRecord, CFG_RECORD_LINK, linkFromLegacy, setLinkDefaults);
+    drMin = rec.drMin;
+    drMax = rec.drMax;
+}
+
+void ConfigManager::setDatarateLimits(uint8_t drMin, uint8_t drMax) {
+    LinkLimitsRecord rec;
+    rec.drMin = drMin;
+    rec.drMax = drMax;
+    storeRecord(linkRecord, CFG_RECORD_LINK, rec);
 }
 
 /* =========================================================================
    CONFIGURACIÓN DE SENSORES NO-MODBUS
    ========================================================================= */
 std::vector<SensorConfig> ConfigManager::getAllSensorConfigs() {
-    std::vector<SensorConfig> configs;
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    readNamespace(NAMESPACE_SENSORS, doc);
-    
-    if (!doc.is<JsonArray>()) {
-        // Si no es un arreglo, no hay nada que leer
-        return configs;
-    }
-    
-    JsonArray sensorArray = doc.as<JsonArray>();
-    for (JsonObject sensorObj : sensorArray) {
-        SensorConfig config;
-        const char* cKey = sensorObj[KEY_SENSOR] | "";
-        strncpy(config.configKey, cKey, sizeof(config.configKey));
-        const char* sensorId = sensorObj[KEY_SENSOR_ID] | "";
-        strncpy(config.sensorId, sensorId, sizeof(config.sensorId));
-        config.type = static_cast<SensorType>(sensorObj[KEY_SENSOR_TYPE] | 0);
-        config.enable = sensorObj[KEY_SENSOR_ENABLE] | false;
-        
-        configs.push_back(config);
-    }
-    
+    std::vector<SensorConfig> configs(MAX_NORMAL_SENSORS);
+    configs.resize(getAllSensorConfigs(configs.data(), configs.size()));
     return configs;
 }
 
-std::vector<SensorConfig> ConfigManager::getEnabledSensorConfigs() {
-    std::vector<SensorConfig> allSensors = getAllSensorConfigs();
+size_t ConfigManager::getAllSensorConfigs(SensorConfig* out, size_t maxCount) {
+    const SensorsConfigRecord& rec = sensorsConfig();
+
+    size_t count = 0;
+    for (uint8_t i = 0; i < rec.count && count < maxCount; i++) {
+        SensorConfig& config = out[count++];
+        strlcpy(config.configKey, rec.sensors[i].configKey, sizeof(config.configKey));
+        strlcpy(config.sensorId, rec.sensors[i].sensorId, sizeof(config.sensorId));
+        config.type = static_cast<SensorType>(rec.sensors[i].type);
+        config.enable = rec.sensors[i].enable;
+        config.periodTicks = rec.sensors[i].periodTicks;
+        config.aggWindow = rec.sensors[i].aggWindow;
+        config.aggStats = rec.sensors[i].aggStats;
+        config.predictTolerance = rec.sensors[i].predictTolerance;
+    }
     
-    std::vector<SensorConfig> enabledSensors;
-    for (const auto& sensor : allSensors) {
-        if (sensor.enable && strlen(sensor.sensorId) > 0) {
-            enabledSensors.push_back(sensor);
+    return count;
+}
+
+size_t ConfigManager::getEnabledSensorConfigs(SensorConfig* out, size_t maxCount) {
+    const SensorsConfigRecord& rec = sensorsConfig();
+
+    // Copiar directamente al arreglo del llamador, sin vectores intermedios
+    size_t count = 0;
+    for (uint8_t i = 0; i < rec.count; i++) {
+        const SensorConfigEntry& entry = rec.sensors[i];
+        if (!entry.enable || entry.sensorId[0] == '\0') {
+            continue;
         }
+        if (count >= maxCount) {
+            DEBUG_PRINTF("Sensores habilitados exceden la capacidad (%u)\n", (unsigned)maxCount);
+            break;
+        }
+        SensorConfig& config = out[count++];
+        strlcpy(config.configKey, entry.configKey, sizeof(config.configKey));
+        strlcpy(config.sensorId, entry.sensorId, sizeof(config.sensorId));
+        config.type = static_cast<SensorType>(entry.type);
+        config.enable = true;
+        config.periodTicks = entry.periodTicks;
+        config.aggWindow = entry.aggWindow;
+        config.aggStats = entry.aggStats;
+        config.predictTolerance = entry.predictTolerance;
     }
-    
-    return enabledSensors;
+
+    return count;
 }
 
 void ConfigManager::setSensorsConfigs(const std::vector<SensorConfig>& configs) {
-    Preferences prefs;
-    prefs.begin(NAMESPACE_SENSORS, false);
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    JsonArray sensorArray = doc.to<JsonArray>();
-    
-    for (const auto& sensor : configs) {
-        JsonObject sensorObj = sensorArray.createNestedObject();
-        sensorObj[KEY_SENSOR] = sensor.configKey;
-        sensorObj[KEY_SENSOR_ID] = sensor.sensorId;
-        sensorObj[KEY_SENSOR_TYPE] = static_cast<int>(sensor.type);
-        sensorObj[KEY_SENSOR_ENABLE] = sensor.enable;
+    setSensorsConfigs(configs.data(), configs.size());
+}
+
+void ConfigManager::setSensorsConfigs(const SensorConfig* configs, size_t count) {
+    if (count > MAX_NORMAL_SENSORS) {
+        DEBUG_PRINTF("Se guardan solo %u sensores\n", (unsigned)MAX_NORMAL_SENSORS);
     }
-    
-    String jsonString;
-    serializeJson(doc, jsonString);
-    prefs.putString(NAMESPACE_SENSORS, jsonString.c_str());
-    prefs.end();
+    SensorsConfigRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    setSensorsFrom(rec, configs, count);
+    storeRecord(sensorsRecord, CFG_RECORD_SENSORS, rec);
 }
 
 /* =========================================================================
    CONFIGURACIÓN DE LORA
    ========================================================================= */
 LoRaConfig ConfigManager::getLoRaConfig() {
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    readNamespace(NAMESPACE_LORAWAN, doc);
-    
+    // Vista en texto ("xx,xx,...") solo para la interfaz BLE
+    const LoRaConfigRecord& rec = loraConfig();
+    char buffer[3 * sizeof(rec.nwkKey)];
+
     LoRaConfig config;
-    config.joinEUI  = doc[KEY_LORA_JOIN_EUI] | DEFAULT_JOIN_EUI;
-    config.devEUI   = doc[KEY_LORA_DEV_EUI]  | DEFAULT_DEV_EUI;
-    config.nwkKey   = doc[KEY_LORA_NWK_KEY]  | DEFAULT_NWK_KEY;
-    config.appKey   = doc[KEY_LORA_APP_KEY]  | DEFAULT_APP_KEY;
+    formatKeyString(rec.joinEUI, sizeof(rec.joinEUI), buffer, sizeof(buffer));
+    config.joinEUI = buffer;
+    formatKeyString(rec.devEUI, sizeof(rec.devEUI), buffer, sizeof(buffer));
+    config.devEUI = buffer;
+    formatKeyString(rec.nwkKey, sizeof(rec.nwkKey), buffer, sizeof(buffer));
+    config.nwkKey = buffer;
+    formatKeyString(rec.appKey, sizeof(rec.appKey), buffer, sizeof(buffer));
+    config.appKey = buffer;
     
     return config;
 }
 
+bool ConfigManager::getLoRaKeys(uint64_t &joinEUI, uint64_t &devEUI, uint8_t *nwkKey, uint8_t *appKey) {
+    const LoRaConfigRecord& rec = loraConfig();
+    joinEUI = 0;
+    devEUI = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+        joinEUI = (joinEUI << 8) | rec.joinEUI[i];
+        devEUI = (devEUI << 8) | rec.devEUI[i];
+    }
+    memcpy(nwkKey, rec.nwkKey, sizeof(rec.nwkKey));
+    memcpy(appKey, rec.appKey, sizeof(rec.appKey));
+
+    // Un DevEUI vacío (texto que no se pudo interpretar) o borrado no es utilizable
+    if (devEUI == 0 || devEUI == UINT64_MAX) {
+        DEBUG_PRINTLN("DevEUI inválido en la configuración LoRaWAN");
+        return false;
+    }
+    return true;
+}
+
 void ConfigManager::setLoRaConfig(
     const String &joinEUI, 
     const String &devEUI, 
     const String &nwkKey, 
     const String &appKey) {
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    readNamespace(NAMESPACE_LORAWAN, doc);
-    
-    doc[KEY_LORA_JOIN_EUI] = joinEUI;
-    doc[KEY_LORA_DEV_EUI]  = devEUI;
-    doc[KEY_LORA_NWK_KEY]  = nwkKey;
-    doc[KEY_LORA_APP_KEY]  = appKey;
-    
-    writeNamespace(NAMESPACE_LORAWAN, doc);
+    LoRaConfigRecord rec;
+    parseLoRaBytes(joinEUI.c_str(), rec.joinEUI);
+    parseLoRaBytes(devEUI.c_str(), rec.devEUI);
+    memset(rec.nwkKey, 0, sizeof(rec.nwkKey));
+    memset(rec.appKey, 0, sizeof(rec.appKey));
+    parseKeyString(nwkKey, rec.nwkKey, sizeof(rec.nwkKey));
+    parseKeyString(appKey, rec.appKey, sizeof(rec.appKey));
+    storeRecord(loraRecord, CFG_RECORD_LORAWAN, rec);
 }
 
 /* =========================================================================
@@ -297,57 +720,66 @@ void ConfigManager::setLoRaConfig(
 const ModbusSensorConfig ConfigManager::defaultModbusSensors[] = DEFAULT_MODBUS_SENSOR_CONFIGS;
 
 void ConfigManager::setModbusSensorsConfigs(const std::vector<ModbusSensorConfig>& configs) {
-    Preferences prefs;
-    prefs.begin(NAMESPACE_SENSORS_MODBUS, false);
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    JsonArray sensorArray = doc.to<JsonArray>();
-    
-    for (const auto& sensor : configs) {
-        JsonObject sensorObj = sensorArray.createNestedObject();
-        sensorObj[KEY_MODBUS_SENSOR_ID] = sensor.sensorId;
-        sensorObj[KEY_MODBUS_SENSOR_TYPE] = static_cast<int>(sensor.type);
-        sensorObj[KEY_MODBUS_SENSOR_ADDR] = sensor.address;
-        sensorObj[KEY_MODBUS_SENSOR_ENABLE] = sensor.enable;
-    }
-    
-    String jsonString;
-    serializeJson(doc, jsonString);
-    prefs.putString(NAMESPACE_SENSORS_MODBUS, jsonString.c_str());
-    prefs.end();
+    setModbusSensorsConfigs(configs.data(), configs.size());
+}
+
+void ConfigManager::setModbusSensorsConfigs(const ModbusSensorConfig* configs, size_t count) {
+    ModbusSensorsConfigRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    setModbusFrom(rec, configs, count);
+    storeRecord(modbusRecord, CFG_RECORD_MODBUS, rec);
 }
 
 std::vector<ModbusSensorConfig> ConfigManager::getAllModbusSensorConfigs() {
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    readNamespace(NAMESPACE_SENSORS_MODBUS, doc);
-    
-    std::vector<ModbusSensorConfig> configs;
-    
-    if (doc.is<JsonArray>()) {
-        JsonArray array = doc.as<JsonArray>();
-        
-        for (JsonObject sensorObj : array) {
-            ModbusSensorConfig config;
-            strlcpy(config.sensorId, sensorObj[KEY_MODBUS_SENSOR_ID] | "", sizeof(config.sensorId));
-            config.type = static_cast<SensorType>(sensorObj[KEY_MODBUS_SENSOR_TYPE] | 0);
-            config.address = sensorObj[KEY_MODBUS_SENSOR_ADDR] | 1;
-            config.enable = sensorObj[KEY_MODBUS_SENSOR_ENABLE] | false;
-            
-            configs.push_back(config);
-        }
+    std::vector<ModbusSensorConfig> configs(MAX_MODBUS_SENSORS);
+    configs.resize(getAllModbusSensorConfigs(configs.data(), configs.size()));
+    return configs;
+}
+
+size_t ConfigManager::getAllModbusSensorConfigs(ModbusSensorConfig* out, size_t maxCount) {
+    const ModbusSensorsConfigRecord& rec = modbusConfig();
+
+    size_t count = 0;
+    for (uint8_t i = 0; i < rec.count && count < maxCount; i++) {
+        ModbusSensorConfig& config = out[count++];
+        strlcpy(config.sensorId, rec.sensors[i].sensorId, sizeof(config.sensorId));
+        config.type = static_cast<SensorType>(rec.sensors[i].type);
+        config.address = rec.sensors[i].address;
+        config.enable = rec.sensors[i].enable;
+        config.periodTicks = rec.sensors[i].periodTicks;
+        config.aggWindow = rec.sensors[i].aggWindow;
+        config.aggStats = rec.sensors[i].aggStats;
+        config.predictTolerance = rec.sensors[i].predictTolerance;
     }
     
-    return configs;
+    return count;
 }
 
-std::vector<ModbusSensorConfig> ConfigManager::getEnabledModbusSensorConfigs() {
-    std::vector<ModbusSensorConfig> all = getAllModbusSensorConfigs();
-    std::vector<ModbusSensorConfig> enabled;
-    for (auto &m : all) {
-        if (m.enable) {
-            enabled.push_back(m);
+size_t ConfigManager::getEnabledModbusSensorConfigs(ModbusSensorConfig* out, size_t maxCount) {
+    const ModbusSensorsConfigRecord& rec = modbusConfig();
+
+    size_t count = 0;
+    for (uint8_t i = 0; i < rec.count; i++) {
+        const ModbusSensorConfigEntry& entry = rec.sensors[i];
+        if (!entry.enable) {
+            continue;
+        }
+        if (count >= maxCount) {
+            DEBUG_PRINTF("Sensores Modbus habilitados exceden la capacidad (%u)\n", (unsigned)maxCount);
+            break;
         }
+        ModbusSensorConfig& config = out[count++];
+        strlcpy(config.sensorId, entry.sensorId, sizeof(config.sensorId));
+        config.type = static_cast<SensorType>(entry.type);
+        config.address = entry.address;
+        config.enable = true;
+        config.periodTicks = entry.periodTicks;
+        config.aggWindow = entry.aggWindow;
+        config.aggStats = entry.aggStats;
+        config.predictTolerance = entry.predictTolerance;
     }
-    return enabled;
+
+    return count;
 }
 #endif
 
@@ -357,102 +789,70 @@ std::vector<ModbusSensorConfig> ConfigManager::getEnabledModbusSensorConfigs() {
 #ifdef DEVICE_TYPE_ANALOGIC
 
 void ConfigManager::getNTC100KConfig(double& t1, double& r1, double& t2, double& r2, double& t3, double& r3) {
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    readNamespace(NAMESPACE_NTC100K, doc);
-    t1 = doc[KEY_NTC100K_T1] | DEFAULT_T1_100K;
-    r1 = doc[KEY_NTC100K_R1] | DEFAULT_R1_100K;
-    t2 = doc[KEY_NTC100K_T2] | DEFAULT_T2_100K;
-    r2 = doc[KEY_NTC100K_R2] | DEFAULT_R2_100K;
-    t3 = doc[KEY_NTC100K_T3] | DEFAULT_T3_100K;
-    r3 = doc[KEY_NTC100K_R3] | DEFAULT_R3_100K;
+    const NtcConfigRecord& rec = loadRecord(ntc100kRecord, CFG_RECORD_NTC100K, ntc100kFromLegacy, setNtc100kDefaults);
+    t1 = rec.t1; r1 = rec.r1;
+    t2 = rec.t2; r2 = rec.r2;
+    t3 = rec.t3; r3 = rec.r3;
 }
 
 void ConfigManager::setNTC100KConfig(double t1, double r1, double t2, double r2, double t3, double r3) {
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    readNamespace(NAMESPACE_NTC100K, doc);
-    doc[KEY_NTC100K_T1] = t1;
-    doc[KEY_NTC100K_R1] = r1;
-    doc[KEY_NTC100K_T2] = t2;
-    doc[KEY_NTC100K_R2] = r2;
-    doc[KEY_NTC100K_T3] = t3;
-    doc[KEY_NTC100K_R3] = r3;
-    writeNamespace(NAMESPACE_NTC100K, doc);
+    NtcConfigRecord rec;
+    rec.t1 = t1; rec.r1 = r1;
+    rec.t2 = t2; rec.r2 = r2;
+    rec.t3 = t3; rec.r3 = r3;
+    storeRecord(ntc100kRecord, CFG_RECORD_NTC100K, rec);
 }
 
 void ConfigManager::getNTC10KConfig(double& t1, double& r1, double& t2, double& r2, double& t3, double& r3) {
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    readNamespace(NAMESPACE_NTC10K, doc);
-    t1 = doc[KEY_NTC10K_T1] | DEFAULT_T1_10K;
-    r1 = doc[KEY_NTC10K_R1] | DEFAULT_R1_10K;
-    t2 = doc[KEY_NTC10K_T2] | DEFAULT_T2_10K;
-    r2 = doc[KEY_NTC10K_R2] | DEFAULT_R2_10K;
-    t3 = doc[KEY_NTC10K_T3] | DEFAULT_T3_10K;
-    r3 = doc[KEY_NTC10K_R3] | DEFAULT_R3_10K;
+    const NtcConfigRecord& rec = loadRecord(ntc10kRecord, CFG_RECORD_NTC10K, ntc10kFromLegacy, setNtc10kDefaults);
+    t1 = rec.t1; r1 = rec.r1;
+    t2 = rec.t2; r2 = rec.r2;
+    t3 = rec.t3; r3 = rec.r3;
 }
 
 void ConfigManager::setNTC10KConfig(double t1, double r1, double t2, double r2, double t3, double r3) {
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    readNamespace(NAMESPACE_NTC10K, doc);
-    doc[KEY_NTC10K_T1] = t1;
-    doc[KEY_NTC10K_R1] = r1;
-    doc[KEY_NTC10K_T2] = t2;
-    doc[KEY_NTC10K_R2] = r2;
-    doc[KEY_NTC10K_T3] = t3;
-    doc[KEY_NTC10K_R3] = r3;
-    writeNamespace(NAMESPACE_NTC10K, doc);
+    NtcConfigRecord rec;
+    rec.t1 = t1; rec.r1 = r1;
+    rec.t2 = t2; rec.r2 = r2;
+    rec.t3 = t3; rec.r3 = r3;
+    storeRecord(ntc10kRecord, CFG_RECORD_NTC10K, rec);
 }
 
 void ConfigManager::getConductivityConfig(float& calTemp, float& coefComp, 
                                            float& v1, float& t1, float& v2, float& t2, float& v3, float& t3) {
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    readNamespace(NAMESPACE_COND, doc);
-    calTemp = doc[KEY_CONDUCT_CT] | CONDUCTIVITY_DEFAULT_TEMP;
-    coefComp = doc[KEY_CONDUCT_CC] | TEMP_COEF_COMPENSATION;
-    v1 = doc[KEY_CONDUCT_V1] | CONDUCTIVITY_DEFAULT_V1;
-    t1 = doc[KEY_CONDUCT_T1] | CONDUCTIVITY_DEFAULT_T1;
-    v2 = doc[KEY_CONDUCT_V2] | CONDUCTIVITY_DEFAULT_V2;
-    t2 = doc[KEY_CONDUCT_T2] | CONDUCTIVITY_DEFAULT_T2;
-    v3 = doc[KEY_CONDUCT_V3] | CONDUCTIVITY_DEFAULT_V3;
-    t3 = doc[KEY_CONDUCT_T3] | CONDUCTIVITY_DEFAULT_T3;
+    const ConductivityConfigRecord& rec = loadRecord(condRecord, CFG_RECORD_COND, condFromLegacy, setCondDefaults);
+    calTemp = rec.calTemp;
+    coefComp = rec.coefComp;
+    v1 = rec.v1; t1 = rec.t1;
+    v2 = rec.v2; t2 = rec.t2;
+    v3 = rec.v3; t3 = rec.t3;
 }
 
 void ConfigManager::setConductivityConfig(float calTemp, float coefComp,
                                            float v1, float t1, float v2, float t2, float v3, float t3) {
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    readNamespace(NAMESPACE_COND, doc);
-    doc[KEY_CONDUCT_CT] = calTemp;
-    doc[KEY_CONDUCT_CC] = coefComp;
-    doc[KEY_CONDUCT_V1] = v1;
-    doc[KEY_CONDUCT_T1] = t1;
-    doc[KEY_CONDUCT_V2] = v2;
-    doc[KEY_CONDUCT_T2] = t2;
-    doc[KEY_CONDUCT_V3] = v3;
-    doc[KEY_CONDUCT_T3] = t3;
-    writeNamespace(NAMESPACE_COND, doc);
+    ConductivityConfigRecord rec;
+    rec.calTemp = calTemp;
+    rec.coefComp = coefComp;
+    rec.v1 = v1; rec.t1 = t1;
+    rec.v2 = v2; rec.t2 = t2;
+    rec.v3 = v3; rec.t3 = t3;
+    storeRecord(condRecord, CFG_RECORD_COND, rec);
 }
 
 void ConfigManager::getPHConfig(float& v1, float& t1, float& v2, float& t2, float& v3, float& t3, float& defaultTemp) {
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    readNamespace(NAMESPACE_PH, doc);
-    v1 = doc[KEY_PH_V1] | PH_DEFAULT_V1;
-    t1 = doc[KEY_PH_T1] | PH_DEFAULT_T1;
-    v2 = doc[KEY_PH_V2] | PH_DEFAULT_V2;
-    t2 = doc[KEY_PH_T2] | PH_DEFAULT_T2;
-    v3 = doc[KEY_PH_V3] | PH_DEFAULT_V3;
-    t3 = doc[KEY_PH_T3] | PH_DEFAULT_T3;
-    defaultTemp = doc[KEY_PH_CT] | PH_DEFAULT_TEMP;
+    const PhConfigRecord& rec = loadRecord(phRecord, CFG_RECORD_PH, phFromLegacy, setPhDefaults);
+    v1 = rec.v1; t1 = rec.t1;
+    v2 = rec.v2; t2 = rec.t2;
+    v3 = rec.v3; t3 = rec.t3;
+    defaultTemp = rec.calTemp;
 }
 
 void ConfigManager::setPHConfig(float v1, float t1, float v2, float t2, float v3, float t3, float defaultTemp) {
-    StaticJsonDocument<JSON_DOC_SIZE_MEDIUM> doc;
-    readNamespace(NAMESPACE_PH, doc);
-    doc[KEY_PH_V1] = v1;
-    doc[KEY_PH_T1] = t1;
-    doc[KEY_PH_V2] = v2;
-    doc[KEY_PH_T2] = t2;
-    doc[KEY_PH_V3] = v3;
-    doc[KEY_PH_T3] = t3;
-    doc[KEY_PH_CT] = defaultTemp;
-    writeNamespace(NAMESPACE_PH, doc);
+    PhConfigRecord rec;
+    rec.v1 = v1; rec.t1 = t1;
+    rec.v2 = v2; rec.t2 = t2;
+    rec.v3 = v3; rec.t3 = t3;
+    rec.calTemp = defaultTemp;
+    storeRecord(phRecord, CFG_RECORD_PH, rec);
 }
 #endif
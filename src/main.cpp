@@ -6,9 +6,9 @@
 #include <OneWire.h>
 #include <DallasTemperature.h>
 #endif
-#include <vector>
 #include <ArduinoJson.h>
 #include <cmath>
+#include <new>
 
 #include "config.h"
 #include "debug.h"
@@ -31,7 +31,24 @@
 #include "ADS124S08.h"
 #include "HardwareManager.h"
 #include "SleepManager.h"
+#include "SpiBusManager.h"
 #include "SHT31.h"
+#include "HeapProbe.h"
+#include "BootManager.h"
+#include "WakeStub.h"
+#include "IntervalPolicy.h"
+#include "SensorScheduler.h"
+#include "SensorFilter.h"
+#include "Aggregator.h"
+#include "BatchBuffer.h"
+#include "DualPredictor.h"
+#include "LinkPolicy.h"
+#include "AirtimeBudget.h"
+#include "TxScheduler.h"
+#include "SessionStore.h"
+#include "JoinPolicy.h"
+#include "SlotScheduler.h"
+#include "util/span.h"
 //--------------------------------------------------------------------------------------------
 // Variables globales
 //--------------------------------------------------------------------------------------------
@@ -39,16 +56,21 @@ const LoRaWANBand_t Region = LORA_REGION;
 const uint8_t subBand = LORA_SUBBAND;
 
 Preferences preferences;
-uint32_t timeToSleep;
-String deviceId;
-String stationId;
+uint32_t timeToSleep;         // Intervalo configurado
+uint32_t sleepInterval;       // Intervalo del siguiente sueño (adaptativo)
+char deviceId[MAX_ID_LENGTH];
+char stationId[MAX_ID_LENGTH];
 bool systemInitialized;
 unsigned long setupStartTime; // Variable para almacenar el tiempo de inicio
+bool reportCycle = true;      // false en los ciclos de solo muestreo (sin radio)
+bool radioReady = false;      // Radio iniciada y sesión LoRaWAN activa
 
-// Configuraciones de sensores
-std::vector<SensorConfig> enabledNormalSensors;
+// Configuraciones de sensores (capacidad fija, se cargan una vez en setup)
+SensorConfig enabledNormalSensors[MAX_NORMAL_SENSORS];
+size_t enabledNormalCount = 0;
 #if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
-std::vector<ModbusSensorConfig> enabledModbusSensors;
+ModbusSensorConfig enabledModbusSensors[MAX_MODBUS_SENSORS];
+size_t enabledModbusCount = 0;
 #endif
 
 RTC_DS3231 rtc;
@@ -56,17 +78,20 @@ PCA9555 ioExpander(I2C_ADDRESS_PCA9555, I2C_SDA_PIN, I2C_SCL_PIN);
 PowerManager powerManager(ioExpander);
 
 SPIClass spi(FSPI);
+// Dispositivos del bus SPI compartido (reloj máximo, modo y estrategia de CS)
 #ifdef DEVICE_TYPE_ANALOGIC
-SPISettings spiAdcSettings(SPI_ADC_CLOCK, MSBFIRST, SPI_MODE1);
-ADS124S08 ADC(ioExpander, spi, spiAdcSettings);
+const SpiDeviceHandle spiAdcDevice = SpiBusManager::registerDevice("ADS124S08", SPI_ADC_CLOCK, SPI_MODE1, SPI_CS_PCA9555, ADS124S08_CS_PIN, &ioExpander);
+ADS124S08 ADC(ioExpander, spiAdcDevice);
 #endif
-SPISettings spiRtdSettings(SPI_RTD_CLOCK, MSBFIRST, SPI_MODE1);
-SPISettings spiRadioSettings(SPI_RADIO_CLOCK, MSBFIRST, SPI_MODE0);
+const SpiDeviceHandle spiRtdDevice = SpiBusManager::registerDevice("MAX31865", SPI_RTD_CLOCK, SPI_MODE1, SPI_CS_PCA9555, PT100_CS_PIN, &ioExpander);
+const SpiDeviceHandle spiRadioDevice = SpiBusManager::registerDevice("SX1262", SPI_RADIO_CLOCK, SPI_MODE0, SPI_CS_EXTERNAL, LORA_NSS_PIN);
 
-MAX31865_RTD rtd(MAX31865_RTD::RTD_PT100, spi, spiRtdSettings, ioExpander, PT100_CS_PIN);
+MAX31865_RTD rtd(MAX31865_RTD::RTD_PT100, spiRtdDevice);
 SHT31 sht30Sensor(0x44, &Wire);
 
-SX1262 radio = new Module(LORA_NSS_PIN, LORA_DIO1_PIN, LORA_RST_PIN, LORA_BUSY_PIN, spi, spiRadioSettings);
+// RadioLib maneja el NSS; sus transacciones pasan por SpiBusManager
+SpiBusHal radioHal(spi, spiRadioDevice);
+SX1262 radio = new Module(&radioHal, LORA_NSS_PIN, LORA_DIO1_PIN, LORA_RST_PIN, LORA_BUSY_PIN);
 LoRaWANNode node(&radio, &Region, subBand);
 
 #if defined(DEVICE_TYPE_BASIC) || defined(DEVICE_TYPE_ANALOGIC)
@@ -75,10 +100,53 @@ DallasTemperature dallasTemp(&oneWire);
 #endif
 
 RTC_DATA_ATTR uint16_t bootCount = 0;
-RTC_DATA_ATTR uint16_t bootCountSinceUnsuccessfulJoin = 0;
 RTC_DATA_ATTR uint8_t LWsession[RADIOLIB_LORAWAN_SESSION_BUF_SIZE];
 Preferences store;
 
+//--------------------------------------------------------------------------------------------
+// Inicia la radio y activa LoRaWAN (restaura la sesión o hace join)
+//--------------------------------------------------------------------------------------------
+static bool startRadio() {
+    // Inicializar radio LoRa
+    int16_t state = radio.begin();
+    if (state != RADIOLIB_ERR_NONE) {
+        DEBUG_PRINTF("Error iniciando radio: %d\n", state);
+        return false;
+    }
+
+    // La sub-banda solo se fija al construir el nodo: recrearlo con la de JoinPolicy
+    // (la última buena o la que toca explorar) antes de restaurar la sesión o unirse
+    node.~LoRaWANNode();
+    new (&node) LoRaWANNode(&radio, &Region, JoinPolicy::subBand());
+
+    // Activar LoRaWAN
+    state = LoRaManager::lwActivate(node);
+    if (state != RADIOLIB_LORAWAN_NEW_SESSION && 
+        state != RADIOLIB_LORAWAN_SESSION_RESTORED) {
+        DEBUG_PRINTF("Error activando LoRaWAN o sincronizando RTC: %d\n", state);
+        return false;
+    }
+    radioReady = true;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------
+// Añade las lecturas de la muestra actual como fila del lote (BatchBuffer)
+//--------------------------------------------------------------------------------------------
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+static void appendBatchRow(Span<const SensorReading> normalReadings,
+                           Span<const ModbusSensorReading> modbusReadings, uint32_t sampleTime) {
+    BatchBuffer::append(Span<const SensorConfig>(enabledNormalSensors, enabledNormalCount), normalReadings,
+                        Span<const ModbusSensorConfig>(enabledModbusSensors, enabledModbusCount), modbusReadings,
+                        sampleTime);
+}
+#else
+static void appendBatchRow(Span<const SensorReading> normalReadings, uint32_t sampleTime) {
+    BatchBuffer::append(Span<const SensorConfig>(enabledNormalSensors, enabledNormalCount), normalReadings,
+                        sampleTime);
+}
+#endif
+
 //--------------------------------------------------------------------------------------------
 // setup()
 //--------------------------------------------------------------------------------------------
@@ -93,20 +161,55 @@ void setup() {
     // nvs_flash_erase();
     // nvs_flash_init();
 
-    // Inicialización de configuración
-    if (!ConfigManager::checkInitialized()) {
-        ConfigManager::initializeDefaultConfig();
-    }
-    ConfigManager::getSystemConfig(systemInitialized, timeToSleep, deviceId, stationId);
+    // Clasificar el arranque: en un despertar por temporizador con estado RTC válido
+    // se restaura la configuración sin leer NVS
+    BootMode bootMode = BootManager::begin();
+    reportCycle = (WakeStub::begin(bootMode) == WAKE_DECISION_REPORT);
+    bool warmBoot = (bootMode == BOOT_MODE_WARM) &&
+                    BootManager::restoreConfig(timeToSleep, deviceId, sizeof(deviceId),
+                                               stationId, sizeof(stationId),
+                                               enabledNormalSensors, enabledNormalCount
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+                                               , enabledModbusSensors, enabledModbusCount
+#endif
+                                               );
+
+    if (!warmBoot) {
+        // Inicialización de configuración
+        if (!ConfigManager::checkInitialized()) {
+            ConfigManager::initializeDefaultConfig();
+        }
+        ConfigManager::getSystemConfig(systemInitialized, timeToSleep,
+                                       deviceId, sizeof(deviceId), stationId, sizeof(stationId));
 
-    // Obtener configuraciones de sensores habilitados
-    enabledNormalSensors = ConfigManager::getEnabledSensorConfigs();
+        // Obtener configuraciones de sensores habilitados
+        enabledNormalCount = ConfigManager::getEnabledSensorConfigs(enabledNormalSensors, MAX_NORMAL_SENSORS);
 #if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
-    enabledModbusSensors = ConfigManager::getEnabledModbusSensorConfigs();
+        enabledModbusCount = ConfigManager::getEnabledModbusSensorConfigs(enabledModbusSensors, MAX_MODBUS_SENSORS);
 #endif
 
-    // Inicialización de hardware
-    if (!HardwareManager::initHardware(ioExpander, powerManager, sht30Sensor, spi, enabledNormalSensors)) {
+        // Guardar en RTC para los siguientes despertares
+        BootManager::storeConfig(timeToSleep, deviceId, stationId,
+                                 Span<const SensorConfig>(enabledNormalSensors, enabledNormalCount)
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+                                 , Span<const ModbusSensorConfig>(enabledModbusSensors, enabledModbusCount)
+#endif
+                                 );
+    }
+    Span<const SensorConfig> normalConfigs(enabledNormalSensors, enabledNormalCount);
+    sleepInterval = timeToSleep;
+    IntervalPolicy::begin(bootMode);
+    // Si la configuración se volvió a leer de NVS los índices de sensores pueden cambiar
+    SensorScheduler::begin(warmBoot ? bootMode : BOOT_MODE_COLD);
+    SensorFilter::begin(bootMode);
+    Aggregator::begin(bootMode);
+    BatchBuffer::begin(bootMode);
+    DualPredictor::begin(bootMode);
+    LinkPolicy::begin(bootMode);
+    SessionStore::begin(bootMode);
+
+    // Inicialización de hardware (en caliente solo lo que perdió su estado)
+    if (!HardwareManager::initHardware(ioExpander, powerManager, sht30Sensor, spi, normalConfigs, warmBoot)) {
         DEBUG_PRINTLN("Error en la inicialización del hardware");
         SleepManager::goToDeepSleep(timeToSleep, powerManager, ioExpander, &radio, node, LWsession, spi);
     }
@@ -124,24 +227,23 @@ void setup() {
     if (!rtc.begin()) {
         DEBUG_PRINTLN("No se pudo encontrar RTC");
     }
+    SlotScheduler::begin(rtc, bootMode);
+    AirtimeBudget::begin(rtc);
+    TxScheduler::begin(rtc, bootMode);
+    JoinPolicy::begin(rtc, bootMode);
 
-    // Inicializar sensores
-    SensorManager::beginSensors(enabledNormalSensors);
+    // Los rieles de sensores y sus dispositivos se encienden en cada medición
+    // (SensorManager::getAllSensorReadings)
 
     //TIEMPO TRASCURRIDO HASTA EL MOMENTO ≈ 98 ms
-    // Inicializar radio LoRa
-    int16_t state = radio.begin();
-    if (state != RADIOLIB_ERR_NONE) {
-        DEBUG_PRINTF("Error iniciando radio: %d\n", state);
-        SleepManager::goToDeepSleep(timeToSleep, powerManager, ioExpander, &radio, node, LWsession, spi);
+    // En un ciclo de solo muestreo no se usa la radio
+    if (reportCycle && !startRadio()) {
+        SleepManager::goToDeepSleep(JoinPolicy::retrySleep(timeToSleep), powerManager, ioExpander, &radio, node, LWsession, spi);
     }
 
-    // Activar LoRaWAN
-    state = LoRaManager::lwActivate(node);
-    if (state != RADIOLIB_LORAWAN_NEW_SESSION && 
-        state != RADIOLIB_LORAWAN_SESSION_RESTORED) {
-        DEBUG_PRINTF("Error activando LoRaWAN o sincronizando RTC: %d\n", state);
-        SleepManager::goToDeepSleep(timeToSleep, powerManager, ioExpander, &radio, node, LWsession, spi);
+    // Coste medido del arranque, usado para elegir entre sueño ligero y deep sleep
+    if (bootMode == BOOT_MODE_WARM) {
+        SleepManager::recordBootCost(millis());
     }
 }
 
@@ -154,20 +256,101 @@ void loop() {
         return;
     }
 
-    // Obtener todas las lecturas de sensores (normales y Modbus)
-    std::vector<SensorReading> normalReadings;
+    // Tras un sueño ligero que empezó en un ciclo de solo muestreo la radio sigue apagada
+    if (reportCycle && !radioReady && !startRadio()) {
+        SleepManager::goToDeepSleep(JoinPolicy::retrySleep(timeToSleep), powerManager, ioExpander, &radio, node, LWsession, spi);
+    }
+
+    // Ciclo de medición y envío sin memoria dinámica
+    HeapProbe::mark();
+    SlotScheduler::markMeasurementStart();
+
+    // Obtener las lecturas de los sensores (normales y Modbus) cuyo periodo vence en este tick
+    SensorScheduler::beginTick();
+    Span<const SensorReading> normalReadings;
+    Span<const SensorConfig> normalConfigs =
+        SensorScheduler::dueNormal(Span<const SensorConfig>(enabledNormalSensors, enabledNormalCount));
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    Span<const ModbusSensorReading> modbusReadings;
+    Span<const ModbusSensorConfig> modbusConfigs =
+        SensorScheduler::dueModbus(Span<const ModbusSensorConfig>(enabledModbusSensors, enabledModbusCount));
+    SensorManager::getAllSensorReadings(normalReadings, modbusReadings, normalConfigs, modbusConfigs);
+#else
+    SensorManager::getAllSensorReadings(normalReadings, normalConfigs);
+#endif
+
+    // Intervalo del siguiente sueño según batería y dinámica de las lecturas
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    sleepInterval = IntervalPolicy::update(timeToSleep, normalReadings, modbusReadings);
+#else
+    sleepInterval = IntervalPolicy::update(timeToSleep, normalReadings);
+#endif
+
+    // Los sensores con ventana de agregación se acumulan en cada muestra y salen de las
+    // lecturas a enviar; sus resúmenes van en un uplink aparte al cerrar la ventana
+    uint32_t sampleTime = SlotScheduler::timestamp(rtc);
+    Aggregator::feed(normalConfigs, normalReadings, sampleTime);
 #if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
-    std::vector<ModbusSensorReading> modbusReadings;
-    SensorManager::getAllSensorReadings(normalReadings, modbusReadings, enabledNormalSensors, enabledModbusSensors);
+    Aggregator::feed(modbusConfigs, modbusReadings, sampleTime);
+#endif
+
+#if BATCH_UPLINK_ENABLED
+    // Cada muestra se añade al lote; se envía completo en el siguiente ciclo de reporte
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+    appendBatchRow(normalReadings, modbusReadings, sampleTime);
 #else
-    SensorManager::getAllSensorReadings(normalReadings, enabledNormalSensors);
+    appendBatchRow(normalReadings, sampleTime);
+#endif
 #endif
 
     // Usar el nuevo formato delimitado en lugar de JSON
+    if (reportCycle) {
+        // La medición queda alineada al slot; el primer uplink espera al slot de este nodo
+        TxScheduler::beginCycle(sampleTime, sleepInterval);
+#if BATCH_UPLINK_ENABLED
+        LoRaManager::sendBatch(node);
+#else
+        if (!AirtimeBudget::allows(AirtimeBudget::lastDataLength())) {
+            // Sin presupuesto de tiempo en el aire la muestra se aplaza al lote, antes de
+            // pasar por el predictor (el servidor no la verá hasta que salga el lote)
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+            appendBatchRow(normalReadings, modbusReadings, sampleTime);
+#else
+            appendBatchRow(normalReadings, sampleTime);
+#endif
+        } else {
+            // Predicción dual: solo viajan las lecturas que el modelo compartido con el servidor
+            // no predice; el payload lleva el mismo sampleTime con el que se evaluó el modelo
+            DualPredictor::beginCycle();
+            DualPredictor::filter(normalConfigs, normalReadings, sampleTime);
 #if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
-    LoRaManager::sendDelimitedPayload(normalReadings, modbusReadings, node, deviceId, stationId, rtc);
+            DualPredictor::filter(modbusConfigs, modbusReadings, sampleTime);
+#endif
+            if (!DualPredictor::silent()) {
+#if defined(DEVICE_TYPE_ANALOGIC) || defined(DEVICE_TYPE_MODBUS)
+                int16_t state = LoRaManager::sendDelimitedPayload(normalReadings, modbusReadings, node,
+                                                                  deviceId, stationId, sampleTime);
 #else
-    LoRaManager::sendDelimitedPayload(normalReadings, node, deviceId, stationId, rtc);
+                int16_t state = LoRaManager::sendDelimitedPayload(normalReadings, node, deviceId,
+                                                                  stationId, sampleTime);
+#endif
+                // Los modelos solo avanzan si el servidor recibió los valores
+                if (state == RADIOLIB_ERR_NONE || state == RADIOLIB_LORAWAN_NO_DOWNLINK) {
+                    DualPredictor::commit();
+                }
+            }
+            // Muestras aplazadas en ciclos anteriores, en tramas de lote compactas
+            LoRaManager::sendBatch(node);
+        }
+#endif
+        LoRaManager::sendAggregates(node, rtc);
+        powerManager.reportRailTime();
+        LoRaManager::sendDiagnostics(node);
+        SessionStore::checkpoint(node);
+    }
+
+#ifdef HEAP_PROBE_ENABLED
+    DEBUG_PRINTF("Asignaciones de heap en el ciclo: %lu\n", (unsigned long)HeapProbe::sinceMark());
 #endif
 
     // Calcular y mostrar el tiempo transcurrido antes de dormir
@@ -175,6 +358,21 @@ void loop() {
     DEBUG_PRINTF("Tiempo transcurrido antes de sleep: %lu ms\n", elapsedTime);
     delay(10);
 
+    // Intervalos cortos: sueño ligero conservando RAM y periféricos; loop() vuelve a medir
+    // sin reinicializar nada en el siguiente tick con trabajo
+    if (SleepManager::useLightSleep(sleepInterval)) {
+        WakeDecision next = WAKE_DECISION_IDLE;
+        while (next == WAKE_DECISION_IDLE) {
+            if (!SleepManager::lightSleep(sleepInterval, &radio)) {
+                break;  // Pin de configuración: lo atiende checkConfigMode()
+            }
+            next = WakeStub::advanceTick();
+        }
+        reportCycle = (next == WAKE_DECISION_REPORT);
+        setupStartTime = millis();
+        return;
+    }
+
     // Dormir
-    SleepManager::goToDeepSleep(timeToSleep, powerManager, ioExpander, &radio, node, LWsession, spi);
+    SleepManager::goToDeepSleep(sleepInterval, powerManager, ioExpander, &radio, node, LWsession, spi);
 }
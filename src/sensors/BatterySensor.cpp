@@ -20,8 +20,9 @@ float BatterySensor::readVoltage() {
     // Asegurarse de que el ADC esté despierto
     ADC.sendCommand(WAKE_OPCODE_MASK);
     
-    // Leer voltaje diferencial entre AIN9 y COMMON
-    float voltage = AdcUtilities::measureAdcDifferential(muxConfig);
+    // Leer voltaje diferencial entre AIN9 y COMMON con el perfil del canal
+    static const AdcAcquisitionProfile profile = ADC_PROFILE_BATTERY;
+    float voltage = AdcUtilities::measureAdcDifferential(muxConfig, profile);
 #else
     // Configurar la resolución del ADC a 12 bits
     analogReadResolution(12);
@@ -5,7 +5,7 @@
 #include <cmath>
 #include "ADS124S08.h"
 #include "AdcUtilities.h"
-#include "sensors/NtcManager.h"
+#include "MeasurementContext.h"
 
 // Variables globales declaradas en main.cpp
 extern ADS124S08 ADC;
@@ -62,16 +62,17 @@ float ConductivitySensor::read() {
     // Configurar el multiplexor para leer AIN6 con referencia a AINCOM (tierra)
     uint8_t muxConfig = ADS_P_AIN6 | ADS_N_AINCOM;
     
-    // Realizar una única lectura del sensor
-    float voltage = AdcUtilities::measureAdcDifferential(muxConfig);
+    // Realizar una ráfaga de lecturas con el perfil de adquisición del canal
+    static const AdcAcquisitionProfile profile = ADC_PROFILE_COND;
+    float voltage = AdcUtilities::measureAdcDifferential(muxConfig, profile);
     
     // Verificar si el voltaje es válido
     if (isnan(voltage) || voltage <= 0.0f || voltage >= 2.5f) {
         return NAN;
     }
     
-    // Obtener temperatura únicamente del sensor NTC10K
-    float waterTemp = NtcManager::readNtc10kTemperature();
+    // Temperatura del NTC10K, medida una sola vez por ciclo en el contexto de medición
+    float waterTemp = MeasurementContext::get(MEAS_INPUT_NTC10K_TEMPERATURE);
     
     // Convertir a conductividad con compensación de temperatura
     float tdsValue = convertVoltageToConductivity(voltage, waterTemp);
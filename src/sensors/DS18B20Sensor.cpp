@@ -8,7 +8,29 @@
  * @return float Temperatura en °C, o NAN si hay error
  */
 float DS18B20Sensor::read() {
+    // Lectura bloqueante (válida también con conversiones en modo no bloqueante)
+    startConversion();
+    unsigned long start = millis();
+    while (!conversionReady() && millis() - start < DS18B20_CONVERSION_TIME_MS) {
+        delay(1);
+    }
+    return readLatest();
+}
+
+void DS18B20Sensor::begin() {
+    dallasTemp.begin();
+    dallasTemp.setWaitForConversion(false);
+}
+
+void DS18B20Sensor::startConversion() {
     dallasTemp.requestTemperatures();
+}
+
+bool DS18B20Sensor::conversionReady() {
+    return dallasTemp.isConversionComplete();
+}
+
+float DS18B20Sensor::readLatest() {
     float temp = dallasTemp.getTempCByIndex(0);
     if (temp == DEVICE_DISCONNECTED_C) {
         return NAN;
@@ -69,8 +69,9 @@ float HDS10Sensor::read() {
     // Configurar el multiplexor para leer AIN5 con referencia a AIN8
     uint8_t muxConfig = ADS_P_AIN5 | ADS_N_AIN8;
     
-    // Usar AdcUtilities para leer el voltaje diferencial
-    float voltage = AdcUtilities::measureAdcDifferential(muxConfig);
+    // Usar AdcUtilities para leer el voltaje diferencial con el perfil del canal
+    static const AdcAcquisitionProfile profile = ADC_PROFILE_HDS10;
+    float voltage = AdcUtilities::measureAdcDifferential(muxConfig, profile);
     
     // Verificar si el voltaje está en rango válido
     if (voltage <= 0.0f || voltage >= 2.5f) {
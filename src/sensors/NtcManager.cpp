@@ -137,8 +137,9 @@ double NtcManager::readNtc100kTemperature(const char* configKey) {
         return NAN;
     }
 
-    // Medir voltaje diferencial
-    float diffVoltage = AdcUtilities::measureAdcDifferential(muxConfig);
+    // Medir voltaje diferencial con el perfil de adquisición del canal
+    static const AdcAcquisitionProfile profile = ADC_PROFILE_NTC100K;
+    float diffVoltage = AdcUtilities::measureAdcDifferential(muxConfig, profile);
     if (isnan(diffVoltage)) {
         return NAN;
     }
@@ -161,6 +162,17 @@ double NtcManager::readNtc100kTemperature(const char* configKey) {
 }
 
 double NtcManager::readNtc10kTemperature() {
+    // Medir voltaje single-ended con el perfil de adquisición del canal
+    static const AdcAcquisitionProfile profile = ADC_PROFILE_NTC10K;
+    float voltage = AdcUtilities::measureAdcDifferential(NTC10K_MUX_CONFIG, profile);
+    return ntc10kTemperatureFromVoltage(voltage);
+}
+
+double NtcManager::ntc10kTemperatureFromVoltage(float voltage) {
+    if (isnan(voltage)) {
+        return NAN;
+    }
+
     // Obtener calibración NTC10K de la configuración
     // Usando valores por defecto para un NTC10K común
     double t1=25.0, r1=10000.0, t2=50.0, r2=3893.0, t3=85.0, r3=1218.0;
@@ -175,15 +187,6 @@ double NtcManager::readNtc10kTemperature() {
     double A=0, B=0, C=0;
     calculateSteinhartHartCoeffs(T1K, r1, T2K, r2, T3K, r3, A, B, C);
 
-    // NTC3 está en el canal AIN11 con AINCOM
-    uint8_t muxConfig = ADS_P_AIN11 | ADS_N_AIN8;
-    
-    // Medir voltaje single-ended
-    float voltage = AdcUtilities::measureAdcDifferential(muxConfig);
-    if (isnan(voltage)) {
-        return NAN;
-    }
-
     // Calcular la resistencia NTC
     // El NTC en NTC3 está conectado entre 2.5V y el punto medio con resistencia de 10k a GND
     double vRef = 2.5; // Voltaje de referencia
@@ -5,7 +5,7 @@
 #include <cmath>
 #include "ADS124S08.h"
 #include "AdcUtilities.h"
-#include "sensors/NtcManager.h"
+#include "MeasurementContext.h"
 
 // Variables globales declaradas en main.cpp
 extern ADS124S08 ADC;
@@ -75,16 +75,17 @@ float PHSensor::read() {
     // Configurar el multiplexor para leer AIN7 con referencia a AINCOM (tierra)
     uint8_t muxConfig = ADS_P_AIN7 | ADS_N_AINCOM;
     
-    // Realizar una única lectura del sensor
-    float voltage = AdcUtilities::measureAdcDifferential(muxConfig);
+    // Realizar una ráfaga de lecturas con el perfil de adquisición del canal
+    static const AdcAcquisitionProfile profile = ADC_PROFILE_PH;
+    float voltage = AdcUtilities::measureAdcDifferential(muxConfig, profile);
     
     // Verificar si el voltaje es válido
     if (isnan(voltage) || voltage < -2.5f || voltage > 2.5f) {
         return NAN;
     }
     
-    // Obtener temperatura únicamente del sensor NTC10K
-    float waterTemp = NtcManager::readNtc10kTemperature();
+    // Temperatura del NTC10K, medida una sola vez por ciclo en el contexto de medición
+    float waterTemp = MeasurementContext::get(MEAS_INPUT_NTC10K_TEMPERATURE);
     
     // Convertir a pH con compensación de temperatura
     float pHValue = convertVoltageToPH(voltage, waterTemp);
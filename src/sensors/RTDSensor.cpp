@@ -1,5 +1,30 @@
 #include "sensors/RTDSensor.h"
 
+// millis() del último begin(): la conversión automática arranca ahí
+static unsigned long rtdBeginMs = 0;
+
+/**
+ * @brief Inicializa el MAX31865 con conversión automática y filtro de 50 Hz
+ */
+void RTDSensor::begin() {
+    rtd.begin();
+    bool vBias = true;
+    bool autoConvert = true;
+    bool oneShot = false;
+    bool threeWire = false;
+    uint8_t faultCycle = 0; // MAX31865_FAULT_DETECTION_NONE
+    bool faultClear = true;
+    bool filter50Hz = true;
+    uint16_t lowTh = 0x0000;
+    uint16_t highTh = 0x7fff;
+    rtd.configure(vBias, autoConvert, oneShot, threeWire, faultCycle, faultClear, filter50Hz, lowTh, highTh);
+    rtdBeginMs = millis();
+}
+
+bool RTDSensor::conversionReady() {
+    return millis() - rtdBeginMs >= RTD_FIRST_CONVERSION_MS;
+}
+
 /**
  * @brief Lee la temperatura del sensor RTD (PT100)
  * 
@@ -7,7 +32,8 @@
  */
 float RTDSensor::read() {
     uint8_t status = rtd.read_all();
-    if (status == 0) {
+    // Un registro RTD a 0 es una conversión que aún no terminó, no una medida
+    if (status == 0 && rtd.raw_resistance() != 0) {
         return rtd.temperature();
     } else {
         return NAN;
@@ -50,6 +50,17 @@ bool parseEUIString(const char* euiStr, uint64_t* eui) {
     return true;
 } 
 
+void formatKeyString(const uint8_t* bytes, size_t len, char* buffer, size_t bufferSize) {
+    size_t offset = 0;
+    if (bufferSize == 0) {
+        return;
+    }
+    buffer[0] = '\0';
+    for (size_t i = 0; i < len && offset + 3 <= bufferSize; i++) {
+        offset += snprintf(buffer + offset, bufferSize - offset, i == 0 ? "%02x" : ",%02x", bytes[i]);
+    }
+}
+
 /**
  * @brief Formatea un valor flotante con hasta 3 decimales, eliminando ceros finales.
  * @param value Valor flotante a formatear.
@@ -0,0 +1,76 @@
+/*******************************************************************************************
+ * Archivo: test/test_airtime/test_airtime.cpp
+ * Descripción: Pruebas en el host del tiempo en el aire LoRa (util/airtime.h): valores
+ *              conocidos de la calculadora de Semtech, umbral de optimización de baja tasa
+ *              y comparación con la fórmula en coma flotante en toda la rejilla de DR.
+ *******************************************************************************************/
+
+#include <unity.h>
+#include <string.h>
+#include <math.h>
+#include "util/airtime.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+/**
+ * @brief Fórmula de Semtech (AN1200.13) en coma flotante, como referencia
+ */
+static double referenceAirtimeUs(uint8_t sf, uint32_t bandwidthHz, uint8_t crDenominator, size_t phyLength) {
+    double symbolS = (double)(1UL << sf) / (double)bandwidthHz;
+    int lowDataRate = symbolS >= 0.016 ? 1 : 0;
+    double blocks = ceil((8.0 * phyLength - 4.0 * sf + 28 + 16) / (4.0 * (sf - 2 * lowDataRate)));
+    double payloadSymbols = 8 + (blocks > 0 ? blocks : 0) * crDenominator;
+    return ((AIRTIME_PREAMBLE_SYMBOLS + 4.25) + payloadSymbols) * symbolS * 1e6;
+}
+
+void test_known_values(void) {
+    // Uplink de 10 bytes en SF7/125 kHz y uplink vacío en SF12/125 kHz (LDRO activa)
+    TEST_ASSERT_EQUAL_UINT32(61696, loraAirtimeUs(7, 125000, 5, 10 + AIRTIME_LORAWAN_OVERHEAD));
+    TEST_ASSERT_EQUAL_UINT32(1155072, loraAirtimeUs(12, 125000, 5, AIRTIME_LORAWAN_OVERHEAD));
+    TEST_ASSERT_EQUAL_UINT32(698368, loraAirtimeUs(10, 125000, 5, 64));
+    TEST_ASSERT_EQUAL_UINT32(76928, loraAirtimeUs(8, 500000, 5, 100));
+}
+
+void test_low_data_rate_threshold(void) {
+    // SF11/125 kHz (16,384 ms por símbolo) activa la optimización; SF10/125 kHz no
+    TEST_ASSERT_EQUAL_UINT32(1314816, loraAirtimeUs(11, 125000, 5, 51));
+    TEST_ASSERT_EQUAL_UINT32(lround(referenceAirtimeUs(10, 125000, 5, 51)),
+                             loraAirtimeUs(10, 125000, 5, 51));
+    // SF12/250 kHz tiene el mismo símbolo que SF11/125 kHz y también la activa
+    TEST_ASSERT_EQUAL_UINT32(1232896, loraAirtimeUs(12, 250000, 5, 51));
+}
+
+void test_empty_frame_uses_minimum_symbols(void) {
+    // Numerador negativo: solo los 8 símbolos fijos de la carga
+    uint32_t symbolUs = (1UL << 12) * 8;
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)((AIRTIME_PREAMBLE_SYMBOLS + 4.25) * symbolUs) + 8 * symbolUs,
+                             loraAirtimeUs(12, 125000, 5, 0));
+}
+
+void test_matches_reference_formula(void) {
+    const uint32_t bandwidths[] = { 125000, 250000, 500000 };
+    for (uint8_t sf = 7; sf <= 12; sf++) {
+        for (uint8_t b = 0; b < 3; b++) {
+            for (uint8_t cr = 5; cr <= 8; cr++) {
+                uint32_t previous = 0;
+                for (size_t length = 0; length <= 255; length++) {
+                    uint32_t us = loraAirtimeUs(sf, bandwidths[b], cr, length);
+                    TEST_ASSERT_EQUAL_UINT32(lround(referenceAirtimeUs(sf, bandwidths[b], cr, length)), us);
+                    TEST_ASSERT_TRUE(us >= previous);
+                    previous = us;
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_known_values);
+    RUN_TEST(test_low_data_rate_threshold);
+    RUN_TEST(test_empty_frame_uses_minimum_symbols);
+    RUN_TEST(test_matches_reference_formula);
+    return UNITY_END();
+}
@@ -0,0 +1,230 @@
+/*******************************************************************************************
+ * Archivo: test/test_batch_codec/test_batch_codec.cpp
+ * Descripción: Pruebas en el host del codificador de lotes (util/batch_codec.h): ida y
+ *              vuelta con lotes aleatorios, columnas parciales, relojes que retroceden y
+ *              tamaño de un lote ANALOGIC típico frente al payload de DR1.
+ *******************************************************************************************/
+
+#include <unity.h>
+#include <string.h>
+#include "util/batch_codec.h"
+
+#define DR1_PAYLOAD_BYTES   61
+
+static BatchFrame frame;
+static BatchFrame decoded;
+static uint8_t buffer[2048];      // Lote máximo con valores aleatorios de 29 bits
+static uint32_t seed;
+
+static uint32_t nextRandom(void) {
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+static int32_t randomBetween(int32_t low, int32_t high) {
+    return low + (int32_t)(nextRandom() % (uint32_t)(high - low + 1));
+}
+
+void setUp(void) {
+    memset(&frame, 0, sizeof(frame));
+    memset(&decoded, 0, sizeof(decoded));
+    seed = 12345;
+}
+
+void tearDown(void) {}
+
+static void assertSameFrame(const BatchFrame& expected, const BatchFrame& actual) {
+    TEST_ASSERT_EQUAL_UINT8(expected.rows, actual.rows);
+    TEST_ASSERT_EQUAL_UINT8(expected.columnCount, actual.columnCount);
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected.timestamps, actual.timestamps, expected.rows);
+    uint16_t allRows = (uint16_t)((1UL << expected.rows) - 1);
+    for (uint8_t c = 0; c < expected.columnCount; c++) {
+        const BatchColumn& want = expected.columns[c];
+        const BatchColumn& got = actual.columns[c];
+        TEST_ASSERT_EQUAL_UINT8(want.tag, got.tag);
+        TEST_ASSERT_EQUAL_UINT8(want.decimals, got.decimals);
+        TEST_ASSERT_EQUAL_UINT16(want.presentMask & allRows, got.presentMask);
+        for (uint8_t r = 0; r < expected.rows; r++) {
+            if (want.presentMask & (1u << r)) {
+                TEST_ASSERT_EQUAL_INT32(want.values[r], got.values[r]);
+            }
+        }
+    }
+}
+
+static size_t roundTrip(void) {
+    size_t length = batchEncode(frame, buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(length > 0);
+    TEST_ASSERT_TRUE(batchDecode(buffer, length, decoded));
+    assertSameFrame(frame, decoded);
+    return length;
+}
+
+/**
+ * @brief Lote ANALOGIC de 10 filas cada 10 min: batería, NTC 100K y 10K, pH, conductividad,
+ *        HDS10, RTD, SHT30 (temperatura y humedad) y DS18B20, con deriva lenta y ruido
+ *        de lecturas ya filtradas
+ */
+static void fillAnalogicBatch(void) {
+    const float base[] = { 3.92f, 21.3f, 22.1f, 6.98f, 1250.0f, 35.2f, 21.8f, 22.4f, 64.5f, 21.9f };
+    const float trend[] = { -0.002f, 0.08f, 0.07f, 0.0f, 1.5f, 0.2f, 0.08f, 0.09f, -0.3f, 0.08f };
+    const float noise[] = { 0.01f, 0.05f, 0.05f, 0.02f, 2.0f, 0.3f, 0.04f, 0.06f, 0.4f, 0.05f };
+    const uint8_t decimals[] = { 2, 1, 1, 2, 0, 0, 1, 1, 0, 1 };
+    const uint8_t tags[] = { 31 << 2, 0 << 2, 1 << 2, 2 << 2, 3 << 2, 4 << 2, 5 << 2,
+                             (6 << 2) | 0, (6 << 2) | 1, 7 << 2 };
+
+    frame.rows = 10;
+    frame.columnCount = 10;
+    uint32_t timestamp = 1760000000;
+    for (uint8_t r = 0; r < frame.rows; r++) {
+        frame.timestamps[r] = timestamp;
+        timestamp += 600 + randomBetween(-1, 1);   // Sello del DS3231 con ±1 s de la rejilla
+    }
+    for (uint8_t c = 0; c < frame.columnCount; c++) {
+        BatchColumn& column = frame.columns[c];
+        column.tag = tags[c];
+        column.decimals = decimals[c];
+        column.presentMask = 0x3FF;
+        for (uint8_t r = 0; r < frame.rows; r++) {
+            float jitter = noise[c] * (float)randomBetween(-1000, 1000) / 1000.0f;
+            TEST_ASSERT_TRUE(batchQuantize(base[c] + trend[c] * r + jitter, decimals[c],
+                                           column.values[r]));
+        }
+    }
+}
+
+void test_analogic_batch_fits_dr1(void) {
+    for (uint8_t trial = 0; trial < 20; trial++) {
+        seed = 1000 + trial;
+        memset(&frame, 0, sizeof(frame));
+        fillAnalogicBatch();
+        size_t length = roundTrip();
+        TEST_ASSERT_LESS_OR_EQUAL(DR1_PAYLOAD_BYTES, length);
+    }
+}
+
+void test_random_frames_round_trip(void) {
+    for (uint16_t trial = 0; trial < 500; trial++) {
+        memset(&frame, 0, sizeof(frame));
+        frame.rows = (uint8_t)randomBetween(1, BATCH_CODEC_MAX_ROWS);
+        frame.columnCount = (uint8_t)randomBetween(0, BATCH_CODEC_MAX_COLUMNS);
+        frame.timestamps[0] = nextRandom() * 256u;
+        for (uint8_t r = 1; r < frame.rows; r++) {
+            frame.timestamps[r] = frame.timestamps[r - 1] + (uint32_t)randomBetween(-100000, 100000);
+        }
+        uint8_t tag = (uint8_t)randomBetween(0, BATCH_CODEC_TAG_LIMIT - 1);
+        int32_t span = 1 << randomBetween(0, 28);
+        for (uint8_t c = 0; c < frame.columnCount; c++) {
+            BatchColumn& column = frame.columns[c];
+            column.tag = tag;
+            tag = (uint8_t)((tag + randomBetween(1, 40)) % BATCH_CODEC_TAG_LIMIT);
+            column.decimals = (uint8_t)randomBetween(0, BATCH_CODEC_MAX_DECIMALS);
+            column.presentMask = (trial % 3 == 0) ? (uint16_t)nextRandom() : 0xFFFF;
+            for (uint8_t r = 0; r < frame.rows; r++) {
+                column.values[r] = randomBetween(-span, span);
+            }
+        }
+        roundTrip();
+    }
+}
+
+void test_extreme_values_round_trip(void) {
+    frame.rows = 4;
+    frame.columnCount = 2;
+    const uint32_t timestamps[] = { 0xFFFFFF00u, 0x10u, 0x3FFFFF00u, 0x200u };
+    memcpy(frame.timestamps, timestamps, sizeof(timestamps));
+    const int32_t limit = BATCH_CODEC_VALUE_LIMIT - 1;
+    const int32_t values[] = { limit, -limit, limit, -limit };
+    for (uint8_t c = 0; c < frame.columnCount; c++) {
+        frame.columns[c].tag = (uint8_t)(c * 100);
+        frame.columns[c].decimals = BATCH_CODEC_MAX_DECIMALS;
+        frame.columns[c].presentMask = 0x0F;
+        memcpy(frame.columns[c].values, values, sizeof(values));
+    }
+    roundTrip();
+}
+
+void test_clock_stepping_backwards(void) {
+    // El DS3231 se corrige hacia atrás entre la primera y la segunda fila
+    frame.rows = 3;
+    frame.columnCount = 1;
+    frame.timestamps[0] = 1760000600;
+    frame.timestamps[1] = 1760000000;
+    frame.timestamps[2] = 1760000600;
+    frame.columns[0].tag = 0;
+    frame.columns[0].decimals = 1;
+    frame.columns[0].presentMask = 0x07;
+    frame.columns[0].values[0] = 215;
+    frame.columns[0].values[1] = 216;
+    frame.columns[0].values[2] = 214;
+    roundTrip();
+
+    frame.rows = 2;
+    roundTrip();
+}
+
+void test_partial_and_empty_columns(void) {
+    frame.rows = 5;
+    frame.columnCount = 3;
+    for (uint8_t r = 0; r < frame.rows; r++) {
+        frame.timestamps[r] = 1760000000 + r * 300;
+    }
+    frame.columns[0] = { 0, 1, 0x1F, { 210, 211, 212, 213, 214 } };
+    frame.columns[1] = { 4, 0, 0x04, { 0, 0, 55, 0, 0 } };     // Una sola muestra
+    frame.columns[2] = { 8, 2, 0x00, { 0 } };                  // Sin muestras
+    roundTrip();
+}
+
+void test_single_row(void) {
+    frame.rows = 1;
+    frame.columnCount = 1;
+    frame.timestamps[0] = 1760000000;
+    frame.columns[0] = { BATCH_CODEC_TAG_LIMIT - 1, 2, 0x01, { -392 } };
+    roundTrip();
+}
+
+void test_rejects_invalid_input(void) {
+    frame.rows = 2;
+    frame.columnCount = 1;
+    frame.columns[0] = { 0, BATCH_CODEC_MAX_DECIMALS + 1, 0x03, { 1, 2 } };
+    TEST_ASSERT_EQUAL_UINT32(0, batchEncode(frame, buffer, sizeof(buffer)));
+
+    frame.columns[0].decimals = 1;
+    frame.columns[0].tag = BATCH_CODEC_TAG_LIMIT;
+    TEST_ASSERT_EQUAL_UINT32(0, batchEncode(frame, buffer, sizeof(buffer)));
+
+    frame.columns[0].tag = 0;
+    TEST_ASSERT_EQUAL_UINT32(0, batchEncode(frame, buffer, BATCH_CODEC_HEADER_SIZE));
+
+    size_t length = batchEncode(frame, buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(length > BATCH_CODEC_HEADER_SIZE);
+    TEST_ASSERT_FALSE(batchDecode(buffer, length - 1, decoded));
+    buffer[0] = (uint8_t)((BATCH_CODEC_VERSION + 1) << 4);
+    TEST_ASSERT_FALSE(batchDecode(buffer, length, decoded));
+}
+
+void test_quantize(void) {
+    int32_t quantized = 0;
+    TEST_ASSERT_TRUE(batchQuantize(6.98f, 2, quantized));
+    TEST_ASSERT_EQUAL_INT32(698, quantized);
+    TEST_ASSERT_TRUE(batchQuantize(-12.35f, 1, quantized));
+    TEST_ASSERT_EQUAL_INT32(-124, quantized);
+    TEST_ASSERT_TRUE(batchQuantize(1249.6f, 0, quantized));
+    TEST_ASSERT_EQUAL_INT32(1250, quantized);
+    TEST_ASSERT_FALSE(batchQuantize(0.0f / 0.0f, 1, quantized));
+    TEST_ASSERT_FALSE(batchQuantize(1e9f, 1, quantized));
+    TEST_ASSERT_EQUAL_FLOAT(6.98f, (float)batchDequantize(698, 2));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_analogic_batch_fits_dr1);
+    RUN_TEST(test_random_frames_round_trip);
+    RUN_TEST(test_extreme_values_round_trip);
+    RUN_TEST(test_clock_stepping_backwards);
+    RUN_TEST(test_partial_and_empty_columns);
+    RUN_TEST(test_single_row);
+    RUN_TEST(test_rejects_invalid_input);
+    RUN_TEST(test_quantize);
+    return UNITY_END();
+}
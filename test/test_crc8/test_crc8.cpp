@@ -0,0 +1,71 @@
+/*******************************************************************************************
+ * Archivo: test/test_crc8/test_crc8.cpp
+ * Descripción: Pruebas en el host del CRC-8 por tabla (util/crc8.h): valor de comprobación
+ *              estándar, comparación de la tabla con el cálculo bit a bit y detección de un
+ *              bit invertido en una trama del ADS124S08.
+ *******************************************************************************************/
+
+#include <unity.h>
+#include <string.h>
+#include "util/crc8.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+/**
+ * @brief CRC-8 (polinomio 0x07) bit a bit, como referencia de la tabla
+ */
+static uint8_t referenceCrc8(const uint8_t* data, size_t len, uint8_t seed) {
+    uint8_t crc = seed;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+void test_check_value(void) {
+    // CRC-8/SMBUS (semilla 0x00): valor de comprobación 0xF4 para "123456789"
+    const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    TEST_ASSERT_EQUAL_HEX8(0xF4, crc8Poly07(check, sizeof(check), 0x00));
+}
+
+void test_empty_block_returns_seed(void) {
+    TEST_ASSERT_EQUAL_HEX8(CRC8_POLY_0x07_SEED, crc8Poly07(NULL, 0));
+    TEST_ASSERT_EQUAL_HEX8(0x5A, crc8Poly07(NULL, 0, 0x5A));
+}
+
+void test_table_matches_bitwise(void) {
+    uint8_t byte[1];
+    for (uint16_t value = 0; value < 256; value++) {
+        byte[0] = (uint8_t)value;
+        TEST_ASSERT_EQUAL_HEX8(referenceCrc8(byte, 1, 0x00), kCrc8Poly07Table[value]);
+        TEST_ASSERT_EQUAL_HEX8(referenceCrc8(byte, 1, CRC8_POLY_0x07_SEED), crc8Poly07(byte, 1));
+    }
+}
+
+void test_detects_single_bit_error(void) {
+    // Conversión de 24 bits como la envía el ADS124S08, seguida de su CRC
+    uint8_t frame[3] = { 0x12, 0x34, 0x56 };
+    uint8_t crc = crc8Poly07(frame, sizeof(frame));
+    TEST_ASSERT_EQUAL_HEX8(referenceCrc8(frame, sizeof(frame), CRC8_POLY_0x07_SEED), crc);
+
+    for (uint8_t bit = 0; bit < 24; bit++) {
+        uint8_t corrupted[3];
+        memcpy(corrupted, frame, sizeof(frame));
+        corrupted[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+        TEST_ASSERT_TRUE(crc8Poly07(corrupted, sizeof(corrupted)) != crc);
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_check_value);
+    RUN_TEST(test_empty_block_returns_seed);
+    RUN_TEST(test_table_matches_bitwise);
+    RUN_TEST(test_detects_single_bit_error);
+    return UNITY_END();
+}
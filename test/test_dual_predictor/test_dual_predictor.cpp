@@ -0,0 +1,135 @@
+/*******************************************************************************************
+ * Archivo: test/test_dual_predictor/test_dual_predictor.cpp
+ * Descripción: Pruebas en el host del predictor compartido (util/dual_predictor.h): lectura
+ *              del texto del payload, predicción entera, criterio de envío y sincronía entre
+ *              el modelo del dispositivo y el del servidor cuando se pierden uplinks.
+ *******************************************************************************************/
+
+#include <unity.h>
+#include <string.h>
+#include "util/dual_predictor.h"
+
+static DualPredictorState device;
+static DualPredictorState server;
+
+void setUp(void) {
+    dualPredictorReset(device);
+    dualPredictorReset(server);
+}
+
+void tearDown(void) {}
+
+void test_parse_payload_text(void) {
+    int32_t milli = 0;
+    TEST_ASSERT_TRUE(dualPredictorParse("21.5", milli));
+    TEST_ASSERT_EQUAL_INT32(21500, milli);
+    TEST_ASSERT_TRUE(dualPredictorParse("-0.125", milli));
+    TEST_ASSERT_EQUAL_INT32(-125, milli);
+    TEST_ASSERT_TRUE(dualPredictorParse("3.14159", milli));
+    TEST_ASSERT_EQUAL_INT32(3141, milli);
+    TEST_ASSERT_TRUE(dualPredictorParse("+7", milli));
+    TEST_ASSERT_EQUAL_INT32(7000, milli);
+    TEST_ASSERT_FALSE(dualPredictorParse("nan", milli));
+    TEST_ASSERT_FALSE(dualPredictorParse("12a", milli));
+    TEST_ASSERT_FALSE(dualPredictorParse("-", milli));
+    TEST_ASSERT_FALSE(dualPredictorParse("99999999", milli));
+}
+
+void test_hold_and_linear_prediction(void) {
+    int32_t predicted = 0;
+    TEST_ASSERT_FALSE(dualPredict(device, DUAL_PREDICT_LINEAR, 100, predicted));
+
+    dualPredictorUpdate(device, 100, 20000);
+    TEST_ASSERT_TRUE(dualPredict(device, DUAL_PREDICT_LINEAR, 700, predicted));
+    TEST_ASSERT_EQUAL_INT32(20000, predicted);     // Un solo valor: se mantiene
+
+    dualPredictorUpdate(device, 700, 20600);
+    TEST_ASSERT_TRUE(dualPredict(device, DUAL_PREDICT_HOLD, 1300, predicted));
+    TEST_ASSERT_EQUAL_INT32(20600, predicted);
+    TEST_ASSERT_TRUE(dualPredict(device, DUAL_PREDICT_LINEAR, 1300, predicted));
+    TEST_ASSERT_EQUAL_INT32(21200, predicted);
+
+    // Redondeo al entero más cercano, mitades hacia fuera, en ambos sentidos
+    dualPredictorReset(device);
+    dualPredictorUpdate(device, 0, 0);
+    dualPredictorUpdate(device, 2, 1);
+    TEST_ASSERT_TRUE(dualPredict(device, DUAL_PREDICT_LINEAR, 3, predicted));
+    TEST_ASSERT_EQUAL_INT32(2, predicted);
+    dualPredictorReset(device);
+    dualPredictorUpdate(device, 0, 0);
+    dualPredictorUpdate(device, 2, -1);
+    TEST_ASSERT_TRUE(dualPredict(device, DUAL_PREDICT_LINEAR, 3, predicted));
+    TEST_ASSERT_EQUAL_INT32(-2, predicted);
+}
+
+void test_prediction_saturates(void) {
+    int32_t predicted = 0;
+    dualPredictorUpdate(device, 0, INT32_MAX - 10);
+    dualPredictorUpdate(device, 1, INT32_MAX);
+    TEST_ASSERT_TRUE(dualPredict(device, DUAL_PREDICT_LINEAR, 1000000, predicted));
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, predicted);
+}
+
+void test_same_instant_replaces_value(void) {
+    dualPredictorUpdate(device, 100, 1000);
+    dualPredictorUpdate(device, 200, 2000);
+    dualPredictorUpdate(device, 200, 2500);
+    TEST_ASSERT_EQUAL_UINT8(2, device.count);
+    TEST_ASSERT_EQUAL_UINT32(100, device.t0);
+    TEST_ASSERT_EQUAL_UINT32(200, device.t1);
+    TEST_ASSERT_EQUAL_INT32(2500, device.v1);
+}
+
+void test_mispredicts_tolerance_and_silence(void) {
+    TEST_ASSERT_TRUE(dualPredictorMispredicts(device, DUAL_PREDICT_LINEAR, 0, 1000, 100, 0));
+
+    dualPredictorUpdate(device, 0, 1000);
+    TEST_ASSERT_FALSE(dualPredictorMispredicts(device, DUAL_PREDICT_HOLD, 600, 1100, 100, 0));
+    TEST_ASSERT_TRUE(dualPredictorMispredicts(device, DUAL_PREDICT_HOLD, 600, 1101, 100, 0));
+    TEST_ASSERT_TRUE(dualPredictorMispredicts(device, DUAL_PREDICT_HOLD, 600, 899, 100, 0));
+    TEST_ASSERT_FALSE(dualPredictorMispredicts(device, DUAL_PREDICT_HOLD, 599, 1000, 100, 600));
+    TEST_ASSERT_TRUE(dualPredictorMispredicts(device, DUAL_PREDICT_HOLD, 600, 1000, 100, 600));
+}
+
+/**
+ * @brief Ciclo de reporte: el dispositivo decide con su modelo y solo lo actualiza si el
+ *        uplink llegó; el servidor actualiza con lo que recibe y predice el resto
+ */
+static void reportCycle(uint32_t t, int32_t milli, bool delivered) {
+    if (!dualPredictorMispredicts(device, DUAL_PREDICT_LINEAR, t, milli, 50, 0)) {
+        return;
+    }
+    if (delivered) {
+        dualPredictorUpdate(server, t, milli);
+        dualPredictorUpdate(device, t, milli);
+    }
+}
+
+void test_models_stay_in_sync_with_lost_uplinks(void) {
+    uint32_t seed = 99;
+    int32_t value = 20000;
+    for (uint32_t cycle = 0; cycle < 500; cycle++) {
+        seed = seed * 1103515245u + 12345u;
+        value += (int32_t)((seed >> 16) % 41) - 20 + ((cycle / 50) % 2 ? 15 : -15);
+        bool delivered = (seed >> 8) % 5 != 0;     // Uno de cada cinco uplinks se pierde
+        reportCycle(cycle * 600, value, delivered);
+        TEST_ASSERT_EQUAL_MEMORY(&server, &device, sizeof(device));
+
+        int32_t fromDevice = 0, fromServer = 0;
+        bool deviceKnows = dualPredict(device, DUAL_PREDICT_LINEAR, cycle * 600 + 600, fromDevice);
+        bool serverKnows = dualPredict(server, DUAL_PREDICT_LINEAR, cycle * 600 + 600, fromServer);
+        TEST_ASSERT_EQUAL(deviceKnows, serverKnows);
+        TEST_ASSERT_EQUAL_INT32(fromServer, fromDevice);
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_payload_text);
+    RUN_TEST(test_hold_and_linear_prediction);
+    RUN_TEST(test_prediction_saturates);
+    RUN_TEST(test_same_instant_replaces_value);
+    RUN_TEST(test_mispredicts_tolerance_and_silence);
+    RUN_TEST(test_models_stay_in_sync_with_lost_uplinks);
+    return UNITY_END();
+}
@@ -0,0 +1,85 @@
+/*******************************************************************************************
+ * Archivo: test/test_ring_buffer/test_ring_buffer.cpp
+ * Descripción: Pruebas en el host del buffer circular (util/ring_buffer.h): orden FIFO,
+ *              vuelta del índice, descarte del elemento más antiguo al desbordar y clear().
+ *******************************************************************************************/
+
+#include <unity.h>
+#include <string.h>
+#include "util/ring_buffer.h"
+
+static RingBuffer<int32_t, 4> ring;
+
+void setUp(void) {
+    ring.clear();
+}
+
+void tearDown(void) {}
+
+void test_starts_empty(void) {
+    int32_t value = 0;
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_FALSE(ring.full());
+    TEST_ASSERT_EQUAL_UINT32(4, (RingBuffer<int32_t, 4>::capacity()));
+    TEST_ASSERT_FALSE(ring.pop(value));
+}
+
+void test_fifo_order_across_wrap(void) {
+    int32_t value = 0;
+    // Avanzar la cola para que las inserciones den la vuelta al final del arreglo
+    for (int32_t i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(ring.push(i));
+        TEST_ASSERT_TRUE(ring.pop(value));
+    }
+    for (int32_t i = 10; i < 14; i++) {
+        TEST_ASSERT_TRUE(ring.push(i));
+    }
+    TEST_ASSERT_TRUE(ring.full());
+    for (int32_t i = 10; i < 14; i++) {
+        TEST_ASSERT_TRUE(ring.pop(value));
+        TEST_ASSERT_EQUAL_INT32(i, value);
+    }
+    TEST_ASSERT_TRUE(ring.empty());
+}
+
+void test_overflow_drops_oldest(void) {
+    int32_t value = 0;
+    for (int32_t i = 1; i <= 4; i++) {
+        ring.push(i);
+    }
+    uint32_t overflowsBefore = ring.overflows();
+    TEST_ASSERT_FALSE(ring.push(5));
+    TEST_ASSERT_FALSE(ring.push(6));
+    TEST_ASSERT_EQUAL_UINT32(overflowsBefore + 2, ring.overflows());
+    TEST_ASSERT_EQUAL_UINT32(4, ring.size());
+
+    for (int32_t expected = 3; expected <= 6; expected++) {
+        TEST_ASSERT_TRUE(ring.pop(value));
+        TEST_ASSERT_EQUAL_INT32(expected, value);
+    }
+}
+
+void test_clear_keeps_overflow_count(void) {
+    int32_t value = 0;
+    for (int32_t i = 0; i < 6; i++) {
+        ring.push(i);
+    }
+    uint32_t overflows = ring.overflows();
+    ring.clear();
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_FALSE(ring.pop(value));
+    // El contador de desbordes es acumulativo: clear() solo vacía el contenido
+    TEST_ASSERT_EQUAL_UINT32(overflows, ring.overflows());
+    TEST_ASSERT_TRUE(ring.push(42));
+    TEST_ASSERT_TRUE(ring.pop(value));
+    TEST_ASSERT_EQUAL_INT32(42, value);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_empty);
+    RUN_TEST(test_fifo_order_across_wrap);
+    RUN_TEST(test_overflow_drops_oldest);
+    RUN_TEST(test_clear_keeps_overflow_count);
+    return UNITY_END();
+}
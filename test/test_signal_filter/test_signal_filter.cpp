@@ -0,0 +1,128 @@
+/*******************************************************************************************
+ * Archivo: test/test_signal_filter/test_signal_filter.cpp
+ * Descripción: Pruebas en el host de los filtros de canal (util/signal_filter.h): EMA,
+ *              mediana deslizante con ventana parcial y número par de muestras, Kalman 1-D
+ *              y paso directo sin filtro.
+ *******************************************************************************************/
+
+#include <unity.h>
+#include <string.h>
+#include "util/signal_filter.h"
+
+static SignalFilterState state;
+static SignalFilterParams params;
+
+void setUp(void) {
+    signalFilterReset(state);
+    params.emaAlpha = 0.25f;
+    params.medianWindow = 5;
+    params.kalmanQ = 0.01f;
+    params.kalmanR = 1.0f;
+}
+
+void tearDown(void) {}
+
+void test_ema_first_sample_and_smoothing(void) {
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, signalFilterUpdate(state, SIGNAL_FILTER_EMA, params, 20.0f));
+    TEST_ASSERT_EQUAL_FLOAT(21.0f, signalFilterUpdate(state, SIGNAL_FILTER_EMA, params, 24.0f));
+    TEST_ASSERT_EQUAL_FLOAT(20.75f, signalFilterUpdate(state, SIGNAL_FILTER_EMA, params, 20.0f));
+
+    // Un escalón se alcanza de forma geométrica: el error restante es (1 - alpha)^n
+    signalFilterReset(state);
+    signalFilterUpdate(state, SIGNAL_FILTER_EMA, params, 0.0f);
+    float out = 0.0f;
+    for (uint8_t i = 0; i < 4; i++) {
+        out = signalFilterUpdate(state, SIGNAL_FILTER_EMA, params, 100.0f);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 100.0f * (1.0f - 0.31640625f), out);
+}
+
+void test_median_partial_window(void) {
+    // Menos muestras que la ventana: mediana de las disponibles
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, signalFilterUpdate(state, SIGNAL_FILTER_MEDIAN, params, 5.0f));
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, signalFilterUpdate(state, SIGNAL_FILTER_MEDIAN, params, 1.0f));
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, signalFilterUpdate(state, SIGNAL_FILTER_MEDIAN, params, 9.0f));
+    TEST_ASSERT_EQUAL_FLOAT(6.0f, signalFilterUpdate(state, SIGNAL_FILTER_MEDIAN, params, 7.0f));
+}
+
+void test_median_even_window_averages_middle_pair(void) {
+    params.medianWindow = 4;
+    const float samples[] = { 10.0f, 40.0f, 20.0f, 30.0f };
+    float out = 0.0f;
+    for (uint8_t i = 0; i < 4; i++) {
+        out = signalFilterUpdate(state, SIGNAL_FILTER_MEDIAN, params, samples[i]);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, out);
+    // Ventana llena: la muestra más antigua (10) sale al entrar la nueva
+    TEST_ASSERT_EQUAL_FLOAT(35.0f, signalFilterUpdate(state, SIGNAL_FILTER_MEDIAN, params, 50.0f));
+}
+
+void test_median_rejects_spike(void) {
+    params.medianWindow = 3;
+    signalFilterUpdate(state, SIGNAL_FILTER_MEDIAN, params, 7.00f);
+    signalFilterUpdate(state, SIGNAL_FILTER_MEDIAN, params, 7.02f);
+    TEST_ASSERT_EQUAL_FLOAT(7.02f, signalFilterUpdate(state, SIGNAL_FILTER_MEDIAN, params, 14.0f));
+    TEST_ASSERT_EQUAL_FLOAT(7.02f, signalFilterUpdate(state, SIGNAL_FILTER_MEDIAN, params, 7.01f));
+}
+
+void test_median_window_is_clamped(void) {
+    params.medianWindow = 0;
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, signalFilterUpdate(state, SIGNAL_FILTER_MEDIAN, params, 3.0f));
+    TEST_ASSERT_EQUAL_FLOAT(8.0f, signalFilterUpdate(state, SIGNAL_FILTER_MEDIAN, params, 8.0f));
+
+    signalFilterReset(state);
+    params.medianWindow = SIGNAL_FILTER_MEDIAN_MAX + 5;
+    float out = 0.0f;
+    for (uint8_t i = 1; i <= SIGNAL_FILTER_MEDIAN_MAX + 2; i++) {
+        out = signalFilterUpdate(state, SIGNAL_FILTER_MEDIAN, params, (float)i);
+    }
+    // Ventana de SIGNAL_FILTER_MEDIAN_MAX (7): últimas muestras 3..9
+    TEST_ASSERT_EQUAL_FLOAT(6.0f, out);
+}
+
+void test_kalman_converges_and_variance_shrinks(void) {
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, signalFilterUpdate(state, SIGNAL_FILTER_KALMAN, params, 10.0f));
+    TEST_ASSERT_EQUAL_FLOAT(params.kalmanR, state.variance);
+
+    // Primera corrección: P = 1 + 0,01, K = 1,01 / 2,01
+    float gain = 1.01f / 2.01f;
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 10.0f + gain * 2.0f,
+                             signalFilterUpdate(state, SIGNAL_FILTER_KALMAN, params, 12.0f));
+
+    float previousVariance = state.variance;
+    float out = 0.0f;
+    for (uint8_t i = 0; i < 200; i++) {
+        out = signalFilterUpdate(state, SIGNAL_FILTER_KALMAN, params, (i % 2) ? 20.5f : 19.5f);
+        TEST_ASSERT_TRUE(state.variance <= previousVariance + 1e-6f);
+        previousVariance = state.variance;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 20.0f, out);
+    // Régimen estacionario: P = (-Q + sqrt(Q^2 + 4QR)) / 2 ≈ 0,0951
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0951f, state.variance);
+}
+
+void test_none_passes_through(void) {
+    TEST_ASSERT_EQUAL_FLOAT(-3.5f, signalFilterUpdate(state, SIGNAL_FILTER_NONE, params, -3.5f));
+    TEST_ASSERT_EQUAL_FLOAT(99.0f, signalFilterUpdate(state, SIGNAL_FILTER_NONE, params, 99.0f));
+}
+
+void test_count_saturates(void) {
+    for (uint16_t i = 0; i < 300; i++) {
+        signalFilterUpdate(state, SIGNAL_FILTER_EMA, params, 1.0f);
+    }
+    TEST_ASSERT_EQUAL_UINT8(255, state.count);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, state.estimate);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_ema_first_sample_and_smoothing);
+    RUN_TEST(test_median_partial_window);
+    RUN_TEST(test_median_even_window_averages_middle_pair);
+    RUN_TEST(test_median_rejects_spike);
+    RUN_TEST(test_median_window_is_clamped);
+    RUN_TEST(test_kalman_converges_and_variance_shrinks);
+    RUN_TEST(test_none_passes_through);
+    RUN_TEST(test_count_saturates);
+    return UNITY_END();
+}
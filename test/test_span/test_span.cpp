@@ -0,0 +1,78 @@
+/*******************************************************************************************
+ * Archivo: test/test_span/test_span.cpp
+ * Descripción: Pruebas en el host de la vista no propietaria (util/span.h): construcción
+ *              desde arreglo y puntero, recorrido, escritura a través de la vista y
+ *              conversión a Span<const T>.
+ *******************************************************************************************/
+
+#include <unity.h>
+#include <string.h>
+#include "util/span.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static float sum(Span<const float> values) {
+    float total = 0.0f;
+    for (const float* it = values.begin(); it != values.end(); ++it) {
+        total += *it;
+    }
+    return total;
+}
+
+void test_default_is_empty(void) {
+    Span<int> span;
+    TEST_ASSERT_TRUE(span.empty());
+    TEST_ASSERT_EQUAL_UINT32(0, span.size());
+    TEST_ASSERT_NULL(span.data());
+    TEST_ASSERT_TRUE(span.begin() == span.end());
+}
+
+void test_from_array_deduces_size(void) {
+    int values[5] = { 1, 2, 3, 4, 5 };
+    Span<int> span(values);
+    TEST_ASSERT_FALSE(span.empty());
+    TEST_ASSERT_EQUAL_UINT32(5, span.size());
+    TEST_ASSERT_EQUAL_PTR(values, span.data());
+    TEST_ASSERT_EQUAL_INT(4, span[3]);
+}
+
+void test_from_pointer_uses_given_length(void) {
+    // Vista parcial: solo las lecturas válidas de un buffer de capacidad fija
+    float buffer[8] = { 1.5f, 2.5f, 3.0f, 99.0f, 99.0f, 99.0f, 99.0f, 99.0f };
+    Span<const float> valid(buffer, 3);
+    TEST_ASSERT_EQUAL_UINT32(3, valid.size());
+    TEST_ASSERT_EQUAL_FLOAT(7.0f, sum(valid));
+}
+
+void test_writes_reach_the_underlying_array(void) {
+    uint8_t bytes[4];
+    memset(bytes, 0, sizeof(bytes));
+    Span<uint8_t> span(bytes);
+    for (size_t i = 0; i < span.size(); i++) {
+        span[i] = (uint8_t)(0xA0 + i);
+    }
+    TEST_ASSERT_EQUAL_HEX8(0xA0, bytes[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xA3, bytes[3]);
+}
+
+void test_converts_to_const_view(void) {
+    float values[] = { 0.25f, 0.75f };
+    Span<float> mutableSpan(values);
+    Span<const float> constSpan = mutableSpan;
+    TEST_ASSERT_EQUAL_PTR(values, constSpan.data());
+    TEST_ASSERT_EQUAL_UINT32(2, constSpan.size());
+    // Conversión implícita en la llamada
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, sum(mutableSpan));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_default_is_empty);
+    RUN_TEST(test_from_array_deduces_size);
+    RUN_TEST(test_from_pointer_uses_given_length);
+    RUN_TEST(test_writes_reach_the_underlying_array);
+    RUN_TEST(test_converts_to_const_view);
+    return UNITY_END();
+}
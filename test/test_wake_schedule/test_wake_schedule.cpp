@@ -0,0 +1,97 @@
+/*******************************************************************************************
+ * Archivo: test/test_wake_schedule/test_wake_schedule.cpp
+ * Descripción: Pruebas en el host de la lógica de ticks del wake stub
+ *              (util/wake_schedule.h): decisión por tick y re-armado sobre la rejilla.
+ *******************************************************************************************/
+
+#include <unity.h>
+#include <string.h>
+#include "util/wake_schedule.h"
+
+static WakeSchedule schedule;
+
+void setUp(void) {
+    memset(&schedule, 0, sizeof(schedule));
+}
+
+void tearDown(void) {}
+
+static void initSchedule(uint16_t sampleEvery, uint16_t reportEvery, uint16_t reportPhase = 0) {
+    const WakeTask tasks[] = {
+        { sampleEvery, 0, WAKE_TASK_SAMPLE },
+        { reportEvery, reportPhase, WAKE_TASK_REPORT },
+    };
+    wakeScheduleInit(&schedule, tasks, 2);
+}
+
+void test_report_wins_over_sample(void) {
+    initSchedule(1, 3);
+    uint8_t mask = 0;
+    TEST_ASSERT_EQUAL(WAKE_DECISION_REPORT, wakeScheduleEvaluate(&schedule, 0, &mask));
+    TEST_ASSERT_EQUAL_UINT8(0x03, mask);
+    TEST_ASSERT_EQUAL(WAKE_DECISION_SAMPLE, wakeScheduleEvaluate(&schedule, 1, &mask));
+    TEST_ASSERT_EQUAL_UINT8(0x01, mask);
+    TEST_ASSERT_EQUAL(WAKE_DECISION_REPORT, wakeScheduleEvaluate(&schedule, 3, &mask));
+}
+
+void test_idle_ticks_between_tasks(void) {
+    initSchedule(4, 8);
+    WakeDecision expected[] = {
+        WAKE_DECISION_IDLE, WAKE_DECISION_IDLE, WAKE_DECISION_IDLE, WAKE_DECISION_SAMPLE,
+        WAKE_DECISION_IDLE, WAKE_DECISION_IDLE, WAKE_DECISION_IDLE, WAKE_DECISION_REPORT,
+    };
+    for (uint8_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        TEST_ASSERT_EQUAL(expected[i], wakeScheduleAdvance(&schedule));
+        TEST_ASSERT_EQUAL_UINT32(i + 1, schedule.tick);
+    }
+    TEST_ASSERT_EQUAL_UINT8(0x03, schedule.dueMask);
+}
+
+void test_phase_and_disabled_task(void) {
+    initSchedule(0, 5, 2);
+    uint8_t mask = 0xFF;
+    TEST_ASSERT_EQUAL(WAKE_DECISION_IDLE, wakeScheduleEvaluate(&schedule, 0, &mask));
+    TEST_ASSERT_EQUAL_UINT8(0, mask);
+    TEST_ASSERT_EQUAL(WAKE_DECISION_REPORT, wakeScheduleEvaluate(&schedule, 2, &mask));
+    TEST_ASSERT_EQUAL_UINT8(0x02, mask);
+    TEST_ASSERT_EQUAL(WAKE_DECISION_REPORT, wakeScheduleEvaluate(&schedule, 7, nullptr));
+}
+
+void test_init_clamps_task_count(void) {
+    WakeTask tasks[WAKE_SCHEDULE_MAX_TASKS + 2];
+    for (uint8_t i = 0; i < WAKE_SCHEDULE_MAX_TASKS + 2; i++) {
+        tasks[i] = { 1, 0, WAKE_TASK_SAMPLE };
+    }
+    wakeScheduleInit(&schedule, tasks, WAKE_SCHEDULE_MAX_TASKS + 2);
+    TEST_ASSERT_EQUAL_UINT8(WAKE_SCHEDULE_MAX_TASKS, schedule.taskCount);
+    TEST_ASSERT_EQUAL_UINT32(0, schedule.tick);
+}
+
+void test_next_wake_follows_grid(void) {
+    // El stub despierta tarde (latencia de arranque): el siguiente sigue en la rejilla
+    const uint64_t period = 150000;
+    uint64_t scheduled = 1000000;
+    for (uint32_t k = 1; k <= 20; k++) {
+        uint64_t actualWake = scheduled + 37 + (k % 5) * 11;
+        scheduled = wakeScheduleNextWake(scheduled, period, actualWake + 200);
+        TEST_ASSERT_EQUAL_UINT64(1000000 + k * period, scheduled);
+    }
+}
+
+void test_next_wake_reanchors_when_late(void) {
+    // Sin ancla o con el despertar previsto ya pasado se cuenta desde 'now'
+    TEST_ASSERT_EQUAL_UINT64(5000 + 100, wakeScheduleNextWake(0, 100, 5000));
+    TEST_ASSERT_EQUAL_UINT64(5000 + 100, wakeScheduleNextWake(4800, 100, 5000));
+    TEST_ASSERT_EQUAL_UINT64(4800 + 300, wakeScheduleNextWake(4800, 300, 5000));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_report_wins_over_sample);
+    RUN_TEST(test_idle_ticks_between_tasks);
+    RUN_TEST(test_phase_and_disabled_task);
+    RUN_TEST(test_init_clamps_task_count);
+    RUN_TEST(test_next_wake_follows_grid);
+    RUN_TEST(test_next_wake_reanchors_when_late);
+    return UNITY_END();
+}
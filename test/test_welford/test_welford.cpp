@@ -0,0 +1,87 @@
+/*******************************************************************************************
+ * Archivo: test/test_welford/test_welford.cpp
+ * Descripción: Pruebas en el host del acumulador de Welford (util/welford.h): media,
+ *              desviación estándar muestral, mínimo y máximo, casos con 0 y 1 muestras y
+ *              estabilidad con un desplazamiento grande.
+ *******************************************************************************************/
+
+#include <unity.h>
+#include <string.h>
+#include "util/welford.h"
+
+static WelfordAccumulator acc;
+
+void setUp(void) {
+    welfordReset(acc);
+}
+
+void tearDown(void) {}
+
+void test_empty_and_single_sample(void) {
+    TEST_ASSERT_EQUAL_UINT16(0, acc.count);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, welfordStddev(acc));
+
+    welfordAdd(acc, -4.5f);
+    TEST_ASSERT_EQUAL_UINT16(1, acc.count);
+    TEST_ASSERT_EQUAL_FLOAT(-4.5f, acc.mean);
+    TEST_ASSERT_EQUAL_FLOAT(-4.5f, acc.min);
+    TEST_ASSERT_EQUAL_FLOAT(-4.5f, acc.max);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, welfordStddev(acc));
+}
+
+void test_mean_stddev_min_max(void) {
+    // Serie clásica: media 5, desviación poblacional 2, muestral sqrt(32/7)
+    const float samples[] = { 2.0f, 4.0f, 4.0f, 4.0f, 5.0f, 5.0f, 7.0f, 9.0f };
+    for (uint8_t i = 0; i < 8; i++) {
+        welfordAdd(acc, samples[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT16(8, acc.count);
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, acc.mean);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, sqrtf(32.0f / 7.0f), welfordStddev(acc));
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, acc.min);
+    TEST_ASSERT_EQUAL_FLOAT(9.0f, acc.max);
+}
+
+void test_constant_series_has_zero_stddev(void) {
+    for (uint8_t i = 0; i < 15; i++) {
+        welfordAdd(acc, 21.3f);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(21.3f, acc.mean);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, welfordStddev(acc));
+    TEST_ASSERT_EQUAL_FLOAT(acc.min, acc.max);
+}
+
+void test_large_offset_is_stable(void) {
+    // Conductividad alrededor de 10000 con ruido de ±0,5: la suma de cuadrados ingenua en
+    // float perdería la varianza; Welford la conserva
+    for (uint8_t i = 0; i < 100; i++) {
+        welfordAdd(acc, 10000.0f + ((i % 2) ? 0.5f : -0.5f));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 10000.0f, acc.mean);
+    TEST_ASSERT_FLOAT_WITHIN(5e-3f, sqrtf(25.0f / 99.0f), welfordStddev(acc));
+    TEST_ASSERT_EQUAL_FLOAT(9999.5f, acc.min);
+    TEST_ASSERT_EQUAL_FLOAT(10000.5f, acc.max);
+}
+
+void test_reset_clears_previous_window(void) {
+    welfordAdd(acc, 100.0f);
+    welfordAdd(acc, 200.0f);
+    welfordReset(acc);
+    welfordAdd(acc, 1.0f);
+    welfordAdd(acc, 3.0f);
+    TEST_ASSERT_EQUAL_UINT16(2, acc.count);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, acc.mean);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, acc.min);
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, acc.max);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, sqrtf(2.0f), welfordStddev(acc));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_and_single_sample);
+    RUN_TEST(test_mean_stddev_min_max);
+    RUN_TEST(test_constant_series_has_zero_stddev);
+    RUN_TEST(test_large_offset_is_stable);
+    RUN_TEST(test_reset_clears_previous_window);
+    return UNITY_END();
+}